@@ -0,0 +1,188 @@
+//
+//  aligned_buffer.hpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#ifndef kssmath_aligned_buffer_hpp
+#define kssmath_aligned_buffer_hpp
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+#include "parallel.hpp"
+#include "workspace.hpp"
+
+namespace kss { namespace math {
+
+    /*!
+     Options for AlignedBuffer.
+     */
+    struct AlignedBufferOptions {
+        /*!
+         Back large buffers with transparent huge pages, where the system supports
+         them. This reduces TLB misses for large streaming kernels, but pages are
+         then placed by first touch in 2 MB units rather than 4 KB ones.
+         */
+        bool        hugePages = false;
+
+        /*!
+         The number of threads that initialize the buffer (0 uses
+         defaultThreadCount()). This should match the threads of the kernels that will
+         use it.
+         */
+        unsigned    threads = 0;
+    };
+
+    namespace _private {
+
+        // The number of elements of T in a 4 KB page.
+        template <class T>
+        constexpr std::size_t elementsPerPage() noexcept {
+            return (4096 / sizeof(T) > 0 ? 4096 / sizeof(T) : 1);
+        }
+
+        // Fill [data, data+n) with parallelRanges, in whole pages, so that each
+        // page is first touched, and so placed, by the pool worker that runs the
+        // same range in a kernel that uses AlignedBuffer::parallelRanges with the
+        // same threads.
+        template <class T, class Fill>
+        void firstTouch(T* data, std::size_t n, unsigned threads, const Fill& fill) {
+            parallelRanges(n, elementsPerPage<T>(), [&](std::size_t begin, std::size_t end) {
+                fill(data, begin, end);
+            }, threads);
+        }
+
+    }
+
+    /*!
+     A fixed size array of a trivial numeric type, aligned to 64 bytes (a cache
+     line, and enough for any SIMD load), for the data of bandwidth bound
+     kernels.
+
+     Large buffers are mapped directly from the system, so none of their pages
+     exist until they are written. The constructors then initialize the buffer
+     with kss::math::parallelRanges, one contiguous range of whole pages per
+     pool worker. On a NUMA machine the system places each page on the node of
+     the thread that first touches it, so with the workers pinned (see
+     setThreadPinning()) a kernel that divides its work with parallelRanges()
+     below, on the same number of threads, reads each range from the node of
+     the worker that runs it. A buffer initialized
+     by a single thread (for example a std::vector) ends up entirely on one
+     node, which halves the bandwidth available to the kernels on a two socket
+     machine. Kernels that use parallelFor get no such placement, since its
+     chunks are handed out dynamically.
+
+     AlignedBuffer is copyable (the copy is made in parallel) and movable.
+     */
+    template <class T>
+    class AlignedBuffer {
+    public:
+        static_assert(std::is_trivially_copyable<T>::value, "AlignedBuffer: T must be trivially copyable");
+
+        using value_type = T;
+        using size_type = std::size_t;
+        using iterator = T*;
+        using const_iterator = const T*;
+
+        AlignedBuffer() = default;
+
+        /*!
+         Construct a buffer of n elements, all set to value.
+         @throws std::bad_alloc if the memory cannot be allocated.
+         */
+        explicit AlignedBuffer(size_type n, const T& value = T(),
+                               const AlignedBufferOptions& opts = AlignedBufferOptions())
+        : AlignedBuffer(Uninitialized(), n, opts.hugePages)
+        {
+            _private::firstTouch(_data, n, opts.threads, [&value](T* d, std::size_t begin, std::size_t end) {
+                std::fill(d + begin, d + end, value);
+            });
+        }
+
+        /*!
+         Construct a buffer holding a copy of [first, last).
+         @throws std::bad_alloc if the memory cannot be allocated.
+         */
+        AlignedBuffer(const T* first, const T* last, const AlignedBufferOptions& opts = AlignedBufferOptions())
+        : AlignedBuffer(Uninitialized(), size_type(last - first), opts.hugePages)
+        {
+            _private::firstTouch(_data, _size, opts.threads, [first](T* d, std::size_t begin, std::size_t end) {
+                std::copy(first + begin, first + end, d + begin);
+            });
+        }
+
+        AlignedBuffer(const AlignedBuffer& other) : AlignedBuffer(other.begin(), other.end()) {}
+
+        AlignedBuffer(AlignedBuffer&& other) noexcept
+        : _region(other._region), _data(other._data), _size(other._size)
+        {
+            other._region = _private::MemoryRegion();
+            other._data = nullptr;
+            other._size = 0;
+        }
+
+        AlignedBuffer& operator=(AlignedBuffer other) noexcept {
+            swap(other);
+            return *this;
+        }
+
+        ~AlignedBuffer() noexcept {
+            if (_region.data != nullptr) {
+                _private::freeRegion(_region);
+            }
+        }
+
+        void swap(AlignedBuffer& other) noexcept {
+            std::swap(_region, other._region);
+            std::swap(_data, other._data);
+            std::swap(_size, other._size);
+        }
+
+        size_type size() const noexcept { return _size; }
+        bool empty() const noexcept { return _size == 0; }
+
+        T* data() noexcept { return _data; }
+        const T* data() const noexcept { return _data; }
+
+        iterator begin() noexcept { return _data; }
+        iterator end() noexcept { return _data + _size; }
+        const_iterator begin() const noexcept { return _data; }
+        const_iterator end() const noexcept { return _data + _size; }
+
+        T& operator[](size_type i) noexcept { return _data[i]; }
+        const T& operator[](size_type i) const noexcept { return _data[i]; }
+
+        /*!
+         Call fn(begin, end) for the same ranges of elements, on the same pool
+         workers, as initialized a buffer of this size on the given number of
+         threads (which should be the threads of its options).
+         */
+        void parallelRanges(const std::function<void(size_type, size_type)>& fn, unsigned threads = 0) const {
+            kss::math::parallelRanges(_size, _private::elementsPerPage<T>(), fn, threads);
+        }
+
+    private:
+        _private::MemoryRegion  _region;
+        T*                      _data = nullptr;
+        size_type               _size = 0;
+
+        struct Uninitialized {};
+
+        AlignedBuffer(Uninitialized, size_type n, bool hugePages) : _size(n) {
+            if (n > 0) {
+                _region = _private::allocateRegion(n * sizeof(T), hugePages);
+                _data = reinterpret_cast<T*>(_region.data);
+            }
+        }
+    };
+
+}}
+
+#endif
@@ -0,0 +1,537 @@
+//
+//  amg.hpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#ifndef kssmath_amg_hpp
+#define kssmath_amg_hpp
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "blocking.hpp"
+#include "cholesky.hpp"
+#include "error.hpp"
+#include "krylov_eigen.hpp"
+#include "linear_operator.hpp"
+#include "matrix.hpp"
+#include "parallel.hpp"
+#include "sparse_matrix.hpp"
+#include "sparse_product.hpp"
+#include "workspace.hpp"
+
+namespace kss { namespace math {
+
+    /*!
+     The smoother used on each level of the AMG hierarchy.
+     */
+    enum class AMGSmoother {
+        GaussSeidel,    ///< Hybrid Gauss-Seidel: Gauss-Seidel within fixed row blocks, Jacobi between them.
+        Chebyshev       ///< Chebyshev polynomial in D^-1*A, which only needs matrix-vector products.
+    };
+
+    /*!
+     Options for SmoothedAggregationAMG.
+     */
+    struct AMGOptions {
+        /*!
+         Off diagonal entry a(i,j) is a strong connection if
+         |a(i,j)| >= strengthThreshold * sqrt(|a(i,i)*a(j,j)|). Only strong
+         connections are used to form the aggregates.
+         */
+        double          strengthThreshold = 0.08;
+
+        /*!
+         The prolongator smoothing weight is prolongatorDamping / rho(D^-1*A).
+         */
+        double          prolongatorDamping = 4.0 / 3.0;
+
+        /*!
+         Coarsening stops once a level has at most this many unknowns (which are
+         then solved directly) or maxLevels is reached.
+         */
+        std::size_t     coarseSize = 500;
+        std::size_t     maxLevels = 10;
+
+        AMGSmoother     smoother = AMGSmoother::GaussSeidel;
+
+        /*!
+         The number of pre- and post-smoothing sweeps on each level.
+         */
+        unsigned        smoothingSteps = 1;
+
+        /*!
+         The degree of the Chebyshev polynomial, when that smoother is used.
+         */
+        unsigned        chebyshevDegree = 2;
+
+        unsigned        threads = 0;
+
+        /*!
+         If given, the vectors used by each V-cycle are taken from this workspace
+         rather than the heap. The preconditioner then must not be applied by
+         more than one thread at a time.
+         */
+        Workspace*      workspace = nullptr;
+    };
+
+    namespace _private {
+
+        // Rows per block of the hybrid Gauss-Seidel smoother. This is independent
+        // of the number of threads so that the preconditioner is too.
+        constexpr std::size_t amgBlockRows = 4096;
+
+        // The strength of connection graph in CSR form, without the diagonal.
+        struct StrengthGraph {
+            std::vector<std::size_t> ptr;
+            std::vector<std::size_t> adj;
+        };
+
+        template <class T>
+        StrengthGraph strengthGraph(const SparseMatrix<T>& a, const std::vector<T>& diag, T theta,
+                                    unsigned threads)
+        {
+            const std::size_t n = a.rows();
+            const auto& rp = a.rowPointers();
+            const auto& ci = a.columnIndices();
+            const auto& v = a.values();
+            auto strong = [&](std::size_t i, std::size_t k) {
+                const std::size_t j = ci[k];
+                return j != i && std::abs(v[k]) >= theta * std::sqrt(std::abs(diag[i] * diag[j]));
+            };
+
+            StrengthGraph g;
+            g.ptr.assign(n + 1, 0);
+            parallelFor(n, 1024, [&](std::size_t r0, std::size_t r1) {
+                for (std::size_t i = r0; i < r1; ++i) {
+                    std::size_t count = 0;
+                    for (std::size_t k = rp[i]; k < rp[i + 1]; ++k) {
+                        count += (strong(i, k) ? 1 : 0);
+                    }
+                    g.ptr[i + 1] = count;
+                }
+            }, threads);
+            std::partial_sum(g.ptr.begin(), g.ptr.end(), g.ptr.begin());
+            g.adj.resize(g.ptr[n]);
+            parallelFor(n, 1024, [&](std::size_t r0, std::size_t r1) {
+                for (std::size_t i = r0; i < r1; ++i) {
+                    std::size_t pos = g.ptr[i];
+                    for (std::size_t k = rp[i]; k < rp[i + 1]; ++k) {
+                        if (strong(i, k)) {
+                            g.adj[pos++] = ci[k];
+                        }
+                    }
+                }
+            }, threads);
+            return g;
+        }
+
+        // Standard three pass aggregation. Pass one forms an aggregate from each
+        // node whose strong neighbourhood is still entirely free, pass two attaches
+        // the remaining nodes to a neighbouring aggregate, and pass three groups any
+        // left over nodes with their free neighbours. Returns the number of
+        // aggregates, with the aggregate of each node in agg.
+        inline std::size_t aggregate(const StrengthGraph& g, std::vector<std::size_t>& agg) {
+            const std::size_t n = g.ptr.size() - 1;
+            const std::size_t none = std::size_t(-1);
+            agg.assign(n, none);
+            std::size_t count = 0;
+
+            for (std::size_t i = 0; i < n; ++i) {
+                if (agg[i] != none || g.ptr[i] == g.ptr[i + 1]) {
+                    continue;
+                }
+                bool free = true;
+                for (std::size_t k = g.ptr[i]; k < g.ptr[i + 1] && free; ++k) {
+                    free = (agg[g.adj[k]] == none);
+                }
+                if (free) {
+                    agg[i] = count;
+                    for (std::size_t k = g.ptr[i]; k < g.ptr[i + 1]; ++k) {
+                        agg[g.adj[k]] = count;
+                    }
+                    ++count;
+                }
+            }
+
+            const std::vector<std::size_t> firstPass = agg;
+            for (std::size_t i = 0; i < n; ++i) {
+                if (agg[i] != none) {
+                    continue;
+                }
+                for (std::size_t k = g.ptr[i]; k < g.ptr[i + 1]; ++k) {
+                    if (firstPass[g.adj[k]] != none) {
+                        agg[i] = firstPass[g.adj[k]];
+                        break;
+                    }
+                }
+            }
+
+            for (std::size_t i = 0; i < n; ++i) {
+                if (agg[i] != none) {
+                    continue;
+                }
+                agg[i] = count;
+                for (std::size_t k = g.ptr[i]; k < g.ptr[i + 1]; ++k) {
+                    if (agg[g.adj[k]] == none) {
+                        agg[g.adj[k]] = count;
+                    }
+                }
+                ++count;
+            }
+            return count;
+        }
+
+        // The tentative prolongator interpolating the constant vector exactly: each
+        // column is the normalized indicator vector of an aggregate.
+        template <class T>
+        SparseMatrix<T> tentativeProlongator(const std::vector<std::size_t>& agg, std::size_t count) {
+            const std::size_t n = agg.size();
+            std::vector<std::size_t> sizes(count, 0);
+            for (auto a : agg) {
+                ++sizes[a];
+            }
+            std::vector<std::size_t> rowPtr(n + 1), colIdx(agg);
+            std::vector<T> values(n);
+            for (std::size_t i = 0; i < n; ++i) {
+                rowPtr[i + 1] = i + 1;
+                values[i] = T(1) / std::sqrt(T(sizes[agg[i]]));
+            }
+            return SparseMatrix<T>(n, count, std::move(rowPtr), std::move(colIdx), std::move(values));
+        }
+
+        // Returns the matrix I - omega*D^-1*A, which has the pattern of A.
+        template <class T>
+        SparseMatrix<T> jacobiSmoother(const SparseMatrix<T>& a, const std::vector<T>& invDiag, T omega,
+                                       unsigned threads)
+        {
+            SparseMatrix<T> s = a;
+            const auto& rp = s.rowPointers();
+            const auto& ci = s.columnIndices();
+            auto& v = s.values();
+            parallelFor(s.rows(), 1024, [&](std::size_t r0, std::size_t r1) {
+                for (std::size_t i = r0; i < r1; ++i) {
+                    for (std::size_t k = rp[i]; k < rp[i + 1]; ++k) {
+                        v[k] = (ci[k] == i ? T(1) : T(0)) - omega * invDiag[i] * v[k];
+                    }
+                }
+            }, threads);
+            return s;
+        }
+
+        // Estimate the largest eigenvalue of D^-1*A, which is that of the symmetric
+        // D^-1/2*A*D^-1/2, by a few steps of Lanczos.
+        template <class T>
+        T spectralRadiusEstimate(const SparseMatrix<T>& a, const std::vector<T>& invDiag, unsigned threads) {
+            const std::size_t n = a.rows();
+            std::vector<T> scale(n), tmp(n);
+            for (std::size_t i = 0; i < n; ++i) {
+                scale[i] = std::sqrt(invDiag[i]);
+            }
+            LinearOperator<T> op = [&](const T* x, T* y) {
+                for (std::size_t i = 0; i < n; ++i) {
+                    tmp[i] = scale[i] * x[i];
+                }
+                a.multiply(tmp.data(), y, threads);
+                for (std::size_t i = 0; i < n; ++i) {
+                    y[i] *= scale[i];
+                }
+            };
+            LanczosOptions opts;
+            opts.count = 1;
+            opts.basisSize = 12;
+            opts.tolerance = 1e-2;
+            opts.maxRestarts = 2;
+            opts.threads = threads;
+            LanczosEigen<T> lanczos(n, op, opts);
+            return lanczos.eigenvalues().front();
+        }
+
+        // One level of the hierarchy. The prolongator p (and restriction r = p')
+        // map between this level and the next coarser one.
+        template <class T>
+        struct AMGLevel {
+            SparseMatrix<T>             a;
+            SparseMatrix<T>             p;
+            SparseMatrix<T>             r;
+            std::vector<T>              invDiag;
+            T                           lambdaMax = T(0);
+            std::vector<std::size_t>    aggregates;
+            std::size_t                 aggregateCount = 0;
+        };
+
+    }
+
+    /*!
+     Smoothed aggregation algebraic multigrid (Vanek, Mandel and Brezina) for
+     sparse symmetric positive definite systems, intended as a preconditioner for
+     the conjugate gradient method.
+
+     The setup builds a hierarchy of coarser matrices: strongly connected unknowns
+     are grouped into aggregates, the piecewise constant interpolation from the
+     aggregates is smoothed by a damped Jacobi step, and the coarse matrix is the
+     Galerkin product P'AP. Strength of connection, smoothing and the smoother
+     setup are parallel; the aggregation itself is a sequential greedy pass.
+
+     When a new matrix has the same sparsity pattern, updateValues reuses the
+     aggregates and only recomputes the numerical parts of the hierarchy.
+     */
+    template <class T>
+    class SmoothedAggregationAMG {
+    public:
+        using size_type = std::size_t;
+
+        /*!
+         Build the hierarchy for the sparse SPD matrix a.
+         @throws std::invalid_argument if a is not square.
+         @throws NotPositiveDefiniteError if a diagonal entry is not positive.
+         */
+        explicit SmoothedAggregationAMG(const SparseMatrix<T>& a, const AMGOptions& opts = AMGOptions())
+        : _opts(opts)
+        {
+            if (!a.isSquare()) {
+                throw std::invalid_argument("SmoothedAggregationAMG: matrix must be square");
+            }
+            _levels.emplace_back();
+            _levels.front().a = a;
+            for (size_type l = 0; ; ++l) {
+                auto& level = _levels[l];
+                setupDiagonal(level);
+                if (level.a.rows() <= _opts.coarseSize || l + 1 >= _opts.maxLevels) {
+                    break;
+                }
+                const auto g = _private::strengthGraph(level.a, diagonal(level), T(_opts.strengthThreshold),
+                                                       _opts.threads);
+                level.aggregateCount = _private::aggregate(g, level.aggregates);
+                if (level.aggregateCount == 0 || level.aggregateCount >= level.a.rows()) {
+                    level.aggregates.clear();
+                    level.aggregateCount = 0;
+                    break;
+                }
+                _private::AMGLevel<T> next;
+                next.a = coarsen(level);
+                _levels.push_back(std::move(next));
+            }
+            setupCoarseSolver();
+        }
+
+        /*!
+         Recompute the hierarchy for a new matrix with the same sparsity pattern,
+         keeping the aggregates. This skips the strength and aggregation phases.
+         @throws std::invalid_argument if the pattern of a differs from the original.
+         @throws NotPositiveDefiniteError if a diagonal entry is not positive.
+         */
+        void updateValues(const SparseMatrix<T>& a) {
+            if (!a.samePattern(_levels.front().a)) {
+                throw std::invalid_argument("SmoothedAggregationAMG::updateValues: sparsity pattern has changed");
+            }
+            _levels.front().a.values() = a.values();
+            for (size_type l = 0; l < _levels.size(); ++l) {
+                setupDiagonal(_levels[l]);
+                if (l + 1 < _levels.size()) {
+                    _levels[l + 1].a = coarsen(_levels[l]);
+                }
+            }
+            setupCoarseSolver();
+        }
+
+        /*!
+         Returns the number of levels in the hierarchy, including the finest.
+         */
+        size_type levels() const noexcept { return _levels.size(); }
+
+        /*!
+         Returns the matrix for the given level, 0 being the finest.
+         */
+        const SparseMatrix<T>& levelMatrix(size_type level) const { return _levels.at(level).a; }
+
+        /*!
+         Returns the operator complexity, the total number of nonzeros over all the
+         levels divided by that of the finest level.
+         */
+        double operatorComplexity() const noexcept {
+            double total = 0;
+            for (const auto& level : _levels) {
+                total += double(level.a.nonZeros());
+            }
+            return total / double(std::max<size_type>(_levels.front().a.nonZeros(), 1));
+        }
+
+        /*!
+         Improve the approximate solution x of Ax = b by one V-cycle.
+         */
+        void vcycle(const T* b, T* x) const {
+            cycle(0, b, x);
+        }
+
+        /*!
+         Apply the preconditioner: x = M^-1 b, one V-cycle from a zero initial
+         guess.
+         */
+        void apply(const T* b, T* x) const {
+            std::fill(x, x + _levels.front().a.rows(), T(0));
+            cycle(0, b, x);
+        }
+
+        /*!
+         Returns the preconditioner as an operator, suitable for passing to
+         conjugateGradient. The operator refers to this object, which must outlive it.
+         */
+        LinearOperator<T> preconditioner() const {
+            return [this](const T* b, T* x) { apply(b, x); };
+        }
+
+    private:
+        AMGOptions                              _opts;
+        std::vector<_private::AMGLevel<T>>      _levels;
+        std::unique_ptr<Cholesky<T>>            _coarse;
+
+        static std::vector<T> diagonal(const _private::AMGLevel<T>& level) {
+            std::vector<T> d(level.invDiag.size());
+            for (size_type i = 0; i < d.size(); ++i) {
+                d[i] = T(1) / level.invDiag[i];
+            }
+            return d;
+        }
+
+        void setupDiagonal(_private::AMGLevel<T>& level) const {
+            const std::vector<T> d = level.a.diagonal();
+            level.invDiag.resize(d.size());
+            for (size_type i = 0; i < d.size(); ++i) {
+                if (!(d[i] > T(0))) {
+                    throw NotPositiveDefiniteError("SmoothedAggregationAMG: diagonal entries must be positive");
+                }
+                level.invDiag[i] = T(1) / d[i];
+            }
+            level.lambdaMax = _private::spectralRadiusEstimate(level.a, level.invDiag, _opts.threads);
+        }
+
+        // Build the prolongator from the aggregates of level and return the
+        // Galerkin coarse matrix.
+        SparseMatrix<T> coarsen(_private::AMGLevel<T>& level) const {
+            const auto ptent = _private::tentativeProlongator<T>(level.aggregates, level.aggregateCount);
+            const T omega = T(_opts.prolongatorDamping) / level.lambdaMax;
+            const auto s = _private::jacobiSmoother(level.a, level.invDiag, omega, _opts.threads);
+            SparseProductOptions product;
+            product.threads = _opts.threads;
+            level.p = sparseProduct(s, ptent, product);
+            level.r = level.p.transpose();
+            return sparseProduct(level.r, sparseProduct(level.a, level.p, product), product);
+        }
+
+        void setupCoarseSolver() {
+            BlockingOptions blocking;
+            blocking.threads = _opts.threads;
+            _coarse.reset(new Cholesky<T>(_levels.back().a.toDense(), blocking));
+        }
+
+        // r = b - A*x
+        void residual(const _private::AMGLevel<T>& level, const T* b, const T* x, T* r) const {
+            level.a.multiply(x, r, _opts.threads);
+            for (size_type i = 0; i < level.a.rows(); ++i) {
+                r[i] = b[i] - r[i];
+            }
+        }
+
+        // Gauss-Seidel within blocks of rows, using the values of x from the start
+        // of the sweep for the columns outside the block.
+        void gaussSeidel(const _private::AMGLevel<T>& level, const T* b, T* x, bool forward) const {
+            const size_type n = level.a.rows();
+            const auto& rp = level.a.rowPointers();
+            const auto& ci = level.a.columnIndices();
+            const auto& v = level.a.values();
+            const _private::ScratchBuffer<T> xold(_opts.workspace, x, x + n);
+            parallelFor(n, _private::amgBlockRows, [&](std::size_t r0, std::size_t r1) {
+                for (size_type step = 0; step < r1 - r0; ++step) {
+                    const size_type i = (forward ? r0 + step : r1 - 1 - step);
+                    T sum = b[i];
+                    for (size_type k = rp[i]; k < rp[i + 1]; ++k) {
+                        const size_type j = ci[k];
+                        if (j != i) {
+                            sum -= v[k] * (j >= r0 && j < r1 ? x[j] : xold[j]);
+                        }
+                    }
+                    x[i] = sum * level.invDiag[i];
+                }
+            }, _opts.threads);
+        }
+
+        // Chebyshev smoothing targeting the upper part [lambdaMax/30, 1.1*lambdaMax]
+        // of the spectrum of D^-1*A.
+        void chebyshev(const _private::AMGLevel<T>& level, const T* b, T* x) const {
+            const size_type n = level.a.rows();
+            const T upper = T(1.1) * level.lambdaMax;
+            const T lower = upper / T(30);
+            const T theta = T(0.5) * (upper + lower);
+            const T delta = T(0.5) * (upper - lower);
+            const T sigma = theta / delta;
+            T rho = T(1) / sigma;
+
+            _private::ScratchBuffer<T> r(_opts.workspace, n), d(_opts.workspace, n);
+            residual(level, b, x, r.data());
+            for (size_type i = 0; i < n; ++i) {
+                d[i] = level.invDiag[i] * r[i] / theta;
+            }
+            for (unsigned k = 0; k < _opts.chebyshevDegree; ++k) {
+                for (size_type i = 0; i < n; ++i) {
+                    x[i] += d[i];
+                }
+                if (k + 1 == _opts.chebyshevDegree) {
+                    break;
+                }
+                residual(level, b, x, r.data());
+                const T rhoNew = T(1) / (T(2) * sigma - rho);
+                for (size_type i = 0; i < n; ++i) {
+                    d[i] = rhoNew * rho * d[i] + T(2) * rhoNew / delta * level.invDiag[i] * r[i];
+                }
+                rho = rhoNew;
+            }
+        }
+
+        void smooth(const _private::AMGLevel<T>& level, const T* b, T* x, bool pre) const {
+            for (unsigned s = 0; s < _opts.smoothingSteps; ++s) {
+                if (_opts.smoother == AMGSmoother::Chebyshev) {
+                    chebyshev(level, b, x);
+                }
+                else {
+                    gaussSeidel(level, b, x, pre);
+                }
+            }
+        }
+
+        void cycle(size_type l, const T* b, T* x) const {
+            const auto& level = _levels[l];
+            const size_type n = level.a.rows();
+            if (l + 1 == _levels.size()) {
+                std::copy(b, b + n, x);
+                _coarse->solveInPlace(x);
+                return;
+            }
+            smooth(level, b, x, true);
+            _private::ScratchBuffer<T> r(_opts.workspace, n);
+            residual(level, b, x, r.data());
+            const size_type nc = level.aggregateCount;
+            _private::ScratchBuffer<T> bc(_opts.workspace, nc), xc(_opts.workspace, nc, T(0));
+            level.r.multiply(r.data(), bc.data(), _opts.threads);
+            cycle(l + 1, bc.data(), xc.data());
+            level.p.multiply(xc.data(), r.data(), _opts.threads);
+            for (size_type i = 0; i < n; ++i) {
+                x[i] += r[i];
+            }
+            smooth(level, b, x, false);
+        }
+    };
+
+}}
+
+#endif
@@ -0,0 +1,608 @@
+//
+//  blas.hpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#ifndef kssmath_blas_hpp
+#define kssmath_blas_hpp
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+
+#include "instrumentation.hpp"
+#include "simd.hpp"
+
+namespace kss { namespace math { namespace blas {
+
+    /*!
+     Basic linear algebra kernels used by the higher level routines. These follow
+     the BLAS conventions: matrices are column-major with an explicit leading
+     dimension, vectors are contiguous.
+
+     For float and double the level 1 kernels, and the level 2 and 3 kernels
+     built on them, use SIMD batches of W lanes (see simd.hpp). W defaults to the
+     register width of the build; the multiversioned variants of
+     cpu_features.cpp pass the width of their instruction set.
+     */
+
+    namespace _private {
+
+        // The kernels for float and double use SIMD batches; other types (such
+        // as std::complex or long double) use plain loops.
+
+        template <class T, std::size_t W>
+        inline T dot(std::size_t n, const T* x, const T* y, std::false_type) noexcept {
+            T s0 = T(0), s1 = T(0), s2 = T(0), s3 = T(0);
+            std::size_t i = 0;
+            for (; i + 4 <= n; i += 4) {
+                s0 += x[i] * y[i];
+                s1 += x[i+1] * y[i+1];
+                s2 += x[i+2] * y[i+2];
+                s3 += x[i+3] * y[i+3];
+            }
+            for (; i < n; ++i) {
+                s0 += x[i] * y[i];
+            }
+            return (s0 + s1) + (s2 + s3);
+        }
+
+        template <class T, std::size_t W>
+        inline T dot(std::size_t n, const T* x, const T* y, std::true_type) noexcept {
+            using B = simd::Batch<T, W>;
+            const std::size_t w = B::size();
+            B s0, s1;
+            std::size_t i = 0;
+            for (; i + 2 * w <= n; i += 2 * w) {
+                s0 = simd::fma(B::load(x + i), B::load(y + i), s0);
+                s1 = simd::fma(B::load(x + i + w), B::load(y + i + w), s1);
+            }
+            if (i + w <= n) {
+                s0 = simd::fma(B::load(x + i), B::load(y + i), s0);
+                i += w;
+            }
+            if (i < n) {
+                s1 = simd::fma(B::loadPartial(x + i, n - i), B::loadPartial(y + i, n - i), s1);
+            }
+            return simd::reduceAdd(s0 + s1);
+        }
+
+        template <class T, std::size_t W>
+        inline void axpy(std::size_t n, T alpha, const T* x, T* y, std::false_type) noexcept {
+            for (std::size_t i = 0; i < n; ++i) {
+                y[i] += alpha * x[i];
+            }
+        }
+
+        template <class T, std::size_t W>
+        inline void axpy(std::size_t n, T alpha, const T* x, T* y, std::true_type) noexcept {
+            using B = simd::Batch<T, W>;
+            const std::size_t w = B::size();
+            const B a(alpha);
+            std::size_t i = 0;
+            for (; i + w <= n; i += w) {
+                simd::fma(a, B::load(x + i), B::load(y + i)).store(y + i);
+            }
+            if (i < n) {
+                simd::fma(a, B::loadPartial(x + i, n - i), B::loadPartial(y + i, n - i)).storePartial(y + i, n - i);
+            }
+        }
+
+        template <class T, std::size_t W>
+        inline void scal(std::size_t n, T alpha, T* x, std::false_type) noexcept {
+            for (std::size_t i = 0; i < n; ++i) {
+                x[i] *= alpha;
+            }
+        }
+
+        template <class T, std::size_t W>
+        inline void scal(std::size_t n, T alpha, T* x, std::true_type) noexcept {
+            using B = simd::Batch<T, W>;
+            const std::size_t w = B::size();
+            const B a(alpha);
+            std::size_t i = 0;
+            for (; i + w <= n; i += w) {
+                (B::load(x + i) * a).store(x + i);
+            }
+            if (i < n) {
+                (B::loadPartial(x + i, n - i) * a).storePartial(x + i, n - i);
+            }
+        }
+
+        template <class T, std::size_t W>
+        inline T amax(std::size_t n, const T* x, std::false_type) noexcept {
+            T mx = T(0);
+            for (std::size_t i = 0; i < n; ++i) {
+                mx = std::max(mx, std::abs(x[i]));
+            }
+            return mx;
+        }
+
+        template <class T, std::size_t W>
+        inline T amax(std::size_t n, const T* x, std::true_type) noexcept {
+            using B = simd::Batch<T, W>;
+            const std::size_t w = B::size();
+            B mx;
+            std::size_t i = 0;
+            for (; i + w <= n; i += w) {
+                mx = simd::max(mx, simd::abs(B::load(x + i)));
+            }
+            if (i < n) {
+                mx = simd::max(mx, simd::abs(B::loadPartial(x + i, n - i)));
+            }
+            return simd::reduceMax(mx);
+        }
+
+        template <class T, std::size_t W>
+        inline T sumOfSquares(std::size_t n, const T* x, T scale, std::false_type) noexcept {
+            T sum = T(0);
+            for (std::size_t i = 0; i < n; ++i) {
+                const T v = x[i] / scale;
+                sum += v * v;
+            }
+            return sum;
+        }
+
+        template <class T, std::size_t W>
+        inline T sumOfSquares(std::size_t n, const T* x, T scale, std::true_type) noexcept {
+            using B = simd::Batch<T, W>;
+            const std::size_t w = B::size();
+            const B s(scale);
+            B sum;
+            std::size_t i = 0;
+            for (; i + w <= n; i += w) {
+                const B v = B::load(x + i) / s;
+                sum = simd::fma(v, v, sum);
+            }
+            if (i < n) {
+                const B v = B::loadPartial(x + i, n - i) / s;
+                sum = simd::fma(v, v, sum);
+            }
+            return simd::reduceAdd(sum);
+        }
+
+    }
+
+    /*!
+     Returns the dot product of x and y. Two batches of partial sums are kept so
+     that the additions of consecutive iterations overlap.
+     */
+    template <class T, std::size_t W = simd::nativeLanes<T>()>
+    inline T dot(std::size_t n, const T* x, const T* y) noexcept {
+        return _private::dot<T, W>(n, x, y, simd::IsVectorizable<T>());
+    }
+
+    /*!
+     Computes y := alpha*x + y.
+     */
+    template <class T, std::size_t W = simd::nativeLanes<T>()>
+    inline void axpy(std::size_t n, T alpha, const T* x, T* y) noexcept {
+        _private::axpy<T, W>(n, alpha, x, y, simd::IsVectorizable<T>());
+    }
+
+    /*!
+     Computes x := alpha*x.
+     */
+    template <class T, std::size_t W = simd::nativeLanes<T>()>
+    inline void scal(std::size_t n, T alpha, T* x) noexcept {
+        _private::scal<T, W>(n, alpha, x, simd::IsVectorizable<T>());
+    }
+
+    /*!
+     Returns the largest absolute value in x (the infinity norm).
+     */
+    template <class T, std::size_t W = simd::nativeLanes<T>()>
+    inline T amax(std::size_t n, const T* x) noexcept {
+        return _private::amax<T, W>(n, x, simd::IsVectorizable<T>());
+    }
+
+    /*!
+     Returns the Euclidean norm of x, scaled to avoid overflow and underflow.
+     */
+    template <class T, std::size_t W = simd::nativeLanes<T>()>
+    inline T nrm2(std::size_t n, const T* x) noexcept {
+        const T scale = amax<T, W>(n, x);
+        if (scale == T(0)) {
+            return T(0);
+        }
+        return scale * std::sqrt(_private::sumOfSquares<T, W>(n, x, scale, simd::IsVectorizable<T>()));
+    }
+
+    /*!
+     Computes y := alpha*A*x + beta*y where A is m x n with leading dimension lda.
+     The loop is ordered by column so that the inner loop is a unit stride axpy.
+     */
+    template <class T, std::size_t W = simd::nativeLanes<T>()>
+    inline void gemv(std::size_t m, std::size_t n, T alpha, const T* a, std::size_t lda,
+                     const T* x, T beta, T* y) noexcept
+    {
+        if (beta != T(1)) {
+            if (beta == T(0)) {
+                std::fill(y, y + m, T(0));
+            }
+            else {
+                scal<T, W>(m, beta, y);
+            }
+        }
+        for (std::size_t j = 0; j < n; ++j) {
+            const T ax = alpha * x[j];
+            if (ax != T(0)) {
+                axpy<T, W>(m, ax, a + j * lda, y);
+            }
+        }
+    }
+
+    /*!
+     Computes y := alpha*A'*x + beta*y where A is m x n with leading dimension lda
+     (so y has n elements and x has m elements).
+     */
+    template <class T, std::size_t W = simd::nativeLanes<T>()>
+    inline void gemvTranspose(std::size_t m, std::size_t n, T alpha, const T* a, std::size_t lda,
+                              const T* x, T beta, T* y) noexcept
+    {
+        for (std::size_t j = 0; j < n; ++j) {
+            const T d = dot<T, W>(m, a + j * lda, x);
+            y[j] = alpha * d + (beta == T(0) ? T(0) : beta * y[j]);
+        }
+    }
+
+    /*!
+     Specifies whether a matrix argument should be used as is or transposed.
+     */
+    enum class Op { NoTrans, Trans };
+
+    /*!
+     Computes C := alpha*op(A)*op(B) + beta*C where op(A) is m x k, op(B) is k x n
+     and C is m x n. The loops are ordered so that the innermost operation is a
+     unit stride axpy or dot product whenever op(A) allows it.
+     */
+    template <class T, std::size_t W = simd::nativeLanes<T>()>
+    inline void gemm(Op opA, Op opB, std::size_t m, std::size_t n, std::size_t k,
+                     T alpha, const T* a, std::size_t lda, const T* b, std::size_t ldb,
+                     T beta, T* c, std::size_t ldc) noexcept
+    {
+        for (std::size_t j = 0; j < n; ++j) {
+            T* cj = c + j * ldc;
+            if (beta == T(0)) {
+                std::fill(cj, cj + m, T(0));
+            }
+            else if (beta != T(1)) {
+                scal<T, W>(m, beta, cj);
+            }
+        }
+        if (alpha == T(0) || k == 0) {
+            return;
+        }
+
+        if (opA == Op::NoTrans) {
+            for (std::size_t j = 0; j < n; ++j) {
+                T* cj = c + j * ldc;
+                for (std::size_t p = 0; p < k; ++p) {
+                    const T bpj = (opB == Op::NoTrans ? b[p + j * ldb] : b[j + p * ldb]);
+                    if (bpj != T(0)) {
+                        axpy<T, W>(m, alpha * bpj, a + p * lda, cj);
+                    }
+                }
+            }
+        }
+        else if (opB == Op::NoTrans) {
+            for (std::size_t j = 0; j < n; ++j) {
+                T* cj = c + j * ldc;
+                const T* bj = b + j * ldb;
+                for (std::size_t i = 0; i < m; ++i) {
+                    cj[i] += alpha * dot<T, W>(k, a + i * lda, bj);
+                }
+            }
+        }
+        else {
+            for (std::size_t j = 0; j < n; ++j) {
+                T* cj = c + j * ldc;
+                for (std::size_t i = 0; i < m; ++i) {
+                    const T* ai = a + i * lda;
+                    T sum = T(0);
+                    for (std::size_t p = 0; p < k; ++p) {
+                        sum += ai[p] * b[j + p * ldb];
+                    }
+                    cj[i] += alpha * sum;
+                }
+            }
+        }
+    }
+
+    /*!
+     Computes the lower triangle of C := alpha*A*A' + beta*C where A is n x k and
+     C is n x n. The strictly upper triangle of C is not referenced.
+     */
+    template <class T, std::size_t W = simd::nativeLanes<T>()>
+    inline void syrkLower(std::size_t n, std::size_t k, T alpha, const T* a, std::size_t lda,
+                          T beta, T* c, std::size_t ldc) noexcept
+    {
+        for (std::size_t j = 0; j < n; ++j) {
+            T* cj = c + j + j * ldc;
+            if (beta == T(0)) {
+                std::fill(cj, cj + (n - j), T(0));
+            }
+            else if (beta != T(1)) {
+                scal<T, W>(n - j, beta, cj);
+            }
+            for (std::size_t p = 0; p < k; ++p) {
+                const T ajp = a[j + p * lda];
+                if (ajp != T(0)) {
+                    axpy<T, W>(n - j, alpha * ajp, a + j + p * lda, cj);
+                }
+            }
+        }
+    }
+
+    /*!
+     Solves X*L' = B for X, overwriting B, where L is an n x n lower triangular
+     matrix and B is m x n. If unitDiagonal is true the diagonal of L is assumed
+     to be all ones and is not referenced.
+     */
+    template <class T>
+    inline void trsmRightLowerTrans(std::size_t m, std::size_t n, const T* l, std::size_t ldl,
+                                    T* b, std::size_t ldb, bool unitDiagonal = false) noexcept
+    {
+        for (std::size_t j = 0; j < n; ++j) {
+            T* bj = b + j * ldb;
+            for (std::size_t p = 0; p < j; ++p) {
+                const T ljp = l[j + p * ldl];
+                if (ljp != T(0)) {
+                    axpy(m, -ljp, b + p * ldb, bj);
+                }
+            }
+            if (!unitDiagonal) {
+                scal(m, T(1) / l[j + j * ldl], bj);
+            }
+        }
+    }
+
+    /*!
+     Solves L*x = b (or L'*x = b if op is Trans) in place, where L is an n x n
+     lower triangular matrix. If unitDiagonal is true the diagonal of L is assumed
+     to be all ones and is not referenced.
+     */
+    template <class T>
+    inline void trsvLower(Op op, std::size_t n, const T* l, std::size_t ldl, T* x,
+                          bool unitDiagonal = false) noexcept
+    {
+        if (op == Op::NoTrans) {
+            for (std::size_t j = 0; j < n; ++j) {
+                if (!unitDiagonal) {
+                    x[j] /= l[j + j * ldl];
+                }
+                const T xj = x[j];
+                if (xj != T(0)) {
+                    axpy(n - j - 1, -xj, l + (j + 1) + j * ldl, x + j + 1);
+                }
+            }
+        }
+        else {
+            for (std::size_t j = n; j-- > 0;) {
+                x[j] -= dot(n - j - 1, l + (j + 1) + j * ldl, x + j + 1);
+                if (!unitDiagonal) {
+                    x[j] /= l[j + j * ldl];
+                }
+            }
+        }
+    }
+
+    /*!
+     Computes y := alpha*A*x + beta*y where A is an n x n symmetric matrix of
+     which only the lower triangle is referenced.
+     */
+    template <class T>
+    inline void symvLower(std::size_t n, T alpha, const T* a, std::size_t lda,
+                          const T* x, T beta, T* y) noexcept
+    {
+        if (beta == T(0)) {
+            std::fill(y, y + n, T(0));
+        }
+        else if (beta != T(1)) {
+            scal(n, beta, y);
+        }
+        for (std::size_t j = 0; j < n; ++j) {
+            const T* aj = a + j * lda;
+            const std::size_t below = n - j - 1;
+            y[j] += alpha * (aj[j] * x[j] + dot(below, aj + j + 1, x + j + 1));
+            axpy(below, alpha * x[j], aj + j + 1, y + j + 1);
+        }
+    }
+
+    /*!
+     Computes the lower triangle of C := alpha*(A*B' + B*A') + C for columns
+     [j0, j1) of C, where A and B are n x k and C is n x n. Restricting the columns
+     allows callers to divide the update among threads.
+     */
+    template <class T>
+    inline void syr2kLower(std::size_t n, std::size_t k, T alpha, const T* a, std::size_t lda,
+                           const T* b, std::size_t ldb, T* c, std::size_t ldc,
+                           std::size_t j0, std::size_t j1) noexcept
+    {
+        for (std::size_t j = j0; j < j1; ++j) {
+            T* cj = c + j + j * ldc;
+            for (std::size_t p = 0; p < k; ++p) {
+                const T* ap = a + p * lda;
+                const T* bp = b + p * ldb;
+                const T bj = alpha * bp[j];
+                const T aj = alpha * ap[j];
+                if (bj != T(0)) {
+                    axpy(n - j, bj, ap + j, cj);
+                }
+                if (aj != T(0)) {
+                    axpy(n - j, aj, bp + j, cj);
+                }
+            }
+        }
+    }
+
+    /*!
+     Solves L*X = B for X, overwriting B, where L is an m x m lower triangular
+     matrix and B is m x n. If unitDiagonal is true the diagonal of L is assumed
+     to be all ones and is not referenced.
+     */
+    template <class T>
+    inline void trsmLeftLower(std::size_t m, std::size_t n, const T* l, std::size_t ldl,
+                              T* b, std::size_t ldb, bool unitDiagonal = false) noexcept
+    {
+        for (std::size_t j = 0; j < n; ++j) {
+            trsvLower(Op::NoTrans, m, l, ldl, b + j * ldb, unitDiagonal);
+        }
+    }
+
+    /*!
+     Solves X*U = B for X, overwriting B, where U is an n x n upper triangular
+     matrix and B is m x n.
+     */
+    template <class T>
+    inline void trsmRightUpper(std::size_t m, std::size_t n, const T* u, std::size_t ldu,
+                               T* b, std::size_t ldb) noexcept
+    {
+        for (std::size_t j = 0; j < n; ++j) {
+            T* bj = b + j * ldb;
+            for (std::size_t p = 0; p < j; ++p) {
+                const T upj = u[p + j * ldu];
+                if (upj != T(0)) {
+                    axpy(m, -upj, b + p * ldb, bj);
+                }
+            }
+            scal(m, T(1) / u[j + j * ldu], bj);
+        }
+    }
+
+    /*!
+     Solves U*x = b in place, where U is an n x n upper triangular matrix.
+     */
+    template <class T>
+    inline void trsvUpper(std::size_t n, const T* u, std::size_t ldu, T* x) noexcept {
+        for (std::size_t j = n; j-- > 0;) {
+            x[j] /= u[j + j * ldu];
+            const T xj = x[j];
+            if (xj != T(0)) {
+                axpy(j, -xj, u + j * ldu, x);
+            }
+        }
+    }
+
+
+    namespace _private {
+
+        // The dispatched kernels for one value type, bound to the variants for the
+        // active instruction set by cpu_features.cpp.
+        template <class T>
+        struct BlasKernels {
+            T (*dot)(std::size_t, const T*, const T*);
+            void (*axpy)(std::size_t, T, const T*, T*);
+            void (*gemv)(std::size_t, std::size_t, T, const T*, std::size_t, const T*, T, T*);
+            void (*gemvTranspose)(std::size_t, std::size_t, T, const T*, std::size_t, const T*, T, T*);
+            void (*gemm)(Op, Op, std::size_t, std::size_t, std::size_t, T, const T*, std::size_t,
+                         const T*, std::size_t, T, T*, std::size_t);
+            void (*syrkLower)(std::size_t, std::size_t, T, const T*, std::size_t, T, T*, std::size_t);
+        };
+
+        extern BlasKernels<float> floatKernels;
+        extern BlasKernels<double> doubleKernels;
+
+    }
+
+    /*!
+     The float and double versions of the kernels that dominate the running time
+     of the library are compiled for several instruction sets, and these
+     overloads call the variant chosen for the CPU the program is running on (see
+     cpu_features.hpp). They are declared after the templates above, so the
+     templates (which are also the variants) call each other directly. These
+     overloads are also the ones recorded by the instrumentation (see
+     instrumentation.hpp), so the calls the kernels make to each other are not.
+     */
+    inline float dot(std::size_t n, const float* x, const float* y) noexcept {
+        KSSMATH_INSTRUMENT("blas::sdot", 2.0 * n, 2.0 * n * sizeof(float));
+        return _private::floatKernels.dot(n, x, y);
+    }
+
+    inline double dot(std::size_t n, const double* x, const double* y) noexcept {
+        KSSMATH_INSTRUMENT("blas::ddot", 2.0 * n, 2.0 * n * sizeof(double));
+        return _private::doubleKernels.dot(n, x, y);
+    }
+
+    inline void axpy(std::size_t n, float alpha, const float* x, float* y) noexcept {
+        KSSMATH_INSTRUMENT("blas::saxpy", 2.0 * n, 3.0 * n * sizeof(float));
+        _private::floatKernels.axpy(n, alpha, x, y);
+    }
+
+    inline void axpy(std::size_t n, double alpha, const double* x, double* y) noexcept {
+        KSSMATH_INSTRUMENT("blas::daxpy", 2.0 * n, 3.0 * n * sizeof(double));
+        _private::doubleKernels.axpy(n, alpha, x, y);
+    }
+
+    inline void gemv(std::size_t m, std::size_t n, float alpha, const float* a, std::size_t lda,
+                     const float* x, float beta, float* y) noexcept
+    {
+        KSSMATH_INSTRUMENT("blas::sgemv", 2.0 * m * n, (double(m) * n + n + 2.0 * m) * sizeof(float));
+        _private::floatKernels.gemv(m, n, alpha, a, lda, x, beta, y);
+    }
+
+    inline void gemv(std::size_t m, std::size_t n, double alpha, const double* a, std::size_t lda,
+                     const double* x, double beta, double* y) noexcept
+    {
+        KSSMATH_INSTRUMENT("blas::dgemv", 2.0 * m * n, (double(m) * n + n + 2.0 * m) * sizeof(double));
+        _private::doubleKernels.gemv(m, n, alpha, a, lda, x, beta, y);
+    }
+
+    inline void gemvTranspose(std::size_t m, std::size_t n, float alpha, const float* a, std::size_t lda,
+                              const float* x, float beta, float* y) noexcept
+    {
+        KSSMATH_INSTRUMENT("blas::sgemvTranspose", 2.0 * m * n,
+                           (double(m) * n + m + 2.0 * n) * sizeof(float));
+        _private::floatKernels.gemvTranspose(m, n, alpha, a, lda, x, beta, y);
+    }
+
+    inline void gemvTranspose(std::size_t m, std::size_t n, double alpha, const double* a, std::size_t lda,
+                              const double* x, double beta, double* y) noexcept
+    {
+        KSSMATH_INSTRUMENT("blas::dgemvTranspose", 2.0 * m * n,
+                           (double(m) * n + m + 2.0 * n) * sizeof(double));
+        _private::doubleKernels.gemvTranspose(m, n, alpha, a, lda, x, beta, y);
+    }
+
+    inline void gemm(Op opA, Op opB, std::size_t m, std::size_t n, std::size_t k,
+                     float alpha, const float* a, std::size_t lda, const float* b, std::size_t ldb,
+                     float beta, float* c, std::size_t ldc) noexcept
+    {
+        KSSMATH_INSTRUMENT("blas::sgemm", 2.0 * m * n * k,
+                           (double(m) * k + double(k) * n + 2.0 * m * n) * sizeof(float));
+        _private::floatKernels.gemm(opA, opB, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+    }
+
+    inline void gemm(Op opA, Op opB, std::size_t m, std::size_t n, std::size_t k,
+                     double alpha, const double* a, std::size_t lda, const double* b, std::size_t ldb,
+                     double beta, double* c, std::size_t ldc) noexcept
+    {
+        KSSMATH_INSTRUMENT("blas::dgemm", 2.0 * m * n * k,
+                           (double(m) * k + double(k) * n + 2.0 * m * n) * sizeof(double));
+        _private::doubleKernels.gemm(opA, opB, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+    }
+
+    inline void syrkLower(std::size_t n, std::size_t k, float alpha, const float* a, std::size_t lda,
+                          float beta, float* c, std::size_t ldc) noexcept
+    {
+        KSSMATH_INSTRUMENT("blas::ssyrkLower", double(n) * (n + 1) * k,
+                           (double(n) * k + double(n) * (n + 1)) * sizeof(float));
+        _private::floatKernels.syrkLower(n, k, alpha, a, lda, beta, c, ldc);
+    }
+
+    inline void syrkLower(std::size_t n, std::size_t k, double alpha, const double* a, std::size_t lda,
+                          double beta, double* c, std::size_t ldc) noexcept
+    {
+        KSSMATH_INSTRUMENT("blas::dsyrkLower", double(n) * (n + 1) * k,
+                           (double(n) * k + double(n) * (n + 1)) * sizeof(double));
+        _private::doubleKernels.syrkLower(n, k, alpha, a, lda, beta, c, ldc);
+    }
+
+}}}
+
+#endif
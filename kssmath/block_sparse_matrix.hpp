@@ -0,0 +1,244 @@
+//
+//  block_sparse_matrix.hpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#ifndef kssmath_block_sparse_matrix_hpp
+#define kssmath_block_sparse_matrix_hpp
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "instrumentation.hpp"
+#include "parallel.hpp"
+#include "sparse_matrix.hpp"
+#include "tuning.hpp"
+
+namespace kss { namespace math {
+
+    namespace _private {
+
+        // Returns the number of br x bc blocks containing at least one entry of a.
+        template <class T>
+        std::size_t nonZeroBlocks(const SparseMatrix<T>& a, std::size_t br, std::size_t bc) {
+            const auto& ptr = a.rowPointers();
+            const auto& idx = a.columnIndices();
+            const std::size_t none = std::size_t(-1);
+            std::vector<std::size_t> marker((a.cols() + bc - 1) / bc, none);
+            std::size_t count = 0;
+            for (std::size_t i = 0; i < a.rows(); ++i) {
+                const std::size_t bi = i / br;
+                for (std::size_t k = ptr[i]; k < ptr[i + 1]; ++k) {
+                    const std::size_t bj = idx[k] / bc;
+                    if (marker[bj] != bi) {
+                        marker[bj] = bi;
+                        ++count;
+                    }
+                }
+            }
+            return count;
+        }
+
+        // y for block rows [b0, b1) with R x C blocks known at compile time, so the
+        // block product is fully unrolled. x must be padded to whole blocks.
+        template <std::size_t R, std::size_t C, class T, class Index>
+        void blockRowsFixed(std::size_t b0, std::size_t b1, const std::size_t* ptr, const Index* idx,
+                            const T* val, const T* x, T* y, std::size_t rows)
+        {
+            for (std::size_t b = b0; b < b1; ++b) {
+                T acc[R] = {};
+                for (std::size_t k = ptr[b]; k < ptr[b + 1]; ++k) {
+                    const T* blk = val + k * R * C;
+                    const T* xb = x + std::size_t(idx[k]) * C;
+                    for (std::size_t r = 0; r < R; ++r) {
+                        for (std::size_t c = 0; c < C; ++c) {
+                            acc[r] += blk[r * C + c] * xb[c];
+                        }
+                    }
+                }
+                for (std::size_t r = 0; r < R && b * R + r < rows; ++r) {
+                    y[b * R + r] = acc[r];
+                }
+            }
+        }
+
+    }
+
+    /*!
+     A sparse matrix in block compressed sparse row (BCSR) form: the matrix is
+     divided into blockRows x blockCols tiles and each tile with any nonzero entry
+     is stored as a small dense row major block, with one 32 bit column index per
+     block instead of per entry. For matrices with a natural block structure, such
+     as finite element matrices with several unknowns per node, this divides the
+     index traffic of SpMV by the block size and lets the block products be
+     unrolled. The 2x2, 3x3 and 4x4 block sizes have specialized kernels.
+
+     The matrix is built from a SparseMatrix and is read-only.
+     */
+    template <class T>
+    class BlockSparseMatrix {
+    public:
+        using value_type = T;
+        using size_type = std::size_t;
+        using index_type = std::uint32_t;
+
+        BlockSparseMatrix() = default;
+
+        /*!
+         Convert a CSR matrix. The dimensions need not be multiples of the block
+         size; the blocks at the edges are padded with zeros.
+         @throws std::invalid_argument if a block dimension is zero or the matrix
+            has too many block columns for 32 bit indices.
+         */
+        BlockSparseMatrix(const SparseMatrix<T>& a, size_type blockRows, size_type blockCols)
+        : _rows(a.rows()), _cols(a.cols()), _nnz(a.nonZeros()), _br(blockRows), _bc(blockCols)
+        {
+            if (_br == 0 || _bc == 0) {
+                throw std::invalid_argument("BlockSparseMatrix: block dimensions must be positive");
+            }
+            const size_type blockRowCount = (_rows + _br - 1) / _br;
+            const size_type blockColCount = (_cols + _bc - 1) / _bc;
+            if (blockColCount > std::numeric_limits<index_type>::max()) {
+                throw std::invalid_argument("BlockSparseMatrix: too many columns for 32 bit indices");
+            }
+            const auto& ptr = a.rowPointers();
+            const auto& idx = a.columnIndices();
+            const auto& val = a.values();
+            const size_type none = size_type(-1);
+            const size_type bs = _br * _bc;
+
+            // Find the blocks of each block row, then scatter the entries into them.
+            std::vector<size_type> marker(blockColCount, none), position(blockColCount);
+            _blockPtr.assign(blockRowCount + 1, 0);
+            for (size_type b = 0; b < blockRowCount; ++b) {
+                const size_type first = _blockIdx.size();
+                const size_type i1 = std::min((b + 1) * _br, _rows);
+                for (size_type i = b * _br; i < i1; ++i) {
+                    for (size_type k = ptr[i]; k < ptr[i + 1]; ++k) {
+                        const size_type bj = idx[k] / _bc;
+                        if (marker[bj] != b) {
+                            marker[bj] = b;
+                            _blockIdx.push_back(index_type(bj));
+                        }
+                    }
+                }
+                std::sort(_blockIdx.begin() + long(first), _blockIdx.end());
+                _blockPtr[b + 1] = _blockIdx.size();
+                for (size_type k = first; k < _blockIdx.size(); ++k) {
+                    position[_blockIdx[k]] = k;
+                }
+                _values.resize(_blockIdx.size() * bs, T(0));
+                for (size_type i = b * _br; i < i1; ++i) {
+                    for (size_type k = ptr[i]; k < ptr[i + 1]; ++k) {
+                        const size_type j = idx[k];
+                        _values[position[j / _bc] * bs + (i - b * _br) * _bc + j % _bc] = val[k];
+                    }
+                }
+            }
+        }
+
+        size_type rows() const noexcept { return _rows; }
+        size_type cols() const noexcept { return _cols; }
+        size_type nonZeros() const noexcept { return _nnz; }
+        size_type blockRows() const noexcept { return _br; }
+        size_type blockCols() const noexcept { return _bc; }
+        size_type blocks() const noexcept { return _blockIdx.size(); }
+
+        /*!
+         Returns the number of stored entries, including the zeros in the blocks.
+         */
+        size_type storedEntries() const noexcept { return _values.size(); }
+
+        /*!
+         Returns storedEntries() / nonZeros(), which is 1 if all the blocks are full.
+         */
+        double fillRatio() const noexcept {
+            return (_nnz == 0 ? 1.0 : double(storedEntries()) / double(_nnz));
+        }
+
+        /*!
+         Computes y = A*x, splitting the block rows over the given number of threads.
+         */
+        void multiply(const T* x, T* y, unsigned threads = 0) const {
+            KSSMATH_INSTRUMENT("BlockSparseMatrix::multiply", 2.0 * nonZeros(),
+                               double(storedEntries()) * sizeof(T) + double(blocks()) * sizeof(index_type)
+                               + double(_rows + _cols) * sizeof(T));
+            // The kernels read whole blocks of x, so pad it if the last block
+            // column is partial.
+            std::vector<T> padded;
+            if (_cols % _bc != 0) {
+                padded.assign(((_cols + _bc - 1) / _bc) * _bc, T(0));
+                std::copy(x, x + _cols, padded.begin());
+                x = padded.data();
+            }
+            const size_type blockRowCount = _blockPtr.size() - 1;
+            parallelFor(blockRowCount, std::max<size_type>(1, tuningParameters().spmvChunkRows / _br), [&](std::size_t b0, std::size_t b1) {
+                multiplyRows(b0, b1, x, y);
+            }, threads);
+        }
+
+    private:
+        size_type               _rows = 0;
+        size_type               _cols = 0;
+        size_type               _nnz = 0;
+        size_type               _br = 1;
+        size_type               _bc = 1;
+        std::vector<size_type>  _blockPtr = std::vector<size_type>(1, 0);
+        std::vector<index_type> _blockIdx;
+        std::vector<T>          _values;
+
+        void multiplyRows(size_type b0, size_type b1, const T* x, T* y) const {
+            const size_type* ptr = _blockPtr.data();
+            const index_type* idx = _blockIdx.data();
+            const T* val = _values.data();
+            if (_br == 2 && _bc == 2) {
+                _private::blockRowsFixed<2, 2>(b0, b1, ptr, idx, val, x, y, _rows);
+            }
+            else if (_br == 3 && _bc == 3) {
+                _private::blockRowsFixed<3, 3>(b0, b1, ptr, idx, val, x, y, _rows);
+            }
+            else if (_br == 4 && _bc == 4) {
+                _private::blockRowsFixed<4, 4>(b0, b1, ptr, idx, val, x, y, _rows);
+            }
+            else {
+                const size_type bs = _br * _bc;
+                std::vector<T> acc(_br);
+                for (size_type b = b0; b < b1; ++b) {
+                    std::fill(acc.begin(), acc.end(), T(0));
+                    for (size_type k = ptr[b]; k < ptr[b + 1]; ++k) {
+                        const T* blk = val + k * bs;
+                        const T* xb = x + size_type(idx[k]) * _bc;
+                        for (size_type r = 0; r < _br; ++r) {
+                            for (size_type c = 0; c < _bc; ++c) {
+                                acc[r] += blk[r * _bc + c] * xb[c];
+                            }
+                        }
+                    }
+                    for (size_type r = 0; r < _br && b * _br + r < _rows; ++r) {
+                        y[b * _br + r] = acc[r];
+                    }
+                }
+            }
+        }
+    };
+
+    /*!
+     Returns an operator computing the product with a, which must outlive it.
+     */
+    template <class T>
+    LinearOperator<T> sparseOperator(const BlockSparseMatrix<T>& a, unsigned threads = 0) {
+        const BlockSparseMatrix<T>* pa = &a;
+        return [pa, threads](const T* x, T* y) { pa->multiply(x, y, threads); };
+    }
+
+}}
+
+#endif
@@ -0,0 +1,39 @@
+//
+//  blocking.hpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#ifndef kssmath_blocking_hpp
+#define kssmath_blocking_hpp
+
+#include <cstddef>
+
+#include "tuning.hpp"
+
+namespace kss { namespace math {
+
+    /*!
+     Options common to the blocked algorithms.
+     */
+    struct BlockingOptions {
+        /*!
+         The block (tile) size. Matrices no larger than this are factored by the
+         unblocked algorithm. The default is tuned for the machine (see
+         tuning.hpp).
+         */
+        std::size_t blockSize = tuningParameters().blockSize;
+
+        /*!
+         The number of threads to use. A value of 0 uses defaultThreadCount().
+         The default is tuned for the machine.
+         */
+        unsigned threads = tuningParameters().threads;
+    };
+
+}}
+
+#endif
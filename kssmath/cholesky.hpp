@@ -0,0 +1,189 @@
+//
+//  cholesky.hpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#ifndef kssmath_cholesky_hpp
+#define kssmath_cholesky_hpp
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "blas.hpp"
+#include "blocking.hpp"
+#include "error.hpp"
+#include "instrumentation.hpp"
+#include "matrix.hpp"
+#include "task_graph.hpp"
+
+namespace kss { namespace math {
+
+    namespace _private {
+
+        // Unblocked right-looking Cholesky of the n x n lower triangle at a.
+        template <class T>
+        void potrfLower(std::size_t n, T* a, std::size_t lda) {
+            for (std::size_t j = 0; j < n; ++j) {
+                T* colj = a + j * lda;
+                const T d = colj[j];
+                if (!(d > T(0)) || !std::isfinite(d)) {
+                    throw NotPositiveDefiniteError("Cholesky: matrix is not positive definite");
+                }
+                colj[j] = std::sqrt(d);
+                blas::scal(n - j - 1, T(1) / colj[j], colj + j + 1);
+                for (std::size_t k = j + 1; k < n; ++k) {
+                    blas::axpy(n - k, -colj[k], colj + k, a + k + k * lda);
+                }
+            }
+        }
+
+    }
+
+    /*!
+     Cholesky factorization A = LL' of a symmetric positive definite matrix. Only
+     the lower triangle of A is referenced.
+
+     The factorization uses the tiled right-looking algorithm. The matrix is
+     divided into square tiles and each step (factor the diagonal tile, solve the
+     tiles below it, then apply the SYRK/GEMM updates to the trailing tiles) is
+     expressed as a task in a TaskGraph. Tasks start as soon as the tiles they
+     read are final, so the trailing updates of one step overlap the panel work
+     of the next and all the cores stay busy.
+     */
+    template <class T>
+    class Cholesky {
+    public:
+        using size_type = std::size_t;
+
+        /*!
+         Factor the matrix a.
+         @throws std::invalid_argument if a is not square.
+         @throws NotPositiveDefiniteError if a is not positive definite.
+         */
+        explicit Cholesky(Matrix<T> a, const BlockingOptions& opts = BlockingOptions()) : _l(std::move(a)) {
+            if (!_l.isSquare()) {
+                throw std::invalid_argument("Cholesky: matrix must be square");
+            }
+            const double n = double(size());
+            KSSMATH_INSTRUMENT("Cholesky", n * n * n / 3, n * n * sizeof(T));
+            factor(opts);
+            for (size_type j = 1; j < size(); ++j) {
+                std::fill(_l.column(j), _l.column(j) + j, T(0));
+            }
+        }
+
+        size_type size() const noexcept { return _l.rows(); }
+
+        /*!
+         Returns the lower triangular factor L. The strictly upper triangle is zero.
+         */
+        const Matrix<T>& factor() const noexcept { return _l; }
+
+        /*!
+         Solve Ax = b in place. On entry x holds b, on exit it holds the solution.
+         */
+        void solveInPlace(T* x) const noexcept {
+            blas::trsvLower(blas::Op::NoTrans, size(), _l.data(), size(), x);
+            blas::trsvLower(blas::Op::Trans, size(), _l.data(), size(), x);
+        }
+
+        /*!
+         Returns the solution of Ax = b.
+         @throws std::invalid_argument if b is not the correct length.
+         */
+        std::vector<T> solve(std::vector<T> b) const {
+            if (b.size() != size()) {
+                throw std::invalid_argument("Cholesky::solve: b has the wrong length");
+            }
+            solveInPlace(b.data());
+            return b;
+        }
+
+        /*!
+         Returns log(det(A)). This is computed from the diagonal of L, hence it will
+         not overflow even when det(A) itself would.
+         */
+        T logDeterminant() const noexcept {
+            T sum = T(0);
+            for (size_type i = 0; i < size(); ++i) {
+                sum += std::log(_l(i, i));
+            }
+            return T(2) * sum;
+        }
+
+    private:
+        Matrix<T> _l;
+
+        void factor(const BlockingOptions& opts) {
+            const size_type n = size();
+            const size_type nb = std::max<size_type>(opts.blockSize, 1);
+            T* a = _l.data();
+            if (n <= nb) {
+                _private::potrfLower(n, a, n);
+                return;
+            }
+
+            // Tile (i, j) covers rows [i*nb, ...) and columns [j*nb, ...).
+            const size_type nt = (n + nb - 1) / nb;
+            auto dim = [=](size_type t) { return std::min(nb, n - t * nb); };
+            auto tile = [=](size_type i, size_type j) { return a + i * nb + j * nb * n; };
+
+            TaskGraph graph;
+            std::vector<TaskGraph::task_id> lastWriter(nt * nt);
+            std::vector<bool> written(nt * nt, false);
+            auto deps = [&](std::initializer_list<std::pair<size_type, size_type>> tiles) {
+                std::vector<TaskGraph::task_id> d;
+                for (const auto& t : tiles) {
+                    const size_type idx = t.first + t.second * nt;
+                    if (written[idx]) {
+                        d.push_back(lastWriter[idx]);
+                    }
+                }
+                return d;
+            };
+            auto wrote = [&](size_type i, size_type j, TaskGraph::task_id id) {
+                lastWriter[i + j * nt] = id;
+                written[i + j * nt] = true;
+            };
+
+            for (size_type k = 0; k < nt; ++k) {
+                const size_type kb = dim(k);
+                wrote(k, k, graph.add([=] { _private::potrfLower(kb, tile(k, k), n); }, deps({{k, k}})));
+
+                for (size_type i = k + 1; i < nt; ++i) {
+                    const size_type ib = dim(i);
+                    wrote(i, k, graph.add([=] {
+                        blas::trsmRightLowerTrans(ib, kb, tile(k, k), n, tile(i, k), n);
+                    }, deps({{k, k}, {i, k}})));
+                }
+
+                for (size_type i = k + 1; i < nt; ++i) {
+                    const size_type ib = dim(i);
+                    wrote(i, i, graph.add([=] {
+                        blas::syrkLower(ib, kb, T(-1), tile(i, k), n, T(1), tile(i, i), n);
+                    }, deps({{i, k}, {i, i}})));
+
+                    for (size_type j = k + 1; j < i; ++j) {
+                        const size_type jb = dim(j);
+                        wrote(i, j, graph.add([=] {
+                            blas::gemm(blas::Op::NoTrans, blas::Op::Trans, ib, jb, kb,
+                                       T(-1), tile(i, k), n, tile(j, k), n, T(1), tile(i, j), n);
+                        }, deps({{i, k}, {j, k}, {i, j}})));
+                    }
+                }
+            }
+            graph.run(opts.threads);
+        }
+    };
+
+}}
+
+#endif
@@ -0,0 +1,163 @@
+//
+//  conjugate_gradient.hpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#ifndef kssmath_conjugate_gradient_hpp
+#define kssmath_conjugate_gradient_hpp
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "blas.hpp"
+#include "error.hpp"
+#include "instrumentation.hpp"
+#include "linear_operator.hpp"
+#include "parallel.hpp"
+#include "workspace.hpp"
+
+namespace kss { namespace math {
+
+    /*!
+     Options for conjugateGradient.
+     */
+    struct CGOptions {
+        /*!
+         The iteration stops once ||b - Ax|| <= tolerance*||b||.
+         */
+        double      tolerance = 1e-8;
+        std::size_t maxIterations = 1000;
+
+        /*!
+         The number of threads used for the vector operations. The operator and
+         preconditioner are responsible for their own parallelism.
+         */
+        unsigned    threads = 0;
+
+        /*!
+         If given, the work vectors are taken from this workspace rather than the
+         heap, which avoids any allocation (other than the solution) when solving
+         repeatedly. It must not be used by another thread during the solve.
+         */
+        Workspace*  workspace = nullptr;
+    };
+
+    /*!
+     The result of conjugateGradient.
+     */
+    template <class T>
+    struct CGResult {
+        std::vector<T>  x;                      ///< The solution.
+        std::size_t     iterations = 0;         ///< The number of iterations performed.
+        T               residualNorm = T(0);    ///< ||b - Ax|| / ||b|| (as updated by the iteration).
+        bool            converged = false;      ///< True if the tolerance was met.
+    };
+
+    namespace _private {
+
+        // Dot product over fixed size chunks in parallel, summed in chunk order so
+        // the result does not depend on the number of threads.
+        template <class T>
+        T parallelDot(std::size_t n, const T* x, const T* y, unsigned threads) {
+            constexpr std::size_t chunk = 16384;
+            constexpr std::size_t localChunks = 64;
+            const std::size_t chunks = (n + chunk - 1) / chunk;
+
+            // The partial sums are on the stack unless the vectors are very long,
+            // since this is called several times per iteration.
+            T local[localChunks];
+            std::vector<T> heap(chunks > localChunks ? chunks : 0);
+            T* partial = (chunks > localChunks ? heap.data() : local);
+            std::fill(partial, partial + chunks, T(0));
+            parallelFor(n, chunk, [&](std::size_t r0, std::size_t r1) {
+                partial[r0 / chunk] = blas::dot(r1 - r0, x + r0, y + r0);
+            }, threads);
+            T sum = T(0);
+            for (std::size_t c = 0; c < chunks; ++c) {
+                sum += partial[c];
+            }
+            return sum;
+        }
+
+        // y := alpha*x + beta*y in parallel.
+        template <class T>
+        void parallelAxpby(std::size_t n, T alpha, const T* x, T beta, T* y, unsigned threads) {
+            parallelFor(n, 16384, [&](std::size_t r0, std::size_t r1) {
+                for (std::size_t i = r0; i < r1; ++i) {
+                    y[i] = alpha * x[i] + beta * y[i];
+                }
+            }, threads);
+        }
+
+    }
+
+    /*!
+     Solve Ax = b for a symmetric positive definite operator by the preconditioned
+     conjugate gradient method, starting from x = 0. The preconditioner, if given,
+     must also be symmetric positive definite and is called as M(r, z) to compute
+     z = M^-1 r.
+     @throws NotPositiveDefiniteError if a search direction p with p'Ap <= 0 is
+        encountered.
+     */
+    template <class T>
+    CGResult<T> conjugateGradient(const LinearOperator<T>& a, const std::vector<T>& b,
+                                  const LinearOperator<T>& preconditioner = LinearOperator<T>(),
+                                  const CGOptions& opts = CGOptions())
+    {
+        const std::size_t n = b.size();
+        KSSMATH_INSTRUMENT("conjugateGradient", 0, 0);
+        const unsigned threads = opts.threads;
+        CGResult<T> res;
+        res.x.assign(n, T(0));
+        const T bnorm = std::sqrt(_private::parallelDot(n, b.data(), b.data(), threads));
+        if (bnorm == T(0)) {
+            res.converged = true;
+            return res;
+        }
+
+        _private::ScratchBuffer<T> r(opts.workspace, b.data(), b.data() + n);
+        _private::ScratchBuffer<T> z(opts.workspace, n), p(opts.workspace, n), q(opts.workspace, n);
+        auto precondition = [&]() {
+            if (preconditioner) {
+                preconditioner(r.data(), z.data());
+            }
+            else {
+                std::copy(r.begin(), r.end(), z.begin());
+            }
+        };
+        precondition();
+        std::copy(z.begin(), z.end(), p.begin());
+        T rz = _private::parallelDot(n, r.data(), z.data(), threads);
+        for (res.iterations = 0; res.iterations < opts.maxIterations;) {
+            a(p.data(), q.data());
+            const T pq = _private::parallelDot(n, p.data(), q.data(), threads);
+            if (pq <= T(0)) {
+                throw NotPositiveDefiniteError("conjugateGradient: operator is not positive definite");
+            }
+            const T alpha = rz / pq;
+            _private::parallelAxpby(n, alpha, p.data(), T(1), res.x.data(), threads);
+            _private::parallelAxpby(n, -alpha, q.data(), T(1), r.data(), threads);
+            ++res.iterations;
+
+            res.residualNorm = std::sqrt(_private::parallelDot(n, r.data(), r.data(), threads)) / bnorm;
+            if (res.residualNorm <= T(opts.tolerance)) {
+                res.converged = true;
+                break;
+            }
+            precondition();
+            const T rzNew = _private::parallelDot(n, r.data(), z.data(), threads);
+            _private::parallelAxpby(n, T(1), z.data(), rzNew / rz, p.data(), threads);
+            rz = rzNew;
+        }
+        return res;
+    }
+
+}}
+
+#endif
@@ -0,0 +1,204 @@
+//
+//  cpu_features.cpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+#   include <cpuid.h>
+#   define KSSMATH_X86_VARIANTS 1
+#endif
+
+#include "blas.hpp"
+#include "cpu_features.hpp"
+#include "tuning.hpp"
+
+using namespace std;
+using namespace kss::math;
+using kss::math::blas::Op;
+using kss::math::blas::_private::BlasKernels;
+
+
+namespace {
+
+    CpuFeatures detect() noexcept {
+        CpuFeatures f;
+#if defined(KSSMATH_X86_VARIANTS)
+        unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+        if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+            return f;
+        }
+        f.sse42 = (ecx & (1u << 20)) != 0;
+        const bool osxsave = (ecx & (1u << 27)) != 0;
+        const bool fma = (ecx & (1u << 12)) != 0;
+        const bool avx = (ecx & (1u << 28)) != 0;
+
+        // The AVX state (XMM and YMM, bits 1 and 2 of XCR0) and the AVX-512 state
+        // (opmask and ZMM, bits 5 to 7) must be enabled by the operating system.
+        unsigned xcr0 = 0;
+        if (osxsave) {
+            unsigned hi = 0;
+            __asm__ volatile("xgetbv" : "=a"(xcr0), "=d"(hi) : "c"(0));
+        }
+        const bool ymm = (xcr0 & 0x6u) == 0x6u;
+        const bool zmm = (xcr0 & 0xe6u) == 0xe6u;
+        f.avx = avx && ymm;
+        f.fma = fma && ymm;
+        if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+            f.avx2 = ymm && (ebx & (1u << 5)) != 0;
+            f.avx512f = zmm && (ebx & (1u << 16)) != 0;
+        }
+#elif defined(__aarch64__) || defined(__ARM_NEON)
+        f.neon = true;
+#endif
+        return f;
+    }
+
+
+    // The kernel variants. Each is the template from blas.hpp compiled for the
+    // instruction set, with SIMD batches as wide as its registers and everything
+    // it calls inlined (flatten) so that the inner loops are compiled for it too.
+
+#define KSSMATH_BLAS_VARIANTS(ATTRIBUTES, T, W, NAME)                                               \
+    ATTRIBUTES T dot##NAME(size_t n, const T* x, const T* y) {                                      \
+        return blas::dot<T, W>(n, x, y);                                                            \
+    }                                                                                               \
+    ATTRIBUTES void axpy##NAME(size_t n, T alpha, const T* x, T* y) {                               \
+        blas::axpy<T, W>(n, alpha, x, y);                                                           \
+    }                                                                                               \
+    ATTRIBUTES void gemv##NAME(size_t m, size_t n, T alpha, const T* a, size_t lda, const T* x,     \
+                               T beta, T* y) {                                                      \
+        blas::gemv<T, W>(m, n, alpha, a, lda, x, beta, y);                                          \
+    }                                                                                               \
+    ATTRIBUTES void gemvTranspose##NAME(size_t m, size_t n, T alpha, const T* a, size_t lda,        \
+                                        const T* x, T beta, T* y) {                                 \
+        blas::gemvTranspose<T, W>(m, n, alpha, a, lda, x, beta, y);                                 \
+    }                                                                                               \
+    ATTRIBUTES void gemm##NAME(Op opA, Op opB, size_t m, size_t n, size_t k, T alpha, const T* a,   \
+                               size_t lda, const T* b, size_t ldb, T beta, T* c, size_t ldc) {      \
+        blas::gemm<T, W>(opA, opB, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);                   \
+    }                                                                                               \
+    ATTRIBUTES void syrkLower##NAME(size_t n, size_t k, T alpha, const T* a, size_t lda, T beta,    \
+                                    T* c, size_t ldc) {                                             \
+        blas::syrkLower<T, W>(n, k, alpha, a, lda, beta, c, ldc);                                   \
+    }                                                                                               \
+    const BlasKernels<T> kernels##NAME = {                                                          \
+        dot##NAME, axpy##NAME, gemv##NAME, gemvTranspose##NAME, gemm##NAME, syrkLower##NAME         \
+    };
+
+    KSSMATH_BLAS_VARIANTS(, float, simd::nativeLanes<float>(), FloatGeneric)
+    KSSMATH_BLAS_VARIANTS(, double, simd::nativeLanes<double>(), DoubleGeneric)
+#if defined(KSSMATH_X86_VARIANTS)
+    KSSMATH_BLAS_VARIANTS(__attribute__((target("avx2,fma"), flatten)), float, 8, FloatAVX2)
+    KSSMATH_BLAS_VARIANTS(__attribute__((target("avx2,fma"), flatten)), double, 4, DoubleAVX2)
+    KSSMATH_BLAS_VARIANTS(__attribute__((target("avx512f,avx2,fma"), flatten)), float, 16, FloatAVX512)
+    KSSMATH_BLAS_VARIANTS(__attribute__((target("avx512f,avx2,fma"), flatten)), double, 8, DoubleAVX512)
+#endif
+
+#undef KSSMATH_BLAS_VARIANTS
+
+    InstructionSet active = InstructionSet::Generic;
+
+    void bind(InstructionSet isa) noexcept {
+        using blas::_private::floatKernels;
+        using blas::_private::doubleKernels;
+        switch (isa) {
+#if defined(KSSMATH_X86_VARIANTS)
+        case InstructionSet::AVX2:
+            floatKernels = kernelsFloatAVX2;
+            doubleKernels = kernelsDoubleAVX2;
+            break;
+        case InstructionSet::AVX512:
+            floatKernels = kernelsFloatAVX512;
+            doubleKernels = kernelsDoubleAVX512;
+            break;
+#endif
+        default:
+            floatKernels = kernelsFloatGeneric;
+            doubleKernels = kernelsDoubleGeneric;
+            break;
+        }
+        active = isa;
+    }
+
+    // Bind the kernels when the library is loaded, to the instruction set of the
+    // tuning parameters (the best one supported unless the tuning file says
+    // otherwise). Until then (that is, from the static initializers of other
+    // translation units) the generic kernels are used.
+    struct LoadTimeBinding {
+        LoadTimeBinding() noexcept {
+            InstructionSet isa = tuningParameters().instructionSet;
+            if (const char* name = getenv("KSSMATH_INSTRUCTION_SET")) {
+                for (auto candidate : { InstructionSet::Generic, InstructionSet::AVX2, InstructionSet::AVX512 }) {
+                    if (strcmp(name, instructionSetName(candidate)) == 0 && isSupported(candidate)) {
+                        isa = candidate;
+                    }
+                }
+            }
+            bind(isa);
+        }
+    } loadTimeBinding;
+
+}
+
+
+BlasKernels<float> kss::math::blas::_private::floatKernels = {
+    dotFloatGeneric, axpyFloatGeneric, gemvFloatGeneric, gemvTransposeFloatGeneric, gemmFloatGeneric,
+    syrkLowerFloatGeneric
+};
+
+BlasKernels<double> kss::math::blas::_private::doubleKernels = {
+    dotDoubleGeneric, axpyDoubleGeneric, gemvDoubleGeneric, gemvTransposeDoubleGeneric, gemmDoubleGeneric,
+    syrkLowerDoubleGeneric
+};
+
+const CpuFeatures& kss::math::cpuFeatures() noexcept {
+    static const CpuFeatures features = detect();
+    return features;
+}
+
+const char* kss::math::instructionSetName(InstructionSet isa) noexcept {
+    switch (isa) {
+    case InstructionSet::Generic:   return "generic";
+    case InstructionSet::AVX2:      return "avx2";
+    case InstructionSet::AVX512:    return "avx512";
+    }
+    return "unknown";
+}
+
+bool kss::math::isSupported(InstructionSet isa) noexcept {
+    const CpuFeatures& f = cpuFeatures();
+    switch (isa) {
+    case InstructionSet::Generic:
+        return true;
+#if defined(KSSMATH_X86_VARIANTS)
+    case InstructionSet::AVX2:
+        return f.avx2 && f.fma;
+    case InstructionSet::AVX512:
+        return f.avx512f && f.avx2 && f.fma;
+#endif
+    default:
+        (void)f;
+        return false;
+    }
+}
+
+InstructionSet kss::math::activeInstructionSet() noexcept {
+    return active;
+}
+
+void kss::math::selectInstructionSet(InstructionSet isa) {
+    if (!isSupported(isa)) {
+        throw invalid_argument(string("selectInstructionSet: ") + instructionSetName(isa)
+                               + " is not supported on this machine");
+    }
+    bind(isa);
+}
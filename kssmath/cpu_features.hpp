@@ -0,0 +1,73 @@
+//
+//  cpu_features.hpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#ifndef kssmath_cpu_features_hpp
+#define kssmath_cpu_features_hpp
+
+namespace kss { namespace math {
+
+    /*!
+     The instruction set extensions of the CPU that matter to the kernels, as
+     detected at run time. For the AVX extensions the operating system must also
+     save the wider registers, so a feature is only reported if it can be used.
+     */
+    struct CpuFeatures {
+        bool sse42 = false;
+        bool avx = false;
+        bool avx2 = false;
+        bool fma = false;
+        bool avx512f = false;
+        bool neon = false;
+    };
+
+    /*!
+     Returns the features of the CPU, detected on the first call.
+     */
+    const CpuFeatures& cpuFeatures() noexcept;
+
+    /*!
+     The instruction sets that the dispatched kernels (the float and double
+     overloads of blas::dot, axpy, gemv, gemvTranspose, gemm and syrkLower) are
+     compiled for. Generic is the baseline of the build; on ARM it already
+     includes NEON.
+     */
+    enum class InstructionSet { Generic, AVX2, AVX512 };
+
+    /*!
+     Returns the name of an instruction set, as accepted by the
+     KSSMATH_INSTRUCTION_SET environment variable ("generic", "avx2", "avx512").
+     */
+    const char* instructionSetName(InstructionSet isa) noexcept;
+
+    /*!
+     Returns true if the kernels were compiled for the instruction set and the
+     CPU supports it.
+     */
+    bool isSupported(InstructionSet isa) noexcept;
+
+    /*!
+     Returns the instruction set whose kernels are in use. When the library is
+     loaded this is the one in the tuning parameters (see tuning.hpp): the best
+     one supported, unless autotuning found another to be faster. The
+     KSSMATH_INSTRUCTION_SET environment variable overrides it if it names a
+     supported one.
+     */
+    InstructionSet activeInstructionSet() noexcept;
+
+    /*!
+     Switch the kernels to those of the given instruction set, for example to
+     compare results or performance between them. This must not be called while
+     other threads may be running the kernels.
+     @throws std::invalid_argument if the instruction set is not supported.
+     */
+    void selectInstructionSet(InstructionSet isa);
+
+}}
+
+#endif
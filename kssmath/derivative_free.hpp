@@ -0,0 +1,502 @@
+//
+//  derivative_free.hpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#ifndef kssmath_derivative_free_hpp
+#define kssmath_derivative_free_hpp
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#include "blas.hpp"
+#include "instrumentation.hpp"
+#include "matrix.hpp"
+#include "parallel.hpp"
+#include "random.hpp"
+#include "symmetric_eigen.hpp"
+
+namespace kss { namespace math {
+
+    /*!
+     The optimizers in this file evaluate the objective on a batch of points at
+     a time: it is called as f(const T* points, std::size_t count, T* values)
+     and sets values[k] to the objective at the k-th point, whose n coordinates
+     are points[k*n] to points[k*n + n - 1]. An expensive objective can then
+     evaluate the points in parallel, or hand them to a simulator that runs
+     several at once. parallelBatch() turns an objective of a single point into
+     one that evaluates a batch by parallelFor, on the calling thread and the
+     persistent workers it shares with the rest of the library. Like any
+     parallelFor, a batch evaluated from within another parallel loop, or while
+     another thread is using the workers, runs serially on the calling thread.
+     */
+    template <class F>
+    auto parallelBatch(F f, std::size_t n, unsigned threads = 0) {
+        return [f, n, threads](const auto* points, std::size_t count, auto* values) {
+            parallelFor(count, 1, [&](std::size_t begin, std::size_t end) {
+                for (std::size_t k = begin; k < end; ++k) {
+                    values[k] = f(points + k * n);
+                }
+            }, threads);
+        };
+    }
+
+    /*!
+     The result of nelderMead and cmaes. The best point found is returned in x.
+     */
+    template <class T>
+    struct DerivativeFreeResult {
+        T           value = T(0);       ///< The objective at x.
+        std::size_t iterations = 0;     ///< Iterations of Nelder-Mead, generations of CMA-ES.
+        std::size_t evaluations = 0;    ///< The number of points evaluated.
+        bool        converged = false;  ///< True if a tolerance was met.
+    };
+
+    /*!
+     Options for nelderMead.
+     */
+    struct NelderMeadOptions {
+        /*!
+         The initial simplex has the vertices x and x + initialStep*max(|x[i]|, 1)
+         along each axis i.
+         */
+        double      initialStep = 0.1;
+
+        /*!
+         The number of the worst vertices replaced in each iteration, by their
+         reflections through the centroid of the others, as in the parallel
+         Nelder-Mead method of Lee and Wiswall. 1 is the classic method. More
+         gives larger batches, which suits an objective that evaluates many
+         points at once, but slows convergence per iteration. At most n - 1
+         vertices (1 if n is 1) are replaced, whatever is asked: with n the
+         centroid is the best vertex alone, each reflection merely mirrors a
+         vertex through it, and the search stalls well short of the minimum.
+         Even below that, more than about n/2 can collapse the simplex early
+         in higher dimensions.
+         */
+        std::size_t parallelVertices = 1;
+
+        /*!
+         If true, the reflection, expansion and both contractions of each vertex
+         are evaluated in one batch; otherwise the reflections are evaluated
+         first and then the one further point each needs. Speculation halves
+         the number of batches at the cost of more evaluations, so it pays when
+         there are idle threads.
+         */
+        bool        speculative = true;
+
+        /*!
+         Use the coefficients of Gao and Han, which depend on the dimension and
+         converge much better than the classic ones above a few dimensions.
+         */
+        bool        adaptive = true;
+
+        /*!
+         The iteration stops once the values at the vertices differ by at most
+         functionTolerance and their coordinates by at most xTolerance, or after
+         maxEvaluations evaluations.
+         */
+        double      functionTolerance = 1e-8;
+        double      xTolerance = 1e-8;
+        std::size_t maxEvaluations = 100000;
+    };
+
+    /*!
+     Minimize f by the Nelder-Mead simplex method, starting from and returning
+     the best point in x. f is a batch objective as described above; each
+     iteration evaluates one batch (two if not speculative), except that a
+     shrink of the simplex evaluates a batch of n points.
+     @throws std::invalid_argument if x is empty or opts.parallelVertices is 0.
+     */
+    template <class T, class F>
+    DerivativeFreeResult<T> nelderMead(F&& f, std::vector<T>& x, const NelderMeadOptions& opts = NelderMeadOptions()) {
+        const std::size_t n = x.size();
+        if (n == 0) {
+            throw std::invalid_argument("nelderMead: x must not be empty");
+        }
+        if (opts.parallelVertices == 0) {
+            throw std::invalid_argument("nelderMead: parallelVertices must be positive");
+        }
+        KSSMATH_INSTRUMENT("nelderMead", 0, 0);
+
+        const T dn = T(n);
+        const T reflection = T(1);
+        const T expansion = (opts.adaptive ? T(1) + T(2) / dn : T(2));
+        const T contraction = (opts.adaptive ? T(0.75) - T(1) / (T(2) * dn) : T(0.5));
+        const T shrinkage = (opts.adaptive && n > 1 ? T(1) - T(1) / dn : T(0.5));
+        const std::size_t p = std::min(opts.parallelVertices, std::max<std::size_t>(n - 1, 1));
+
+        // The vertices, sorted by value at the start of each iteration, and the
+        // candidates for the worst p of them: reflection, expansion, outside and
+        // inside contraction.
+        std::vector<T> simplex((n + 1) * n), values(n + 1), sorted((n + 1) * n), sortedValues(n + 1);
+        std::vector<std::size_t> order(n + 1);
+        std::vector<T> candidates(4 * p * n), candidateValues(4 * p);
+        std::vector<T> batch(std::max(4 * p, n + 1) * n), batchValues(std::max(4 * p, n + 1));
+        std::vector<std::size_t> pending;
+        pending.reserve(4 * p);
+        std::vector<T> centroid(n);
+
+        DerivativeFreeResult<T> res;
+
+        // Evaluate the listed rows of a point array in one batch.
+        auto evaluate = [&](const T* rows, T* rowValues, const std::vector<std::size_t>& which) {
+            if (which.empty()) {
+                return;
+            }
+            for (std::size_t k = 0; k < which.size(); ++k) {
+                std::copy(rows + which[k] * n, rows + which[k] * n + n, batch.begin() + k * n);
+            }
+            f(static_cast<const T*>(batch.data()), which.size(), batchValues.data());
+            for (std::size_t k = 0; k < which.size(); ++k) {
+                rowValues[which[k]] = batchValues[k];
+            }
+            res.evaluations += which.size();
+        };
+
+        for (std::size_t v = 0; v <= n; ++v) {
+            std::copy(x.begin(), x.end(), simplex.begin() + v * n);
+            if (v > 0) {
+                simplex[v * n + v - 1] += T(opts.initialStep) * std::max(std::abs(x[v - 1]), T(1));
+            }
+        }
+        pending.resize(n + 1);
+        std::iota(pending.begin(), pending.end(), std::size_t(0));
+        evaluate(simplex.data(), values.data(), pending);
+
+        while (true) {
+            std::iota(order.begin(), order.end(), std::size_t(0));
+            std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+                return values[a] < values[b];
+            });
+            for (std::size_t v = 0; v <= n; ++v) {
+                std::copy(simplex.begin() + order[v] * n, simplex.begin() + order[v] * n + n, sorted.begin() + v * n);
+                sortedValues[v] = values[order[v]];
+            }
+            simplex.swap(sorted);
+            values.swap(sortedValues);
+
+            T xSpread = T(0);
+            for (std::size_t v = 1; v <= n; ++v) {
+                for (std::size_t i = 0; i < n; ++i) {
+                    xSpread = std::max(xSpread, std::abs(simplex[v * n + i] - simplex[i]));
+                }
+            }
+            if (values[n] - values[0] <= T(opts.functionTolerance) && xSpread <= T(opts.xTolerance)) {
+                res.converged = true;
+                break;
+            }
+            if (res.evaluations >= opts.maxEvaluations) {
+                break;
+            }
+            ++res.iterations;
+
+            // The centroid of the vertices that are kept.
+            std::fill(centroid.begin(), centroid.end(), T(0));
+            for (std::size_t v = 0; v <= n - p; ++v) {
+                for (std::size_t i = 0; i < n; ++i) {
+                    centroid[i] += simplex[v * n + i];
+                }
+            }
+            for (auto& c : centroid) {
+                c /= T(n + 1 - p);
+            }
+
+            for (std::size_t j = 0; j < p; ++j) {
+                const T* worst = simplex.data() + (n - p + 1 + j) * n;
+                T* r = candidates.data() + 4 * j * n;
+                for (std::size_t i = 0; i < n; ++i) {
+                    const T c = centroid[i];
+                    r[i] = c + reflection * (c - worst[i]);
+                    r[n + i] = c + expansion * reflection * (c - worst[i]);
+                    r[2 * n + i] = c + contraction * reflection * (c - worst[i]);
+                    r[3 * n + i] = c - contraction * (c - worst[i]);
+                }
+            }
+
+            const T best = values[0];
+            const T kept = values[n - p];
+            pending.clear();
+            for (std::size_t j = 0; j < p; ++j) {
+                pending.push_back(4 * j);
+                if (opts.speculative) {
+                    pending.push_back(4 * j + 1);
+                    pending.push_back(4 * j + 2);
+                    pending.push_back(4 * j + 3);
+                }
+            }
+            evaluate(candidates.data(), candidateValues.data(), pending);
+            if (!opts.speculative) {
+                // The one further point that each reflection calls for.
+                pending.clear();
+                for (std::size_t j = 0; j < p; ++j) {
+                    const T fr = candidateValues[4 * j];
+                    if (fr < best) {
+                        pending.push_back(4 * j + 1);
+                    }
+                    else if (fr >= kept) {
+                        pending.push_back(fr < values[n - p + 1 + j] ? 4 * j + 2 : 4 * j + 3);
+                    }
+                }
+                evaluate(candidates.data(), candidateValues.data(), pending);
+            }
+
+            // Replace each of the worst vertices by its best acceptable candidate.
+            bool improved = false;
+            for (std::size_t j = 0; j < p; ++j) {
+                const std::size_t v = n - p + 1 + j;
+                const T fr = candidateValues[4 * j];
+                std::size_t accept = 4;
+                if (fr < best) {
+                    accept = (candidateValues[4 * j + 1] < fr ? 1 : 0);
+                }
+                else if (fr < kept) {
+                    accept = 0;
+                }
+                else if (fr < values[v]) {
+                    accept = (candidateValues[4 * j + 2] <= fr ? 2 : 4);
+                }
+                else if (candidateValues[4 * j + 3] < values[v]) {
+                    accept = 3;
+                }
+                if (accept < 4) {
+                    const T* c = candidates.data() + (4 * j + accept) * n;
+                    std::copy(c, c + n, simplex.begin() + v * n);
+                    values[v] = candidateValues[4 * j + accept];
+                    improved = true;
+                }
+            }
+
+            // Otherwise shrink the simplex towards the best vertex.
+            if (!improved) {
+                pending.clear();
+                for (std::size_t v = 1; v <= n; ++v) {
+                    for (std::size_t i = 0; i < n; ++i) {
+                        simplex[v * n + i] = simplex[i] + shrinkage * (simplex[v * n + i] - simplex[i]);
+                    }
+                    pending.push_back(v);
+                }
+                evaluate(simplex.data(), values.data(), pending);
+            }
+        }
+
+        const auto bestVertex = std::size_t(std::min_element(values.begin(), values.end()) - values.begin());
+        std::copy(simplex.begin() + bestVertex * n, simplex.begin() + bestVertex * n + n, x.begin());
+        res.value = values[bestVertex];
+        return res;
+    }
+
+    /*!
+     Options for cmaes.
+     */
+    struct CmaesOptions {
+        /*!
+         The initial step size (sigma), which should be about a quarter of the
+         width of the region where the minimum is expected.
+         */
+        double          initialStep = 0.3;
+
+        /*!
+         The number of points per generation (lambda); 0 uses the default
+         4 + 3 ln n. Larger populations search more globally. Since a generation
+         is evaluated as one batch, a multiple of the number of threads
+         available to the objective makes good use of them.
+         */
+        std::size_t     populationSize = 0;
+
+        /*!
+         The iteration stops once the values of the recent best points and of the
+         current generation differ by at most functionTolerance, or the step
+         size in every coordinate is at most xTolerance, or after maxEvaluations
+         evaluations.
+         */
+        double          functionTolerance = 1e-12;
+        double          xTolerance = 1e-11;
+        std::size_t     maxEvaluations = 100000;
+
+        /*!
+         Seed of the random samples.
+         */
+        std::uint64_t   seed = 0x6b73736d617468ull;
+    };
+
+    /*!
+     Minimize f by the covariance matrix adaptation evolution strategy,
+     (mu/mu_w, lambda)-CMA-ES, starting from the mean x and returning the best
+     point found in x. Each generation samples lambda points from a normal
+     distribution whose mean, step size and covariance adapt to the objective,
+     and evaluates them as one batch (see above). The covariance is
+     decomposed by SymmetricEigen every few generations, as often as its
+     learning rates warrant.
+     @throws std::invalid_argument if x is empty or opts.initialStep is not
+        positive.
+     */
+    template <class T, class F>
+    DerivativeFreeResult<T> cmaes(F&& f, std::vector<T>& x, const CmaesOptions& opts = CmaesOptions()) {
+        const std::size_t n = x.size();
+        if (n == 0) {
+            throw std::invalid_argument("cmaes: x must not be empty");
+        }
+        if (!(opts.initialStep > 0)) {
+            throw std::invalid_argument("cmaes: the initial step must be positive");
+        }
+        KSSMATH_INSTRUMENT("cmaes", 0, 0);
+
+        // The strategy parameters, as recommended by Hansen (The CMA Evolution
+        // Strategy: A Tutorial, 2016).
+        const T dn = T(n);
+        const std::size_t lambda = (opts.populationSize > 0 ? std::max<std::size_t>(opts.populationSize, 2)
+                                                            : 4 + std::size_t(3 * std::log(double(n))));
+        const std::size_t mu = lambda / 2;
+        std::vector<T> weights(mu);
+        for (std::size_t i = 0; i < mu; ++i) {
+            weights[i] = std::log(T(lambda + 1) / T(2)) - std::log(T(i + 1));
+        }
+        const T weightSum = std::accumulate(weights.begin(), weights.end(), T(0));
+        T weightSquares = T(0);
+        for (auto& w : weights) {
+            w /= weightSum;
+            weightSquares += w * w;
+        }
+        const T muEff = T(1) / weightSquares;
+        const T cSigma = (muEff + T(2)) / (dn + muEff + T(5));
+        const T dSigma = T(1) + T(2) * std::max(T(0), std::sqrt((muEff - T(1)) / (dn + T(1))) - T(1)) + cSigma;
+        const T cc = (T(4) + muEff / dn) / (dn + T(4) + T(2) * muEff / dn);
+        const T c1 = T(2) / ((dn + T(1.3)) * (dn + T(1.3)) + muEff);
+        const T cMu = std::min(T(1) - c1, T(2) * (muEff - T(2) + T(1) / muEff) / ((dn + T(2)) * (dn + T(2)) + muEff));
+        const T chiN = std::sqrt(dn) * (T(1) - T(1) / (T(4) * dn) + T(1) / (T(21) * dn * dn));
+        const std::size_t eigenInterval = std::max<std::size_t>(1, std::size_t(T(1) / ((c1 + cMu) * dn * T(10))));
+        const std::size_t history = 10 + std::size_t(std::ceil(T(30) * dn / T(lambda)));
+
+        // The covariance C = B*D^2*B' (only its lower triangle is kept), with BD
+        // = B*D; the samples are the columns of Y = BD*Z and X = m + sigma*Y.
+        std::vector<T> mean(x), pSigma(n, T(0)), pc(n, T(0)), yw(n), tmp(n), d(n, T(1));
+        Matrix<T> c(n, n), b(n, n), bd(n, n), z(n, lambda), y(n, lambda), points(n, lambda), weighted(n, mu);
+        for (std::size_t i = 0; i < n; ++i) {
+            c(i, i) = b(i, i) = bd(i, i) = T(1);
+        }
+        std::vector<T> values(lambda);
+        std::vector<std::size_t> order(lambda);
+        std::deque<T> recentBest;
+        _private::NormalGenerator<T> gen(opts.seed);
+        T sigma = T(opts.initialStep);
+
+        DerivativeFreeResult<T> res;
+        res.value = std::numeric_limits<T>::infinity();
+        while (res.evaluations + lambda <= std::max(opts.maxEvaluations, lambda)) {
+            // Sample and evaluate a generation.
+            std::generate(z.data(), z.data() + z.size(), [&] { return gen(); });
+            blas::gemm(blas::Op::NoTrans, blas::Op::NoTrans, n, lambda, n, T(1), bd.data(), n, z.data(), n,
+                       T(0), y.data(), n);
+            for (std::size_t k = 0; k < lambda; ++k) {
+                for (std::size_t i = 0; i < n; ++i) {
+                    points(i, k) = mean[i] + sigma * y(i, k);
+                }
+            }
+            f(static_cast<const T*>(points.data()), lambda, values.data());
+            res.evaluations += lambda;
+            ++res.iterations;
+
+            std::iota(order.begin(), order.end(), std::size_t(0));
+            std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+                return values[a] < values[b];
+            });
+            if (values[order[0]] < res.value) {
+                res.value = values[order[0]];
+                std::copy(points.data() + order[0] * n, points.data() + order[0] * n + n, x.begin());
+            }
+
+            // Move the mean to the weighted mean of the best mu samples.
+            std::fill(yw.begin(), yw.end(), T(0));
+            for (std::size_t i = 0; i < mu; ++i) {
+                blas::axpy(n, weights[i], y.data() + order[i] * n, yw.data());
+            }
+            blas::axpy(n, sigma, yw.data(), mean.data());
+
+            // The evolution paths. C^(-1/2)*yw = B*D^-1*B'*yw.
+            blas::gemvTranspose(n, n, T(1), b.data(), n, yw.data(), T(0), tmp.data());
+            for (std::size_t i = 0; i < n; ++i) {
+                tmp[i] /= d[i];
+            }
+            const T sigmaScale = std::sqrt(cSigma * (T(2) - cSigma) * muEff);
+            blas::scal(n, T(1) - cSigma, pSigma.data());
+            blas::gemv(n, n, sigmaScale, b.data(), n, tmp.data(), T(1), pSigma.data());
+            const T pSigmaNorm = std::sqrt(blas::dot(n, pSigma.data(), pSigma.data()));
+            const T decay = T(1) - std::pow(T(1) - cSigma, T(2 * res.iterations));
+            const bool hSigma = pSigmaNorm / std::sqrt(decay) < (T(1.4) + T(2) / (dn + T(1))) * chiN;
+            blas::scal(n, T(1) - cc, pc.data());
+            if (hSigma) {
+                blas::axpy(n, std::sqrt(cc * (T(2) - cc) * muEff), yw.data(), pc.data());
+            }
+
+            // The rank one and rank mu updates of the covariance.
+            const T delta = (hSigma ? T(0) : cc * (T(2) - cc));
+            const T keep = T(1) - c1 - cMu + c1 * delta;
+            for (std::size_t j = 0; j < n; ++j) {
+                for (std::size_t i = j; i < n; ++i) {
+                    c(i, j) = keep * c(i, j) + c1 * pc[i] * pc[j];
+                }
+            }
+            for (std::size_t k = 0; k < mu; ++k) {
+                const T scale = std::sqrt(weights[k]);
+                for (std::size_t i = 0; i < n; ++i) {
+                    weighted(i, k) = scale * y(i, order[k]);
+                }
+            }
+            blas::syrkLower(n, mu, cMu, weighted.data(), n, T(1), c.data(), n);
+
+            sigma *= std::exp((cSigma / dSigma) * (pSigmaNorm / chiN - T(1)));
+
+            if (res.iterations % eigenInterval == 0) {
+                SymmetricEigen<T> eig(c);
+                const auto& ev = eig.eigenvalues();
+                b = eig.eigenvectors();
+                const T floor = ev.back() * std::numeric_limits<T>::epsilon();
+                for (std::size_t i = 0; i < n; ++i) {
+                    d[i] = std::sqrt(std::max(ev[i], floor));
+                    for (std::size_t r = 0; r < n; ++r) {
+                        bd(r, i) = b(r, i) * d[i];
+                    }
+                }
+            }
+
+            // Stop when the values have flattened out or the steps are tiny.
+            recentBest.push_back(values[order[0]]);
+            if (recentBest.size() > history) {
+                recentBest.pop_front();
+            }
+            if (recentBest.size() == history) {
+                const auto range = std::minmax_element(recentBest.begin(), recentBest.end());
+                if (*range.second - *range.first <= T(opts.functionTolerance)
+                    && values[order[lambda - 1]] - values[order[0]] <= T(opts.functionTolerance))
+                {
+                    res.converged = true;
+                    break;
+                }
+            }
+            T largestStep = T(0);
+            for (std::size_t i = 0; i < n; ++i) {
+                largestStep = std::max(largestStep, sigma * std::max(std::sqrt(c(i, i)), std::abs(pc[i])));
+            }
+            if (largestStep <= T(opts.xTolerance)) {
+                res.converged = true;
+                break;
+            }
+        }
+        return res;
+    }
+
+}}
+
+#endif
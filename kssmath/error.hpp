@@ -0,0 +1,38 @@
+//
+//  error.hpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#ifndef kssmath_error_hpp
+#define kssmath_error_hpp
+
+#include <stdexcept>
+#include <string>
+
+namespace kss { namespace math {
+
+    /*!
+     Thrown when a factorization encounters an exactly singular (or, in reduced
+     precision, numerically unusable) matrix.
+     */
+    class SingularMatrixError : public std::runtime_error {
+    public:
+        explicit SingularMatrixError(const std::string& what_arg) : std::runtime_error(what_arg) {}
+    };
+
+    /*!
+     Thrown when a Cholesky factorization finds that its matrix is not positive
+     definite.
+     */
+    class NotPositiveDefiniteError : public std::runtime_error {
+    public:
+        explicit NotPositiveDefiniteError(const std::string& what_arg) : std::runtime_error(what_arg) {}
+    };
+
+}}
+
+#endif
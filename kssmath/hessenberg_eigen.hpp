@@ -0,0 +1,306 @@
+//
+//  hessenberg_eigen.hpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#ifndef kssmath_hessenberg_eigen_hpp
+#define kssmath_hessenberg_eigen_hpp
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+// Eigensolvers for a small real upper Hessenberg matrix h (n x n, leading
+// dimension ldh). These are the building blocks for the Arnoldi solver and are
+// not intended to be used directly.
+
+namespace kss { namespace math { namespace _private {
+
+    // Returns the 1-norm of the upper Hessenberg matrix h.
+    template <class T>
+    T hessenbergNorm(std::size_t n, const T* h, std::size_t ldh) noexcept {
+        T nrm = T(0);
+        for (std::size_t j = 0; j < n; ++j) {
+            T sum = T(0);
+            for (std::size_t i = 0; i <= std::min(j + 1, n - 1); ++i) {
+                sum += std::abs(h[i + j * ldh]);
+            }
+            nrm = std::max(nrm, sum);
+        }
+        return nrm;
+    }
+
+    // Eigenvalues of h by the Francis double shift QR algorithm, with an
+    // exceptional shift after every 10 iterations without deflation. h is
+    // destroyed. The eigenvalues are returned in no particular order, but complex
+    // conjugate pairs are adjacent with the positive imaginary part first.
+    template <class T>
+    std::vector<std::complex<T>> hessenbergEigenvalues(std::size_t n, T* h, std::size_t ldh) {
+        using std::abs;
+        using index = std::ptrdiff_t;
+        std::vector<std::complex<T>> w(n);
+        if (n == 0) {
+            return w;
+        }
+        const T eps = std::numeric_limits<T>::epsilon();
+        // One based indexing keeps the loops close to the classic formulation.
+        auto a = [h, ldh](index i, index j) -> T& { return h[(i - 1) + (j - 1) * index(ldh)]; };
+        auto sign = [](T x, T y) { return (y >= T(0) ? abs(x) : -abs(x)); };
+        const T anorm = hessenbergNorm(n, h, ldh);
+        const unsigned maxIterations = 30 * unsigned(std::max<std::size_t>(n, 10));
+
+        index nn = index(n);
+        index l = 1;
+        T t = T(0), p = T(0), q = T(0), r = T(0), s = T(0), x = T(0), y = T(0), z = T(0);
+        while (nn >= 1) {
+            unsigned its = 0;
+            do {
+                for (l = nn; l >= 2; --l) {
+                    s = abs(a(l - 1, l - 1)) + abs(a(l, l));
+                    if (s == T(0)) {
+                        s = anorm;
+                    }
+                    if (abs(a(l, l - 1)) <= eps * s) {
+                        a(l, l - 1) = T(0);
+                        break;
+                    }
+                }
+                x = a(nn, nn);
+                if (l == nn) {
+                    w[std::size_t(nn - 1)] = std::complex<T>(x + t, T(0));
+                    --nn;
+                }
+                else {
+                    y = a(nn - 1, nn - 1);
+                    const T ww = a(nn, nn - 1) * a(nn - 1, nn);
+                    if (l == nn - 1) {
+                        p = T(0.5) * (y - x);
+                        q = p * p + ww;
+                        z = std::sqrt(abs(q));
+                        x += t;
+                        if (q >= T(0)) {
+                            z = p + sign(z, p);
+                            const T hi = x + z;
+                            const T lo = (z != T(0) ? x - ww / z : hi);
+                            w[std::size_t(nn - 2)] = std::complex<T>(hi, T(0));
+                            w[std::size_t(nn - 1)] = std::complex<T>(lo, T(0));
+                        }
+                        else {
+                            w[std::size_t(nn - 2)] = std::complex<T>(x + p, abs(z));
+                            w[std::size_t(nn - 1)] = std::complex<T>(x + p, -abs(z));
+                        }
+                        nn -= 2;
+                    }
+                    else {
+                        if (its == maxIterations) {
+                            throw std::runtime_error("hessenbergEigenvalues: failed to converge");
+                        }
+                        T wq = ww;
+                        if (its > 0 && its % 10 == 0) {
+                            t += x;
+                            for (index i = 1; i <= nn; ++i) {
+                                a(i, i) -= x;
+                            }
+                            s = abs(a(nn, nn - 1)) + abs(a(nn - 1, nn - 2));
+                            y = x = T(0.75) * s;
+                            wq = T(-0.4375) * s * s;
+                        }
+                        ++its;
+
+                        // Look for two consecutive small subdiagonal elements.
+                        index m = nn - 2;
+                        for (; m >= l; --m) {
+                            z = a(m, m);
+                            r = x - z;
+                            s = y - z;
+                            p = (r * s - wq) / a(m + 1, m) + a(m, m + 1);
+                            q = a(m + 1, m + 1) - z - r - s;
+                            r = a(m + 2, m + 1);
+                            s = abs(p) + abs(q) + abs(r);
+                            p /= s;
+                            q /= s;
+                            r /= s;
+                            if (m == l) {
+                                break;
+                            }
+                            const T u = abs(a(m, m - 1)) * (abs(q) + abs(r));
+                            const T v = abs(p) * (abs(a(m - 1, m - 1)) + abs(z) + abs(a(m + 1, m + 1)));
+                            if (u <= eps * v) {
+                                break;
+                            }
+                        }
+                        for (index i = m + 2; i <= nn; ++i) {
+                            a(i, i - 2) = T(0);
+                            if (i != m + 2) {
+                                a(i, i - 3) = T(0);
+                            }
+                        }
+
+                        // Double QR step on rows l..nn and columns m..nn.
+                        for (index k = m; k <= nn - 1; ++k) {
+                            if (k != m) {
+                                p = a(k, k - 1);
+                                q = a(k + 1, k - 1);
+                                r = (k != nn - 1 ? a(k + 2, k - 1) : T(0));
+                                x = abs(p) + abs(q) + abs(r);
+                                if (x != T(0)) {
+                                    p /= x;
+                                    q /= x;
+                                    r /= x;
+                                }
+                            }
+                            s = sign(std::sqrt(p * p + q * q + r * r), p);
+                            if (s == T(0)) {
+                                continue;
+                            }
+                            if (k == m) {
+                                if (l != m) {
+                                    a(k, k - 1) = -a(k, k - 1);
+                                }
+                            }
+                            else {
+                                a(k, k - 1) = -s * x;
+                            }
+                            p += s;
+                            x = p / s;
+                            y = q / s;
+                            z = r / s;
+                            q /= p;
+                            r /= p;
+                            for (index j = k; j <= nn; ++j) {
+                                p = a(k, j) + q * a(k + 1, j);
+                                if (k != nn - 1) {
+                                    p += r * a(k + 2, j);
+                                    a(k + 2, j) -= p * z;
+                                }
+                                a(k + 1, j) -= p * y;
+                                a(k, j) -= p * x;
+                            }
+                            const index mmin = std::min(nn, k + 3);
+                            for (index i = l; i <= mmin; ++i) {
+                                p = x * a(i, k) + y * a(i, k + 1);
+                                if (k != nn - 1) {
+                                    p += z * a(i, k + 2);
+                                    a(i, k + 2) -= p * r;
+                                }
+                                a(i, k + 1) -= p * q;
+                                a(i, k) -= p;
+                            }
+                        }
+                    }
+                }
+            } while (l < nn - 1);
+        }
+        return w;
+    }
+
+    // Returns ||(h - lambda*I)v|| for the upper Hessenberg matrix h.
+    template <class T>
+    T hessenbergResidual(std::size_t n, const T* h, std::size_t ldh, std::complex<T> lambda,
+                         const std::vector<std::complex<T>>& v) noexcept
+    {
+        T nrm = T(0);
+        for (std::size_t i = 0; i < n; ++i) {
+            std::complex<T> sum = -lambda * v[i];
+            for (std::size_t j = (i > 0 ? i - 1 : 0); j < n; ++j) {
+                sum += h[i + j * ldh] * v[j];
+            }
+            nrm = std::hypot(nrm, std::abs(sum));
+        }
+        return nrm;
+    }
+
+    // Returns a unit eigenvector of h for the eigenvalue lambda by inverse
+    // iteration, and its residual ||(h - lambda*I)v|| in residual. The shifted
+    // Hessenberg matrix is factored by Gaussian elimination with pivoting
+    // between adjacent rows, with tiny pivots replaced by eps*||h|| so that the
+    // (nearly) singular system can still be solved. The iteration continues
+    // until the residual is at the rounding level of h, or stops improving, and
+    // the best vector found is returned. A residual well above eps*||h|| means
+    // that lambda is not an accurate eigenvalue of h (or is ill conditioned).
+    template <class T>
+    std::vector<std::complex<T>> hessenbergInverseIteration(std::size_t n, const T* h, std::size_t ldh,
+                                                            std::complex<T> lambda, T& residual)
+    {
+        using C = std::complex<T>;
+        const T eps = std::numeric_limits<T>::epsilon();
+        const T hnorm = std::max(hessenbergNorm(n, h, ldh), std::numeric_limits<T>::min());
+        const T tiny = eps * hnorm;
+        constexpr int maxIterations = 10;
+
+        std::vector<C> u(n * n, C(0));
+        for (std::size_t j = 0; j < n; ++j) {
+            for (std::size_t i = 0; i <= std::min(j + 1, n - 1); ++i) {
+                u[i + j * n] = C(h[i + j * ldh]);
+            }
+            u[j + j * n] -= lambda;
+        }
+        std::vector<bool> swapped(n, false);
+        std::vector<C> mult(n, C(0));
+        for (std::size_t k = 0; k + 1 < n; ++k) {
+            if (std::abs(u[k + 1 + k * n]) > std::abs(u[k + k * n])) {
+                swapped[k] = true;
+                for (std::size_t j = k; j < n; ++j) {
+                    std::swap(u[k + j * n], u[k + 1 + j * n]);
+                }
+            }
+            if (std::abs(u[k + k * n]) < tiny) {
+                u[k + k * n] = tiny;
+            }
+            mult[k] = u[k + 1 + k * n] / u[k + k * n];
+            for (std::size_t j = k + 1; j < n; ++j) {
+                u[k + 1 + j * n] -= mult[k] * u[k + j * n];
+            }
+        }
+        if (n > 0 && std::abs(u[(n - 1) * (n + 1)]) < tiny) {
+            u[(n - 1) * (n + 1)] = tiny;
+        }
+
+        std::vector<C> v(n, C(1)), best;
+        residual = std::numeric_limits<T>::infinity();
+        for (int iter = 0; iter < maxIterations; ++iter) {
+            for (std::size_t k = 0; k + 1 < n; ++k) {
+                if (swapped[k]) {
+                    std::swap(v[k], v[k + 1]);
+                }
+                v[k + 1] -= mult[k] * v[k];
+            }
+            for (std::size_t i = n; i-- > 0;) {
+                C sum = v[i];
+                for (std::size_t j = i + 1; j < n; ++j) {
+                    sum -= u[i + j * n] * v[j];
+                }
+                v[i] = sum / u[i + i * n];
+            }
+            T nrm = T(0);
+            for (const auto& vi : v) {
+                nrm = std::hypot(nrm, std::abs(vi));
+            }
+            for (auto& vi : v) {
+                vi /= nrm;
+            }
+
+            const T res = hessenbergResidual(n, h, ldh, lambda, v);
+            if (!(res < residual)) {
+                break;
+            }
+            residual = res;
+            best = v;
+            if (res <= T(n) * tiny) {
+                break;
+            }
+        }
+        return best;
+    }
+
+}}}
+
+#endif
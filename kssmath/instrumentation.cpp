@@ -0,0 +1,310 @@
+//
+//  instrumentation.cpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <system_error>
+
+#if defined(__linux__)
+#   include <linux/perf_event.h>
+#   include <sys/syscall.h>
+#   include <unistd.h>
+#   define KSSMATH_PERF_EVENTS 1
+#endif
+
+#include "instrumentation.hpp"
+
+using namespace std;
+using namespace kss::math;
+using kss::math::_private::Kernel;
+using kss::math::_private::KernelScope;
+
+
+namespace {
+
+    atomic<Kernel*> kernels { nullptr };
+    atomic<bool> hardwareEnabled { false };
+
+    constexpr int hardwareEvents = 4;
+
+    uint64_t now() noexcept {
+        using namespace std::chrono;
+        return uint64_t(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+    }
+
+    uint64_t count(double value) noexcept {
+        return (value > 0 ? uint64_t(value + 0.5) : 0);
+    }
+
+#if defined(KSSMATH_PERF_EVENTS)
+
+    // The hardware counters of a thread, opened as a group on the first kernel
+    // call that needs them so that all four are read with a single system call.
+    class PerfGroup {
+    public:
+        PerfGroup() noexcept {
+            fill(_fds, _fds + hardwareEvents, -1);
+        }
+
+        ~PerfGroup() noexcept {
+            for (int fd : _fds) {
+                if (fd >= 0) {
+                    ::close(fd);
+                }
+            }
+        }
+
+        PerfGroup(const PerfGroup&) = delete;
+        PerfGroup& operator=(const PerfGroup&) = delete;
+
+        // Returns 0 if the counters are open, otherwise the error that stopped
+        // them from opening. Opening is only attempted once per thread.
+        int open() noexcept {
+            if (_state == State::Untried) {
+                static const uint64_t configs[hardwareEvents] = {
+                    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                    PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+                };
+                _state = State::Open;
+                for (int i = 0; i < hardwareEvents; ++i) {
+                    perf_event_attr attr;
+                    memset(&attr, 0, sizeof(attr));
+                    attr.size = sizeof(attr);
+                    attr.type = PERF_TYPE_HARDWARE;
+                    attr.config = configs[i];
+                    attr.read_format = PERF_FORMAT_GROUP;
+                    attr.exclude_kernel = 1;
+                    attr.exclude_hv = 1;
+                    _fds[i] = int(syscall(__NR_perf_event_open, &attr, 0, -1, (i == 0 ? -1 : _fds[0]), 0));
+                    if (_fds[i] < 0) {
+                        _error = errno;
+                        _state = State::Failed;
+                        break;
+                    }
+                }
+            }
+            return (_state == State::Open ? 0 : _error);
+        }
+
+        bool read(uint64_t* values) noexcept {
+            struct {
+                uint64_t nr;
+                uint64_t values[hardwareEvents];
+            } data;
+            if (open() != 0 || ::read(_fds[0], &data, sizeof(data)) != ssize_t(sizeof(data))) {
+                return false;
+            }
+            copy(data.values, data.values + hardwareEvents, values);
+            return true;
+        }
+
+    private:
+        enum class State { Untried, Open, Failed };
+
+        int     _fds[hardwareEvents];
+        State   _state = State::Untried;
+        int     _error = 0;
+    };
+
+    thread_local PerfGroup perfGroup;
+
+    int openHardwareCounters() noexcept {
+        return perfGroup.open();
+    }
+
+    bool readHardwareCounters(uint64_t* values) noexcept {
+        return perfGroup.read(values);
+    }
+
+#else
+
+    int openHardwareCounters() noexcept {
+        return ENOTSUP;
+    }
+
+    bool readHardwareCounters(uint64_t*) noexcept {
+        return false;
+    }
+
+#endif
+
+    // Write the report to stderr at exit if instrumentation was enabled by the
+    // environment.
+    void reportAtExit() {
+        writeKernelReport(cerr);
+    }
+
+    // Enable instrumentation when the library is loaded if KSSMATH_INSTRUMENTATION
+    // asks for it. If the hardware counters are not available only the counts and
+    // times are recorded.
+    struct LoadTimeInstrumentation {
+        LoadTimeInstrumentation() noexcept {
+            const char* value = getenv("KSSMATH_INSTRUMENTATION");
+            if (!value || !*value || strcmp(value, "0") == 0) {
+                return;
+            }
+            if (strcmp(value, "hardware") == 0) {
+                const int err = openHardwareCounters();
+                if (err == 0) {
+                    hardwareEnabled = true;
+                }
+                else {
+                    cerr << "kssmath: hardware counters are not available: " << strerror(err) << endl;
+                }
+            }
+            _private::instrumentationEnabled = true;
+            atexit(reportAtExit);
+        }
+    } loadTimeInstrumentation;
+
+}
+
+
+atomic<bool> kss::math::_private::instrumentationEnabled { false };
+
+void kss::math::enableInstrumentation(const InstrumentationOptions& opts) {
+    if (opts.hardwareCounters) {
+        const int err = openHardwareCounters();
+        if (err != 0) {
+            throw system_error(err, system_category(), "perf_event_open");
+        }
+    }
+    hardwareEnabled = opts.hardwareCounters;
+    _private::instrumentationEnabled = true;
+}
+
+void kss::math::disableInstrumentation() noexcept {
+    _private::instrumentationEnabled = false;
+}
+
+bool kss::math::isInstrumentationEnabled() noexcept {
+    return _private::instrumentationEnabled;
+}
+
+vector<KernelStatistics> kss::math::kernelStatistics() {
+    map<string, KernelStatistics> byName;
+    for (const Kernel* k = kernels.load(memory_order_acquire); k; k = k->next) {
+        const uint64_t calls = k->calls.load(memory_order_relaxed);
+        if (calls == 0) {
+            continue;
+        }
+        KernelStatistics& s = byName[k->name];
+        s.name = k->name;
+        s.calls += calls;
+        s.flops += double(k->flops.load(memory_order_relaxed));
+        s.bytes += double(k->bytes.load(memory_order_relaxed));
+        s.seconds += double(k->nanoseconds.load(memory_order_relaxed)) * 1e-9;
+        s.hardware.cycles += k->hardware[0].load(memory_order_relaxed);
+        s.hardware.instructions += k->hardware[1].load(memory_order_relaxed);
+        s.hardware.cacheMisses += k->hardware[2].load(memory_order_relaxed);
+        s.hardware.branchMisses += k->hardware[3].load(memory_order_relaxed);
+    }
+
+    vector<KernelStatistics> stats;
+    stats.reserve(byName.size());
+    for (auto& entry : byName) {
+        stats.push_back(move(entry.second));
+    }
+    stable_sort(stats.begin(), stats.end(), [](const KernelStatistics& a, const KernelStatistics& b) {
+        return a.seconds > b.seconds;
+    });
+    return stats;
+}
+
+void kss::math::resetKernelStatistics() noexcept {
+    for (Kernel* k = kernels.load(memory_order_acquire); k; k = k->next) {
+        k->calls = 0;
+        k->flops = 0;
+        k->bytes = 0;
+        k->nanoseconds = 0;
+        for (auto& h : k->hardware) {
+            h = 0;
+        }
+    }
+}
+
+void kss::math::writeKernelReport(ostream& out) {
+    const auto stats = kernelStatistics();
+    const bool hardware = any_of(stats.begin(), stats.end(), [](const KernelStatistics& s) {
+        return s.hardware.cycles > 0;
+    });
+
+    const auto flags = out.flags();
+    const auto precision = out.precision();
+    out << left << setw(32) << "kernel" << right
+        << setw(12) << "calls" << setw(12) << "seconds" << setw(12) << "us/call"
+        << setw(10) << "GFLOP/s" << setw(10) << "GB/s";
+    if (hardware) {
+        out << setw(8) << "IPC" << setw(14) << "cache misses" << setw(14) << "branch misses";
+    }
+    out << '\n';
+
+    out << fixed;
+    for (const auto& s : stats) {
+        out << left << setw(32) << s.name << right
+            << setw(12) << s.calls
+            << setw(12) << setprecision(4) << s.seconds
+            << setw(12) << setprecision(2) << s.seconds * 1e6 / double(s.calls);
+        // A rate is left out if the kernel does not estimate its operations or
+        // traffic.
+        for (double amount : { s.flops, s.bytes }) {
+            if (amount > 0 && s.seconds > 0) {
+                out << setw(10) << amount / s.seconds * 1e-9;
+            }
+            else {
+                out << setw(10) << "-";
+            }
+        }
+        if (hardware) {
+            const auto& h = s.hardware;
+            out << setw(8) << (h.cycles > 0 ? double(h.instructions) / double(h.cycles) : 0.0)
+                << setw(14) << h.cacheMisses << setw(14) << h.branchMisses;
+        }
+        out << '\n';
+    }
+    out.flush();
+    out.flags(flags);
+    out.precision(precision);
+}
+
+
+kss::math::_private::Kernel::Kernel(const char* name_) noexcept : name(name_) {
+    Kernel* head = kernels.load(memory_order_relaxed);
+    do {
+        next = head;
+    } while (!kernels.compare_exchange_weak(head, this, memory_order_release, memory_order_relaxed));
+}
+
+void kss::math::_private::KernelScope::begin(Kernel& kernel, double flops, double bytes) noexcept {
+    _kernel = &kernel;
+    kernel.calls.fetch_add(1, memory_order_relaxed);
+    kernel.flops.fetch_add(count(flops), memory_order_relaxed);
+    kernel.bytes.fetch_add(count(bytes), memory_order_relaxed);
+    if (hardwareEnabled.load(memory_order_relaxed)) {
+        _hasHardware = readHardwareCounters(_hardware);
+    }
+    _start = now();
+}
+
+void kss::math::_private::KernelScope::end() noexcept {
+    const uint64_t elapsed = now() - _start;
+    _kernel->nanoseconds.fetch_add(elapsed, memory_order_relaxed);
+    uint64_t hardware[hardwareEvents];
+    if (_hasHardware && readHardwareCounters(hardware)) {
+        for (int i = 0; i < hardwareEvents; ++i) {
+            _kernel->hardware[i].fetch_add(hardware[i] - _hardware[i], memory_order_relaxed);
+        }
+    }
+}
@@ -0,0 +1,186 @@
+//
+//  instrumentation.hpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#ifndef kssmath_instrumentation_hpp
+#define kssmath_instrumentation_hpp
+
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace kss { namespace math {
+
+    /*!
+     Per kernel counters for finding which routines of the library dominate the
+     time of a running program without attaching a profiler.
+
+     The entry points of the library (the dispatched float and double BLAS
+     kernels, the dense and sparse factorizations, the sparse products and the
+     iterative solvers) record the number of calls, the floating point
+     operations and bytes of memory traffic of their algorithm (as estimated
+     from the sizes of the arguments, not measured), and the wall time. On Linux
+     they can also read hardware event counters through perf_event.
+
+     Instrumentation is off by default, and then costs each call one relaxed
+     atomic load and a branch. It can be turned on with enableInstrumentation(),
+     or for a whole run by setting the environment variable
+     KSSMATH_INSTRUMENTATION to "1" (counters and times) or "hardware" (also the
+     hardware events), in which case a report is written to stderr at exit.
+     Building with KSSMATH_NO_INSTRUMENTATION defined removes it entirely.
+
+     The times are inclusive: a factorization includes the time of the BLAS
+     kernels it calls, which are also counted under their own names. The
+     hardware events are those of the calling thread only, so work that a kernel
+     hands to other threads is not included in them.
+     */
+    struct InstrumentationOptions {
+        /*!
+         Read the hardware event counters (cycles, instructions, cache misses
+         and branch misses) at the start and end of each kernel. This costs a
+         system call at each, so it suits kernels of microseconds or more.
+         */
+        bool hardwareCounters = false;
+    };
+
+    /*!
+     Start recording. Counts already recorded are kept; use
+     resetKernelStatistics() to start afresh.
+     @throws std::system_error if hardware counters are requested but cannot be
+        opened (for example because they are not supported by the system or are
+        restricted by perf_event_paranoid).
+     */
+    void enableInstrumentation(const InstrumentationOptions& opts = InstrumentationOptions());
+
+    /*!
+     Stop recording. Kernels already running when this is called still record
+     their calls.
+     */
+    void disableInstrumentation() noexcept;
+
+    /*!
+     Returns true if instrumentation is enabled.
+     */
+    bool isInstrumentationEnabled() noexcept;
+
+    /*!
+     Hardware event counts, summed over the calls of a kernel.
+     */
+    struct HardwareCounters {
+        std::uint64_t cycles = 0;
+        std::uint64_t instructions = 0;
+        std::uint64_t cacheMisses = 0;
+        std::uint64_t branchMisses = 0;
+    };
+
+    /*!
+     What has been recorded for a kernel. The BLAS kernels are named in the BLAS
+     style ("blas::dgemm"); the templates are named by class or function and
+     combine their value types.
+     */
+    struct KernelStatistics {
+        std::string         name;
+        std::uint64_t       calls = 0;
+        double              flops = 0;
+        double              bytes = 0;
+        double              seconds = 0;
+        HardwareCounters    hardware;
+    };
+
+    /*!
+     Returns the statistics of the kernels that have been called while
+     instrumentation was enabled, ordered by decreasing time.
+     */
+    std::vector<KernelStatistics> kernelStatistics();
+
+    /*!
+     Sets all counts to zero. Kernels running while this is called may leave
+     part of their counts.
+     */
+    void resetKernelStatistics() noexcept;
+
+    /*!
+     Writes a table of the kernel statistics, one line per kernel ordered by
+     decreasing time, with the rates achieved.
+     */
+    void writeKernelReport(std::ostream& out);
+
+
+    namespace _private {
+
+        extern std::atomic<bool> instrumentationEnabled;
+
+        // The counters of one kernel. Each call site has its own (for templates
+        // one per instantiation) and they are combined by name in the report.
+        // They are linked into a list as they are created, so that creating one
+        // does not allocate.
+        struct Kernel {
+            explicit Kernel(const char* name) noexcept;
+
+            const char*                 name;
+            Kernel*                     next = nullptr;
+            std::atomic<std::uint64_t>  calls { 0 };
+            std::atomic<std::uint64_t>  flops { 0 };
+            std::atomic<std::uint64_t>  bytes { 0 };
+            std::atomic<std::uint64_t>  nanoseconds { 0 };
+            std::atomic<std::uint64_t>  hardware[4] {};
+        };
+
+        // Records a call of a kernel from construction to destruction, if
+        // instrumentation is enabled at construction. The kernel is passed as a
+        // function so that its counters are only created (on the first call)
+        // once they are needed.
+        class KernelScope {
+        public:
+            KernelScope(Kernel& (*kernel)(), double flops, double bytes) noexcept {
+                if (instrumentationEnabled.load(std::memory_order_relaxed)) {
+                    begin(kernel(), flops, bytes);
+                }
+            }
+
+            ~KernelScope() noexcept {
+                if (_kernel) {
+                    end();
+                }
+            }
+
+            KernelScope(const KernelScope&) = delete;
+            KernelScope& operator=(const KernelScope&) = delete;
+
+        private:
+            void begin(Kernel& kernel, double flops, double bytes) noexcept;
+            void end() noexcept;
+
+            Kernel*         _kernel = nullptr;
+            std::uint64_t   _start = 0;
+            std::uint64_t   _hardware[4];
+            bool            _hasHardware = false;
+        };
+
+    }
+
+}}
+
+/*!
+ Records the enclosing scope as a call of the named kernel, with the given
+ operation count and memory traffic. The name must be a string literal.
+ */
+#if defined(KSSMATH_NO_INSTRUMENTATION)
+#   define KSSMATH_INSTRUMENT(NAME, FLOPS, BYTES) ((void)0)
+#else
+#   define KSSMATH_INSTRUMENT(NAME, FLOPS, BYTES)                                                  \
+        ::kss::math::_private::KernelScope kssmathKernelScope_(                                    \
+            []() noexcept -> ::kss::math::_private::Kernel& {                                      \
+                static ::kss::math::_private::Kernel kernel(NAME);                                 \
+                return kernel;                                                                     \
+            }, double(FLOPS), double(BYTES))
+#endif
+
+#endif
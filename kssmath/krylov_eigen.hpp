@@ -0,0 +1,647 @@
+//
+//  krylov_eigen.hpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#ifndef kssmath_krylov_eigen_hpp
+#define kssmath_krylov_eigen_hpp
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "blas.hpp"
+#include "hessenberg_eigen.hpp"
+#include "linear_operator.hpp"
+#include "matrix.hpp"
+#include "parallel.hpp"
+#include "qr.hpp"
+#include "random.hpp"
+#include "symmetric_eigen.hpp"
+
+namespace kss { namespace math {
+
+    /*!
+     Options for LanczosEigen.
+     */
+    struct LanczosOptions {
+        /*!
+         The number of eigenpairs to compute, taken from the end of the spectrum
+         given by which.
+         */
+        std::size_t count = 6;
+        Which which = Which::Largest;
+
+        /*!
+         The maximum dimension of the Krylov basis. Larger bases need fewer restarts
+         but more memory (one vector of the operator size per basis vector). A value
+         of 0 uses max(2*count + 1, 20).
+         */
+        std::size_t basisSize = 0;
+
+        /*!
+         A Ritz pair (theta, x) is accepted once ||Ax - theta*x|| <= tolerance*|theta|,
+         or the residual is at the rounding level of the projected matrix
+         (basisSize*eps times its norm), below which it cannot be reduced. A value
+         of 0 uses machine epsilon.
+         */
+        double tolerance = 0.0;
+
+        std::size_t maxRestarts = 1000;
+
+        /*!
+         Seed for the random starting vector.
+         */
+        std::uint64_t seed = 0x6b73736d617468ull;
+
+        /*!
+         The number of threads used for the vector operations on the basis. The
+         operator itself is responsible for its own parallelism.
+         */
+        unsigned threads = 0;
+    };
+
+    /*!
+     Selects which eigenvalues ArnoldiEigen computes.
+     */
+    enum class ArnoldiWhich {
+        LargestMagnitude,
+        SmallestMagnitude,
+        LargestReal,
+        SmallestReal
+    };
+
+    /*!
+     Options for ArnoldiEigen. The fields other than which have the same meaning
+     as for LanczosOptions.
+     */
+    struct ArnoldiOptions {
+        std::size_t     count = 6;
+        ArnoldiWhich    which = ArnoldiWhich::LargestMagnitude;
+        std::size_t     basisSize = 0;
+        double          tolerance = 0.0;
+        std::size_t     maxRestarts = 1000;
+        std::uint64_t   seed = 0x6b73736d617468ull;
+        unsigned        threads = 0;
+    };
+
+    namespace _private {
+
+        // Rows per chunk for the parallel vector operations. The partial results
+        // are combined in chunk order, so the results do not depend on the number
+        // of threads.
+        constexpr std::size_t krylovChunk = 16384;
+
+        // Returns ||x|| computed in parallel.
+        template <class T>
+        T parallelNorm(std::size_t n, const T* x, unsigned threads) {
+            const std::size_t chunks = (n + krylovChunk - 1) / krylovChunk;
+            std::vector<T> partial(chunks, T(0));
+            parallelFor(n, krylovChunk, [&](std::size_t r0, std::size_t r1) {
+                partial[r0 / krylovChunk] = blas::nrm2(r1 - r0, x + r0);
+            }, threads);
+            return blas::nrm2(chunks, partial.data());
+        }
+
+        // Orthogonalize w against the k orthonormal columns of v using classical
+        // Gram-Schmidt applied twice, which keeps the basis orthogonal to working
+        // precision. The projection coefficients are added to h.
+        template <class T>
+        void orthogonalize(std::size_t n, std::size_t k, const T* v, std::size_t ldv,
+                           T* w, T* h, unsigned threads)
+        {
+            if (k == 0) {
+                return;
+            }
+            const std::size_t chunks = (n + krylovChunk - 1) / krylovChunk;
+            Matrix<T> partial(k, chunks);
+            std::vector<T> c(k);
+            for (int pass = 0; pass < 2; ++pass) {
+                parallelFor(n, krylovChunk, [&](std::size_t r0, std::size_t r1) {
+                    blas::gemvTranspose(r1 - r0, k, T(1), v + r0, ldv, w + r0, T(0),
+                                        partial.column(r0 / krylovChunk));
+                }, threads);
+                std::fill(c.begin(), c.end(), T(0));
+                for (std::size_t ch = 0; ch < chunks; ++ch) {
+                    blas::axpy(k, T(1), partial.column(ch), c.data());
+                }
+                parallelFor(n, krylovChunk, [&](std::size_t r0, std::size_t r1) {
+                    blas::gemv(r1 - r0, k, T(-1), v + r0, ldv, c.data(), T(1), w + r0);
+                }, threads);
+                blas::axpy(k, T(1), c.data(), h);
+            }
+        }
+
+        // Computes the first k columns of v*q, where v is n x m and q is m x k,
+        // overwriting the first k columns of v.
+        template <class T>
+        void rotateBasis(std::size_t n, std::size_t m, std::size_t k, T* v, std::size_t ldv,
+                         const T* q, std::size_t ldq, unsigned threads)
+        {
+            parallelFor(n, 1024, [&](std::size_t r0, std::size_t r1) {
+                Matrix<T> tmp(r1 - r0, k);
+                blas::gemm(blas::Op::NoTrans, blas::Op::NoTrans, r1 - r0, k, m, T(1), v + r0, ldv,
+                           q, ldq, T(0), tmp.data(), r1 - r0);
+                for (std::size_t j = 0; j < k; ++j) {
+                    std::copy(tmp.column(j), tmp.column(j) + (r1 - r0), v + r0 + j * ldv);
+                }
+            }, threads);
+        }
+
+        // Fills column j of v with a random unit vector orthogonal to the previous
+        // columns. Returns false if that is impossible (the basis spans everything).
+        template <class T>
+        bool randomBasisVector(std::size_t n, std::size_t j, T* v, std::size_t ldv,
+                               NormalGenerator<T>& gen, unsigned threads)
+        {
+            if (j >= n) {
+                return false;
+            }
+            T* w = v + j * ldv;
+            std::vector<T> h(j, T(0));
+            for (int attempt = 0; attempt < 3; ++attempt) {
+                for (std::size_t i = 0; i < n; ++i) {
+                    w[i] = gen();
+                }
+                const T before = parallelNorm(n, w, threads);
+                orthogonalize(n, j, v, ldv, w, h.data(), threads);
+                const T nrm = parallelNorm(n, w, threads);
+                if (nrm > T(0.01) * before) {
+                    blas::scal(n, T(1) / nrm, w);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Extend the Krylov factorization A*V(:, 0:j) = V(:, 0:j+1)*H from column
+        // k to column m. Column j of h receives the projection coefficients of
+        // A*v_j, and the norm of the new residual is returned (0 if the Krylov space
+        // became invariant and no new direction could be found).
+        template <class T>
+        T extendKrylov(std::size_t n, std::size_t k, std::size_t m, const LinearOperator<T>& op,
+                       Matrix<T>& v, Matrix<T>& h, NormalGenerator<T>& gen, unsigned threads,
+                       std::size_t& applications)
+        {
+            const T eps = std::numeric_limits<T>::epsilon();
+            T beta = T(0);
+            for (std::size_t j = k; j < m; ++j) {
+                T* w = v.column(j + 1);
+                op(v.column(j), w);
+                ++applications;
+                T* hj = h.column(j);
+                std::fill(hj, hj + h.rows(), T(0));
+                const T before = parallelNorm(n, w, threads);
+                orthogonalize(n, j + 1, v.data(), n, w, hj, threads);
+                beta = parallelNorm(n, w, threads);
+                if (beta <= eps * before || beta == T(0)) {
+                    beta = T(0);
+                    if (!randomBasisVector(n, j + 1, v.data(), n, gen, threads)) {
+                        std::fill(w, w + n, T(0));
+                    }
+                }
+                else {
+                    blas::scal(n, T(1) / beta, w);
+                }
+                if (j + 1 < h.rows()) {
+                    hj[j + 1] = beta;
+                }
+            }
+            return beta;
+        }
+
+        // Default Krylov basis size for count eigenpairs of an n x n operator.
+        inline std::size_t krylovBasisSize(std::size_t n, std::size_t count, std::size_t requested) {
+            std::size_t m = (requested == 0 ? std::max<std::size_t>(2 * count + 1, 20) : requested);
+            m = std::max(m, count + 1);
+            return std::min(m, n);
+        }
+
+    }
+
+    /*!
+     A few extreme eigenpairs of a large symmetric operator by the thick restarted
+     Lanczos method, which is mathematically equivalent to implicitly restarted
+     Lanczos with exact shifts. The basis is kept fully orthogonal, so the method
+     is robust for clustered eigenvalues, and only the operator-vector products
+     touch the matrix.
+
+     The computed eigenvalues are in ascending order with the eigenvectors as the
+     corresponding columns of eigenvectors(). If the iteration did not converge
+     within the allowed number of restarts the best approximations are returned
+     and converged() is false.
+     */
+    template <class T>
+    class LanczosEigen {
+    public:
+        using size_type = std::size_t;
+
+        /*!
+         Compute the eigenpairs of the n x n symmetric operator op.
+         @throws std::invalid_argument if count is 0 or larger than n.
+         */
+        LanczosEigen(size_type n, const LinearOperator<T>& op, const LanczosOptions& opts = LanczosOptions()) {
+            if (opts.count == 0 || opts.count > n) {
+                throw std::invalid_argument("LanczosEigen: count must be in [1, n]");
+            }
+            const size_type nev = opts.count;
+            const size_type m = _private::krylovBasisSize(n, nev, opts.basisSize);
+            const T tol = (opts.tolerance > 0 ? T(opts.tolerance) : std::numeric_limits<T>::epsilon());
+            const T eps23 = std::pow(std::numeric_limits<T>::epsilon(), T(2) / T(3));
+            const unsigned threads = opts.threads;
+
+            Matrix<T> v(n, m + 1);
+            Matrix<T> h(m, m);
+            _private::NormalGenerator<T> gen(opts.seed);
+            _private::randomBasisVector(n, 0, v.data(), n, gen, threads);
+
+            size_type k = 0;
+            for (;; ++_restarts) {
+                const T beta = _private::extendKrylov(n, k, m, op, v, h, gen, threads, _applications);
+                for (size_type j = 0; j < m; ++j) {
+                    for (size_type i = j + 1; i < m; ++i) {
+                        h(i, j) = h(j, i);
+                    }
+                }
+
+                SymmetricEigenOptions eopts;
+                eopts.blocking.threads = 1;
+                SymmetricEigen<T> ritz(h, eopts);
+                const auto& theta = ritz.eigenvalues();
+                const Matrix<T>& s = ritz.eigenvectors();
+
+                // Ritz values ordered from most to least wanted.
+                std::vector<size_type> order(m);
+                std::iota(order.begin(), order.end(), size_type(0));
+                if (opts.which == Which::Largest) {
+                    std::reverse(order.begin(), order.end());
+                }
+                const T roundoff = T(m) * std::numeric_limits<T>::epsilon()
+                    * std::max(std::abs(theta.front()), std::abs(theta.back()));
+                size_type nconv = 0;
+                for (size_type i = 0; i < nev; ++i) {
+                    const size_type idx = order[i];
+                    const T accept = std::max(tol * std::max(eps23, std::abs(theta[idx])), roundoff);
+                    if (std::abs(beta * s(m - 1, idx)) <= accept) {
+                        ++nconv;
+                    }
+                }
+
+                if (nconv == nev || _restarts >= opts.maxRestarts || m == n) {
+                    _converged = (nconv == nev || beta == T(0));
+                    std::vector<size_type> wanted(order.begin(), order.begin() + long(nev));
+                    std::sort(wanted.begin(), wanted.end());
+                    Matrix<T> sw(m, nev);
+                    _values.resize(nev);
+                    for (size_type i = 0; i < nev; ++i) {
+                        _values[i] = theta[wanted[i]];
+                        std::copy(s.column(wanted[i]), s.column(wanted[i]) + m, sw.column(i));
+                    }
+                    _private::rotateBasis(n, m, nev, v.data(), n, sw.data(), m, threads);
+                    _vectors = Matrix<T>(n, nev);
+                    std::copy(v.data(), v.data() + n * nev, _vectors.data());
+                    return;
+                }
+
+                // Thick restart: keep the most wanted Ritz vectors (plus some extra
+                // once some have converged, to speed up the rest) and continue the
+                // factorization from the residual vector.
+                k = nev + std::min(nconv, (m - nev) / 2);
+                Matrix<T> sk(m, k);
+                for (size_type i = 0; i < k; ++i) {
+                    std::copy(s.column(order[i]), s.column(order[i]) + m, sk.column(i));
+                }
+                _private::rotateBasis(n, m, k, v.data(), n, sk.data(), m, threads);
+                std::copy(v.column(m), v.column(m) + n, v.column(k));
+                h = Matrix<T>(m, m);
+                for (size_type i = 0; i < k; ++i) {
+                    h(i, i) = theta[order[i]];
+                }
+            }
+        }
+
+        /*!
+         Returns the computed eigenvalues in ascending order.
+         */
+        const std::vector<T>& eigenvalues() const noexcept { return _values; }
+
+        /*!
+         Returns the eigenvectors, one per column, in the same order as the
+         eigenvalues.
+         */
+        const Matrix<T>& eigenvectors() const noexcept { return _vectors; }
+
+        /*!
+         Returns true if all the requested eigenpairs met the tolerance.
+         */
+        bool converged() const noexcept { return _converged; }
+
+        size_type restarts() const noexcept { return _restarts; }
+        size_type operatorApplications() const noexcept { return _applications; }
+
+    private:
+        std::vector<T> _values;
+        Matrix<T>       _vectors;
+        bool            _converged = false;
+        size_type       _restarts = 0;
+        size_type       _applications = 0;
+    };
+
+    /*!
+     A few eigenpairs of a large non-symmetric operator by the implicitly restarted
+     Arnoldi method. Each restart applies the unwanted Ritz values as exact shifts
+     (complex conjugate pairs as a real double shift), compressing the Krylov
+     factorization onto the wanted part of the spectrum. Exact shifts can be
+     forward unstable; when they would perturb the factorization by more than
+     rounding error the restart is done explicitly instead.
+
+     The eigenvalues are returned from most to least wanted according to which,
+     with the (complex) eigenvectors as the corresponding columns of
+     eigenvectors(). If the iteration did not converge within the allowed number
+     of restarts the best approximations are returned and converged() is false.
+     */
+    template <class T>
+    class ArnoldiEigen {
+    public:
+        using size_type = std::size_t;
+        using complex_type = std::complex<T>;
+
+        /*!
+         Compute the eigenpairs of the n x n operator op.
+         @throws std::invalid_argument if count is 0 or larger than n.
+         */
+        ArnoldiEigen(size_type n, const LinearOperator<T>& op, const ArnoldiOptions& opts = ArnoldiOptions()) {
+            if (opts.count == 0 || opts.count > n) {
+                throw std::invalid_argument("ArnoldiEigen: count must be in [1, n]");
+            }
+            const size_type nev = opts.count;
+            const size_type m = _private::krylovBasisSize(n, nev + 1, opts.basisSize);
+            const T tol = (opts.tolerance > 0 ? T(opts.tolerance) : std::numeric_limits<T>::epsilon());
+            const T eps23 = std::pow(std::numeric_limits<T>::epsilon(), T(2) / T(3));
+            const unsigned threads = opts.threads;
+
+            Matrix<T> v(n, m + 1);
+            Matrix<T> h(m, m);
+            _private::NormalGenerator<T> gen(opts.seed);
+            _private::randomBasisVector(n, 0, v.data(), n, gen, threads);
+
+            size_type k = 0;
+            T drift = T(0);
+            for (;; ++_restarts) {
+                const T beta = _private::extendKrylov(n, k, m, op, v, h, gen, threads, _applications);
+
+                Matrix<T> work = h;
+                std::vector<complex_type> ritz = _private::hessenbergEigenvalues(m, work.data(), m);
+                std::vector<size_type> order = sortRitzValues(ritz, opts.which);
+
+                // The residual of the Ritz pair (theta, V*y) is V*(H*y - theta*y) +
+                // beta*y[m-1]*v_m, plus the drift of the Arnoldi relation over the
+                // restarts, so the usual estimate beta*|y[m-1]| is only valid once y
+                // is an eigenvector of H to working precision.
+                std::vector<std::vector<complex_type>> y(nev);
+                const T hroundoff = T(m) * std::numeric_limits<T>::epsilon() * _private::hessenbergNorm(m, h.data(), m);
+                size_type nconv = 0;
+                for (size_type i = 0; i < nev; ++i) {
+                    const complex_type theta = ritz[order[i]];
+                    T hres = T(0);
+                    y[i] = _private::hessenbergInverseIteration(m, h.data(), m, theta, hres);
+                    const T accept = std::max(tol * std::max(eps23, std::abs(theta)), hroundoff);
+                    if (hres <= hroundoff && beta * std::abs(y[i][m - 1]) <= accept) {
+                        ++nconv;
+                    }
+                }
+
+                if (nconv == nev || _restarts >= opts.maxRestarts || m == n) {
+                    _converged = (nconv == nev || beta == T(0));
+                    finish(n, m, v, ritz, order, y, threads);
+                    return;
+                }
+
+                // Keep the wanted part, without splitting a complex conjugate pair.
+                k = nev + std::min(nconv, (m - nev) / 2);
+                if (k < m && splitsPair(ritz, order, k)) {
+                    k = (k + 1 < m ? k + 1 : k - 1);
+                }
+
+                // Apply the unwanted Ritz values as shifts: H := Q'HQ. H is not
+                // forced back to Hessenberg form between shifts, so that it stays
+                // similar to the original.
+                Matrix<T> q = Matrix<T>::identity(m);
+                for (size_type i = k; i < m; ++i) {
+                    const complex_type mu = ritz[order[i]];
+                    if (mu.imag() < T(0) && i > k && ritz[order[i - 1]] == std::conj(mu)) {
+                        continue;
+                    }
+                    Matrix<T> shifted = shiftedPolynomial(h, mu);
+                    QR<T> qr(std::move(shifted));
+                    const Matrix<T> qi = qr.Q();
+                    h = multiply(multiply(qi, h, true), qi, false);
+                    q = multiply(q, qi, false);
+                }
+
+                // Truncating to k columns discards the entries of H below the
+                // subdiagonal in its first k-1 columns and the first k-1 entries of
+                // the last row of Q, which vanish in exact arithmetic. Exact shifts
+                // can be forward unstable, leaving them far above the rounding
+                // level, and dropping them would break the Arnoldi relation (and
+                // with it the residual estimates). Once the accumulated drift
+                // would pass the rounding level of H the iteration instead
+                // restarts explicitly, from the sum of the wanted Ritz vectors.
+                T dropped = T(0);
+                for (size_type j = 0; j + 1 < k; ++j) {
+                    for (size_type r = j + 2; r < m; ++r) {
+                        dropped = std::hypot(dropped, h(r, j));
+                    }
+                    dropped = std::hypot(dropped, beta * q(m - 1, j));
+                }
+                if (drift + dropped > hroundoff) {
+                    std::vector<T> c(m, T(0));
+                    for (size_type i = 0; i < nev; ++i) {
+                        for (size_type j = 0; j < m; ++j) {
+                            c[j] += y[i][j].real() + y[i][j].imag();
+                        }
+                    }
+                    _private::rotateBasis(n, m, 1, v.data(), n, c.data(), m, threads);
+                    const T nrm = _private::parallelNorm(n, v.data(), threads);
+                    if (nrm > T(0)) {
+                        blas::scal(n, T(1) / nrm, v.data());
+                    }
+                    else {
+                        _private::randomBasisVector(n, 0, v.data(), n, gen, threads);
+                    }
+                    h = Matrix<T>(m, m);
+                    k = 0;
+                    drift = T(0);
+                    continue;
+                }
+                drift += dropped;
+
+                // The new residual is V*Q(:, k:m-1)*H(k:m-1, k-1) + beta*Q(m-1, k-1)*v_m.
+                std::vector<T> qk(m, T(0));
+                blas::gemv(m, m - k, T(1), q.column(k), m, h.column(k - 1) + k, T(0), qk.data());
+                const T sigma = beta * q(m - 1, k - 1);
+                std::vector<T> f(v.column(m), v.column(m) + n);
+                blas::scal(n, sigma, f.data());
+                parallelFor(n, 1024, [&](std::size_t r0, std::size_t r1) {
+                    blas::gemv(r1 - r0, m, T(1), v.data() + r0, n, qk.data(), T(1), f.data() + r0);
+                }, threads);
+                _private::rotateBasis(n, m, k, v.data(), n, q.data(), m, threads);
+                std::vector<T> hcol(k, T(0));
+                _private::orthogonalize(n, k, v.data(), n, f.data(), hcol.data(), threads);
+                const T fnorm = _private::parallelNorm(n, f.data(), threads);
+
+                Matrix<T> hk1(m, m);
+                for (size_type j = 0; j < k; ++j) {
+                    std::copy(h.column(j), h.column(j) + std::min(j + 2, k), hk1.column(j));
+                }
+                blas::axpy(k, T(1), hcol.data(), hk1.column(k - 1));
+                h = std::move(hk1);
+                if (fnorm == T(0)) {
+                    if (!_private::randomBasisVector(n, k, v.data(), n, gen, threads)) {
+                        std::fill(v.column(k), v.column(k) + n, T(0));
+                    }
+                }
+                else {
+                    h(k, k - 1) = fnorm;
+                    blas::scal(n, T(1) / fnorm, f.data());
+                    std::copy(f.begin(), f.end(), v.column(k));
+                }
+            }
+        }
+
+        /*!
+         Returns the computed eigenvalues, from most to least wanted.
+         */
+        const std::vector<complex_type>& eigenvalues() const noexcept { return _values; }
+
+        /*!
+         Returns the unit eigenvectors, one per column, in the same order as the
+         eigenvalues.
+         */
+        const Matrix<complex_type>& eigenvectors() const noexcept { return _vectors; }
+
+        /*!
+         Returns true if all the requested eigenpairs met the tolerance.
+         */
+        bool converged() const noexcept { return _converged; }
+
+        size_type restarts() const noexcept { return _restarts; }
+        size_type operatorApplications() const noexcept { return _applications; }
+
+    private:
+        std::vector<complex_type>   _values;
+        Matrix<complex_type>        _vectors;
+        bool                        _converged = false;
+        size_type                   _restarts = 0;
+        size_type                   _applications = 0;
+
+        static std::vector<size_type> sortRitzValues(const std::vector<complex_type>& ritz, ArnoldiWhich which) {
+            std::vector<size_type> order(ritz.size());
+            std::iota(order.begin(), order.end(), size_type(0));
+            auto key = [which](const complex_type& z) -> T {
+                switch (which) {
+                    case ArnoldiWhich::LargestMagnitude:    return std::abs(z);
+                    case ArnoldiWhich::SmallestMagnitude:   return -std::abs(z);
+                    case ArnoldiWhich::LargestReal:         return z.real();
+                    case ArnoldiWhich::SmallestReal:        return -z.real();
+                }
+                return T(0);
+            };
+            // Ties (conjugate pairs) are broken by putting the positive imaginary
+            // part first, so that pairs stay adjacent.
+            std::stable_sort(order.begin(), order.end(), [&](size_type a, size_type b) {
+                const T ka = key(ritz[a]);
+                const T kb = key(ritz[b]);
+                if (ka != kb) {
+                    return ka > kb;
+                }
+                return ritz[a].imag() > ritz[b].imag();
+            });
+            return order;
+        }
+
+        // True if keeping the first k values of order would separate a complex
+        // conjugate pair.
+        static bool splitsPair(const std::vector<complex_type>& ritz, const std::vector<size_type>& order,
+                               size_type k) noexcept
+        {
+            const complex_type last = ritz[order[k - 1]];
+            return last.imag() != T(0) && ritz[order[k]] == std::conj(last);
+        }
+
+        // Returns H - mu*I for a real shift, or (H - mu*I)(H - conj(mu)*I) for a
+        // complex one, which is real.
+        static Matrix<T> shiftedPolynomial(const Matrix<T>& h, complex_type mu) {
+            const size_type m = h.rows();
+            if (mu.imag() == T(0)) {
+                Matrix<T> res = h;
+                for (size_type i = 0; i < m; ++i) {
+                    res(i, i) -= mu.real();
+                }
+                return res;
+            }
+            Matrix<T> res = multiply(h, h, false);
+            const T tr = T(2) * mu.real();
+            const T det = std::norm(mu);
+            for (size_type j = 0; j < m; ++j) {
+                blas::axpy(m, -tr, h.column(j), res.column(j));
+                res(j, j) += det;
+            }
+            return res;
+        }
+
+        // Returns op(a)*b for small square matrices.
+        static Matrix<T> multiply(const Matrix<T>& a, const Matrix<T>& b, bool transposeA) {
+            const size_type m = a.rows();
+            Matrix<T> c(m, m);
+            blas::gemm(transposeA ? blas::Op::Trans : blas::Op::NoTrans, blas::Op::NoTrans, m, m, m,
+                       T(1), a.data(), m, b.data(), m, T(0), c.data(), m);
+            return c;
+        }
+
+        // Form the Ritz vectors V*y for the wanted Ritz values.
+        void finish(size_type n, size_type m, const Matrix<T>& v, const std::vector<complex_type>& ritz,
+                    const std::vector<size_type>& order, const std::vector<std::vector<complex_type>>& y,
+                    unsigned threads)
+        {
+            const size_type nev = y.size();
+            _values.resize(nev);
+            _vectors = Matrix<complex_type>(n, nev);
+            Matrix<T> yr(m, nev), yi(m, nev);
+            for (size_type i = 0; i < nev; ++i) {
+                _values[i] = ritz[order[i]];
+                for (size_type j = 0; j < m; ++j) {
+                    yr(j, i) = y[i][j].real();
+                    yi(j, i) = y[i][j].imag();
+                }
+            }
+            parallelFor(n, 1024, [&](std::size_t r0, std::size_t r1) {
+                const size_type rows = r1 - r0;
+                Matrix<T> xr(rows, nev), xi(rows, nev);
+                blas::gemm(blas::Op::NoTrans, blas::Op::NoTrans, rows, nev, m, T(1), v.data() + r0, n,
+                           yr.data(), m, T(0), xr.data(), rows);
+                blas::gemm(blas::Op::NoTrans, blas::Op::NoTrans, rows, nev, m, T(1), v.data() + r0, n,
+                           yi.data(), m, T(0), xi.data(), rows);
+                for (size_type j = 0; j < nev; ++j) {
+                    for (size_type r = 0; r < rows; ++r) {
+                        _vectors(r0 + r, j) = complex_type(xr(r, j), xi(r, j));
+                    }
+                }
+            }, threads);
+        }
+    };
+
+}}
+
+#endif
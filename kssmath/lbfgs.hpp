@@ -0,0 +1,528 @@
+//
+//  lbfgs.hpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#ifndef kssmath_lbfgs_hpp
+#define kssmath_lbfgs_hpp
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "blas.hpp"
+#include "instrumentation.hpp"
+#include "workspace.hpp"
+
+namespace kss { namespace math {
+
+    /*!
+     Options for lbfgs and lbfgsb.
+     */
+    struct LbfgsOptions {
+        /*!
+         The number of correction pairs kept to approximate the inverse Hessian
+         (m). 3 to 20 is usual; more costs 4mn operations per iteration.
+         */
+        std::size_t history = 6;
+
+        /*!
+         The iteration stops once the largest component of the projected
+         gradient is at most gradientTolerance, or once an iteration reduces the
+         objective by at most functionTolerance*max(|f|, 1).
+         */
+        double      gradientTolerance = 1e-5;
+        double      functionTolerance = 1e-10;
+        std::size_t maxIterations = 1000;
+
+        /*!
+         The parameters of the More-Thuente line search: the sufficient decrease
+         (ftol) and curvature (gtol) constants of the strong Wolfe conditions,
+         and the most objective evaluations per iteration.
+         */
+        double      sufficientDecrease = 1e-4;
+        double      curvature = 0.9;
+        std::size_t maxLineSearchEvaluations = 20;
+
+        /*!
+         If given, the history and work vectors are taken from this workspace
+         rather than the heap, so that repeated optimizations do not allocate at
+         all. It must not be used by another thread during the optimization.
+         */
+        Workspace*  workspace = nullptr;
+    };
+
+    /*!
+     The result of lbfgs and lbfgsb. The minimizer is returned in x.
+     */
+    template <class T>
+    struct LbfgsResult {
+        T           value = T(0);           ///< The objective at x.
+        T           gradientNorm = T(0);    ///< The largest component of the projected gradient at x.
+        std::size_t iterations = 0;
+        std::size_t evaluations = 0;        ///< The number of calls of the objective.
+        bool        converged = false;      ///< True if a tolerance was met.
+    };
+
+    namespace _private {
+
+        // One step of the More-Thuente line search (dcstep of MINPACK-2): update
+        // the interval [stx, sty] that contains a step satisfying the Wolfe
+        // conditions, given the function value fp and derivative dp at the trial
+        // step stp, and set stp to the next trial step, by cubic or quadratic
+        // interpolation safeguarded to [stpmin, stpmax].
+        template <class T>
+        void moreThuenteStep(T& stx, T& fx, T& dx, T& sty, T& fy, T& dy, T& stp, T fp, T dp,
+                             bool& bracketed, T stpmin, T stpmax) noexcept
+        {
+            const T sgnd = dp * (dx / std::abs(dx));
+            T stpf;
+            if (fp > fx) {
+                // A higher function value: the minimum is bracketed. Take the
+                // cubic step if it is closer to stx, else the average of it and
+                // the quadratic step.
+                const T theta = T(3) * (fx - fp) / (stp - stx) + dx + dp;
+                const T s = std::max(std::abs(theta), std::max(std::abs(dx), std::abs(dp)));
+                T gamma = s * std::sqrt((theta / s) * (theta / s) - (dx / s) * (dp / s));
+                if (stp < stx) {
+                    gamma = -gamma;
+                }
+                const T p = (gamma - dx) + theta;
+                const T q = ((gamma - dx) + gamma) + dp;
+                const T stpc = stx + (p / q) * (stp - stx);
+                const T stpq = stx + ((dx / ((fx - fp) / (stp - stx) + dx)) / T(2)) * (stp - stx);
+                stpf = (std::abs(stpc - stx) < std::abs(stpq - stx) ? stpc : stpc + (stpq - stpc) / T(2));
+                bracketed = true;
+            }
+            else if (sgnd < T(0)) {
+                // The derivatives have opposite signs: the minimum is bracketed.
+                // Take whichever of the cubic and secant steps is farther from stp.
+                const T theta = T(3) * (fx - fp) / (stp - stx) + dx + dp;
+                const T s = std::max(std::abs(theta), std::max(std::abs(dx), std::abs(dp)));
+                T gamma = s * std::sqrt((theta / s) * (theta / s) - (dx / s) * (dp / s));
+                if (stp > stx) {
+                    gamma = -gamma;
+                }
+                const T p = (gamma - dp) + theta;
+                const T q = ((gamma - dp) + gamma) + dx;
+                const T stpc = stp + (p / q) * (stx - stp);
+                const T stpq = stp + (dp / (dp - dx)) * (stx - stp);
+                stpf = (std::abs(stpc - stp) > std::abs(stpq - stp) ? stpc : stpq);
+                bracketed = true;
+            }
+            else if (std::abs(dp) < std::abs(dx)) {
+                // The derivative decreases in magnitude. The cubic step is only
+                // used if it tends to infinity in the direction of the step or
+                // its minimum is beyond stp.
+                const T theta = T(3) * (fx - fp) / (stp - stx) + dx + dp;
+                const T s = std::max(std::abs(theta), std::max(std::abs(dx), std::abs(dp)));
+                T gamma = s * std::sqrt(std::max(T(0), (theta / s) * (theta / s) - (dx / s) * (dp / s)));
+                if (stp > stx) {
+                    gamma = -gamma;
+                }
+                const T p = (gamma - dp) + theta;
+                const T q = (gamma + (dx - dp)) + gamma;
+                const T r = p / q;
+                T stpc;
+                if (r < T(0) && gamma != T(0)) {
+                    stpc = stp + r * (stx - stp);
+                }
+                else {
+                    stpc = (stp > stx ? stpmax : stpmin);
+                }
+                const T stpq = stp + (dp / (dp - dx)) * (stx - stp);
+                if (bracketed) {
+                    stpf = (std::abs(stpc - stp) < std::abs(stpq - stp) ? stpc : stpq);
+                    if (stp > stx) {
+                        stpf = std::min(stp + T(0.66) * (sty - stp), stpf);
+                    }
+                    else {
+                        stpf = std::max(stp + T(0.66) * (sty - stp), stpf);
+                    }
+                }
+                else {
+                    stpf = (std::abs(stpc - stp) > std::abs(stpq - stp) ? stpc : stpq);
+                    stpf = std::max(stpmin, std::min(stpmax, stpf));
+                }
+            }
+            else {
+                // The derivative does not decrease in magnitude: take the cubic
+                // step to sty if the minimum is bracketed, else a limit.
+                if (bracketed) {
+                    const T theta = T(3) * (fp - fy) / (sty - stp) + dy + dp;
+                    const T s = std::max(std::abs(theta), std::max(std::abs(dy), std::abs(dp)));
+                    T gamma = s * std::sqrt((theta / s) * (theta / s) - (dy / s) * (dp / s));
+                    if (stp > sty) {
+                        gamma = -gamma;
+                    }
+                    const T p = (gamma - dp) + theta;
+                    const T q = ((gamma - dp) + gamma) + dy;
+                    stpf = stp + (p / q) * (sty - stp);
+                }
+                else {
+                    stpf = (stp > stx ? stpmax : stpmin);
+                }
+            }
+
+            if (fp > fx) {
+                sty = stp;
+                fy = fp;
+                dy = dp;
+            }
+            else {
+                if (sgnd < T(0)) {
+                    sty = stx;
+                    fy = fx;
+                    dy = dx;
+                }
+                stx = stp;
+                fx = fp;
+                dx = dp;
+            }
+            stp = stpf;
+        }
+
+        // The More-Thuente line search (dcsrch of MINPACK-2) for a step in
+        // (0, stpmax] satisfying the strong Wolfe conditions, starting from stp.
+        // phi(stp, f, g) evaluates the objective along the search direction,
+        // setting f and its derivative g. f0 and g0 < 0 are their values at 0.
+        // Returns true with phi last evaluated at the step found, or false if no
+        // step decreased the objective.
+        template <class T, class Phi>
+        bool moreThuente(Phi&& phi, T f0, T g0, T& stp, T stpmax, const LbfgsOptions& opts,
+                         std::size_t& evaluations)
+        {
+            const T ftol = T(opts.sufficientDecrease);
+            const T gtol = T(opts.curvature);
+            const T xtol = std::numeric_limits<T>::epsilon();
+            const T gtest = ftol * g0;
+
+            bool bracketed = false;
+            bool stage1 = true;
+            T width = stpmax;
+            T width1 = T(2) * width;
+            T stx = T(0), fx = f0, gx = g0;
+            T sty = T(0), fy = f0, gy = g0;
+            T stmin = T(0), stmax = stp + T(4) * stp;
+            T f = f0, g = g0;
+            T evaluated = T(0);
+
+            for (std::size_t k = 0; k < std::max<std::size_t>(opts.maxLineSearchEvaluations, 1); ++k) {
+                phi(stp, f, g);
+                ++evaluations;
+                evaluated = stp;
+                if (!std::isfinite(f) || !std::isfinite(g)) {
+                    // Outside the domain of the objective: step back towards
+                    // the best point.
+                    stmax = stp;
+                    stp = stx + T(0.5) * (stp - stx);
+                    continue;
+                }
+
+                const T ftest = f0 + stp * gtest;
+                if (stage1 && f <= ftest && g >= T(0)) {
+                    stage1 = false;
+                }
+                if (f <= ftest && std::abs(g) <= -gtol * g0) {
+                    return true;
+                }
+                if (stp == stpmax && f <= ftest && g <= gtest) {
+                    return true;
+                }
+                if ((bracketed && (stp <= stmin || stp >= stmax)) || (bracketed && stmax - stmin <= xtol * stmax)) {
+                    break;
+                }
+
+                // In the first stage use the modified function f - ftol*g0*stp,
+                // whose minimum satisfies the sufficient decrease condition.
+                if (stage1 && f <= fx && f > ftest) {
+                    T fm = f - stp * gtest, fxm = fx - stx * gtest, fym = fy - sty * gtest;
+                    T gm = g - gtest, gxm = gx - gtest, gym = gy - gtest;
+                    moreThuenteStep(stx, fxm, gxm, sty, fym, gym, stp, fm, gm, bracketed, stmin, stmax);
+                    fx = fxm + stx * gtest;
+                    fy = fym + sty * gtest;
+                    gx = gxm + gtest;
+                    gy = gym + gtest;
+                }
+                else {
+                    moreThuenteStep(stx, fx, gx, sty, fy, gy, stp, f, g, bracketed, stmin, stmax);
+                }
+
+                if (bracketed) {
+                    if (std::abs(sty - stx) >= T(0.66) * width1) {
+                        stp = stx + T(0.5) * (sty - stx);
+                    }
+                    width1 = width;
+                    width = std::abs(sty - stx);
+                    stmin = std::min(stx, sty);
+                    stmax = std::max(stx, sty);
+                }
+                else {
+                    stmin = stp + T(1.1) * (stp - stx);
+                    stmax = stp + T(4) * (stp - stx);
+                }
+                stp = std::max(T(0), std::min(stpmax, stp));
+            }
+
+            // Out of evaluations or tolerance: settle for the best point, if it
+            // is a decrease.
+            if (stx > T(0) && fx < f0) {
+                stp = stx;
+                if (evaluated != stx) {
+                    phi(stp, f, g);
+                    ++evaluations;
+                }
+                return true;
+            }
+            return false;
+        }
+
+        // Returns the largest step along d from x that stays within the bounds.
+        template <class T>
+        T maxStep(std::size_t n, const T* x, const T* d, const T* lower, const T* upper) noexcept {
+            T stpmax = std::numeric_limits<T>::max();
+            for (std::size_t i = 0; i < n; ++i) {
+                if (d[i] < T(0) && lower[i] > -std::numeric_limits<T>::max()) {
+                    stpmax = std::min(stpmax, (lower[i] - x[i]) / d[i]);
+                }
+                else if (d[i] > T(0) && upper[i] < std::numeric_limits<T>::max()) {
+                    stpmax = std::min(stpmax, (upper[i] - x[i]) / d[i]);
+                }
+            }
+            return stpmax;
+        }
+
+        // The iteration of lbfgs and lbfgsb. lower and upper are null if there
+        // are no bounds. The gradient is projected onto the bounds by zeroing the
+        // components of the variables that are at a bound it points out of (the
+        // active set); the quasi-Newton direction is computed on the others, and
+        // the line search is limited to the step at which the first of them
+        // reaches its bound.
+        template <class T, class F>
+        LbfgsResult<T> lbfgs(F& f, T* x, std::size_t n, const T* lower, const T* upper, const LbfgsOptions& opts) {
+            KSSMATH_INSTRUMENT("lbfgs", 0, 0);
+            if (opts.history == 0) {
+                throw std::invalid_argument("lbfgs: the history must be positive");
+            }
+            const std::size_t m = opts.history;
+            const bool bounded = (lower != nullptr);
+
+            ScratchBuffer<T> g(opts.workspace, n), d(opts.workspace, n);
+            ScratchBuffer<T> xPrev(opts.workspace, n), gPrev(opts.workspace, n);
+            ScratchBuffer<T> s(opts.workspace, m * n), y(opts.workspace, m * n);
+            ScratchBuffer<T> rho(opts.workspace, m), alpha(opts.workspace, m);
+
+            auto isActive = [&](std::size_t i) {
+                return bounded && ((x[i] <= lower[i] && g[i] > T(0)) || (x[i] >= upper[i] && g[i] < T(0)));
+            };
+            auto projectedGradientNorm = [&]() {
+                T norm = T(0);
+                for (std::size_t i = 0; i < n; ++i) {
+                    if (!isActive(i)) {
+                        norm = std::max(norm, std::abs(g[i]));
+                    }
+                }
+                return norm;
+            };
+            auto zeroActive = [&](T* v) {
+                if (bounded) {
+                    for (std::size_t i = 0; i < n; ++i) {
+                        if (isActive(i)) {
+                            v[i] = T(0);
+                        }
+                    }
+                }
+            };
+
+            LbfgsResult<T> res;
+            if (bounded) {
+                for (std::size_t i = 0; i < n; ++i) {
+                    x[i] = std::max(lower[i], std::min(upper[i], x[i]));
+                }
+            }
+            res.value = f(static_cast<const T*>(x), g.data());
+            res.evaluations = 1;
+            res.gradientNorm = projectedGradientNorm();
+            if (!std::isfinite(res.value)) {
+                throw std::domain_error("lbfgs: the objective is not finite at the starting point");
+            }
+
+            std::size_t newest = 0, count = 0;
+            while (true) {
+                if (res.gradientNorm <= T(opts.gradientTolerance)) {
+                    res.converged = true;
+                    break;
+                }
+                if (res.iterations >= opts.maxIterations) {
+                    break;
+                }
+
+                // The two loop recursion for d = -H*g on the free variables.
+                std::copy(g.begin(), g.end(), d.begin());
+                zeroActive(d.data());
+                for (std::size_t k = 0; k < count; ++k) {
+                    const std::size_t j = (newest + m - k) % m;
+                    alpha[j] = rho[j] * blas::dot(n, s.data() + j * n, d.data());
+                    blas::axpy(n, -alpha[j], y.data() + j * n, d.data());
+                    zeroActive(d.data());
+                }
+                if (count > 0) {
+                    const T* yn = y.data() + newest * n;
+                    blas::scal(n, T(1) / (rho[newest] * blas::dot(n, yn, yn)), d.data());
+                }
+                for (std::size_t k = count; k-- > 0; ) {
+                    const std::size_t j = (newest + m - k) % m;
+                    const T beta = rho[j] * blas::dot(n, y.data() + j * n, d.data());
+                    blas::axpy(n, alpha[j] - beta, s.data() + j * n, d.data());
+                    zeroActive(d.data());
+                }
+                blas::scal(n, T(-1), d.data());
+
+                // A free variable at a bound cannot move out of it.
+                if (bounded) {
+                    for (std::size_t i = 0; i < n; ++i) {
+                        if ((x[i] <= lower[i] && d[i] < T(0)) || (x[i] >= upper[i] && d[i] > T(0))) {
+                            d[i] = T(0);
+                        }
+                    }
+                }
+                T dg = blas::dot(n, d.data(), g.data());
+                if (!(dg < T(0))) {
+                    // Not a descent direction: forget the history and take the
+                    // projected steepest descent.
+                    count = 0;
+                    std::copy(g.begin(), g.end(), d.begin());
+                    zeroActive(d.data());
+                    blas::scal(n, T(-1), d.data());
+                    dg = blas::dot(n, d.data(), g.data());
+                }
+
+                const T stpmax = (bounded ? maxStep(n, x, d.data(), lower, upper) : std::numeric_limits<T>::max());
+                T stp = (count == 0 ? T(1) / std::sqrt(blas::dot(n, d.data(), d.data())) : T(1));
+                stp = std::min(stp, stpmax);
+
+                std::copy(x, x + n, xPrev.begin());
+                std::copy(g.begin(), g.end(), gPrev.begin());
+                const T fPrev = res.value;
+                T fLast = fPrev;
+                auto phi = [&](T step, T& value, T& derivative) {
+                    for (std::size_t i = 0; i < n; ++i) {
+                        x[i] = xPrev[i] + step * d[i];
+                    }
+                    if (bounded) {
+                        // A variable whose bound is reached at this step is put
+                        // on it exactly (as maxStep computes the step), not a
+                        // rounding error short of it, where it would stay free
+                        // and limit the next step to almost nothing.
+                        for (std::size_t i = 0; i < n; ++i) {
+                            if (d[i] < T(0) && (lower[i] - xPrev[i]) / d[i] <= step) {
+                                x[i] = lower[i];
+                            }
+                            else if (d[i] > T(0) && (upper[i] - xPrev[i]) / d[i] <= step) {
+                                x[i] = upper[i];
+                            }
+                            else {
+                                x[i] = std::max(lower[i], std::min(upper[i], x[i]));
+                            }
+                        }
+                    }
+                    value = fLast = f(static_cast<const T*>(x), g.data());
+                    derivative = blas::dot(n, g.data(), d.data());
+                };
+                if (!moreThuente(phi, fPrev, dg, stp, stpmax, opts, res.evaluations)) {
+                    std::copy(xPrev.begin(), xPrev.end(), x);
+                    std::copy(gPrev.begin(), gPrev.end(), g.begin());
+                    res.value = fPrev;
+                    if (count == 0) {
+                        break;
+                    }
+                    count = 0;
+                    continue;
+                }
+                res.value = fLast;
+                ++res.iterations;
+                res.gradientNorm = projectedGradientNorm();
+
+                // Keep the correction pair if it has positive curvature, so that
+                // the approximation stays positive definite. It is formed in d
+                // and gPrev, which are free until the next iteration, so that a
+                // rejected pair does not overwrite the oldest one in the ring.
+                T* sNew = d.data();
+                T* yNew = gPrev.data();
+                for (std::size_t i = 0; i < n; ++i) {
+                    sNew[i] = x[i] - xPrev[i];
+                    yNew[i] = g[i] - gPrev[i];
+                }
+                const T sy = blas::dot(n, sNew, yNew);
+                if (sy > std::numeric_limits<T>::epsilon() * blas::dot(n, yNew, yNew)) {
+                    const std::size_t next = (count == 0 ? 0 : (newest + 1) % m);
+                    std::copy(sNew, sNew + n, s.data() + next * n);
+                    std::copy(yNew, yNew + n, y.data() + next * n);
+                    rho[next] = T(1) / sy;
+                    newest = next;
+                    count = std::min(count + 1, m);
+                }
+
+                if (fPrev - res.value <= T(opts.functionTolerance) * std::max(std::abs(res.value), T(1))) {
+                    res.converged = true;
+                    break;
+                }
+            }
+            return res;
+        }
+
+    }
+
+    /*!
+     Minimize a smooth function by the limited memory BFGS method with a
+     More-Thuente line search, starting from and returning the minimizer in x.
+     The objective is called as f(const T* x, T* grad), returns the value at x
+     and sets grad to the gradient there; it is a template parameter, so the
+     calls are direct and can be inlined. All storage (2mn + 4n + 2m values) is
+     allocated before the first iteration, and from opts.workspace if given, so
+     the iterations do not allocate.
+     @throws std::invalid_argument if opts.history is 0.
+     @throws std::domain_error if the objective is not finite at the start.
+     */
+    template <class T, class F>
+    LbfgsResult<T> lbfgs(F&& f, std::vector<T>& x, const LbfgsOptions& opts = LbfgsOptions()) {
+        return _private::lbfgs<T>(f, x.data(), x.size(), static_cast<const T*>(nullptr),
+                                  static_cast<const T*>(nullptr), opts);
+    }
+
+    /*!
+     Minimize a smooth function subject to lower[i] <= x[i] <= upper[i], in the
+     manner of L-BFGS-B: the variables at a bound that the gradient points out
+     of are held fixed, the quasi-Newton step is taken in the others, and the
+     line search stops where the first of them reaches its bound. The infinities
+     (or the largest finite values) leave a side unbounded. x is first moved
+     into the box. Otherwise as lbfgs.
+     @throws std::invalid_argument if the bounds do not have the size of x, a
+        lower bound is above its upper bound, or opts.history is 0.
+     @throws std::domain_error if the objective is not finite at the start.
+     */
+    template <class T, class F>
+    LbfgsResult<T> lbfgsb(F&& f, std::vector<T>& x, const std::vector<T>& lower, const std::vector<T>& upper,
+                          const LbfgsOptions& opts = LbfgsOptions())
+    {
+        if (lower.size() != x.size() || upper.size() != x.size()) {
+            throw std::invalid_argument("lbfgsb: the bounds must have the size of x");
+        }
+        for (std::size_t i = 0; i < x.size(); ++i) {
+            if (lower[i] > upper[i]) {
+                throw std::invalid_argument("lbfgsb: a lower bound is above its upper bound");
+            }
+        }
+        return _private::lbfgs<T>(f, x.data(), x.size(), lower.data(), upper.data(), opts);
+    }
+
+}}
+
+#endif
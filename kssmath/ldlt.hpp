@@ -0,0 +1,346 @@
+//
+//  ldlt.hpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#ifndef kssmath_ldlt_hpp
+#define kssmath_ldlt_hpp
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "blas.hpp"
+#include "blocking.hpp"
+#include "error.hpp"
+#include "instrumentation.hpp"
+#include "matrix.hpp"
+#include "task_graph.hpp"
+
+namespace kss { namespace math {
+
+    /*!
+     LDL' factorization of a symmetric, possibly indefinite, matrix using
+     Bunch-Kaufman diagonal pivoting. D is block diagonal with 1x1 and 2x2 blocks
+     and L is unit lower triangular. Only the lower triangle of A is referenced.
+
+     The factorization is blocked in the manner of LAPACK's sytrf. Each panel of
+     columns is factored with delayed updates, accumulating W = LD for the panel,
+     and the trailing matrix is then updated by A22 := A22 - L21*W21'. That update
+     is split by block column and run in parallel on a TaskGraph.
+
+     As in LAPACK the factors are stored in product form, so L is not available as
+     an ordinary matrix, but solve() and inertia() use them directly.
+     */
+    template <class T>
+    class LDLT {
+    public:
+        using size_type = std::size_t;
+
+        /*!
+         Factor the matrix a.
+         @throws std::invalid_argument if a is not square.
+         @throws SingularMatrixError if a is exactly singular.
+         */
+        explicit LDLT(Matrix<T> a, const BlockingOptions& opts = BlockingOptions()) : _a(std::move(a)) {
+            if (!_a.isSquare()) {
+                throw std::invalid_argument("LDLT: matrix must be square");
+            }
+            const double n = double(size());
+            KSSMATH_INSTRUMENT("LDLT", n * n * n / 3, n * n * sizeof(T));
+            factor(opts);
+        }
+
+        size_type size() const noexcept { return _a.rows(); }
+
+        /*!
+         Solve Ax = b in place. On entry x holds b, on exit it holds the solution.
+         */
+        void solveInPlace(T* x) const noexcept {
+            const size_type n = size();
+
+            // Solve LD y = b.
+            for (size_type k = 0; k < n;) {
+                const T* colk = _a.column(k);
+                if (!_twoByTwo[k]) {
+                    if (_piv[k] != k) {
+                        std::swap(x[k], x[_piv[k]]);
+                    }
+                    blas::axpy(n - k - 1, -x[k], colk + k + 1, x + k + 1);
+                    x[k] /= colk[k];
+                    k += 1;
+                }
+                else {
+                    const T* colk1 = _a.column(k + 1);
+                    if (_piv[k] != k + 1) {
+                        std::swap(x[k + 1], x[_piv[k]]);
+                    }
+                    blas::axpy(n - k - 2, -x[k], colk + k + 2, x + k + 2);
+                    blas::axpy(n - k - 2, -x[k + 1], colk1 + k + 2, x + k + 2);
+                    const T akm1k = colk[k + 1];
+                    const T akm1 = colk[k] / akm1k;
+                    const T ak = colk1[k + 1] / akm1k;
+                    const T denom = akm1 * ak - T(1);
+                    const T bkm1 = x[k] / akm1k;
+                    const T bk = x[k + 1] / akm1k;
+                    x[k] = (ak * bkm1 - bk) / denom;
+                    x[k + 1] = (akm1 * bk - bkm1) / denom;
+                    k += 2;
+                }
+            }
+
+            // Solve L' x = y.
+            for (size_type k = n; k-- > 0;) {
+                const T* colk = _a.column(k);
+                x[k] -= blas::dot(n - k - 1, colk + k + 1, x + k + 1);
+                if (_twoByTwo[k]) {
+                    const T* colkm1 = _a.column(k - 1);
+                    x[k - 1] -= blas::dot(n - k - 1, colkm1 + k + 1, x + k + 1);
+                    if (_piv[k] != k) {
+                        std::swap(x[k], x[_piv[k]]);
+                    }
+                    --k;
+                }
+                else if (_piv[k] != k) {
+                    std::swap(x[k], x[_piv[k]]);
+                }
+            }
+        }
+
+        /*!
+         Returns the solution of Ax = b.
+         @throws std::invalid_argument if b is not the correct length.
+         */
+        std::vector<T> solve(std::vector<T> b) const {
+            if (b.size() != size()) {
+                throw std::invalid_argument("LDLT::solve: b has the wrong length");
+            }
+            solveInPlace(b.data());
+            return b;
+        }
+
+        /*!
+         The inertia of A: the number of positive, negative and zero eigenvalues.
+         By Sylvester's law this is the same as the inertia of D.
+         */
+        struct Inertia {
+            size_type positive = 0;
+            size_type negative = 0;
+            size_type zero = 0;
+        };
+
+        Inertia inertia() const noexcept {
+            Inertia res;
+            const size_type n = size();
+            for (size_type k = 0; k < n;) {
+                if (!_twoByTwo[k]) {
+                    const T d = _a(k, k);
+                    (d > T(0) ? res.positive : (d < T(0) ? res.negative : res.zero)) += 1;
+                    k += 1;
+                }
+                else {
+                    // A Bunch-Kaufman 2x2 block always has one eigenvalue of each sign.
+                    res.positive += 1;
+                    res.negative += 1;
+                    k += 2;
+                }
+            }
+            return res;
+        }
+
+    private:
+        Matrix<T>               _a;
+        std::vector<size_type>  _piv;       // row interchanged with k (or with k+1 for a 2x2 block)
+        std::vector<char>       _twoByTwo;  // true for both columns of a 2x2 block
+
+        void factor(const BlockingOptions& opts) {
+            const size_type n = size();
+            const size_type nb = std::max<size_type>(opts.blockSize, 2);
+            _piv.assign(n, 0);
+            _twoByTwo.assign(n, 0);
+            Matrix<T> w(n, std::min(nb, n));
+            for (size_type k = 0; k < n;) {
+                k += factorPanel(k, (n - k > nb ? nb : n - k), w, opts.threads);
+            }
+        }
+
+        // Factor at most nb columns starting at k0 using delayed updates, apply the
+        // trailing update, and return the number of columns factored. This follows
+        // the structure of LAPACK's lasyf (lower).
+        size_type factorPanel(size_type k0, size_type nb, Matrix<T>& w, unsigned threads) {
+            static const T alpha = (T(1) + std::sqrt(T(17))) / T(8);
+            const size_type n = size();
+            const size_type ldw = w.rows();
+            auto A = [this](size_type i, size_type j) -> T& { return _a(i, j); };
+            auto W = [&w, k0](size_type i, size_type j) -> T& { return w(i, j - k0); };
+            std::vector<T> xrow(nb);
+
+            // Computes W(k:n, wc) -= A(k:n, k0:k) * W(r, k0:k)'.
+            auto updateColumn = [&](size_type k, size_type r, size_type wc) {
+                if (k == k0) {
+                    return;
+                }
+                for (size_type p = k0; p < k; ++p) {
+                    xrow[p - k0] = W(r, p);
+                }
+                blas::gemv(n - k, k - k0, T(-1), _a.column(k0) + k, n, xrow.data(), T(1), &W(k, wc));
+            };
+
+            size_type k = k0;
+            while (k < n && !(k - k0 >= nb - 1 && nb < n - k0)) {
+                size_type kstep = 1;
+                size_type kp = k;
+
+                std::copy(_a.column(k) + k, _a.column(k) + n, &W(k, k));
+                updateColumn(k, k, k);
+
+                const T absakk = std::abs(W(k, k));
+                size_type imax = k;
+                T colmax = T(0);
+                for (size_type i = k + 1; i < n; ++i) {
+                    if (std::abs(W(i, k)) > colmax) {
+                        colmax = std::abs(W(i, k));
+                        imax = i;
+                    }
+                }
+                if (std::max(absakk, colmax) == T(0) || !std::isfinite(absakk) || !std::isfinite(colmax)) {
+                    throw SingularMatrixError("LDLT: matrix is singular");
+                }
+
+                if (absakk < alpha * colmax) {
+                    // Copy column imax to column k+1 of W and update it.
+                    for (size_type i = k; i < imax; ++i) {
+                        W(i, k + 1) = A(imax, i);
+                    }
+                    std::copy(_a.column(imax) + imax, _a.column(imax) + n, &W(imax, k + 1));
+                    updateColumn(k, imax, k + 1);
+
+                    T rowmax = T(0);
+                    for (size_type i = k; i < n; ++i) {
+                        if (i != imax) {
+                            rowmax = std::max(rowmax, std::abs(W(i, k + 1)));
+                        }
+                    }
+
+                    if (absakk >= alpha * colmax * (colmax / rowmax)) {
+                        kp = k;
+                    }
+                    else if (std::abs(W(imax, k + 1)) >= alpha * rowmax) {
+                        kp = imax;
+                        std::copy(&W(k, k + 1), &W(k, k + 1) + (n - k), &W(k, k));
+                    }
+                    else {
+                        kp = imax;
+                        kstep = 2;
+                    }
+                }
+
+                const size_type kk = k + kstep - 1;
+                if (kp != kk) {
+                    // Copy the non-updated column kk to column kp and interchange
+                    // rows kk and kp in the first columns of the panel and of W.
+                    A(kp, kp) = A(kk, kk);
+                    for (size_type i = kk + 1; i < kp; ++i) {
+                        A(kp, i) = A(i, kk);
+                    }
+                    for (size_type i = kp + 1; i < n; ++i) {
+                        A(i, kp) = A(i, kk);
+                    }
+                    for (size_type j = k0; j < kk; ++j) {
+                        std::swap(A(kk, j), A(kp, j));
+                    }
+                    for (size_type j = k0; j <= kk; ++j) {
+                        std::swap(W(kk, j), W(kp, j));
+                    }
+                }
+
+                if (kstep == 1) {
+                    std::copy(&W(k, k), &W(k, k) + (n - k), _a.column(k) + k);
+                    blas::scal(n - k - 1, T(1) / A(k, k), _a.column(k) + k + 1);
+                }
+                else {
+                    T d21 = W(k + 1, k);
+                    const T d11 = W(k + 1, k + 1) / d21;
+                    const T d22 = W(k, k) / d21;
+                    const T t = T(1) / (d11 * d22 - T(1));
+                    d21 = t / d21;
+                    for (size_type j = k + 2; j < n; ++j) {
+                        A(j, k) = d21 * (d11 * W(j, k) - W(j, k + 1));
+                        A(j, k + 1) = d21 * (d22 * W(j, k + 1) - W(j, k));
+                    }
+                    A(k, k) = W(k, k);
+                    A(k + 1, k) = W(k + 1, k);
+                    A(k + 1, k + 1) = W(k + 1, k + 1);
+                }
+
+                _piv[k] = kp;
+                if (kstep == 2) {
+                    _piv[k + 1] = kp;
+                    _twoByTwo[k] = _twoByTwo[k + 1] = 1;
+                }
+                k += kstep;
+            }
+
+            trailingUpdate(k0, k, nb, w.data(), ldw, threads);
+            undoPanelInterchanges(k0, k);
+            return k - k0;
+        }
+
+        // Update the lower triangle of A(k:n, k:n) -= A(k:n, k0:k) * W(k:n, 0:k-k0)'.
+        // Each block column is independent so they are run as parallel tasks.
+        void trailingUpdate(size_type k0, size_type k, size_type nb, const T* w, size_type ldw, unsigned threads) {
+            const size_type n = size();
+            const size_type kw = k - k0;
+            if (k >= n || kw == 0) {
+                return;
+            }
+            T* a = _a.data();
+            TaskGraph graph;
+            for (size_type j = k; j < n; j += nb) {
+                const size_type jb = std::min(nb, n - j);
+                graph.add([=] {
+                    for (size_type jj = j; jj < j + jb; ++jj) {
+                        for (size_type p = 0; p < kw; ++p) {
+                            const T wjp = w[jj + p * ldw];
+                            if (wjp != T(0)) {
+                                blas::axpy(j + jb - jj, -wjp, a + jj + (k0 + p) * n, a + jj + jj * n);
+                            }
+                        }
+                    }
+                    if (j + jb < n) {
+                        blas::gemm(blas::Op::NoTrans, blas::Op::Trans, n - j - jb, jb, kw,
+                                   T(-1), a + (j + jb) + k0 * n, n, w + j, ldw,
+                                   T(1), a + (j + jb) + j * n, n);
+                    }
+                });
+            }
+            graph.run(threads);
+        }
+
+        // Put the panel's part of L in the form expected by solve() by partially
+        // undoing the interchanges applied to the earlier columns of the panel.
+        void undoPanelInterchanges(size_type k0, size_type k) {
+            size_type j = k;     // one past the column being examined
+            while (j > k0) {
+                const size_type jj = j - 1;
+                const size_type jp = _piv[jj];
+                j = (_twoByTwo[jj] ? jj - 1 : jj);
+                if (jp != jj && j > k0) {
+                    for (size_type c = k0; c < j; ++c) {
+                        std::swap(_a(jp, c), _a(jj, c));
+                    }
+                }
+            }
+        }
+    };
+
+}}
+
+#endif
@@ -0,0 +1,248 @@
+//
+//  least_squares.hpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#ifndef kssmath_least_squares_hpp
+#define kssmath_least_squares_hpp
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "blas.hpp"
+#include "blocking.hpp"
+#include "matrix.hpp"
+#include "parallel.hpp"
+#include "qr.hpp"
+#include "task_graph.hpp"
+
+namespace kss { namespace math {
+
+    /*!
+     The algorithm used by lstsq.
+     */
+    enum class LeastSquaresMethod {
+        Automatic,  ///< TSQR for tall-skinny problems, otherwise QR, PivotedQR if rank deficient.
+        QR,         ///< Blocked Householder QR (or QR of A' for underdetermined systems).
+        PivotedQR,  ///< Column pivoted QR, giving the basic solution for rank deficient A.
+        TSQR        ///< Tall-skinny QR over row blocks in parallel. Requires m >= n.
+    };
+
+    /*!
+     Options for lstsq.
+     */
+    struct LeastSquaresOptions {
+        LeastSquaresMethod  method = LeastSquaresMethod::Automatic;
+
+        /*!
+         Singular values (as estimated by the diagonal of R) smaller than rcond times
+         the largest are treated as zero. A negative value uses machine epsilon times
+         max(m, n).
+         */
+        double              rcond = -1.0;
+
+        /*!
+         Blocking options passed to the QR factorizations. For TSQR the threads value
+         is also the number of row blocks processed concurrently.
+         */
+        BlockingOptions     blocking;
+    };
+
+    /*!
+     The result of lstsq.
+     */
+    template <class T>
+    struct LeastSquaresResult {
+        std::vector<T>  x;                      ///< The solution.
+        T               residualNorm = T(0);    ///< ||b - Ax|| (2-norm).
+        std::size_t     rank = 0;               ///< The numerical rank of A used for the solution.
+    };
+
+    namespace _private {
+
+        // Upper triangular factor R of A along with c = Q'b, where only the first n
+        // entries of c are kept and the norm of the remainder is tracked separately.
+        template <class T>
+        struct ReducedSystem {
+            Matrix<T>       r;
+            std::vector<T>  c;
+            T               tailNormSquared = T(0);
+        };
+
+        template <class T>
+        T sumSquares(std::size_t n, const T* x) noexcept {
+            const T nrm = blas::nrm2(n, x);
+            return nrm * nrm;
+        }
+
+        // TSQR: factor independent row blocks of A in parallel, stack their R
+        // factors and factor that again. Only a single reduction level is used since
+        // the stacked R factors are small (threads*n x n) compared to A.
+        template <class T>
+        ReducedSystem<T> tsqr(const Matrix<T>& a, const std::vector<T>& b, const BlockingOptions& opts) {
+            const std::size_t m = a.rows();
+            const std::size_t n = a.cols();
+            const unsigned threads = (opts.threads == 0 ? defaultThreadCount() : opts.threads);
+            const std::size_t maxBlocks = std::max<std::size_t>(1, m / std::max<std::size_t>(2 * n, 1));
+            const std::size_t numBlocks = std::min<std::size_t>(threads, maxBlocks);
+
+            BlockingOptions local = opts;
+            local.threads = 1;
+            Matrix<T> stacked(numBlocks * n, n);
+            std::vector<T> stackedC(numBlocks * n);
+            std::vector<T> tails(numBlocks, T(0));
+
+            parallelFor(numBlocks, 1, [&](std::size_t begin, std::size_t end) {
+                for (std::size_t blk = begin; blk < end; ++blk) {
+                    // Balanced bounds, so every block has at least m/numBlocks >= 2n rows.
+                    const std::size_t r0 = blk * m / numBlocks;
+                    const std::size_t rb = (blk + 1) * m / numBlocks - r0;
+                    Matrix<T> ablk(rb, n);
+                    for (std::size_t j = 0; j < n; ++j) {
+                        std::copy(a.column(j) + r0, a.column(j) + r0 + rb, ablk.column(j));
+                    }
+                    std::vector<T> cblk(b.begin() + long(r0), b.begin() + long(r0 + rb));
+
+                    QR<T> qr(std::move(ablk), local);
+                    qr.applyQTranspose(cblk);
+                    const std::size_t k = std::min(rb, n);
+                    const Matrix<T>& f = qr.factors();
+                    for (std::size_t j = 0; j < n; ++j) {
+                        std::copy(f.column(j), f.column(j) + std::min(j + 1, k), stacked.column(j) + blk * n);
+                    }
+                    std::copy(cblk.begin(), cblk.begin() + long(k), stackedC.begin() + long(blk * n));
+                    tails[blk] = sumSquares(rb - k, cblk.data() + k);
+                }
+            }, threads);
+
+            ReducedSystem<T> res;
+            QR<T> top(std::move(stacked), opts);
+            top.applyQTranspose(stackedC);
+            res.r = top.R();
+            res.c.assign(stackedC.begin(), stackedC.begin() + long(n));
+            res.tailNormSquared = sumSquares(stackedC.size() - n, stackedC.data() + n);
+            for (auto t : tails) {
+                res.tailNormSquared += t;
+            }
+            return res;
+        }
+
+        template <class T>
+        ReducedSystem<T> qrReduce(const Matrix<T>& a, const std::vector<T>& b, const BlockingOptions& opts) {
+            const std::size_t n = a.cols();
+            ReducedSystem<T> res;
+            QR<T> qr(a, opts);
+            std::vector<T> c = b;
+            qr.applyQTranspose(c);
+            res.r = qr.R();
+            res.c.assign(c.begin(), c.begin() + long(n));
+            res.tailNormSquared = sumSquares(c.size() - n, c.data() + n);
+            return res;
+        }
+
+        template <class T>
+        bool isFullRank(const Matrix<T>& r, T rcond) noexcept {
+            T hi = T(0);
+            T lo = std::numeric_limits<T>::infinity();
+            for (std::size_t i = 0; i < std::min(r.rows(), r.cols()); ++i) {
+                hi = std::max(hi, std::abs(r(i, i)));
+                lo = std::min(lo, std::abs(r(i, i)));
+            }
+            return hi > T(0) && lo > rcond * hi;
+        }
+
+        template <class T>
+        LeastSquaresResult<T> pivotedSolve(const Matrix<T>& a, const std::vector<T>& b, T rcond) {
+            LeastSquaresResult<T> res;
+            PivotedQR<T> pqr(a);
+            res.rank = pqr.rank(rcond);
+            res.x = pqr.solve(b, rcond);
+            std::vector<T> r = b;
+            blas::gemv(a.rows(), a.cols(), T(-1), a.data(), a.rows(), res.x.data(), T(1), r.data());
+            res.residualNorm = blas::nrm2(r.size(), r.data());
+            return res;
+        }
+
+    }
+
+    /*!
+     Returns the least squares solution x minimizing ||b - Ax||. If A has more
+     columns than rows the minimum norm solution is returned. If A is found to be
+     rank deficient the column pivoted QR is used and the basic solution (with
+     rank(A) nonzero components) is returned.
+     @throws std::invalid_argument if b does not have one entry per row of A, or if
+        the TSQR method is requested for a matrix with fewer rows than columns.
+     */
+    template <class T>
+    LeastSquaresResult<T> lstsq(const Matrix<T>& a, const std::vector<T>& b,
+                                const LeastSquaresOptions& opts = LeastSquaresOptions())
+    {
+        const std::size_t m = a.rows();
+        const std::size_t n = a.cols();
+        if (b.size() != m) {
+            throw std::invalid_argument("lstsq: b must have one entry per row of a");
+        }
+        const T rcond = (opts.rcond < 0
+                         ? std::numeric_limits<T>::epsilon() * T(std::max(m, n))
+                         : T(opts.rcond));
+
+        LeastSquaresMethod method = opts.method;
+        if (method == LeastSquaresMethod::PivotedQR) {
+            return _private::pivotedSolve(a, b, rcond);
+        }
+        if (method == LeastSquaresMethod::TSQR && m < n) {
+            throw std::invalid_argument("lstsq: TSQR requires at least as many rows as columns");
+        }
+        if (method == LeastSquaresMethod::Automatic) {
+            const unsigned threads = (opts.blocking.threads == 0 ? defaultThreadCount() : opts.blocking.threads);
+            method = (threads > 1 && m >= 4 * n * threads ? LeastSquaresMethod::TSQR : LeastSquaresMethod::QR);
+        }
+
+        LeastSquaresResult<T> res;
+        if (m >= n) {
+            auto sys = (method == LeastSquaresMethod::TSQR
+                        ? _private::tsqr(a, b, opts.blocking)
+                        : _private::qrReduce(a, b, opts.blocking));
+            if (!_private::isFullRank(sys.r, rcond)) {
+                return _private::pivotedSolve(a, b, rcond);
+            }
+            _private::solveUpper(n, sys.r.data(), sys.r.rows(), sys.c.data());
+            res.x = std::move(sys.c);
+            res.residualNorm = std::sqrt(sys.tailNormSquared);
+            res.rank = n;
+            return res;
+        }
+
+        // Underdetermined: with A' = QR, A = R'Q' so x = Q*(R'^-1 b) is the
+        // minimum norm solution.
+        Matrix<T> at(n, m);
+        for (std::size_t j = 0; j < n; ++j) {
+            for (std::size_t i = 0; i < m; ++i) {
+                at(j, i) = a(i, j);
+            }
+        }
+        QR<T> qr(std::move(at), opts.blocking);
+        Matrix<T> r = qr.R();
+        if (!_private::isFullRank(r, rcond)) {
+            return _private::pivotedSolve(a, b, rcond);
+        }
+        res.x.assign(n, T(0));
+        for (std::size_t i = 0; i < m; ++i) {
+            res.x[i] = (b[i] - blas::dot(i, r.column(i), res.x.data())) / r(i, i);
+        }
+        qr.applyQ(res.x);
+        res.rank = m;
+        return res;
+    }
+
+}}
+
+#endif
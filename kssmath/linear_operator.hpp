@@ -0,0 +1,50 @@
+//
+//  linear_operator.hpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#ifndef kssmath_linear_operator_hpp
+#define kssmath_linear_operator_hpp
+
+#include <cstddef>
+#include <functional>
+
+#include "blas.hpp"
+#include "matrix.hpp"
+#include "parallel.hpp"
+
+namespace kss { namespace math {
+
+    /*!
+     A matrix-free linear operator. It is called as op(x, y) and must set y = A*x,
+     where x and y are vectors of the operator's size. x and y never overlap.
+
+     Iterative solvers only access the matrix through this interface, so it may
+     be a sparse matrix, a stencil, or a composition of other operators.
+     */
+    template <class T>
+    using LinearOperator = std::function<void(const T* x, T* y)>;
+
+    /*!
+     Returns an operator computing the dense matrix-vector product with a. The
+     rows are split over the given number of threads. The operator refers to a,
+     which must outlive it.
+     */
+    template <class T>
+    LinearOperator<T> denseOperator(const Matrix<T>& a, unsigned threads = 0) {
+        const Matrix<T>* pa = &a;
+        return [pa, threads](const T* x, T* y) {
+            const std::size_t m = pa->rows();
+            parallelFor(m, 256, [&](std::size_t r0, std::size_t r1) {
+                blas::gemv(r1 - r0, pa->cols(), T(1), pa->data() + r0, m, x, T(0), y + r0);
+            }, threads);
+        };
+    }
+
+}}
+
+#endif
@@ -0,0 +1,137 @@
+//
+//  lu.hpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#ifndef kssmath_lu_hpp
+#define kssmath_lu_hpp
+
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "blas.hpp"
+#include "error.hpp"
+#include "instrumentation.hpp"
+#include "matrix.hpp"
+
+namespace kss { namespace math {
+
+    /*!
+     LU factorization with partial pivoting, PA = LU. The unit lower triangle L and
+     the upper triangle U are stored together in place of A.
+     */
+    template <class T>
+    class LU {
+    public:
+        using size_type = std::size_t;
+
+        /*!
+         Factor the square matrix a.
+         @throws std::invalid_argument if a is not square.
+         @throws SingularMatrixError if a zero (or non-finite) pivot is encountered.
+         */
+        explicit LU(Matrix<T> a) : _lu(std::move(a)) {
+            if (!_lu.isSquare()) {
+                throw std::invalid_argument("LU: matrix must be square");
+            }
+            const double n = double(size());
+            KSSMATH_INSTRUMENT("LU", 2 * n * n * n / 3, n * n * sizeof(T));
+            factor();
+        }
+
+        size_type size() const noexcept { return _lu.rows(); }
+        const Matrix<T>& factors() const noexcept { return _lu; }
+        const std::vector<size_type>& pivots() const noexcept { return _piv; }
+
+        /*!
+         Solve Ax = b in place. On entry x holds b, on exit it holds the solution.
+         */
+        void solveInPlace(T* x) const noexcept {
+            const size_type n = size();
+            for (size_type k = 0; k < n; ++k) {
+                if (_piv[k] != k) {
+                    std::swap(x[k], x[_piv[k]]);
+                }
+            }
+            // Forward substitution with unit L, column oriented.
+            for (size_type j = 0; j < n; ++j) {
+                const T xj = x[j];
+                if (xj != T(0)) {
+                    blas::axpy(n - j - 1, -xj, _lu.column(j) + j + 1, x + j + 1);
+                }
+            }
+            // Back substitution with U, column oriented.
+            for (size_type j = n; j-- > 0;) {
+                x[j] /= _lu(j, j);
+                const T xj = x[j];
+                if (xj != T(0)) {
+                    blas::axpy(j, -xj, _lu.column(j), x);
+                }
+            }
+        }
+
+        /*!
+         Returns the solution of Ax = b.
+         @throws std::invalid_argument if b is not the correct length.
+         */
+        std::vector<T> solve(std::vector<T> b) const {
+            if (b.size() != size()) {
+                throw std::invalid_argument("LU::solve: b has the wrong length");
+            }
+            solveInPlace(b.data());
+            return b;
+        }
+
+    private:
+        Matrix<T>               _lu;
+        std::vector<size_type>  _piv;
+
+        // Right-looking elimination. Each step pivots, scales the column below the
+        // diagonal, then applies a rank-one update to the trailing matrix one
+        // column at a time so the inner loop stays unit stride.
+        void factor() {
+            const size_type n = size();
+            _piv.resize(n);
+            for (size_type k = 0; k < n; ++k) {
+                T* colk = _lu.column(k);
+                size_type p = k;
+                T pmax = std::abs(colk[k]);
+                for (size_type i = k + 1; i < n; ++i) {
+                    const T v = std::abs(colk[i]);
+                    if (v > pmax) {
+                        pmax = v;
+                        p = i;
+                    }
+                }
+                _piv[k] = p;
+                if (pmax == T(0) || !std::isfinite(pmax)) {
+                    throw SingularMatrixError("LU: matrix is singular to working precision");
+                }
+                if (p != k) {
+                    for (size_type j = 0; j < n; ++j) {
+                        std::swap(_lu(k, j), _lu(p, j));
+                    }
+                }
+                const T rpivot = T(1) / colk[k];
+                blas::scal(n - k - 1, rpivot, colk + k + 1);
+                for (size_type j = k + 1; j < n; ++j) {
+                    T* colj = _lu.column(j);
+                    const T ukj = colj[k];
+                    if (ukj != T(0)) {
+                        blas::axpy(n - k - 1, -ukj, colk + k + 1, colj + k + 1);
+                    }
+                }
+            }
+        }
+    };
+
+}}
+
+#endif
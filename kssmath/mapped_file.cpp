@@ -0,0 +1,148 @@
+//
+//  mapped_file.cpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#include <cerrno>
+#include <cstdint>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "mapped_file.hpp"
+
+using namespace std;
+using namespace kss::math;
+
+
+namespace {
+
+    [[noreturn]] void throwErrno(const string& what, const string& path) {
+        throw system_error(errno, generic_category(), "MappedFile: " + what + " " + path);
+    }
+
+    // Closes the descriptor when the scope ends. The mapping stays valid after the
+    // file is closed.
+    struct FileDescriptor {
+        int fd;
+        explicit FileDescriptor(int f) noexcept : fd(f) {}
+        ~FileDescriptor() noexcept { if (fd >= 0) { ::close(fd); } }
+    };
+
+    char* mapFile(int fd, size_t size, bool writable, const string& path) {
+        if (size == 0) {
+            return nullptr;
+        }
+        const int prot = PROT_READ | (writable ? PROT_WRITE : 0);
+        void* p = ::mmap(nullptr, size, prot, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) {
+            throwErrno("cannot map", path);
+        }
+        return static_cast<char*>(p);
+    }
+
+}
+
+
+MappedFile::MappedFile(const string& path, Mode mode)
+: _path(path), _writable(mode == Mode::ReadWrite)
+{
+    FileDescriptor f(::open(path.c_str(), _writable ? O_RDWR : O_RDONLY));
+    if (f.fd < 0) {
+        throwErrno("cannot open", path);
+    }
+    struct stat st;
+    if (::fstat(f.fd, &st) != 0) {
+        throwErrno("cannot stat", path);
+    }
+    _size = static_cast<size_t>(st.st_size);
+    _data = mapFile(f.fd, _size, _writable, path);
+}
+
+MappedFile MappedFile::create(const string& path, size_t size) {
+    FileDescriptor f(::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644));
+    if (f.fd < 0) {
+        throwErrno("cannot create", path);
+    }
+    if (::ftruncate(f.fd, static_cast<off_t>(size)) != 0) {
+        throwErrno("cannot resize", path);
+    }
+    MappedFile res;
+    res._path = path;
+    res._writable = true;
+    res._size = size;
+    res._data = mapFile(f.fd, size, true, path);
+    return res;
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+: _path(move(other._path)), _data(other._data), _size(other._size), _writable(other._writable)
+{
+    other._data = nullptr;
+    other._size = 0;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        unmap();
+        _path = move(other._path);
+        _data = other._data;
+        _size = other._size;
+        _writable = other._writable;
+        other._data = nullptr;
+        other._size = 0;
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile() noexcept {
+    unmap();
+}
+
+char* MappedFile::mutableData() {
+    if (!_writable) {
+        throw logic_error("MappedFile: " + _path + " is mapped read only");
+    }
+    return _data;
+}
+
+void MappedFile::advise(const void* p, size_t length, Access access) noexcept {
+    if (p == nullptr || length == 0) {
+        return;
+    }
+    const uintptr_t page = static_cast<uintptr_t>(::sysconf(_SC_PAGESIZE));
+    const uintptr_t begin = reinterpret_cast<uintptr_t>(p) / page * page;
+    const uintptr_t end = reinterpret_cast<uintptr_t>(p) + length;
+    int advice = MADV_NORMAL;
+    switch (access) {
+    case Access::Normal:        advice = MADV_NORMAL; break;
+    case Access::Sequential:    advice = MADV_SEQUENTIAL; break;
+    case Access::Random:        advice = MADV_RANDOM; break;
+    case Access::WillNeed:      advice = MADV_WILLNEED; break;
+    case Access::DontNeed:      advice = MADV_DONTNEED; break;
+    }
+    ::madvise(reinterpret_cast<void*>(begin), end - begin, advice);
+}
+
+void MappedFile::sync() const {
+    if (_data != nullptr && _writable && ::msync(_data, _size, MS_SYNC) != 0) {
+        throwErrno("cannot sync", _path);
+    }
+}
+
+void MappedFile::unmap() noexcept {
+    if (_data != nullptr) {
+        ::munmap(_data, _size);
+        _data = nullptr;
+        _size = 0;
+    }
+}
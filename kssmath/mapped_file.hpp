@@ -0,0 +1,101 @@
+//
+//  mapped_file.hpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#ifndef kssmath_mapped_file_hpp
+#define kssmath_mapped_file_hpp
+
+#include <cstddef>
+#include <string>
+
+namespace kss { namespace math {
+
+    /*!
+     A file mapped into memory. The pages are read from the file by the operating
+     system as they are first touched, so opening even a very large file is
+     immediate and only the parts that are used are ever read. Writes to a
+     writable mapping go back to the file.
+
+     MappedFile is movable but not copyable; the mapping is removed when it is
+     destroyed.
+     */
+    class MappedFile {
+    public:
+        enum class Mode { ReadOnly, ReadWrite };
+
+        /*!
+         Hints describing how a range of the file will be accessed.
+         */
+        enum class Access {
+            Normal,
+            Sequential, ///< Read ahead aggressively.
+            Random,     ///< Do not read ahead.
+            WillNeed,   ///< Start reading the range in now (prefetch).
+            DontNeed    ///< The range may be dropped from memory.
+        };
+
+        MappedFile() = default;
+
+        /*!
+         Map an existing file in its entirety.
+         @throws std::system_error if the file cannot be opened or mapped.
+         */
+        explicit MappedFile(const std::string& path, Mode mode = Mode::ReadOnly);
+
+        /*!
+         Create (or truncate) the file, extend it to the given size with zeros, and
+         map it for reading and writing. On most file systems the file is sparse
+         until it is written.
+         @throws std::system_error if the file cannot be created or mapped.
+         */
+        static MappedFile create(const std::string& path, std::size_t size);
+
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        ~MappedFile() noexcept;
+
+        const std::string& path() const noexcept { return _path; }
+        std::size_t size() const noexcept { return _size; }
+        bool isWritable() const noexcept { return _writable; }
+
+        const char* data() const noexcept { return _data; }
+
+        /*!
+         Returns the data of a writable mapping.
+         @throws std::logic_error if the file was mapped read only.
+         */
+        char* mutableData();
+
+        /*!
+         Give the operating system a hint about the access to the bytes [p, p+length)
+         of a mapping (which need not be this one, so that code holding only a view
+         of the data can use it). The range is widened to whole pages. This is only
+         advice, so errors are ignored.
+         */
+        static void advise(const void* p, std::size_t length, Access access) noexcept;
+
+        /*!
+         Write any modified pages back to the file.
+         @throws std::system_error if the write fails.
+         */
+        void sync() const;
+
+    private:
+        std::string _path;
+        char*       _data = nullptr;
+        std::size_t _size = 0;
+        bool        _writable = false;
+
+        void unmap() noexcept;
+    };
+
+}}
+
+#endif
@@ -0,0 +1,133 @@
+//
+//  matrix.hpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#ifndef kssmath_matrix_hpp
+#define kssmath_matrix_hpp
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <stdexcept>
+#include <vector>
+
+namespace kss { namespace math {
+
+    /*!
+     Dense matrix stored in column-major order. The leading dimension is always
+     equal to the number of rows, so column j begins at data() + j*rows(). This
+     matches the layout expected by the factorization and solver routines.
+     */
+    template <class T>
+    class Matrix {
+    public:
+        using value_type = T;
+        using size_type = std::size_t;
+
+        Matrix() = default;
+
+        /*!
+         Construct a matrix of the given size with all elements set to initialValue.
+         */
+        Matrix(size_type rows, size_type cols, const T& initialValue = T())
+        : _rows(rows), _cols(cols), _data(rows * cols, initialValue)
+        {}
+
+        /*!
+         Construct a matrix from a list of rows. All rows must be the same length.
+         @throws std::invalid_argument if the rows are not all the same length.
+         */
+        Matrix(std::initializer_list<std::initializer_list<T>> rowList)
+        : _rows(rowList.size()), _cols(rowList.size() ? rowList.begin()->size() : 0)
+        {
+            _data.resize(_rows * _cols);
+            size_type i = 0;
+            for (const auto& row : rowList) {
+                if (row.size() != _cols) {
+                    throw std::invalid_argument("Matrix: all rows must be the same length");
+                }
+                size_type j = 0;
+                for (const auto& value : row) {
+                    (*this)(i, j++) = value;
+                }
+                ++i;
+            }
+        }
+
+        /*!
+         Construct a matrix by converting each element of another matrix. This is
+         primarily used to move between precisions (e.g. double to float).
+         */
+        template <class U>
+        explicit Matrix(const Matrix<U>& other)
+        : _rows(other.rows()), _cols(other.cols()), _data(other.rows() * other.cols())
+        {
+            std::transform(other.data(), other.data() + other.size(), _data.begin(),
+                           [](const U& u) { return static_cast<T>(u); });
+        }
+
+        Matrix(const Matrix&) = default;
+        Matrix(Matrix&&) = default;
+        Matrix& operator=(const Matrix&) = default;
+        Matrix& operator=(Matrix&&) = default;
+
+        /*!
+         Returns an n x n identity matrix.
+         */
+        static Matrix identity(size_type n) {
+            Matrix m(n, n);
+            for (size_type i = 0; i < n; ++i) {
+                m(i, i) = T(1);
+            }
+            return m;
+        }
+
+        // Accessors
+        size_type rows() const noexcept { return _rows; }
+        size_type cols() const noexcept { return _cols; }
+        size_type size() const noexcept { return _data.size(); }
+        bool empty() const noexcept { return _data.empty(); }
+        bool isSquare() const noexcept { return _rows == _cols; }
+
+        T* data() noexcept { return _data.data(); }
+        const T* data() const noexcept { return _data.data(); }
+        T* column(size_type j) noexcept { return _data.data() + j * _rows; }
+        const T* column(size_type j) const noexcept { return _data.data() + j * _rows; }
+
+        T& operator()(size_type i, size_type j) noexcept { return _data[i + j * _rows]; }
+        const T& operator()(size_type i, size_type j) const noexcept { return _data[i + j * _rows]; }
+
+        /*!
+         Range checked element access.
+         @throws std::out_of_range if (i, j) is not a valid position.
+         */
+        T& at(size_type i, size_type j) {
+            if (i >= _rows || j >= _cols) {
+                throw std::out_of_range("Matrix::at: index out of range");
+            }
+            return (*this)(i, j);
+        }
+        const T& at(size_type i, size_type j) const {
+            return const_cast<Matrix*>(this)->at(i, j);
+        }
+
+        // Comparison
+        bool operator==(const Matrix& rhs) const {
+            return _rows == rhs._rows && _cols == rhs._cols && _data == rhs._data;
+        }
+        bool operator!=(const Matrix& rhs) const { return !operator==(rhs); }
+
+    private:
+        size_type       _rows = 0;
+        size_type       _cols = 0;
+        std::vector<T>  _data;
+    };
+
+}}
+
+#endif
@@ -0,0 +1,133 @@
+//
+//  matrix_file.cpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#include <cstring>
+#include <stdexcept>
+
+#include "matrix_file.hpp"
+
+using namespace std;
+using namespace kss::math;
+using kss::math::_private::MatrixFileHeader;
+
+
+namespace {
+
+    const char magic[8] = { 'K', 'S', 'S', 'M', 'A', 'T', 'X', '\0' };
+    constexpr uint32_t currentVersion = 1;
+    constexpr uint32_t byteOrderMark = 0x01020304;
+
+    // Limits on the dimensions in a header, so that the layout computation cannot
+    // overflow for a corrupt file.
+    constexpr uint64_t maxDimension = uint64_t(1) << 40;
+    constexpr uint64_t maxEntries = uint64_t(1) << 56;
+
+    uint64_t roundUp(uint64_t n, uint64_t alignment) noexcept {
+        return (n + alignment - 1) / alignment * alignment;
+    }
+
+    [[noreturn]] void invalid(const string& path, const string& why) {
+        throw runtime_error("MatrixFile: " + path + " " + why);
+    }
+
+}
+
+
+MatrixFileHeader kss::math::_private::matrixFileLayout(MatrixFileKind kind, MatrixFileValueType valueType,
+                                                       size_t valueSize, size_t rows, size_t cols,
+                                                       size_t nonZeros)
+{
+    MatrixFileHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, magic, sizeof(magic));
+    h.version = currentVersion;
+    h.byteOrder = byteOrderMark;
+    h.kind = static_cast<uint32_t>(kind);
+    h.valueType = static_cast<uint32_t>(valueType);
+    h.valueSize = static_cast<uint32_t>(valueSize);
+    h.rows = rows;
+    h.cols = cols;
+
+    uint64_t offset = matrixFileSectionAlignment;
+    if (kind == MatrixFileKind::Dense) {
+        h.nonZeros = uint64_t(rows) * cols;
+        h.leadingDimension = roundUp(uint64_t(rows) * valueSize, matrixFileColumnAlignment) / valueSize;
+        h.valuesOffset = offset;
+        offset += h.leadingDimension * valueSize * cols;
+    }
+    else {
+        h.nonZeros = nonZeros;
+        h.rowPointersOffset = offset;
+        offset = roundUp(offset + (uint64_t(rows) + 1) * sizeof(uint64_t), matrixFileSectionAlignment);
+        h.columnIndicesOffset = offset;
+        offset = roundUp(offset + uint64_t(nonZeros) * sizeof(uint64_t), matrixFileSectionAlignment);
+        h.valuesOffset = offset;
+        offset += uint64_t(nonZeros) * valueSize;
+    }
+    h.fileSize = offset;
+    return h;
+}
+
+MatrixFileHeader kss::math::_private::readMatrixFileHeader(const MappedFile& file) {
+    const string& path = file.path();
+    MatrixFileHeader h;
+    if (file.size() < sizeof(h)) {
+        invalid(path, "is too small to be a matrix file");
+    }
+    memcpy(&h, file.data(), sizeof(h));
+    if (memcmp(h.magic, magic, sizeof(magic)) != 0) {
+        invalid(path, "is not a kssmath matrix file");
+    }
+    if (h.byteOrder != byteOrderMark) {
+        invalid(path, "was written with a different byte order");
+    }
+    if (h.version != currentVersion) {
+        invalid(path, "has an unsupported version");
+    }
+
+    // Recompute the layout from the dimensions and check that it matches, which
+    // also guarantees that every section is within the file.
+    const auto kind = static_cast<MatrixFileKind>(h.kind);
+    const auto valueType = static_cast<MatrixFileValueType>(h.valueType);
+    if ((kind != MatrixFileKind::Dense && kind != MatrixFileKind::Sparse)
+        || (valueType == MatrixFileValueType::Float32 && h.valueSize != 4)
+        || (valueType == MatrixFileValueType::Float64 && h.valueSize != 8)
+        || (valueType != MatrixFileValueType::Float32 && valueType != MatrixFileValueType::Float64))
+    {
+        invalid(path, "has an unsupported kind or value type");
+    }
+    if (h.rows > maxDimension || h.cols > maxDimension || h.nonZeros > maxEntries
+        || (h.cols > 0 && (h.rows + matrixFileColumnAlignment) > maxEntries / h.cols))
+    {
+        invalid(path, "has invalid dimensions");
+    }
+    const MatrixFileHeader expected = matrixFileLayout(kind, valueType, h.valueSize, size_t(h.rows),
+                                                       size_t(h.cols), size_t(h.nonZeros));
+    if (memcmp(&h, &expected, sizeof(h)) != 0 || h.fileSize > file.size()) {
+        invalid(path, "has an inconsistent header or is truncated");
+    }
+
+    // Only the ends of the row pointers are checked, so that opening the file does
+    // not need to read the whole structure.
+    if (kind == MatrixFileKind::Sparse) {
+        uint64_t first, last;
+        memcpy(&first, file.data() + h.rowPointersOffset, sizeof(first));
+        memcpy(&last, file.data() + h.rowPointersOffset + h.rows * sizeof(uint64_t), sizeof(last));
+        if (first != 0 || last != h.nonZeros) {
+            invalid(path, "has inconsistent row pointers");
+        }
+    }
+    return h;
+}
+
+MatrixFile::MatrixFile(const string& path, const MatrixFileHeader& header)
+: _file(MappedFile::create(path, size_t(header.fileSize))), _header(header)
+{
+    memcpy(_file.mutableData(), &_header, sizeof(_header));
+}
@@ -0,0 +1,388 @@
+//
+//  matrix_file.hpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#ifndef kssmath_matrix_file_hpp
+#define kssmath_matrix_file_hpp
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "mapped_file.hpp"
+#include "matrix.hpp"
+#include "parallel.hpp"
+#include "sparse_matrix.hpp"
+#include "tuning.hpp"
+
+namespace kss { namespace math {
+
+    /*!
+     The kinds of matrix stored in a MatrixFile.
+     */
+    enum class MatrixFileKind : std::uint32_t {
+        Dense = 1,  ///< Column major, each column aligned to matrixFileColumnAlignment bytes.
+        Sparse = 2  ///< CSR with 64 bit row pointers and column indices.
+    };
+
+    /*!
+     The value types that may be stored in a MatrixFile.
+     */
+    enum class MatrixFileValueType : std::uint32_t {
+        Float32 = 1,
+        Float64 = 2
+    };
+
+    /*!
+     The sections of a MatrixFile start on this boundary, which is a multiple of
+     the page size on all the supported systems.
+     */
+    constexpr std::size_t matrixFileSectionAlignment = 4096;
+
+    /*!
+     Each column of a dense MatrixFile starts on this boundary (a cache line, and
+     the width of the widest SIMD registers), so the leading dimension may be
+     larger than the number of rows.
+     */
+    constexpr std::size_t matrixFileColumnAlignment = 64;
+
+    namespace _private {
+
+        // The header at the start of a matrix file. All offsets are in bytes from
+        // the start of the file. The file is in the byte order of the machine that
+        // wrote it, recorded by byteOrder.
+        struct MatrixFileHeader {
+            char            magic[8];
+            std::uint32_t   version;
+            std::uint32_t   byteOrder;
+            std::uint32_t   kind;
+            std::uint32_t   valueType;
+            std::uint32_t   valueSize;
+            std::uint32_t   reserved;
+            std::uint64_t   rows;
+            std::uint64_t   cols;
+            std::uint64_t   nonZeros;
+            std::uint64_t   leadingDimension;
+            std::uint64_t   valuesOffset;
+            std::uint64_t   rowPointersOffset;
+            std::uint64_t   columnIndicesOffset;
+            std::uint64_t   fileSize;
+        };
+        static_assert(sizeof(MatrixFileHeader) == 96, "MatrixFileHeader must have no padding");
+
+        template <class T> struct MatrixFileValue;
+        template <> struct MatrixFileValue<float> {
+            static constexpr MatrixFileValueType type = MatrixFileValueType::Float32;
+        };
+        template <> struct MatrixFileValue<double> {
+            static constexpr MatrixFileValueType type = MatrixFileValueType::Float64;
+        };
+
+        // The header for a new file, with the section offsets and file size filled in.
+        MatrixFileHeader matrixFileLayout(MatrixFileKind kind, MatrixFileValueType valueType,
+                                          std::size_t valueSize, std::size_t rows, std::size_t cols,
+                                          std::size_t nonZeros);
+
+        // Returns the header of a mapped file.
+        // @throws std::runtime_error if it is not a valid matrix file.
+        MatrixFileHeader readMatrixFileHeader(const MappedFile& file);
+
+    }
+
+    /*!
+     A view of a column major dense matrix that the view does not own, such as the
+     contents of a MatrixFile. T may be const.
+     */
+    template <class T>
+    class DenseMatrixView {
+    public:
+        using value_type = typename std::remove_const<T>::type;
+        using size_type = std::size_t;
+
+        DenseMatrixView() = default;
+        DenseMatrixView(size_type rows, size_type cols, size_type ld, T* data) noexcept
+        : _rows(rows), _cols(cols), _ld(ld), _data(data) {}
+
+        size_type rows() const noexcept { return _rows; }
+        size_type cols() const noexcept { return _cols; }
+        size_type leadingDimension() const noexcept { return _ld; }
+        T* data() const noexcept { return _data; }
+        T* column(size_type j) const noexcept { return _data + j * _ld; }
+        T& operator()(size_type i, size_type j) const noexcept { return _data[i + j * _ld]; }
+
+        /*!
+         Returns the sub-view of rows [i0, i0+m) and columns [j0, j0+n).
+         @throws std::out_of_range if the block is outside the view.
+         */
+        DenseMatrixView block(size_type i0, size_type j0, size_type m, size_type n) const {
+            if (i0 + m > _rows || j0 + n > _cols) {
+                throw std::out_of_range("DenseMatrixView::block: block is outside the matrix");
+            }
+            return DenseMatrixView(m, n, _ld, _data + i0 + j0 * _ld);
+        }
+
+        /*!
+         Returns a copy of the viewed matrix in memory.
+         */
+        Matrix<value_type> toMatrix() const {
+            Matrix<value_type> res(_rows, _cols);
+            for (size_type j = 0; j < _cols; ++j) {
+                std::copy(column(j), column(j) + _rows, res.column(j));
+            }
+            return res;
+        }
+
+    private:
+        size_type   _rows = 0;
+        size_type   _cols = 0;
+        size_type   _ld = 0;
+        T*          _data = nullptr;
+    };
+
+    /*!
+     A view of a CSR sparse matrix that the view does not own, such as the
+     contents of a MatrixFile. The indices are 64 bit. T may be const.
+     */
+    template <class T>
+    class SparseMatrixView {
+    public:
+        using value_type = typename std::remove_const<T>::type;
+        using size_type = std::size_t;
+        using index_type = typename std::conditional<std::is_const<T>::value,
+                                                     const std::uint64_t, std::uint64_t>::type;
+
+        SparseMatrixView() = default;
+        SparseMatrixView(size_type rows, size_type cols, index_type* rowPointers, index_type* columnIndices,
+                         T* values) noexcept
+        : _rows(rows), _cols(cols), _rowPtr(rowPointers), _colIdx(columnIndices), _values(values) {}
+
+        size_type rows() const noexcept { return _rows; }
+        size_type cols() const noexcept { return _cols; }
+        size_type nonZeros() const noexcept { return (_rowPtr == nullptr ? 0 : size_type(_rowPtr[_rows])); }
+        index_type* rowPointers() const noexcept { return _rowPtr; }
+        index_type* columnIndices() const noexcept { return _colIdx; }
+        T* values() const noexcept { return _values; }
+
+        /*!
+         Computes y = A*x, splitting the rows over the given number of threads.
+         */
+        void multiply(const value_type* x, value_type* y, unsigned threads = 0) const {
+            parallelFor(_rows, tuningParameters().spmvChunkRows, [&](std::size_t r0, std::size_t r1) {
+                for (size_type i = r0; i < r1; ++i) {
+                    value_type sum = value_type(0);
+                    for (size_type k = size_type(_rowPtr[i]); k < size_type(_rowPtr[i + 1]); ++k) {
+                        sum += _values[k] * x[_colIdx[k]];
+                    }
+                    y[i] = sum;
+                }
+            }, threads);
+        }
+
+        /*!
+         Returns a copy of the viewed matrix in memory.
+         @throws std::invalid_argument if the viewed arrays are not a valid CSR
+            matrix.
+         */
+        SparseMatrix<value_type> toSparseMatrix() const {
+            const size_type nnz = nonZeros();
+            return SparseMatrix<value_type>(_rows, _cols,
+                                            std::vector<size_type>(_rowPtr, _rowPtr + (_rowPtr ? _rows + 1 : 0)),
+                                            std::vector<size_type>(_colIdx, _colIdx + nnz),
+                                            std::vector<value_type>(_values, _values + nnz));
+        }
+
+    private:
+        size_type   _rows = 0;
+        size_type   _cols = 0;
+        index_type* _rowPtr = nullptr;
+        index_type* _colIdx = nullptr;
+        T*          _values = nullptr;
+    };
+
+    /*!
+     A matrix stored in the kssmath binary matrix file format and mapped into
+     memory. The file starts with a fixed header, followed by the data sections,
+     each aligned to matrixFileSectionAlignment: for a dense matrix the values in
+     column major order with each column aligned to matrixFileColumnAlignment
+     bytes, and for a sparse matrix the CSR row pointers, column indices and
+     values.
+
+     Opening a file only reads and checks the header, so it takes the same time
+     for any size of matrix, and the views returned by denseView and sparseView
+     refer directly to the mapped data. Only the pages that an algorithm touches
+     are read from disk, and advise() can be used to prefetch or release ranges.
+     */
+    class MatrixFile {
+    public:
+        using size_type = std::size_t;
+
+        /*!
+         Open an existing matrix file.
+         @throws std::system_error if the file cannot be opened or mapped.
+         @throws std::runtime_error if it is not a valid matrix file.
+         */
+        explicit MatrixFile(const std::string& path, MappedFile::Mode mode = MappedFile::Mode::ReadOnly)
+        : _file(path, mode), _header(_private::readMatrixFileHeader(_file)) {}
+
+        /*!
+         Create a writable file for a rows x cols dense matrix of zeros, to be
+         filled through mutableDenseView().
+         @throws std::system_error if the file cannot be created.
+         */
+        template <class T>
+        static MatrixFile createDense(const std::string& path, size_type rows, size_type cols) {
+            return MatrixFile(path, _private::matrixFileLayout(MatrixFileKind::Dense,
+                                                               _private::MatrixFileValue<T>::type,
+                                                               sizeof(T), rows, cols, 0));
+        }
+
+        /*!
+         Create a writable file for a rows x cols sparse matrix with the given number
+         of entries, to be filled through mutableSparseView(). The row pointers are
+         initially all zero, and must be set to a valid CSR structure before the
+         file is opened again.
+         @throws std::system_error if the file cannot be created.
+         */
+        template <class T>
+        static MatrixFile createSparse(const std::string& path, size_type rows, size_type cols, size_type nonZeros) {
+            return MatrixFile(path, _private::matrixFileLayout(MatrixFileKind::Sparse,
+                                                               _private::MatrixFileValue<T>::type,
+                                                               sizeof(T), rows, cols, nonZeros));
+        }
+
+        /*!
+         Write a dense matrix to a new file.
+         @throws std::system_error if the file cannot be written.
+         */
+        template <class T>
+        static void write(const std::string& path, const Matrix<T>& a) {
+            MatrixFile f = createDense<T>(path, a.rows(), a.cols());
+            const auto view = f.mutableDenseView<T>();
+            for (size_type j = 0; j < a.cols(); ++j) {
+                std::copy(a.column(j), a.column(j) + a.rows(), view.column(j));
+            }
+            f.sync();
+        }
+
+        /*!
+         Write a sparse matrix to a new file.
+         @throws std::system_error if the file cannot be written.
+         */
+        template <class T>
+        static void write(const std::string& path, const SparseMatrix<T>& a) {
+            MatrixFile f = createSparse<T>(path, a.rows(), a.cols(), a.nonZeros());
+            const auto view = f.mutableSparseView<T>();
+            std::copy(a.rowPointers().begin(), a.rowPointers().end(), view.rowPointers());
+            std::copy(a.columnIndices().begin(), a.columnIndices().end(), view.columnIndices());
+            std::copy(a.values().begin(), a.values().end(), view.values());
+            f.sync();
+        }
+
+        MatrixFileKind kind() const noexcept { return MatrixFileKind(_header.kind); }
+        MatrixFileValueType valueType() const noexcept { return MatrixFileValueType(_header.valueType); }
+        size_type rows() const noexcept { return size_type(_header.rows); }
+        size_type cols() const noexcept { return size_type(_header.cols); }
+        size_type nonZeros() const noexcept { return size_type(_header.nonZeros); }
+        const MappedFile& mappedFile() const noexcept { return _file; }
+
+        /*!
+         Returns a read only view of a dense matrix.
+         @throws std::invalid_argument if the file is not a dense matrix of T.
+         */
+        template <class T>
+        DenseMatrixView<const T> denseView() const {
+            check<T>(MatrixFileKind::Dense);
+            return DenseMatrixView<const T>(rows(), cols(), size_type(_header.leadingDimension),
+                                            section<const T>(_header.valuesOffset));
+        }
+
+        /*!
+         Returns a writable view of a dense matrix.
+         @throws std::invalid_argument if the file is not a dense matrix of T.
+         @throws std::logic_error if the file is not writable.
+         */
+        template <class T>
+        DenseMatrixView<T> mutableDenseView() {
+            check<T>(MatrixFileKind::Dense);
+            return DenseMatrixView<T>(rows(), cols(), size_type(_header.leadingDimension),
+                                      mutableSection<T>(_header.valuesOffset));
+        }
+
+        /*!
+         Returns a read only view of a sparse matrix.
+         @throws std::invalid_argument if the file is not a sparse matrix of T.
+         */
+        template <class T>
+        SparseMatrixView<const T> sparseView() const {
+            check<T>(MatrixFileKind::Sparse);
+            return SparseMatrixView<const T>(rows(), cols(), section<const std::uint64_t>(_header.rowPointersOffset),
+                                             section<const std::uint64_t>(_header.columnIndicesOffset),
+                                             section<const T>(_header.valuesOffset));
+        }
+
+        /*!
+         Returns a writable view of a sparse matrix.
+         @throws std::invalid_argument if the file is not a sparse matrix of T.
+         @throws std::logic_error if the file is not writable.
+         */
+        template <class T>
+        SparseMatrixView<T> mutableSparseView() {
+            check<T>(MatrixFileKind::Sparse);
+            return SparseMatrixView<T>(rows(), cols(), mutableSection<std::uint64_t>(_header.rowPointersOffset),
+                                       mutableSection<std::uint64_t>(_header.columnIndicesOffset),
+                                       mutableSection<T>(_header.valuesOffset));
+        }
+
+        /*!
+         Give the operating system a hint about the access to [p, p+length), which
+         must be within the file's data (see MappedFile::advise).
+         */
+        void advise(const void* p, size_type length, MappedFile::Access access) const noexcept {
+            MappedFile::advise(p, length, access);
+        }
+
+        /*!
+         Write any modified pages back to the file.
+         @throws std::system_error if the write fails.
+         */
+        void sync() const { _file.sync(); }
+
+    private:
+        MappedFile                  _file;
+        _private::MatrixFileHeader  _header;
+
+        MatrixFile(const std::string& path, const _private::MatrixFileHeader& header);
+
+        template <class T>
+        void check(MatrixFileKind k) const {
+            if (kind() != k) {
+                throw std::invalid_argument("MatrixFile: " + _file.path() + " does not hold a matrix of that kind");
+            }
+            if (valueType() != _private::MatrixFileValue<T>::type) {
+                throw std::invalid_argument("MatrixFile: " + _file.path() + " does not hold values of that type");
+            }
+        }
+
+        template <class T>
+        T* section(std::uint64_t offset) const noexcept {
+            return reinterpret_cast<T*>(_file.data() + offset);
+        }
+
+        template <class T>
+        T* mutableSection(std::uint64_t offset) {
+            return reinterpret_cast<T*>(_file.mutableData() + offset);
+        }
+    };
+
+}}
+
+#endif
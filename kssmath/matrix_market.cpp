@@ -0,0 +1,353 @@
+//
+//  matrix_market.cpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+#include "mapped_file.hpp"
+#include "matrix_market.hpp"
+#include "parallel.hpp"
+
+using namespace std;
+using namespace kss::math;
+using kss::math::_private::MatrixMarketData;
+
+
+namespace {
+
+    // The target size of the chunks of text parsed by each task.
+    constexpr size_t chunkBytes = size_t(1) << 20;
+
+    [[noreturn]] void invalid(const string& path, const string& why) {
+        throw runtime_error("readMatrixMarket: " + path + " " + why);
+    }
+
+    inline bool isBlank(char c) noexcept {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    inline const char* skipBlanks(const char* p, const char* end) noexcept {
+        while (p < end && isBlank(*p)) {
+            ++p;
+        }
+        return p;
+    }
+
+    inline const char* endOfLine(const char* p, const char* end) noexcept {
+        const void* nl = memchr(p, '\n', size_t(end - p));
+        return nl ? static_cast<const char*>(nl) : end;
+    }
+
+    // True if the line [p, eol) holds data, rather than being empty or a comment.
+    inline bool isDataLine(const char* p, const char* eol) noexcept {
+        p = skipBlanks(p, eol);
+        return p < eol && *p != '%';
+    }
+
+    // Parse an unsigned decimal integer, advancing p past it.
+    bool parseIndex(const char*& p, const char* end, uint64_t& value) noexcept {
+        const char* s = p;
+        uint64_t v = 0;
+        while (p < end && *p >= '0' && *p <= '9') {
+            if (v > (UINT64_MAX - 9) / 10) {
+                return false;
+            }
+            v = v * 10 + uint64_t(*p - '0');
+            ++p;
+        }
+        value = v;
+        return p > s;
+    }
+
+    const double exactPowersOfTen[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    // Parse a floating point number, advancing p past it. Numbers of up to 15
+    // significant digits with a small exponent, which covers nearly everything
+    // written to Matrix Market files, are converted exactly with a single
+    // multiplication or division by a power of ten (both operands are exact, so
+    // the result is correctly rounded). Anything else falls back to strtod.
+    bool parseValue(const char*& p, const char* end, double& value) noexcept {
+        const char* s = p;
+        const char* q = p;
+        bool negative = false;
+        if (q < end && (*q == '-' || *q == '+')) {
+            negative = (*q == '-');
+            ++q;
+        }
+        uint64_t mantissa = 0;
+        int digits = 0;
+        int exponent = 0;
+        bool any = false;
+        for (; q < end && *q >= '0' && *q <= '9'; ++q) {
+            any = true;
+            if (digits < 19) {
+                mantissa = mantissa * 10 + uint64_t(*q - '0');
+                digits += (mantissa != 0);
+            }
+            else {
+                ++exponent;
+                digits = 20;
+            }
+        }
+        if (q < end && *q == '.') {
+            for (++q; q < end && *q >= '0' && *q <= '9'; ++q) {
+                any = true;
+                if (digits < 19) {
+                    mantissa = mantissa * 10 + uint64_t(*q - '0');
+                    digits += (mantissa != 0);
+                    --exponent;
+                }
+                else {
+                    digits = 20;
+                }
+            }
+        }
+        if (any && q < end && (*q == 'e' || *q == 'E')) {
+            const char* e = q + 1;
+            bool negativeExponent = false;
+            if (e < end && (*e == '-' || *e == '+')) {
+                negativeExponent = (*e == '-');
+                ++e;
+            }
+            uint64_t x = 0;
+            if (parseIndex(e, end, x)) {
+                const int ex = int(std::min<uint64_t>(x, 100000));
+                exponent += (negativeExponent ? -ex : ex);
+                q = e;
+            }
+            else {
+                any = false;
+            }
+        }
+        const bool terminated = (q == end || isBlank(*q) || *q == '\n');
+        if (any && terminated && digits <= 15 && exponent >= -22 && exponent <= 22) {
+            double v = double(mantissa);
+            v = (exponent < 0 ? v / exactPowersOfTen[-exponent] : v * exactPowersOfTen[exponent]);
+            value = (negative ? -v : v);
+            p = q;
+            return true;
+        }
+
+        // The slow path, for long or unusual numbers (including inf and nan).
+        const char* t = s;
+        while (t < end && !isBlank(*t) && *t != '\n') {
+            ++t;
+        }
+        char buffer[128];
+        if (t == s || size_t(t - s) >= sizeof(buffer)) {
+            return false;
+        }
+        memcpy(buffer, s, size_t(t - s));
+        buffer[t - s] = '\0';
+        char* last = nullptr;
+        value = strtod(buffer, &last);
+        if (last != buffer + (t - s)) {
+            return false;
+        }
+        p = t;
+        return true;
+    }
+
+    string lowerCase(string s) {
+        transform(s.begin(), s.end(), s.begin(), [](char c) { return char(tolower(c)); });
+        return s;
+    }
+
+    // Parse the banner, the comments and the size line, returning the start of the
+    // entries.
+    const char* parseHeader(const char* p, const char* end, const string& path, MatrixMarketHeader& h) {
+        const char* eol = endOfLine(p, end);
+        char banner[5][32] = {};
+        const string first(p, eol);
+        if (sscanf(first.c_str(), "%31s %31s %31s %31s %31s", banner[0], banner[1], banner[2], banner[3],
+                   banner[4]) != 5
+            || lowerCase(banner[0]) != "%%matrixmarket" || lowerCase(banner[1]) != "matrix")
+        {
+            invalid(path, "is not a Matrix Market matrix file");
+        }
+
+        const string format = lowerCase(banner[2]);
+        const string field = lowerCase(banner[3]);
+        const string symmetry = lowerCase(banner[4]);
+        if (format == "coordinate") { h.format = MatrixMarketFormat::Coordinate; }
+        else if (format == "array") { h.format = MatrixMarketFormat::Array; }
+        else { invalid(path, "has an unknown format " + format); }
+        if (field == "real" || field == "double") { h.field = MatrixMarketField::Real; }
+        else if (field == "integer") { h.field = MatrixMarketField::Integer; }
+        else if (field == "pattern" && h.format == MatrixMarketFormat::Coordinate) {
+            h.field = MatrixMarketField::Pattern;
+        }
+        else { invalid(path, "has an unsupported field " + field); }
+        if (symmetry == "general") { h.symmetry = MatrixMarketSymmetry::General; }
+        else if (symmetry == "symmetric") { h.symmetry = MatrixMarketSymmetry::Symmetric; }
+        else if (symmetry == "skew-symmetric") { h.symmetry = MatrixMarketSymmetry::SkewSymmetric; }
+        else { invalid(path, "has an unsupported symmetry " + symmetry); }
+
+        p = eol;
+        for (;;) {
+            if (p == end) {
+                invalid(path, "has no size line");
+            }
+            ++p;
+            eol = endOfLine(p, end);
+            if (isDataLine(p, eol)) {
+                break;
+            }
+            p = eol;
+        }
+
+        uint64_t dims[3] = { 0, 0, 0 };
+        const int count = (h.format == MatrixMarketFormat::Coordinate ? 3 : 2);
+        for (int i = 0; i < count; ++i) {
+            p = skipBlanks(p, eol);
+            if (!parseIndex(p, eol, dims[i])) {
+                invalid(path, "has an invalid size line");
+            }
+        }
+        if (skipBlanks(p, eol) != eol) {
+            invalid(path, "has an invalid size line");
+        }
+        h.rows = size_t(dims[0]);
+        h.cols = size_t(dims[1]);
+        if (h.symmetry != MatrixMarketSymmetry::General && h.rows != h.cols) {
+            invalid(path, "is symmetric but not square");
+        }
+        if (h.format == MatrixMarketFormat::Coordinate) {
+            h.entries = size_t(dims[2]);
+        }
+        else if (h.symmetry == MatrixMarketSymmetry::General) {
+            h.entries = h.rows * h.cols;
+        }
+        else if (h.symmetry == MatrixMarketSymmetry::Symmetric) {
+            h.entries = h.rows * (h.rows + 1) / 2;
+        }
+        else {
+            h.entries = h.rows * (h.rows - std::min<size_t>(h.rows, 1)) / 2;
+        }
+        return eol;
+    }
+
+    // Parse the data lines of [p, end) into the entries starting at k.
+    void parseChunk(const char* p, const char* end, size_t k, MatrixMarketData& d, const string& path) {
+        const MatrixMarketHeader& h = d.header;
+        const bool coordinate = (h.format == MatrixMarketFormat::Coordinate);
+        const bool pattern = (h.field == MatrixMarketField::Pattern);
+        while (p < end) {
+            const char* eol = endOfLine(p, end);
+            if (isDataLine(p, eol)) {
+                bool ok = true;
+                if (coordinate) {
+                    uint64_t i = 0, j = 0;
+                    p = skipBlanks(p, eol);
+                    ok = parseIndex(p, eol, i);
+                    p = skipBlanks(p, eol);
+                    ok = ok && parseIndex(p, eol, j);
+                    if (ok && (i == 0 || i > h.rows || j == 0 || j > h.cols)) {
+                        invalid(path, "has an entry outside the matrix");
+                    }
+                    d.rows[k] = size_t(i - 1);
+                    d.cols[k] = size_t(j - 1);
+                }
+                if (ok && !pattern) {
+                    p = skipBlanks(p, eol);
+                    ok = parseValue(p, eol, d.values[k]);
+                }
+                if (!ok || skipBlanks(p, eol) != eol) {
+                    invalid(path, "has an invalid entry");
+                }
+                ++k;
+            }
+            p = eol + 1;
+        }
+    }
+
+}
+
+
+MatrixMarketData kss::math::_private::readMatrixMarket(const string& path, unsigned threads) {
+    const MappedFile file(path);
+    const char* begin = file.data();
+    const char* end = begin + file.size();
+    MappedFile::advise(begin, file.size(), MappedFile::Access::Sequential);
+
+    MatrixMarketData d;
+    if (begin == nullptr) {
+        invalid(path, "is not a Matrix Market matrix file");
+    }
+    const char* body = parseHeader(begin, end, path, d.header);
+
+    // Split the entries into chunks at line boundaries, count the data lines of
+    // each chunk, and then parse each chunk into its own range of the arrays.
+    const size_t bytes = size_t(end - body);
+    const size_t chunks = std::max<size_t>(1, bytes / chunkBytes);
+    vector<const char*> bounds(chunks + 1, end);
+    bounds[0] = body;
+    for (size_t c = 1; c < chunks; ++c) {
+        const char* p = std::max(bounds[c - 1], body + c * (bytes / chunks));
+        bounds[c] = std::min(end, endOfLine(p, end) + 1);
+    }
+    vector<size_t> offsets(chunks + 1, 0);
+    parallelFor(chunks, 1, [&](size_t c0, size_t c1) {
+        for (size_t c = c0; c < c1; ++c) {
+            size_t count = 0;
+            for (const char* p = bounds[c]; p < bounds[c + 1];) {
+                const char* eol = endOfLine(p, bounds[c + 1]);
+                count += isDataLine(p, eol);
+                p = eol + 1;
+            }
+            offsets[c + 1] = count;
+        }
+    }, threads);
+    for (size_t c = 0; c < chunks; ++c) {
+        offsets[c + 1] += offsets[c];
+    }
+    if (offsets[chunks] != d.header.entries) {
+        invalid(path, "does not have the number of entries given by its size line");
+    }
+
+    if (d.header.format == MatrixMarketFormat::Coordinate) {
+        d.rows.resize(d.header.entries);
+        d.cols.resize(d.header.entries);
+    }
+    if (d.header.field != MatrixMarketField::Pattern) {
+        d.values.resize(d.header.entries);
+    }
+    parallelFor(chunks, 1, [&](size_t c0, size_t c1) {
+        for (size_t c = c0; c < c1; ++c) {
+            parseChunk(bounds[c], bounds[c + 1], offsets[c], d, path);
+        }
+    }, threads);
+    return d;
+}
+
+void kss::math::_private::writeTextFile(const string& path, const vector<string>& chunks) {
+    FILE* f = fopen(path.c_str(), "wb");
+    if (f == nullptr) {
+        throw system_error(errno, generic_category(), "writeMatrixMarket: cannot create " + path);
+    }
+    bool ok = true;
+    for (const auto& s : chunks) {
+        ok = ok && fwrite(s.data(), 1, s.size(), f) == s.size();
+    }
+    const int err = errno;
+    ok = (fclose(f) == 0) && ok;
+    if (!ok) {
+        throw system_error(err ? err : errno, generic_category(), "writeMatrixMarket: cannot write " + path);
+    }
+}
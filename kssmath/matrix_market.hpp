@@ -0,0 +1,262 @@
+//
+//  matrix_market.hpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#ifndef kssmath_matrix_market_hpp
+#define kssmath_matrix_market_hpp
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "matrix.hpp"
+#include "parallel.hpp"
+#include "sparse_matrix.hpp"
+
+namespace kss { namespace math {
+
+    enum class MatrixMarketFormat { Coordinate, Array };
+    enum class MatrixMarketField { Real, Integer, Pattern };
+    enum class MatrixMarketSymmetry { General, Symmetric, SkewSymmetric };
+
+    /*!
+     The banner and size line of a Matrix Market file. For the coordinate format
+     entries is the number of entries stored in the file, which for a symmetric
+     matrix is only those in the lower triangle.
+     */
+    struct MatrixMarketHeader {
+        MatrixMarketFormat      format = MatrixMarketFormat::Coordinate;
+        MatrixMarketField       field = MatrixMarketField::Real;
+        MatrixMarketSymmetry    symmetry = MatrixMarketSymmetry::General;
+        std::size_t             rows = 0;
+        std::size_t             cols = 0;
+        std::size_t             entries = 0;
+    };
+
+    namespace _private {
+
+        // The contents of a Matrix Market file as stored: the zero based row and
+        // column of each coordinate entry (empty for the array format) and the
+        // values (empty for a pattern matrix).
+        struct MatrixMarketData {
+            MatrixMarketHeader          header;
+            std::vector<std::size_t>    rows;
+            std::vector<std::size_t>    cols;
+            std::vector<double>         values;
+        };
+
+        // Read and parse a file, splitting the entries into chunks that are parsed
+        // in parallel.
+        // @throws std::system_error if the file cannot be read.
+        // @throws std::runtime_error if it is not a valid Matrix Market file.
+        MatrixMarketData readMatrixMarket(const std::string& path, unsigned threads);
+
+        // Write the text chunks, in order, to a new file.
+        // @throws std::system_error if the file cannot be written.
+        void writeTextFile(const std::string& path, const std::vector<std::string>& chunks);
+
+        // Format the lines of a file in parallel, in chunks of up to chunkSize
+        // lines, with format(i, buffer) appending line i. The header is the first
+        // of the returned chunks.
+        template <class Format>
+        std::vector<std::string> formatLines(std::string header, std::size_t lines, std::size_t chunkSize,
+                                             unsigned threads, const Format& format)
+        {
+            const std::size_t chunks = (lines + chunkSize - 1) / chunkSize;
+            std::vector<std::string> res(chunks + 1);
+            res[0] = std::move(header);
+            parallelFor(chunks, 1, [&](std::size_t c0, std::size_t c1) {
+                for (std::size_t c = c0; c < c1; ++c) {
+                    std::string& buffer = res[c + 1];
+                    const std::size_t last = std::min(lines, (c + 1) * chunkSize);
+                    for (std::size_t i = c * chunkSize; i < last; ++i) {
+                        format(i, buffer);
+                    }
+                }
+            }, threads);
+            return res;
+        }
+
+        template <class T>
+        void appendValue(std::string& buffer, T value) {
+            char s[40];
+            const int n = std::snprintf(s, sizeof(s), "%.*g", std::numeric_limits<T>::max_digits10, double(value));
+            buffer.append(s, std::size_t(n));
+        }
+
+        inline void appendIndex(std::string& buffer, std::size_t i) {
+            char s[24];
+            std::size_t n = sizeof(s);
+            do {
+                s[--n] = char('0' + i % 10);
+                i /= 10;
+            } while (i > 0);
+            buffer.append(s + n, sizeof(s) - n);
+        }
+
+        // Convert the values of a file to T, where a pattern matrix has all ones.
+        template <class T>
+        T matrixMarketValue(const MatrixMarketData& d, std::size_t k) noexcept {
+            return d.header.field == MatrixMarketField::Pattern ? T(1) : T(d.values[k]);
+        }
+
+    }
+
+    /*!
+     Read a sparse matrix from a Matrix Market file. Symmetric and skew symmetric
+     matrices are expanded to both triangles, and a file in the array format is
+     converted, keeping its nonzero entries. The file is mapped into memory and
+     its entries are parsed in parallel chunks.
+     @throws std::system_error if the file cannot be read.
+     @throws std::runtime_error if it is not a valid Matrix Market file, or holds a
+        complex or Hermitian matrix.
+     */
+    template <class T>
+    SparseMatrix<T> readSparseMatrixMarket(const std::string& path, unsigned threads = 0) {
+        const _private::MatrixMarketData d = _private::readMatrixMarket(path, threads);
+        if (d.header.format == MatrixMarketFormat::Array) {
+            const std::size_t rows = d.header.rows;
+            std::vector<Triplet<T>> entries;
+            std::size_t k = 0;
+            for (std::size_t j = 0; j < d.header.cols; ++j) {
+                std::size_t i0 = 0;
+                if (d.header.symmetry != MatrixMarketSymmetry::General) {
+                    i0 = (d.header.symmetry == MatrixMarketSymmetry::Symmetric ? j : j + 1);
+                }
+                for (std::size_t i = i0; i < rows; ++i, ++k) {
+                    const T v = _private::matrixMarketValue<T>(d, k);
+                    if (v != T(0)) {
+                        entries.push_back(Triplet<T> { i, j, v });
+                        if (i != j && d.header.symmetry != MatrixMarketSymmetry::General) {
+                            entries.push_back(Triplet<T> {
+                                j, i, d.header.symmetry == MatrixMarketSymmetry::Symmetric ? v : -v });
+                        }
+                    }
+                }
+            }
+            return SparseMatrix<T>::fromTriplets(rows, d.header.cols, entries);
+        }
+
+        const bool general = (d.header.symmetry == MatrixMarketSymmetry::General);
+        const T sign = (d.header.symmetry == MatrixMarketSymmetry::SkewSymmetric ? T(-1) : T(1));
+        std::vector<Triplet<T>> entries;
+        entries.reserve(general ? d.rows.size() : 2 * d.rows.size());
+        for (std::size_t k = 0; k < d.rows.size(); ++k) {
+            const T v = _private::matrixMarketValue<T>(d, k);
+            entries.push_back(Triplet<T> { d.rows[k], d.cols[k], v });
+            if (!general && d.rows[k] != d.cols[k]) {
+                entries.push_back(Triplet<T> { d.cols[k], d.rows[k], sign * v });
+            }
+        }
+        return SparseMatrix<T>::fromTriplets(d.header.rows, d.header.cols, entries);
+    }
+
+    /*!
+     Read a dense matrix from a Matrix Market file in either format. Symmetric and
+     skew symmetric matrices are expanded to both triangles.
+     @throws std::system_error if the file cannot be read.
+     @throws std::runtime_error if it is not a valid Matrix Market file, or holds a
+        complex or Hermitian matrix.
+     */
+    template <class T>
+    Matrix<T> readDenseMatrixMarket(const std::string& path, unsigned threads = 0) {
+        const _private::MatrixMarketData d = _private::readMatrixMarket(path, threads);
+        const MatrixMarketSymmetry symmetry = d.header.symmetry;
+        const T sign = (symmetry == MatrixMarketSymmetry::SkewSymmetric ? T(-1) : T(1));
+        Matrix<T> res(d.header.rows, d.header.cols);
+        if (d.header.format == MatrixMarketFormat::Array) {
+            std::size_t k = 0;
+            for (std::size_t j = 0; j < res.cols(); ++j) {
+                std::size_t i0 = 0;
+                if (symmetry != MatrixMarketSymmetry::General) {
+                    i0 = (symmetry == MatrixMarketSymmetry::Symmetric ? j : j + 1);
+                }
+                for (std::size_t i = i0; i < res.rows(); ++i, ++k) {
+                    res(i, j) = _private::matrixMarketValue<T>(d, k);
+                    if (i != j && symmetry != MatrixMarketSymmetry::General) {
+                        res(j, i) = sign * res(i, j);
+                    }
+                }
+            }
+        }
+        else {
+            for (std::size_t k = 0; k < d.rows.size(); ++k) {
+                const T v = _private::matrixMarketValue<T>(d, k);
+                res(d.rows[k], d.cols[k]) += v;
+                if (symmetry != MatrixMarketSymmetry::General && d.rows[k] != d.cols[k]) {
+                    res(d.cols[k], d.rows[k]) += sign * v;
+                }
+            }
+        }
+        return res;
+    }
+
+    /*!
+     Write a sparse matrix to a Matrix Market file in the general real coordinate
+     format. Values are written with enough digits to be read back exactly, and
+     the lines are formatted in parallel.
+     @throws std::system_error if the file cannot be written.
+     */
+    template <class T>
+    void writeMatrixMarket(const std::string& path, const SparseMatrix<T>& a, unsigned threads = 0) {
+        std::string header = "%%MatrixMarket matrix coordinate real general\n";
+        _private::appendIndex(header, a.rows());
+        header += ' ';
+        _private::appendIndex(header, a.cols());
+        header += ' ';
+        _private::appendIndex(header, a.nonZeros());
+        header += '\n';
+        const auto& ptr = a.rowPointers();
+        const auto& idx = a.columnIndices();
+        const auto& val = a.values();
+        const auto chunks = _private::formatLines(std::move(header), a.rows(), 4096, threads,
+                                                  [&](std::size_t i, std::string& buffer) {
+            for (std::size_t k = ptr[i]; k < ptr[i + 1]; ++k) {
+                _private::appendIndex(buffer, i + 1);
+                buffer += ' ';
+                _private::appendIndex(buffer, idx[k] + 1);
+                buffer += ' ';
+                _private::appendValue(buffer, val[k]);
+                buffer += '\n';
+            }
+        });
+        _private::writeTextFile(path, chunks);
+    }
+
+    /*!
+     Write a dense matrix to a Matrix Market file in the general real array
+     format. Values are written with enough digits to be read back exactly, and
+     the lines are formatted in parallel.
+     @throws std::system_error if the file cannot be written.
+     */
+    template <class T>
+    void writeMatrixMarket(const std::string& path, const Matrix<T>& a, unsigned threads = 0) {
+        std::string header = "%%MatrixMarket matrix array real general\n";
+        _private::appendIndex(header, a.rows());
+        header += ' ';
+        _private::appendIndex(header, a.cols());
+        header += '\n';
+        const std::size_t chunkSize = std::max<std::size_t>(1, 65536 / std::max<std::size_t>(a.rows(), 1));
+        const auto chunks = _private::formatLines(std::move(header), a.cols(), chunkSize, threads,
+                                                  [&](std::size_t j, std::string& buffer) {
+            for (std::size_t i = 0; i < a.rows(); ++i) {
+                _private::appendValue(buffer, a(i, j));
+                buffer += '\n';
+            }
+        });
+        _private::writeTextFile(path, chunks);
+    }
+
+}}
+
+#endif
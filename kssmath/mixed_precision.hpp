@@ -0,0 +1,232 @@
+//
+//  mixed_precision.hpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#ifndef kssmath_mixed_precision_hpp
+#define kssmath_mixed_precision_hpp
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "blas.hpp"
+#include "error.hpp"
+#include "lu.hpp"
+#include "matrix.hpp"
+
+namespace kss { namespace math {
+
+    /*!
+     Options controlling the iterative refinement in MixedPrecisionSolver.
+     */
+    struct RefinementOptions {
+        /*!
+         Maximum number of refinement steps before falling back to a full precision
+         factorization.
+         */
+        unsigned maxIterations = 30;
+
+        /*!
+         If a refinement step fails to reduce the residual norm by at least this
+         factor, the iteration is considered stalled and the solver falls back.
+         */
+        double stallRatio = 0.5;
+    };
+
+    /*!
+     The result of a mixed precision solve.
+     */
+    template <class T>
+    struct RefinementResult {
+        std::vector<T>  x;                      ///< The solution.
+        unsigned        iterations = 0;         ///< Number of refinement steps taken.
+        bool            usedFallback = false;   ///< True if the full precision path was used.
+        T               backwardError = T(0);   ///< ||b-Ax|| / (||A|| ||x|| + ||b||), infinity norms.
+    };
+
+    /*!
+     Solves Ax = b by factoring A in the Low precision and refining the solution in
+     the High precision via residual correction. Since the O(n^3) factorization
+     runs at the lower precision it is roughly twice as fast, while the O(n^2)
+     refinement steps recover a High precision answer for reasonably conditioned
+     systems.
+
+     If the low precision factorization fails (e.g. A overflows or is singular in
+     Low), or the refinement stalls, the solver automatically factors A in High
+     precision and solves directly. That factorization is retained so subsequent
+     solves go straight to it.
+
+     The factorization is shared by all calls to solve, so an instance may be used
+     for many right hand sides. Instances are not safe to use concurrently since the
+     fallback factorization is created lazily.
+     */
+    template <class Low = float, class High = double>
+    class MixedPrecisionSolver {
+    public:
+        using size_type = std::size_t;
+
+        /*!
+         Prepare to solve systems involving a.
+         @throws std::invalid_argument if a is not square.
+         */
+        explicit MixedPrecisionSolver(const Matrix<High>& a, const RefinementOptions& opts = RefinementOptions())
+        : _a(a), _opts(opts)
+        {
+            if (!_a.isSquare()) {
+                throw std::invalid_argument("MixedPrecisionSolver: matrix must be square");
+            }
+            _anorm = infinityNorm(_a);
+            try {
+                _low.reset(new LU<Low>(Matrix<Low>(_a)));
+            }
+            catch (const SingularMatrixError&) {
+                _low.reset();
+            }
+        }
+
+        size_type size() const noexcept { return _a.rows(); }
+
+        /*!
+         Returns true if the low precision factorization is still in use (i.e. no
+         fallback has been required yet).
+         */
+        bool usingLowPrecision() const noexcept { return bool(_low) && !_high; }
+
+        /*!
+         Solve Ax = b.
+         @throws std::invalid_argument if b is the wrong length.
+         @throws SingularMatrixError if A is singular even in the High precision.
+         */
+        RefinementResult<High> solve(const std::vector<High>& b) {
+            const size_type n = size();
+            if (b.size() != n) {
+                throw std::invalid_argument("MixedPrecisionSolver::solve: b has the wrong length");
+            }
+
+            RefinementResult<High> res;
+            const High bnorm = blas::amax(n, b.data());
+            if (_low && !_high) {
+                if (refine(b, bnorm, res)) {
+                    return res;
+                }
+            }
+
+            // Fallback path.
+            if (!_high) {
+                _high.reset(new LU<High>(_a));
+            }
+            res.usedFallback = true;
+            res.x = _high->solve(b);
+            std::vector<High> r(n);
+            res.backwardError = residual(b, res.x, r, bnorm);
+            return res;
+        }
+
+    private:
+        Matrix<High>                _a;
+        RefinementOptions           _opts;
+        High                        _anorm = High(0);
+        std::unique_ptr<LU<Low>>    _low;
+        std::unique_ptr<LU<High>>   _high;
+
+        static High infinityNorm(const Matrix<High>& a) {
+            std::vector<High> rowsum(a.rows(), High(0));
+            for (size_type j = 0; j < a.cols(); ++j) {
+                const High* col = a.column(j);
+                for (size_type i = 0; i < a.rows(); ++i) {
+                    rowsum[i] += std::abs(col[i]);
+                }
+            }
+            return blas::amax(rowsum.size(), rowsum.data());
+        }
+
+        // Computes r = b - Ax and returns the normwise backward error.
+        High residual(const std::vector<High>& b, const std::vector<High>& x, std::vector<High>& r, High bnorm) const {
+            const size_type n = size();
+            r = b;
+            blas::gemv(n, n, High(-1), _a.data(), n, x.data(), High(1), r.data());
+            const High denom = _anorm * blas::amax(n, x.data()) + bnorm;
+            const High rnorm = blas::amax(n, r.data());
+            return denom == High(0) ? rnorm : rnorm / denom;
+        }
+
+        // Solve A d = v using the low precision factors. The vector is scaled to unit
+        // infinity norm before the conversion so that small residuals do not
+        // underflow in Low. Returns false if the result is not finite.
+        bool lowSolve(const std::vector<High>& v, std::vector<High>& d, std::vector<Low>& work) const {
+            const size_type n = size();
+            const High scale = blas::amax(n, v.data());
+            if (scale == High(0)) {
+                std::fill(d.begin(), d.end(), High(0));
+                return true;
+            }
+            for (size_type i = 0; i < n; ++i) {
+                work[i] = static_cast<Low>(v[i] / scale);
+            }
+            _low->solveInPlace(work.data());
+            for (size_type i = 0; i < n; ++i) {
+                if (!std::isfinite(work[i])) {
+                    return false;
+                }
+                d[i] = static_cast<High>(work[i]) * scale;
+            }
+            return true;
+        }
+
+        // Returns true if the refinement converged, false if a fallback is needed.
+        bool refine(const std::vector<High>& b, High bnorm, RefinementResult<High>& res) const {
+            const size_type n = size();
+            const High tolerance = std::numeric_limits<High>::epsilon() * std::sqrt(static_cast<High>(n));
+            std::vector<Low> work(n);
+            std::vector<High> r(n), d(n);
+
+            res.x.assign(n, High(0));
+            if (!lowSolve(b, res.x, work)) {
+                return false;
+            }
+
+            High prevNorm = std::numeric_limits<High>::infinity();
+            for (res.iterations = 0; ; ++res.iterations) {
+                res.backwardError = residual(b, res.x, r, bnorm);
+                if (res.backwardError <= tolerance) {
+                    return true;
+                }
+                const High rnorm = blas::amax(n, r.data());
+                if (res.iterations >= _opts.maxIterations
+                    || !std::isfinite(rnorm)
+                    || rnorm > static_cast<High>(_opts.stallRatio) * prevNorm)
+                {
+                    return false;
+                }
+                prevNorm = rnorm;
+                if (!lowSolve(r, d, work)) {
+                    return false;
+                }
+                blas::axpy(n, High(1), d.data(), res.x.data());
+            }
+        }
+    };
+
+    /*!
+     Convenience function that solves a single system Ax = b using mixed precision
+     iterative refinement.
+     */
+    template <class Low = float, class High = double>
+    RefinementResult<High> solveMixedPrecision(const Matrix<High>& a, const std::vector<High>& b,
+                                               const RefinementOptions& opts = RefinementOptions())
+    {
+        MixedPrecisionSolver<Low, High> solver(a, opts);
+        return solver.solve(b);
+    }
+
+}}
+
+#endif
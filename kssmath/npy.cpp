@@ -0,0 +1,498 @@
+//
+//  npy.cpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#include "npy.hpp"
+
+using namespace std;
+using namespace kss::math;
+using kss::math::_private::NpyEntry;
+
+
+namespace {
+
+    const char npyMagic[6] = { '\x93', 'N', 'U', 'M', 'P', 'Y' };
+
+    constexpr uint32_t localHeaderSignature = 0x04034b50;
+    constexpr uint32_t centralHeaderSignature = 0x02014b50;
+    constexpr uint32_t endOfDirectorySignature = 0x06054b50;
+    constexpr uint32_t zip64EndOfDirectorySignature = 0x06064b50;
+    constexpr uint32_t zip64LocatorSignature = 0x07064b50;
+    constexpr uint32_t zip64Limit = 0xffffffff;
+
+    // The alignment of the array data in the files that we write.
+    constexpr size_t dataAlignment = 64;
+
+    [[noreturn]] void invalid(const string& path, const string& why) {
+        throw runtime_error("NpyArray: " + path + " " + why);
+    }
+
+    bool isLittleEndian() noexcept {
+        const uint16_t one = 1;
+        unsigned char c;
+        memcpy(&c, &one, 1);
+        return c == 1;
+    }
+
+    // The zip and .npy headers are little endian regardless of the machine.
+    uint64_t getLE(const char* p, size_t bytes) noexcept {
+        uint64_t v = 0;
+        for (size_t i = bytes; i-- > 0;) {
+            v = (v << 8) | uint64_t(static_cast<unsigned char>(p[i]));
+        }
+        return v;
+    }
+
+    size_t elementSize(NpyValueType type) noexcept {
+        return (type == NpyValueType::Float32 || type == NpyValueType::Int32) ? 4 : 8;
+    }
+
+    string typeDescription(NpyValueType type) {
+        const char order = (isLittleEndian() ? '<' : '>');
+        switch (type) {
+        case NpyValueType::Float32:     return string(1, order) + "f4";
+        case NpyValueType::Float64:     return string(1, order) + "f8";
+        case NpyValueType::Int32:       return string(1, order) + "i4";
+        case NpyValueType::Int64:       return string(1, order) + "i8";
+        }
+        return string();
+    }
+
+    // Returns the text following "'key':" in the header dictionary.
+    const char* findKey(const string& header, const char* key, const string& name) {
+        const size_t pos = header.find(string("'") + key + "'");
+        if (pos == string::npos) {
+            invalid(name, string("has no ") + key + " in its header");
+        }
+        const size_t colon = header.find(':', pos);
+        if (colon == string::npos) {
+            invalid(name, "has an invalid header");
+        }
+        const char* p = header.c_str() + colon + 1;
+        while (*p == ' ') {
+            ++p;
+        }
+        return p;
+    }
+
+    // The .npy header: the magic string, the version, the length of the header
+    // dictionary, and the dictionary itself padded with spaces and a newline so
+    // that the data starts on an aligned offset.
+    string npyHeader(const NpyEntry& e) {
+        string dict = "{'descr': '" + typeDescription(e.type) + "', 'fortran_order': True, 'shape': ("
+            + to_string(e.rows) + ", " + to_string(e.cols) + "), }";
+        const size_t fixed = sizeof(npyMagic) + 4;
+        const size_t length = (fixed + dict.size() + 1 + dataAlignment - 1) / dataAlignment * dataAlignment;
+        dict.append(length - fixed - dict.size() - 1, ' ');
+        dict += '\n';
+        string res(npyMagic, sizeof(npyMagic));
+        res += char(1);
+        res += char(0);
+        res += char(dict.size() & 0xff);
+        res += char(dict.size() >> 8);
+        return res + dict;
+    }
+
+    uint32_t crc32(uint32_t crc, const char* p, size_t n) noexcept {
+        static const struct Table {
+            uint32_t entries[256];
+            Table() noexcept {
+                for (uint32_t i = 0; i < 256; ++i) {
+                    uint32_t c = i;
+                    for (int k = 0; k < 8; ++k) {
+                        c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+                    }
+                    entries[i] = c;
+                }
+            }
+        } table;
+        crc = ~crc;
+        for (size_t i = 0; i < n; ++i) {
+            crc = table.entries[(crc ^ static_cast<unsigned char>(p[i])) & 0xff] ^ (crc >> 8);
+        }
+        return ~crc;
+    }
+
+    // A file being written, with little endian output of the zip fields.
+    class Writer {
+    public:
+        Writer(const string& path) : _path(path), _file(fopen(path.c_str(), "wb")) {
+            if (_file == nullptr) {
+                throw system_error(errno, generic_category(), "writeNpy: cannot create " + path);
+            }
+        }
+
+        ~Writer() noexcept {
+            if (_file != nullptr) {
+                fclose(_file);
+            }
+        }
+
+        uint64_t offset() const noexcept { return _offset; }
+
+        void bytes(const void* p, size_t n) {
+            if (n > 0 && fwrite(p, 1, n, _file) != n) {
+                fail();
+            }
+            _offset += n;
+        }
+
+        void put(uint64_t v, size_t n) {
+            char s[8];
+            for (size_t i = 0; i < n; ++i) {
+                s[i] = char((v >> (8 * i)) & 0xff);
+            }
+            bytes(s, n);
+        }
+
+        void close() {
+            FILE* f = _file;
+            _file = nullptr;
+            if (fclose(f) != 0) {
+                fail();
+            }
+        }
+
+    private:
+        string      _path;
+        FILE*       _file;
+        uint64_t    _offset = 0;
+
+        [[noreturn]] void fail() {
+            throw system_error(errno, generic_category(), "writeNpy: cannot write " + _path);
+        }
+    };
+
+    size_t dataBytes(const NpyEntry& e) noexcept {
+        return e.rows * e.cols * elementSize(e.type);
+    }
+
+    // Locate the central directory of a zip archive from its end record, which
+    // for a large archive refers to a zip64 end record.
+    void findDirectory(const char* data, size_t size, const string& path, uint64_t& offset,
+                       uint64_t& length, uint64_t& count)
+    {
+        const size_t minimum = 22;
+        if (size < minimum) {
+            invalid(path, "is not a zip archive");
+        }
+        size_t eocd = size - minimum;
+        const size_t first = (size > minimum + 65535 ? size - minimum - 65535 : 0);
+        while (getLE(data + eocd, 4) != endOfDirectorySignature) {
+            if (eocd == first) {
+                invalid(path, "is not a zip archive");
+            }
+            --eocd;
+        }
+        count = getLE(data + eocd + 10, 2);
+        length = getLE(data + eocd + 12, 4);
+        offset = getLE(data + eocd + 16, 4);
+        if ((count == 0xffff || length == zip64Limit || offset == zip64Limit)
+            && eocd >= 20 && getLE(data + eocd - 20, 4) == zip64LocatorSignature)
+        {
+            const uint64_t z = getLE(data + eocd - 20 + 8, 8);
+            if (z > size - 56 || getLE(data + z, 4) != zip64EndOfDirectorySignature) {
+                invalid(path, "has an invalid zip64 end record");
+            }
+            count = getLE(data + z + 32, 8);
+            length = getLE(data + z + 40, 8);
+            offset = getLE(data + z + 48, 8);
+        }
+        if (offset > size || length > size - offset) {
+            invalid(path, "has an invalid central directory");
+        }
+    }
+
+}
+
+
+NpyArray kss::math::_private::parseNpy(shared_ptr<const void> owner, const char* data, size_t length,
+                                       const string& name)
+{
+    if (length < 10 || memcmp(data, npyMagic, sizeof(npyMagic)) != 0) {
+        invalid(name, "is not a .npy array");
+    }
+    const int major = static_cast<unsigned char>(data[6]);
+    if (major < 1 || major > 3) {
+        invalid(name, "has an unsupported .npy version");
+    }
+    const size_t fixed = (major == 1 ? 10 : 12);
+    const size_t headerLength = (length < fixed ? 0 : size_t(getLE(data + 8, fixed - 8)));
+    if (length < fixed || headerLength > length - fixed) {
+        invalid(name, "has a truncated header");
+    }
+    const string header(data + fixed, headerLength);
+
+    NpyArray res;
+    const char* descr = findKey(header, "descr", name);
+    if (*descr != '\'' && *descr != '"') {
+        invalid(name, "has an invalid descr");
+    }
+    const char order = descr[1];
+    const string type(descr + 2, strcspn(descr + 2, "'\""));
+    if (!(order == '=' || order == '|' || order == (isLittleEndian() ? '<' : '>'))) {
+        invalid(name, "has an unsupported byte order");
+    }
+    if (type == "f4") { res._type = NpyValueType::Float32; }
+    else if (type == "f8") { res._type = NpyValueType::Float64; }
+    else if (type == "i4") { res._type = NpyValueType::Int32; }
+    else if (type == "i8") { res._type = NpyValueType::Int64; }
+    else { invalid(name, "has an unsupported type " + type); }
+
+    res._fortranOrder = (strncmp(findKey(header, "fortran_order", name), "True", 4) == 0);
+
+    const char* p = findKey(header, "shape", name);
+    if (*p != '(') {
+        invalid(name, "has an invalid shape");
+    }
+    uint64_t elements = 1;
+    for (++p; *p != ')'; ) {
+        if (*p == ' ' || *p == ',') {
+            ++p;
+            continue;
+        }
+        char* last = nullptr;
+        const unsigned long long n = strtoull(p, &last, 10);
+        if (last == p || (n > 0 && elements > UINT64_MAX / n)) {
+            invalid(name, "has an invalid shape");
+        }
+        elements *= n;
+        res._shape.push_back(size_t(n));
+        p = last;
+    }
+
+    const size_t offset = fixed + headerLength;
+    const size_t size = elementSize(res._type);
+    if (elements > (length - offset) / size) {
+        invalid(name, "is truncated");
+    }
+
+    // Use the data in place if it is aligned for its type, as it always is in a
+    // .npy file, otherwise (possible for a member of an .npz archive) copy it.
+    res._data = data + offset;
+    res._zeroCopy = (reinterpret_cast<uintptr_t>(res._data) % size == 0);
+    if (res._zeroCopy) {
+        res._owner = move(owner);
+    }
+    else {
+        auto copy = make_shared<vector<char>>(res._data, res._data + elements * size);
+        res._data = copy->data();
+        res._owner = move(copy);
+    }
+    return res;
+}
+
+NpyArray kss::math::readNpy(const string& path) {
+    const auto file = make_shared<const MappedFile>(path);
+    return _private::parseNpy(file, file->data(), file->size(), path);
+}
+
+map<string, NpyArray> kss::math::readNpz(const string& path) {
+    const auto file = make_shared<const MappedFile>(path);
+    const char* data = file->data();
+    const size_t size = file->size();
+    uint64_t offset = 0, length = 0, count = 0;
+    findDirectory(data, size, path, offset, length, count);
+
+    map<string, NpyArray> res;
+    const char* p = data + offset;
+    const char* end = p + length;
+    for (uint64_t i = 0; i < count; ++i) {
+        if (end - p < 46 || getLE(p, 4) != centralHeaderSignature) {
+            invalid(path, "has an invalid central directory");
+        }
+        const uint64_t flags = getLE(p + 8, 2);
+        const uint64_t method = getLE(p + 10, 2);
+        uint64_t compressed = getLE(p + 20, 4);
+        uint64_t uncompressed = getLE(p + 24, 4);
+        const size_t nameLength = size_t(getLE(p + 28, 2));
+        const size_t extraLength = size_t(getLE(p + 30, 2));
+        const size_t commentLength = size_t(getLE(p + 32, 2));
+        uint64_t local = getLE(p + 42, 4);
+        if (size_t(end - p) < 46 + nameLength + extraLength + commentLength) {
+            invalid(path, "has an invalid central directory");
+        }
+        string name(p + 46, nameLength);
+
+        // The zip64 extra field holds, in order, those of the sizes and offset that
+        // did not fit in their 32 bit fields.
+        const char* extraEnd = p + 46 + nameLength + extraLength;
+        for (const char* x = p + 46 + nameLength; x + 4 <= extraEnd;) {
+            const uint64_t id = getLE(x, 2);
+            const size_t n = size_t(getLE(x + 2, 2));
+            if (n > size_t(extraEnd - x - 4)) {
+                invalid(path, "has an invalid extra field for " + name);
+            }
+            if (id == 1) {
+                // Each value must lie within the n bytes of the field.
+                const char* f = x + 4;
+                auto next = [&]() {
+                    if (f + 8 > x + 4 + n) {
+                        invalid(path, "has an invalid zip64 extra field for " + name);
+                    }
+                    const uint64_t value = getLE(f, 8);
+                    f += 8;
+                    return value;
+                };
+                if (uncompressed == zip64Limit) { uncompressed = next(); }
+                if (compressed == zip64Limit) { compressed = next(); }
+                if (local == zip64Limit) { local = next(); }
+            }
+            x += 4 + n;
+        }
+        p += 46 + nameLength + extraLength + commentLength;
+
+        if ((flags & 1) != 0 || method != 0) {
+            invalid(path, "has a compressed or encrypted member " + name);
+        }
+        if (local > size - 30 || getLE(data + local, 4) != localHeaderSignature) {
+            invalid(path, "has an invalid local header for " + name);
+        }
+        const uint64_t start = local + 30 + getLE(data + local + 26, 2) + getLE(data + local + 28, 2);
+        if (start > size || compressed > size - start) {
+            invalid(path, "has a truncated member " + name);
+        }
+        if (name.size() > 4 && name.compare(name.size() - 4, 4, ".npy") == 0) {
+            name.resize(name.size() - 4);
+        }
+        res[name] = _private::parseNpy(file, data + start, size_t(compressed), path + ":" + name);
+    }
+    return res;
+}
+
+void kss::math::_private::writeNpy(const string& path, const NpyEntry& entry) {
+    const string header = npyHeader(entry);
+    Writer w(path);
+    w.bytes(header.data(), header.size());
+    w.bytes(entry.data, dataBytes(entry));
+    w.close();
+}
+
+void kss::math::_private::writeNpz(const string& path, const vector<NpyEntry>& entries) {
+    const uint64_t dosDate = 0x21;  // 1980-01-01, the earliest a zip file can hold.
+    const uint16_t paddingId = 0x6b73;
+
+    struct Member {
+        string      name;
+        uint32_t    crc;
+        uint64_t    size;
+        uint64_t    offset;
+        bool        zip64;
+    };
+    vector<Member> members;
+    Writer w(path);
+    for (const auto& e : entries) {
+        const string header = npyHeader(e);
+        const size_t bytes = dataBytes(e);
+        Member m;
+        m.name = e.name + ".npy";
+        m.crc = crc32(crc32(0, header.data(), header.size()), static_cast<const char*>(e.data), bytes);
+        m.size = header.size() + bytes;
+        m.offset = w.offset();
+        m.zip64 = (m.size >= zip64Limit || m.offset >= zip64Limit);
+
+        // Pad the extra field so that the member starts on an aligned offset, and
+        // so its array data does too.
+        const size_t zip64Extra = (m.zip64 ? 20 : 0);
+        const size_t fixed = 30 + m.name.size() + zip64Extra + 4;
+        const size_t padding = (dataAlignment - (m.offset + fixed) % dataAlignment) % dataAlignment;
+
+        w.put(localHeaderSignature, 4);
+        w.put(m.zip64 ? 45 : 20, 2);
+        w.put(0, 2);
+        w.put(0, 2);
+        w.put(0, 2);
+        w.put(dosDate, 2);
+        w.put(m.crc, 4);
+        w.put(m.zip64 ? zip64Limit : m.size, 4);
+        w.put(m.zip64 ? zip64Limit : m.size, 4);
+        w.put(m.name.size(), 2);
+        w.put(zip64Extra + 4 + padding, 2);
+        w.bytes(m.name.data(), m.name.size());
+        if (m.zip64) {
+            w.put(1, 2);
+            w.put(16, 2);
+            w.put(m.size, 8);
+            w.put(m.size, 8);
+        }
+        w.put(paddingId, 2);
+        w.put(padding, 2);
+        w.bytes(string(padding, '\0').data(), padding);
+        w.bytes(header.data(), header.size());
+        w.bytes(e.data, bytes);
+        members.push_back(move(m));
+    }
+
+    const uint64_t directory = w.offset();
+    for (const auto& m : members) {
+        w.put(centralHeaderSignature, 4);
+        w.put(m.zip64 ? 45 : 20, 2);
+        w.put(m.zip64 ? 45 : 20, 2);
+        w.put(0, 2);
+        w.put(0, 2);
+        w.put(0, 2);
+        w.put(dosDate, 2);
+        w.put(m.crc, 4);
+        w.put(m.zip64 ? zip64Limit : m.size, 4);
+        w.put(m.zip64 ? zip64Limit : m.size, 4);
+        w.put(m.name.size(), 2);
+        w.put(m.zip64 ? 28 : 0, 2);
+        w.put(0, 2);
+        w.put(0, 2);
+        w.put(0, 2);
+        w.put(0, 4);
+        w.put(m.zip64 ? zip64Limit : m.offset, 4);
+        w.bytes(m.name.data(), m.name.size());
+        if (m.zip64) {
+            w.put(1, 2);
+            w.put(24, 2);
+            w.put(m.size, 8);
+            w.put(m.size, 8);
+            w.put(m.offset, 8);
+        }
+    }
+
+    const uint64_t directoryLength = w.offset() - directory;
+    const bool zip64 = (members.size() >= 0xffff || directory >= zip64Limit || directoryLength >= zip64Limit);
+    if (zip64) {
+        const uint64_t record = w.offset();
+        w.put(zip64EndOfDirectorySignature, 4);
+        w.put(44, 8);
+        w.put(45, 2);
+        w.put(45, 2);
+        w.put(0, 4);
+        w.put(0, 4);
+        w.put(members.size(), 8);
+        w.put(members.size(), 8);
+        w.put(directoryLength, 8);
+        w.put(directory, 8);
+        w.put(zip64LocatorSignature, 4);
+        w.put(0, 4);
+        w.put(record, 8);
+        w.put(1, 4);
+    }
+    w.put(endOfDirectorySignature, 4);
+    w.put(0, 2);
+    w.put(0, 2);
+    w.put(zip64 ? 0xffff : members.size(), 2);
+    w.put(zip64 ? 0xffff : members.size(), 2);
+    w.put(zip64 ? zip64Limit : directoryLength, 4);
+    w.put(zip64 ? zip64Limit : directory, 4);
+    w.put(0, 2);
+    w.close();
+}
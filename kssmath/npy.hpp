@@ -0,0 +1,219 @@
+//
+//  npy.hpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#ifndef kssmath_npy_hpp
+#define kssmath_npy_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "mapped_file.hpp"
+#include "matrix.hpp"
+#include "matrix_file.hpp"
+
+namespace kss { namespace math {
+
+    /*!
+     The element types of NumPy arrays that can be read.
+     */
+    enum class NpyValueType { Float32, Float64, Int32, Int64 };
+
+    class NpyArray;
+
+    namespace _private {
+
+        template <class T> struct NpyValue;
+        template <> struct NpyValue<float> {
+            static constexpr NpyValueType type = NpyValueType::Float32;
+        };
+        template <> struct NpyValue<double> {
+            static constexpr NpyValueType type = NpyValueType::Float64;
+        };
+
+        // An array to be written: a column major rows x cols matrix of the given
+        // type, stored as a 2-D array in Fortran order.
+        struct NpyEntry {
+            std::string     name;
+            NpyValueType    type;
+            std::size_t     rows;
+            std::size_t     cols;
+            const void*     data;
+        };
+
+        // Parse the .npy data in [data, data+length), which is owned by owner.
+        // @throws std::runtime_error if it is not a valid or supported .npy array.
+        NpyArray parseNpy(std::shared_ptr<const void> owner, const char* data, std::size_t length,
+                          const std::string& name);
+
+        // @throws std::system_error if the file cannot be written.
+        void writeNpy(const std::string& path, const NpyEntry& entry);
+        void writeNpz(const std::string& path, const std::vector<NpyEntry>& entries);
+
+    }
+
+    /*!
+     An array read from a NumPy .npy file or a member of an .npz archive. The
+     file is mapped into memory, and when the data is suitably aligned (always for
+     .npy files, and for .npz members written by writeNpz) the array refers
+     directly to the mapped data instead of holding a copy.
+
+     Arrays of up to two dimensions are treated as matrices: a 1-D array of length
+     n is an n x 1 column and a 0-D array is 1 x 1. An array in Fortran (column
+     major) order can be viewed directly as a DenseMatrixView; one in C order is
+     the transpose of that and has to be copied by toMatrix.
+
+     NpyArray is cheap to copy, and the copies share the data.
+     */
+    class NpyArray {
+    public:
+        using size_type = std::size_t;
+
+        NpyArray() = default;
+
+        NpyValueType valueType() const noexcept { return _type; }
+        const std::vector<size_type>& shape() const noexcept { return _shape; }
+        bool isFortranOrder() const noexcept { return _fortranOrder; }
+
+        /*!
+         Returns true if the data is the mapped file rather than a copy.
+         */
+        bool isZeroCopy() const noexcept { return _zeroCopy; }
+
+        /*!
+         Returns the number of rows and columns of the array as a matrix.
+         @throws std::invalid_argument if the array has more than two dimensions.
+         */
+        size_type rows() const {
+            checkMatrix();
+            return _shape.empty() ? 1 : _shape[0];
+        }
+
+        size_type cols() const {
+            checkMatrix();
+            return _shape.size() < 2 ? 1 : _shape[1];
+        }
+
+        /*!
+         Returns a view of the data without copying it.
+         @throws std::invalid_argument if the array is not of type T, has more than
+            two dimensions, or is a 2-D array in C order (with more than one row and
+            column).
+         */
+        template <class T>
+        DenseMatrixView<const T> denseView() const {
+            if (_type != _private::NpyValue<T>::type) {
+                throw std::invalid_argument("NpyArray::denseView: array has a different value type");
+            }
+            if (!_fortranOrder && rows() > 1 && cols() > 1) {
+                throw std::invalid_argument("NpyArray::denseView: array is in C order");
+            }
+            return DenseMatrixView<const T>(rows(), cols(), rows(), reinterpret_cast<const T*>(_data));
+        }
+
+        /*!
+         Returns a copy of the array as a matrix of T, converting the values and
+         transposing an array in C order.
+         @throws std::invalid_argument if the array has more than two dimensions.
+         */
+        template <class T>
+        Matrix<T> toMatrix() const {
+            switch (_type) {
+            case NpyValueType::Float32:    return convert<T, float>();
+            case NpyValueType::Float64:    return convert<T, double>();
+            case NpyValueType::Int32:      return convert<T, std::int32_t>();
+            case NpyValueType::Int64:      return convert<T, std::int64_t>();
+            }
+            return Matrix<T>();
+        }
+
+    private:
+        std::shared_ptr<const void> _owner;
+        const char*                 _data = nullptr;
+        NpyValueType                _type = NpyValueType::Float64;
+        std::vector<size_type>      _shape;
+        bool                        _fortranOrder = false;
+        bool                        _zeroCopy = false;
+
+        friend NpyArray _private::parseNpy(std::shared_ptr<const void>, const char*, std::size_t,
+                                           const std::string&);
+
+        void checkMatrix() const {
+            if (_shape.size() > 2) {
+                throw std::invalid_argument("NpyArray: array has more than two dimensions");
+            }
+        }
+
+        template <class T, class U>
+        Matrix<T> convert() const {
+            Matrix<T> res(rows(), cols());
+            const size_type m = res.rows(), n = res.cols();
+            for (size_type j = 0; j < n; ++j) {
+                for (size_type i = 0; i < m; ++i) {
+                    U v;
+                    std::memcpy(&v, _data + (_fortranOrder ? i + j * m : j + i * n) * sizeof(U), sizeof(U));
+                    res(i, j) = T(v);
+                }
+            }
+            return res;
+        }
+    };
+
+    /*!
+     Read a NumPy .npy file. Little endian float32, float64, int32 and int64 arrays
+     are supported (on a big endian machine, big endian ones).
+     @throws std::system_error if the file cannot be read.
+     @throws std::runtime_error if it is not a valid or supported .npy file.
+     */
+    NpyArray readNpy(const std::string& path);
+
+    /*!
+     Read the arrays of a NumPy .npz archive, keyed by their names (without the
+     .npy suffix). Only uncompressed archives, as written by numpy.savez, are
+     supported; numpy.savez_compressed archives would need a deflate decoder.
+     @throws std::system_error if the file cannot be read.
+     @throws std::runtime_error if it is not a valid or supported archive.
+     */
+    std::map<std::string, NpyArray> readNpz(const std::string& path);
+
+    /*!
+     Write a matrix to a .npy file as a 2-D array in Fortran order, which
+     numpy.load reads without a copy and readNpy maps back as a DenseMatrixView.
+     @throws std::system_error if the file cannot be written.
+     */
+    template <class T>
+    void writeNpy(const std::string& path, const Matrix<T>& a) {
+        _private::writeNpy(path, _private::NpyEntry { std::string(), _private::NpyValue<T>::type,
+                                                      a.rows(), a.cols(), a.data() });
+    }
+
+    /*!
+     Write matrices to an uncompressed .npz archive, as numpy.savez would, with
+     the data of each array aligned in the file so that readNpz can map it
+     without a copy.
+     @throws std::system_error if the file cannot be written.
+     */
+    template <class T>
+    void writeNpz(const std::string& path, const std::map<std::string, Matrix<T>>& arrays) {
+        std::vector<_private::NpyEntry> entries;
+        for (const auto& a : arrays) {
+            entries.push_back(_private::NpyEntry { a.first, _private::NpyValue<T>::type,
+                                                   a.second.rows(), a.second.cols(), a.second.data() });
+        }
+        _private::writeNpz(path, entries);
+    }
+
+}}
+
+#endif
@@ -0,0 +1,370 @@
+//
+//  out_of_core.hpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#ifndef kssmath_out_of_core_hpp
+#define kssmath_out_of_core_hpp
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "blas.hpp"
+#include "blocking.hpp"
+#include "cholesky.hpp"
+#include "instrumentation.hpp"
+#include "mapped_file.hpp"
+#include "matrix.hpp"
+#include "matrix_file.hpp"
+#include "parallel.hpp"
+#include "qr.hpp"
+
+namespace kss { namespace math {
+
+    /*!
+     Options for the out of core algorithms.
+     */
+    struct OutOfCoreOptions {
+        /*!
+         The tile size. At most a few tiles (or QR panels of tileSize columns) are
+         in memory at once: the ones being computed on and the ones being read
+         ahead.
+         */
+        std::size_t tileSize = 2048;
+
+        /*!
+         The block size used for the in-memory kernels on each tile.
+         */
+        std::size_t blockSize = 96;
+
+        unsigned    threads = 0;
+    };
+
+    namespace _private {
+
+        // Copy the m x n block at (i0, j0) of a view into memory. The pages of all
+        // the columns are requested first so that the reads are issued together.
+        template <class T, class V>
+        Matrix<T> loadTile(const DenseMatrixView<V>& a, std::size_t i0, std::size_t j0,
+                           std::size_t m, std::size_t n)
+        {
+            for (std::size_t j = 0; j < n; ++j) {
+                MappedFile::advise(a.column(j0 + j) + i0, m * sizeof(T), MappedFile::Access::WillNeed);
+            }
+            Matrix<T> res(m, n);
+            for (std::size_t j = 0; j < n; ++j) {
+                std::copy(a.column(j0 + j) + i0, a.column(j0 + j) + i0 + m, res.column(j));
+            }
+            return res;
+        }
+
+        // Copy a tile back to the block at (i0, j0) of a view. The operating system
+        // writes the modified pages back to the file in the background.
+        template <class T>
+        void storeTile(const Matrix<T>& tile, const DenseMatrixView<T>& a, std::size_t i0, std::size_t j0) {
+            for (std::size_t j = 0; j < tile.cols(); ++j) {
+                std::copy(tile.column(j), tile.column(j) + tile.rows(), a.column(j0 + j) + i0);
+            }
+        }
+
+        // Run a sequence of steps, where step s first reads some tiles (load) and
+        // then computes with them and perhaps writes results back (run). The tiles
+        // of step s+1 are read on another thread while step s computes, so that
+        // the I/O overlaps the computation (double buffering). If step s+1 reads
+        // what step s writes, as given by dependsOnPrevious, its read is started
+        // only once step s has finished.
+        template <class T>
+        void streamSteps(std::size_t steps,
+                         const std::function<std::vector<Matrix<T>>(std::size_t)>& load,
+                         const std::function<bool(std::size_t)>& dependsOnPrevious,
+                         const std::function<void(std::size_t, std::vector<Matrix<T>>&)>& run)
+        {
+            if (steps == 0) {
+                return;
+            }
+            std::future<std::vector<Matrix<T>>> next = std::async(std::launch::async, load, std::size_t(0));
+            for (std::size_t s = 0; s < steps; ++s) {
+                std::vector<Matrix<T>> current = next.get();
+                const bool prefetch = (s + 1 < steps && !dependsOnPrevious(s + 1));
+                if (prefetch) {
+                    next = std::async(std::launch::async, load, s + 1);
+                }
+                run(s, current);
+                if (s + 1 < steps && !prefetch) {
+                    next = std::async(std::launch::async, load, s + 1);
+                }
+            }
+        }
+
+        // C -= A*B' (lower triangle only if lower) for in-memory tiles, with the
+        // columns of C split over the threads.
+        template <class T>
+        void tileUpdate(const Matrix<T>& a, const Matrix<T>& b, Matrix<T>& c, bool lower, unsigned threads) {
+            const std::size_t m = c.rows();
+            const std::size_t k = a.cols();
+            parallelFor(c.cols(), 64, [&](std::size_t j0, std::size_t j1) {
+                if (lower) {
+                    blas::syrkLower(j1 - j0, k, T(-1), a.data() + j0, m, T(1), &c(j0, j0), m);
+                    if (j1 < m) {
+                        blas::gemm(blas::Op::NoTrans, blas::Op::Trans, m - j1, j1 - j0, k, T(-1),
+                                   a.data() + j1, m, b.data() + j0, b.rows(), T(1), &c(j1, j0), m);
+                    }
+                }
+                else {
+                    blas::gemm(blas::Op::NoTrans, blas::Op::Trans, m, j1 - j0, k, T(-1),
+                               a.data(), m, b.data() + j0, b.rows(), T(1), c.column(j0), m);
+                }
+            }, threads);
+        }
+
+    }
+
+    /*!
+     Computes C := alpha*A*B + beta*C for matrices that may be much larger than
+     memory, such as those mapped from a MatrixFile. C is processed one tile at a
+     time, accumulating the products of the matching tiles of A and B, and the
+     tiles for the next product are read from disk while the current one is
+     computed. C must not overlap A or B.
+     @throws std::invalid_argument if the dimensions are not compatible.
+     */
+    template <class T>
+    void outOfCoreGemm(T alpha, const DenseMatrixView<const T>& a, const DenseMatrixView<const T>& b,
+                       T beta, const DenseMatrixView<T>& c, const OutOfCoreOptions& opts = OutOfCoreOptions())
+    {
+        if (a.rows() != c.rows() || b.cols() != c.cols() || a.cols() != b.rows()) {
+            throw std::invalid_argument("outOfCoreGemm: incompatible dimensions");
+        }
+        KSSMATH_INSTRUMENT("outOfCoreGemm", 2.0 * c.rows() * c.cols() * a.cols(),
+                           (double(a.rows()) * a.cols() + double(b.rows()) * b.cols()
+                            + 2.0 * c.rows() * c.cols()) * sizeof(T));
+        const std::size_t nb = std::max<std::size_t>(opts.tileSize, 1);
+        const std::size_t m = c.rows(), n = c.cols(), k = a.cols();
+        const std::size_t mt = (m + nb - 1) / nb, nt = (n + nb - 1) / nb;
+        const std::size_t kt = std::max<std::size_t>((k + nb - 1) / nb, 1);
+        auto dim = [nb](std::size_t total, std::size_t t) { return std::min(nb, total - std::min(total, t * nb)); };
+
+        // Step (i, j, p) multiplies A(i, p) by B(p, j); the first also reads C(i, j).
+        Matrix<T> acc;
+        _private::streamSteps<T>(mt * nt * kt, [&](std::size_t s) {
+            const std::size_t p = s % kt, j = (s / kt) % nt, i = s / (kt * nt);
+            std::vector<Matrix<T>> tiles;
+            tiles.push_back(_private::loadTile<T>(a, i * nb, p * nb, dim(m, i), dim(k, p)));
+            tiles.push_back(_private::loadTile<T>(b, p * nb, j * nb, dim(k, p), dim(n, j)));
+            if (p == 0 && beta != T(0)) {
+                tiles.push_back(_private::loadTile<T>(c, i * nb, j * nb, dim(m, i), dim(n, j)));
+            }
+            return tiles;
+        }, [](std::size_t) { return false; }, [&](std::size_t s, std::vector<Matrix<T>>& tiles) {
+            const std::size_t p = s % kt, j = (s / kt) % nt, i = s / (kt * nt);
+            const Matrix<T>& at = tiles[0];
+            const Matrix<T>& bt = tiles[1];
+            if (p == 0) {
+                if (beta == T(0)) {
+                    acc = Matrix<T>(dim(m, i), dim(n, j));
+                }
+                else {
+                    acc = std::move(tiles[2]);
+                    for (std::size_t q = 0; q < acc.cols(); ++q) {
+                        blas::scal(acc.rows(), beta, acc.column(q));
+                    }
+                }
+            }
+            const std::size_t mc = acc.rows();
+            parallelFor(acc.cols(), 64, [&](std::size_t j0, std::size_t j1) {
+                blas::gemm(blas::Op::NoTrans, blas::Op::NoTrans, mc, j1 - j0, at.cols(), alpha,
+                           at.data(), mc, bt.data() + j0 * bt.rows(), bt.rows(), T(1), acc.column(j0), mc);
+            }, opts.threads);
+            if (p + 1 == kt) {
+                _private::storeTile(acc, c, i * nb, j * nb);
+            }
+        });
+    }
+
+    /*!
+     Computes the Cholesky factorization A = LL' in place for a symmetric positive
+     definite matrix that may be much larger than memory, such as one mapped from
+     a MatrixFile. Only the lower triangle is referenced, and it is overwritten by
+     L; the strictly upper triangle is not modified.
+
+     The left-looking tiled algorithm is used, since it writes each tile of L only
+     once: tile (i, k) is read, updated with the products of the tiles of L to its
+     left, then factored (on the diagonal) or solved against the diagonal tile,
+     and written back. The next pair of tiles is read while the current update is
+     computed.
+     @throws std::invalid_argument if the matrix is not square.
+     @throws NotPositiveDefiniteError if the matrix is not positive definite.
+     */
+    template <class T>
+    void outOfCoreCholesky(const DenseMatrixView<T>& a, const OutOfCoreOptions& opts = OutOfCoreOptions()) {
+        if (a.rows() != a.cols()) {
+            throw std::invalid_argument("outOfCoreCholesky: matrix must be square");
+        }
+        const std::size_t nb = std::max<std::size_t>(opts.tileSize, 1);
+        const std::size_t n = a.rows();
+        const std::size_t nt = (n + nb - 1) / nb;
+        auto dim = [=](std::size_t t) { return std::min(nb, n - t * nb); };
+
+        // Step (k, i, j) reads L(i, j) and L(k, j) for the update of tile (i, k),
+        // and the first (j = 0) also reads A(i, k). Column k = 0 has no updates but
+        // still takes one step per tile.
+        struct Step { std::size_t k, i, j; bool last; };
+        std::vector<Step> steps;
+        for (std::size_t k = 0; k < nt; ++k) {
+            for (std::size_t i = k; i < nt; ++i) {
+                const std::size_t updates = std::max<std::size_t>(k, 1);
+                for (std::size_t j = 0; j < updates; ++j) {
+                    steps.push_back(Step { k, i, j, j + 1 == updates });
+                }
+            }
+        }
+        auto reads = [&](const Step& st, std::size_t i, std::size_t j) {
+            return (st.j == 0 && i == st.i && j == st.k)
+                || (st.k > 0 && j == st.j && (i == st.i || i == st.k));
+        };
+
+        BlockingOptions blocking;
+        blocking.blockSize = opts.blockSize;
+        blocking.threads = opts.threads;
+        Matrix<T> acc, diag;
+        _private::streamSteps<T>(steps.size(), [&](std::size_t s) {
+            const Step& st = steps[s];
+            std::vector<Matrix<T>> tiles;
+            if (st.j == 0) {
+                tiles.push_back(_private::loadTile<T>(a, st.i * nb, st.k * nb, dim(st.i), dim(st.k)));
+            }
+            if (st.k > 0) {
+                tiles.push_back(_private::loadTile<T>(a, st.i * nb, st.j * nb, dim(st.i), dim(st.j)));
+                if (st.i != st.k) {
+                    tiles.push_back(_private::loadTile<T>(a, st.k * nb, st.j * nb, dim(st.k), dim(st.j)));
+                }
+            }
+            return tiles;
+        }, [&](std::size_t s) {
+            const Step& prev = steps[s - 1];
+            return prev.last && reads(steps[s], prev.i, prev.k);
+        }, [&](std::size_t s, std::vector<Matrix<T>>& tiles) {
+            const Step& st = steps[s];
+            std::size_t t = 0;
+            if (st.j == 0) {
+                acc = std::move(tiles[t++]);
+            }
+            if (st.k > 0) {
+                const Matrix<T>& lij = tiles[t];
+                const Matrix<T>& lkj = (st.i == st.k ? tiles[t] : tiles[t + 1]);
+                _private::tileUpdate(lij, lkj, acc, st.i == st.k, opts.threads);
+            }
+            if (!st.last) {
+                return;
+            }
+            if (st.i == st.k) {
+                Cholesky<T> chol(std::move(acc), blocking);
+                diag = chol.factor();
+                acc = diag;
+            }
+            else {
+                const std::size_t mi = acc.rows();
+                parallelFor(mi, 64, [&](std::size_t r0, std::size_t r1) {
+                    blas::trsmRightLowerTrans(r1 - r0, diag.rows(), diag.data(), diag.rows(), &acc(r0, 0), mi);
+                }, opts.threads);
+            }
+
+            // Write only the lower triangle of a diagonal tile.
+            if (st.i == st.k) {
+                for (std::size_t j = 0; j < acc.cols(); ++j) {
+                    std::copy(acc.column(j) + j, acc.column(j) + acc.rows(), a.column(st.k * nb + j) + st.k * nb + j);
+                }
+            }
+            else {
+                _private::storeTile(acc, a, st.i * nb, st.k * nb);
+            }
+        });
+    }
+
+    /*!
+     Computes the Householder QR factorization of an m x n matrix that may be much
+     larger than memory, such as one mapped from a MatrixFile. On return R is in
+     the upper triangle and the Householder vectors are below it, in the same form
+     as QR::factors(), and the returned vector holds the min(m, n) scalar factors
+     of the reflectors.
+
+     The left-looking algorithm is used over panels of tileSize columns, each of
+     which holds all m rows, so a panel (three panels, with the read ahead) must
+     fit in memory. Each panel is read, the reflectors of the panels to its left
+     are applied to it (reading them in turn, with the next one read while the
+     current one is applied), and it is factored and written back once.
+     */
+    template <class T>
+    std::vector<T> outOfCoreQR(const DenseMatrixView<T>& a, const OutOfCoreOptions& opts = OutOfCoreOptions()) {
+        const std::size_t nb = std::max<std::size_t>(opts.tileSize, 1);
+        const std::size_t m = a.rows(), n = a.cols();
+        const std::size_t np = (n + nb - 1) / nb;
+        auto width = [=](std::size_t p) { return std::min(nb, n - p * nb); };
+        std::vector<T> tau(std::min(m, n), T(0));
+
+        // Step (k, j) applies the reflectors of panel j < k to panel k; the first
+        // also reads panel k. Panel 0 only has its one factoring step. Panels that
+        // start below the last row have no reflectors and are not read.
+        struct Step { std::size_t k, j; bool last; };
+        std::vector<Step> steps;
+        for (std::size_t k = 0; k < np; ++k) {
+            const std::size_t applies = std::max<std::size_t>(std::min(k, (m + nb - 1) / nb), 1);
+            for (std::size_t j = 0; j < applies; ++j) {
+                steps.push_back(Step { k, j, j + 1 == applies });
+            }
+        }
+        auto hasReflectors = [&](std::size_t k, std::size_t j) { return k > 0 && j * nb < m; };
+
+        BlockingOptions blocking;
+        blocking.blockSize = opts.blockSize;
+        blocking.threads = opts.threads;
+        Matrix<T> panel;
+        _private::streamSteps<T>(steps.size(), [&](std::size_t s) {
+            const Step& st = steps[s];
+            std::vector<Matrix<T>> tiles;
+            if (st.j == 0) {
+                tiles.push_back(_private::loadTile<T>(a, 0, st.k * nb, m, width(st.k)));
+            }
+            if (hasReflectors(st.k, st.j)) {
+                tiles.push_back(_private::loadTile<T>(a, st.j * nb, st.j * nb, m - st.j * nb, width(st.j)));
+            }
+            return tiles;
+        }, [&](std::size_t s) {
+            const Step& prev = steps[s - 1];
+            return prev.last && hasReflectors(steps[s].k, steps[s].j) && steps[s].j == prev.k;
+        }, [&](std::size_t s, std::vector<Matrix<T>>& tiles) {
+            const Step& st = steps[s];
+            std::size_t t = 0;
+            if (st.j == 0) {
+                panel = std::move(tiles[t++]);
+            }
+            if (hasReflectors(st.k, st.j)) {
+                const Matrix<T>& v = tiles[t];
+                const std::size_t r0 = st.j * nb;
+                const std::size_t reflectors = std::min(v.cols(), v.rows());
+                _private::applyReflectors(true, m - r0, reflectors, 0, v.data(), v.rows(), tau.data() + r0,
+                                          panel.cols(), panel.data() + r0, m, blocking);
+            }
+            if (!st.last) {
+                return;
+            }
+            const std::size_t c0 = st.k * nb;
+            if (c0 < m) {
+                _private::geqrf(m - c0, panel.cols(), panel.data() + c0, m, tau.data() + c0, blocking);
+            }
+            _private::storeTile(panel, a, 0, c0);
+        });
+        return tau;
+    }
+
+}}
+
+#endif
@@ -0,0 +1,353 @@
+//
+//  parallel.cpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#   include <pthread.h>
+#   include <sched.h>
+#endif
+
+#include "parallel.hpp"
+#include "task_graph.hpp"
+
+using namespace std;
+using namespace kss::math;
+
+
+namespace {
+
+    // True on the pool workers, and on a thread while it is running a job on the
+    // pool, so that nested calls run serially rather than wait for workers that
+    // can never become free.
+    thread_local bool inParallel = false;
+
+    // The CPUs the process may run on, in order, or none if this is not known.
+    vector<unsigned> allowedCpus() {
+        vector<unsigned> cpus;
+#if defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for (unsigned cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET(cpu, &set)) {
+                    cpus.push_back(cpu);
+                }
+            }
+        }
+#endif
+        return cpus;
+    }
+
+    const vector<unsigned>& processCpus() {
+        static const vector<unsigned> cpus = allowedCpus();
+        return cpus;
+    }
+
+    // Read the CPUs when the library is loaded, before main can narrow the
+    // affinity of its thread, rather than from whichever thread first uses the
+    // pool.
+    struct LoadTimeCpus {
+        LoadTimeCpus() { (void)processCpus(); }
+    } loadTimeCpus;
+
+    // Pinning is off unless KSSMATH_PIN_THREADS is set to something other than
+    // "0" or setThreadPinning() turns it on.
+    bool pinningFromEnvironment() noexcept {
+        const char* value = getenv("KSSMATH_PIN_THREADS");
+        return value && *value && strcmp(value, "0") != 0;
+    }
+
+    atomic<bool> pinning { pinningFromEnvironment() };
+
+    // Restrict a thread to the given CPUs. Failure (for example in a restricted
+    // container) only loses the placement, not correctness.
+    void setAffinity(thread& t, const unsigned* cpus, size_t count) {
+#if defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (size_t i = 0; i < count; ++i) {
+            CPU_SET(cpus[i], &set);
+        }
+        (void)pthread_setaffinity_np(t.native_handle(), sizeof(set), &set);
+#else
+        (void)t;
+        (void)cpus;
+        (void)count;
+#endif
+    }
+
+    // A persistent set of worker threads, created as they are first needed and
+    // kept for the life of the process. Worker i is always the same thread, and
+    // when pinning is on always on the same CPU, so that work given to it
+    // repeatedly (as by parallelRanges) stays on the pages it first touched.
+    class ThreadPool {
+    public:
+        // Claim the pool for one job. Returns false if another thread is using
+        // it, in which case the caller should do the work itself.
+        bool tryAcquire() noexcept {
+            bool expected = false;
+            return _busy.compare_exchange_strong(expected, true, memory_order_acquire);
+        }
+
+        void release() noexcept { _busy.store(false, memory_order_release); }
+
+        // Run job(i) on workers 0 .. count-1, and alongside() (if given) on the
+        // calling thread, and wait for them all. The pool must have been
+        // acquired. Exceptions must be caught by job and alongside.
+        // @throws std::system_error if a worker cannot be started.
+        void run(unsigned count, const function<void(unsigned)>& job,
+                 const function<void()>& alongside = function<void()>())
+        {
+            unique_lock<mutex> l(_lock);
+            const bool pin = pinning.load(memory_order_relaxed);
+            if (pin != _pinned) {
+                _pinned = pin;
+                for (unsigned i = 0; i < _workers.size(); ++i) {
+                    place(i);
+                }
+            }
+            while (_workers.size() < count) {
+                const unsigned index = unsigned(_workers.size());
+                _workers.emplace_back([this, index] { work(index); });
+                place(index);
+            }
+            _job = &job;
+            _jobWorkers = count;
+            _remaining = count;
+            ++_generation;
+            _wake.notify_all();
+            if (alongside) {
+                l.unlock();
+                alongside();
+                l.lock();
+            }
+            _done.wait(l, [this] { return _remaining == 0; });
+            _job = nullptr;
+        }
+
+        static ThreadPool& instance() {
+            // Never destroyed, so that the workers (which are blocked waiting for
+            // work) are not joined during static destruction.
+            static ThreadPool* pool = new ThreadPool();
+            return *pool;
+        }
+
+    private:
+        atomic<bool>                    _busy { false };
+        mutex                           _lock;
+        condition_variable              _wake;
+        condition_variable              _done;
+        vector<thread>                  _workers;
+        bool                            _pinned = false;
+        const function<void(unsigned)>* _job = nullptr;
+        unsigned                        _jobWorkers = 0;
+        unsigned                        _remaining = 0;
+        uint64_t                        _generation = 0;
+
+        // Pin worker i to the i-th CPU of the process (modulo their number), or
+        // let it run on any of them. A new thread would otherwise inherit the
+        // affinity of the thread that happened to create it.
+        void place(unsigned index) {
+            const vector<unsigned>& cpus = processCpus();
+            if (cpus.empty()) {
+                return;
+            }
+            if (_pinned) {
+                setAffinity(_workers[index], &cpus[index % cpus.size()], 1);
+            }
+            else {
+                setAffinity(_workers[index], cpus.data(), cpus.size());
+            }
+        }
+
+        void work(unsigned index) {
+            inParallel = true;
+            uint64_t seen = 0;
+            unique_lock<mutex> l(_lock);
+            while (true) {
+                _wake.wait(l, [&] { return _generation != seen; });
+                seen = _generation;
+                if (index >= _jobWorkers) {
+                    continue;
+                }
+                const auto* job = _job;
+                l.unlock();
+                (*job)(index);
+                l.lock();
+                if (--_remaining == 0) {
+                    _done.notify_all();
+                }
+            }
+        }
+    };
+
+    // Holds the pool for the calling thread for the duration of a job.
+    class PoolClaim {
+    public:
+        explicit PoolClaim(ThreadPool& pool) noexcept : _pool(pool) { inParallel = true; }
+        ~PoolClaim() noexcept { inParallel = false; _pool.release(); }
+        PoolClaim(const PoolClaim&) = delete;
+        PoolClaim& operator=(const PoolClaim&) = delete;
+
+    private:
+        ThreadPool& _pool;
+    };
+
+    // Records the first exception thrown by any of the workers of a job.
+    class FirstError {
+    public:
+        void capture() {
+            lock_guard<mutex> l(_lock);
+            if (!_error) {
+                _error = current_exception();
+            }
+            _failed.store(true, memory_order_relaxed);
+        }
+
+        bool failed() const noexcept { return _failed.load(memory_order_relaxed); }
+
+        void rethrow() const {
+            if (_error) {
+                rethrow_exception(_error);
+            }
+        }
+
+    private:
+        mutex           _lock;
+        exception_ptr   _error;
+        atomic<bool>    _failed { false };
+    };
+
+}
+
+
+unsigned kss::math::defaultThreadCount() noexcept {
+    // The CPUs the process may run on, which under taskset or a cgroup limit
+    // can be far fewer than the hardware threads.
+    const size_t cpus = processCpus().size();
+    if (cpus > 0) {
+        return unsigned(cpus);
+    }
+    const unsigned n = thread::hardware_concurrency();
+    return (n == 0 ? 1 : n);
+}
+
+void kss::math::setThreadPinning(bool pin) noexcept {
+    pinning.store(pin, memory_order_relaxed);
+}
+
+bool kss::math::threadPinning() noexcept {
+    return pinning.load(memory_order_relaxed);
+}
+
+void kss::math::parallelFor(size_t n, size_t chunkSize,
+                            const function<void(size_t, size_t)>& fn,
+                            unsigned threads)
+{
+    if (n == 0) {
+        return;
+    }
+    if (chunkSize == 0) {
+        chunkSize = 1;
+    }
+    if (threads == 0) {
+        threads = defaultThreadCount();
+    }
+    const size_t numChunks = (n + chunkSize - 1) / chunkSize;
+    const unsigned numThreads = static_cast<unsigned>(min<size_t>(threads, numChunks));
+    ThreadPool& pool = ThreadPool::instance();
+    if (numThreads <= 1 || inParallel || !pool.tryAcquire()) {
+        // The same chunks as the threads would see, so that a caller whose
+        // result depends on the chunking gets the same result on one thread.
+        for (size_t begin = 0; begin < n; begin += chunkSize) {
+            fn(begin, min(begin + chunkSize, n));
+        }
+        return;
+    }
+
+    atomic<size_t> nextChunk(0);
+    FirstError error;
+    auto worker = [&] {
+        while (!error.failed()) {
+            const size_t chunk = nextChunk.fetch_add(1, memory_order_relaxed);
+            if (chunk >= numChunks) {
+                return;
+            }
+            const size_t begin = chunk * chunkSize;
+            try {
+                fn(begin, min(begin + chunkSize, n));
+            }
+            catch (...) {
+                error.capture();
+            }
+        }
+    };
+
+    // The calling thread takes chunks alongside numThreads-1 of the workers.
+    {
+        PoolClaim claim(pool);
+        pool.run(numThreads - 1, [&](unsigned) { worker(); }, worker);
+    }
+    error.rethrow();
+}
+
+void kss::math::parallelRanges(size_t n, size_t granularity,
+                               const function<void(size_t, size_t)>& fn,
+                               unsigned threads)
+{
+    if (n == 0) {
+        return;
+    }
+    if (granularity == 0) {
+        granularity = 1;
+    }
+    if (threads == 0) {
+        threads = defaultThreadCount();
+    }
+    const size_t units = (n + granularity - 1) / granularity;
+    const unsigned numRanges = static_cast<unsigned>(min<size_t>(threads, units));
+    const size_t rangeSize = (units + numRanges - 1) / numRanges * granularity;
+    ThreadPool& pool = ThreadPool::instance();
+    if (numRanges <= 1 || inParallel || !pool.tryAcquire()) {
+        for (size_t begin = 0; begin < n; begin += rangeSize) {
+            fn(begin, min(begin + rangeSize, n));
+        }
+        return;
+    }
+
+    // Range i always runs on worker i, so repeated calls with the same
+    // arguments put each range on the same thread and CPU.
+    FirstError error;
+    const function<void(unsigned)> job = [&](unsigned i) {
+        const size_t begin = i * rangeSize;
+        if (begin < n && !error.failed()) {
+            try {
+                fn(begin, min(begin + rangeSize, n));
+            }
+            catch (...) {
+                error.capture();
+            }
+        }
+    };
+    {
+        PoolClaim claim(pool);
+        pool.run(numRanges, job);
+    }
+    error.rethrow();
+}
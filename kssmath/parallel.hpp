@@ -0,0 +1,74 @@
+//
+//  parallel.hpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#ifndef kssmath_parallel_hpp
+#define kssmath_parallel_hpp
+
+#include <cstddef>
+#include <functional>
+
+namespace kss { namespace math {
+
+    /*!
+     Divide the range [0, n) into chunks of at most chunkSize elements and call
+     fn(begin, end) for each chunk, using the given number of threads (0 will use
+     defaultThreadCount()). Chunks are handed out dynamically so uneven work
+     is balanced. The calling thread participates as one of the workers. The
+     chunks are the same whatever the number of threads (a single thread calls
+     fn for each chunk in order), so a computation that combines per-chunk
+     results in chunk order gives the same result on any number of threads.
+
+     The other workers come from a persistent pool of threads, created as they
+     are first needed, that may run on any of the CPUs of the process (or each
+     on its own CPU, see setThreadPinning()). A call made from
+     within fn, or while another thread is using the pool, calls fn for each
+     chunk in order on the calling thread.
+
+     If fn throws, the remaining chunks are abandoned and the first exception is
+     rethrown once all the threads have finished.
+     */
+    void parallelFor(std::size_t n, std::size_t chunkSize,
+                     const std::function<void(std::size_t, std::size_t)>& fn,
+                     unsigned threads = 0);
+
+    /*!
+     Divide the range [0, n) into one contiguous range per thread, each a
+     multiple of granularity elements (except the last), and call fn(begin, end)
+     for each range. Range i always runs on pool worker i, so when the workers
+     are pinned memory first touched through parallelRanges is placed (on a
+     NUMA machine) on the node of the thread that later calls with the same n,
+     granularity and threads. The calling thread waits for the workers.
+
+     As with parallelFor, a nested call, a call while the pool is in use, or a
+     single range calls fn for each range in order on the calling thread, and if
+     fn throws the first exception is rethrown once all the threads have
+     finished.
+     */
+    void parallelRanges(std::size_t n, std::size_t granularity,
+                        const std::function<void(std::size_t, std::size_t)>& fn,
+                        unsigned threads = 0);
+
+    /*!
+     Pin each pool worker to its own CPU (on Linux), worker i to the i-th of
+     the CPUs the process could run on when it started, or let them run on any
+     of those CPUs. Pinning keeps the ranges of parallelRanges on one NUMA node,
+     but two pinned processes on one machine share the same first CPUs, so it
+     is off unless the environment variable KSSMATH_PIN_THREADS is set to other
+     than "0". A change applies from the next parallel call.
+     */
+    void setThreadPinning(bool pin) noexcept;
+
+    /*!
+     Returns true if the pool workers are pinned.
+     */
+    bool threadPinning() noexcept;
+
+}}
+
+#endif
@@ -0,0 +1,468 @@
+//
+//  qr.hpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#ifndef kssmath_qr_hpp
+#define kssmath_qr_hpp
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "blas.hpp"
+#include "blocking.hpp"
+#include "instrumentation.hpp"
+#include "matrix.hpp"
+#include "parallel.hpp"
+
+namespace kss { namespace math {
+
+    namespace _private {
+
+        // The operation count of a Householder QR factorization of an m x n matrix.
+        inline double qrFlops(std::size_t m, std::size_t n) noexcept {
+            const double big = double(std::max(m, n));
+            const double small = double(std::min(m, n));
+            return 2 * big * small * small - 2 * small * small * small / 3;
+        }
+
+        // Generate an elementary reflector H = I - tau*v*v' such that H*x = (beta, 0, ..., 0)'.
+        // On exit x[0] is beta and x[1..n) holds v[1..n); v[0] is implicitly 1.
+        template <class T>
+        T householder(std::size_t n, T* x) noexcept {
+            if (n <= 1) {
+                return T(0);
+            }
+            const T xnorm = blas::nrm2(n - 1, x + 1);
+            if (xnorm == T(0)) {
+                return T(0);
+            }
+            const T alpha = x[0];
+            const T beta = -std::copysign(std::hypot(alpha, xnorm), alpha);
+            blas::scal(n - 1, T(1) / (alpha - beta), x + 1);
+            x[0] = beta;
+            return (beta - alpha) / beta;
+        }
+
+        // Apply H = I - tau*v*v' from the left to the m x n matrix c. As above, v[0]
+        // is implicitly 1 and is not referenced.
+        template <class T>
+        void applyReflector(std::size_t m, std::size_t n, const T* v, T tau, T* c, std::size_t ldc) noexcept {
+            if (tau == T(0) || m == 0) {
+                return;
+            }
+            for (std::size_t j = 0; j < n; ++j) {
+                T* cj = c + j * ldc;
+                const T w = tau * (cj[0] + blas::dot(m - 1, v + 1, cj + 1));
+                cj[0] -= w;
+                blas::axpy(m - 1, -w, v + 1, cj + 1);
+            }
+        }
+
+        // Unblocked Householder QR of the m x n matrix a.
+        template <class T>
+        void geqr2(std::size_t m, std::size_t n, T* a, std::size_t lda, T* tau) noexcept {
+            const std::size_t k = std::min(m, n);
+            for (std::size_t i = 0; i < k; ++i) {
+                T* aii = a + i + i * lda;
+                tau[i] = householder(m - i, aii);
+                applyReflector(m - i, n - i - 1, aii, tau[i], aii + lda, lda);
+            }
+        }
+
+        // A block of k reflectors in compact WY form, H1*H2*...*Hk = I - V*T*V'.
+        // V is m x k unit lower trapezoidal and T is k x k upper triangular.
+        template <class T>
+        struct BlockReflector {
+            Matrix<T> v;
+            Matrix<T> t;
+
+            // Form the block from k reflectors stored below the diagonal of a (as
+            // left by geqr2) and their scalar factors.
+            BlockReflector(std::size_t m, std::size_t k, const T* a, std::size_t lda, const T* tau)
+            : v(m, k), t(k, k)
+            {
+                for (std::size_t j = 0; j < k; ++j) {
+                    T* vj = v.column(j);
+                    vj[j] = T(1);
+                    std::copy(a + (j + 1) + j * lda, a + m + j * lda, vj + j + 1);
+                }
+                for (std::size_t i = 0; i < k; ++i) {
+                    t(i, i) = tau[i];
+                    if (tau[i] == T(0)) {
+                        continue;
+                    }
+                    // t(0:i, i) = -tau[i] * T(0:i, 0:i) * V(i:m, 0:i)' * V(i:m, i)
+                    const T* vi = v.column(i);
+                    for (std::size_t j = 0; j < i; ++j) {
+                        t(j, i) = -tau[i] * blas::dot(m - i, v.column(j) + i, vi + i);
+                    }
+                    for (std::size_t r = 0; r < i; ++r) {
+                        T sum = T(0);
+                        for (std::size_t c = r; c < i; ++c) {
+                            sum += t(r, c) * t(c, i);
+                        }
+                        t(r, i) = sum;
+                    }
+                }
+            }
+
+            // Apply H' = I - V*T'*V' (transpose true) or H = I - V*T*V' from the left
+            // to the m x n matrix c. The columns of c are processed in parallel.
+            void apply(bool transpose, std::size_t n, T* c, std::size_t ldc, unsigned threads) const {
+                const std::size_t m = v.rows();
+                const std::size_t k = v.cols();
+                const std::size_t chunk = std::max<std::size_t>(k, 32);
+                parallelFor(n, chunk, [&](std::size_t begin, std::size_t end) {
+                    const std::size_t nc = end - begin;
+                    T* cc = c + begin * ldc;
+                    Matrix<T> w(k, nc);
+                    blas::gemm(blas::Op::Trans, blas::Op::NoTrans, k, nc, m,
+                               T(1), v.data(), m, cc, ldc, T(0), w.data(), k);
+                    for (std::size_t j = 0; j < nc; ++j) {
+                        T* wj = w.column(j);
+                        if (transpose) {
+                            for (std::size_t r = k; r-- > 0;) {
+                                T sum = T(0);
+                                for (std::size_t p = 0; p <= r; ++p) {
+                                    sum += t(p, r) * wj[p];
+                                }
+                                wj[r] = sum;
+                            }
+                        }
+                        else {
+                            for (std::size_t r = 0; r < k; ++r) {
+                                T sum = T(0);
+                                for (std::size_t p = r; p < k; ++p) {
+                                    sum += t(r, p) * wj[p];
+                                }
+                                wj[r] = sum;
+                            }
+                        }
+                    }
+                    blas::gemm(blas::Op::NoTrans, blas::Op::NoTrans, m, nc, k,
+                               T(-1), v.data(), m, w.data(), k, T(1), cc, ldc);
+                }, threads);
+            }
+        };
+
+        // Blocked Householder QR of the m x n matrix a: each block of columns is
+        // factored by geqr2 and then applied to the trailing columns as a block
+        // reflector. tau must have room for min(m, n) elements.
+        template <class T>
+        void geqrf(std::size_t m, std::size_t n, T* a, std::size_t lda, T* tau, const BlockingOptions& opts) {
+            const std::size_t nb = std::max<std::size_t>(opts.blockSize, 1);
+            const std::size_t k = std::min(m, n);
+            for (std::size_t j = 0; j < k; j += nb) {
+                const std::size_t jb = std::min(nb, k - j);
+                T* ajj = a + j + j * lda;
+                geqr2(m - j, jb, ajj, lda, tau + j);
+                if (j + jb < n) {
+                    BlockReflector<T> h(m - j, jb, ajj, lda, tau + j);
+                    h.apply(true, n - j - jb, ajj + jb * lda, lda, opts.threads);
+                }
+            }
+        }
+
+        // Apply Q = H(0)*H(1)*...*H(k-1) (or Q' if transpose is true) from the left to
+        // the m x nc matrix c, one block of reflectors at a time. Reflector j acts on
+        // rows j+offset..m and its vector is stored from f(j+offset, j) down, as left
+        // by geqr2 (offset 0) or a tridiagonal/bidiagonal reduction (offset 1).
+        template <class T>
+        void applyReflectors(bool transpose, std::size_t m, std::size_t k, std::size_t offset,
+                             const T* f, std::size_t ldf, const T* tau,
+                             std::size_t nc, T* c, std::size_t ldc, const BlockingOptions& opts)
+        {
+            const std::size_t nb = std::max<std::size_t>(opts.blockSize, 1);
+            if (k == 0) {
+                return;
+            }
+            const std::size_t numBlocks = (k + nb - 1) / nb;
+            for (std::size_t b = 0; b < numBlocks; ++b) {
+                const std::size_t j = (transpose ? b : numBlocks - 1 - b) * nb;
+                const std::size_t jb = std::min(nb, k - j);
+                const std::size_t r = j + offset;
+                BlockReflector<T> h(m - r, jb, f + r + j * ldf, ldf, tau + j);
+                h.apply(transpose, nc, c + r, ldc, opts.threads);
+            }
+        }
+
+        // Solve the leading n x n upper triangle R x = b in place.
+        template <class T>
+        void solveUpper(std::size_t n, const T* r, std::size_t ldr, T* x) noexcept {
+            for (std::size_t j = n; j-- > 0;) {
+                x[j] /= r[j + j * ldr];
+                blas::axpy(j, -x[j], r + j * ldr, x);
+            }
+        }
+
+        // Copy the upper triangle of the leading rows x cols of a.
+        template <class T>
+        Matrix<T> upperTriangle(const Matrix<T>& a, std::size_t rows) {
+            Matrix<T> r(rows, a.cols());
+            for (std::size_t j = 0; j < a.cols(); ++j) {
+                std::copy(a.column(j), a.column(j) + std::min(j + 1, rows), r.column(j));
+            }
+            return r;
+        }
+
+    }
+
+    /*!
+     Householder QR factorization A = QR of an m x n matrix.
+
+     The factorization is blocked: each panel of columns is factored with the
+     unblocked algorithm, its reflectors are accumulated in compact WY form
+     (I - V*T*V'), and the trailing matrix is updated with matrix-matrix
+     products. The trailing update is split by column over the worker threads.
+     Q is not formed explicitly but may be applied with applyQ/applyQTranspose.
+     */
+    template <class T>
+    class QR {
+    public:
+        using size_type = std::size_t;
+
+        /*!
+         Factor the matrix a.
+         */
+        explicit QR(Matrix<T> a, const BlockingOptions& opts = BlockingOptions())
+        : _qr(std::move(a)), _tau(std::min(_qr.rows(), _qr.cols())), _opts(opts)
+        {
+            _opts.blockSize = std::max<size_type>(_opts.blockSize, 1);
+            KSSMATH_INSTRUMENT("QR", _private::qrFlops(rows(), cols()), double(rows()) * cols() * sizeof(T));
+            _private::geqrf(rows(), cols(), _qr.data(), rows(), _tau.data(), _opts);
+        }
+
+        size_type rows() const noexcept { return _qr.rows(); }
+        size_type cols() const noexcept { return _qr.cols(); }
+
+        /*!
+         Returns the min(m,n) x n upper triangular (trapezoidal) factor R.
+         */
+        Matrix<T> R() const { return _private::upperTriangle(_qr, _tau.size()); }
+
+        /*!
+         Returns the first min(m,n) columns of Q.
+         */
+        Matrix<T> Q() const {
+            const size_type k = _tau.size();
+            Matrix<T> q(rows(), k);
+            for (size_type i = 0; i < k; ++i) {
+                q(i, i) = T(1);
+            }
+            applyQ(q);
+            return q;
+        }
+
+        /*!
+         Compute C := Q'C in place. C must have m rows.
+         @throws std::invalid_argument if C has the wrong number of rows.
+         */
+        void applyQTranspose(Matrix<T>& c) const {
+            checkRows(c.rows());
+            applyQTranspose(c.cols(), c.data());
+        }
+        void applyQTranspose(std::vector<T>& c) const {
+            checkRows(c.size());
+            applyQTranspose(1, c.data());
+        }
+
+        /*!
+         Compute C := QC in place. C must have m rows.
+         @throws std::invalid_argument if C has the wrong number of rows.
+         */
+        void applyQ(Matrix<T>& c) const {
+            checkRows(c.rows());
+            applyQ(c.cols(), c.data());
+        }
+        void applyQ(std::vector<T>& c) const {
+            checkRows(c.size());
+            applyQ(1, c.data());
+        }
+
+        /*!
+         Returns the smallest and largest absolute values on the diagonal of R. Their
+         ratio is a cheap (lower bound) estimate of the reciprocal condition number.
+         */
+        std::pair<T, T> diagonalRange() const noexcept {
+            T lo = std::numeric_limits<T>::infinity();
+            T hi = T(0);
+            for (size_type i = 0; i < _tau.size(); ++i) {
+                lo = std::min(lo, std::abs(_qr(i, i)));
+                hi = std::max(hi, std::abs(_qr(i, i)));
+            }
+            return std::make_pair(_tau.empty() ? T(0) : lo, hi);
+        }
+
+        /*!
+         Returns the factored matrix, with R in the upper triangle and the
+         Householder vectors below the diagonal.
+         */
+        const Matrix<T>& factors() const noexcept { return _qr; }
+
+    private:
+        Matrix<T>       _qr;
+        std::vector<T>  _tau;
+        BlockingOptions _opts;
+
+        void checkRows(size_type r) const {
+            if (r != rows()) {
+                throw std::invalid_argument("QR: argument has the wrong number of rows");
+            }
+        }
+
+        void applyQTranspose(size_type nc, T* c) const {
+            _private::applyReflectors(true, rows(), _tau.size(), 0, _qr.data(), rows(), _tau.data(),
+                                      nc, c, rows(), _opts);
+        }
+
+        void applyQ(size_type nc, T* c) const {
+            _private::applyReflectors(false, rows(), _tau.size(), 0, _qr.data(), rows(), _tau.data(),
+                                      nc, c, rows(), _opts);
+        }
+    };
+
+    /*!
+     QR factorization with column pivoting, AP = QR. At each step the remaining
+     column of largest norm is chosen, so the diagonal of R is non-increasing in
+     magnitude and reveals the numerical rank of A. Column norms are downdated
+     rather than recomputed, with the safeguarded recomputation used by LAPACK.
+     */
+    template <class T>
+    class PivotedQR {
+    public:
+        using size_type = std::size_t;
+
+        /*!
+         Factor the matrix a.
+         */
+        explicit PivotedQR(Matrix<T> a)
+        : _qr(std::move(a)), _tau(std::min(_qr.rows(), _qr.cols())), _perm(_qr.cols())
+        {
+            std::iota(_perm.begin(), _perm.end(), size_type(0));
+            KSSMATH_INSTRUMENT("PivotedQR", _private::qrFlops(rows(), cols()), double(rows()) * cols() * sizeof(T));
+            factor();
+        }
+
+        size_type rows() const noexcept { return _qr.rows(); }
+        size_type cols() const noexcept { return _qr.cols(); }
+
+        /*!
+         Returns the column permutation. Column j of AP is column permutation()[j] of A.
+         */
+        const std::vector<size_type>& permutation() const noexcept { return _perm; }
+
+        /*!
+         Returns the min(m,n) x n upper triangular (trapezoidal) factor R.
+         */
+        Matrix<T> R() const { return _private::upperTriangle(_qr, _tau.size()); }
+
+        /*!
+         Returns the numerical rank: the number of diagonal elements of R whose
+         magnitude exceeds rcond times the largest. A negative rcond uses
+         machine epsilon times max(m, n).
+         */
+        size_type rank(T rcond = T(-1)) const noexcept {
+            if (_tau.empty()) {
+                return 0;
+            }
+            if (rcond < T(0)) {
+                rcond = std::numeric_limits<T>::epsilon() * T(std::max(rows(), cols()));
+            }
+            const T threshold = rcond * std::abs(_qr(0, 0));
+            size_type r = 0;
+            while (r < _tau.size() && std::abs(_qr(r, r)) > threshold) {
+                ++r;
+            }
+            return r;
+        }
+
+        /*!
+         Compute c := Q'c in place.
+         @throws std::invalid_argument if c is the wrong length.
+         */
+        void applyQTranspose(std::vector<T>& c) const {
+            if (c.size() != rows()) {
+                throw std::invalid_argument("PivotedQR: argument has the wrong length");
+            }
+            for (size_type i = 0; i < _tau.size(); ++i) {
+                _private::applyReflector(rows() - i, 1, &_qr(i, i), _tau[i], c.data() + i, rows());
+            }
+        }
+
+        /*!
+         Returns the basic least squares solution of Ax = b: the solution using only
+         the first rank(rcond) pivoted columns, with the remaining components zero.
+         @throws std::invalid_argument if b is the wrong length.
+         */
+        std::vector<T> solve(std::vector<T> b, T rcond = T(-1)) const {
+            applyQTranspose(b);
+            const size_type r = rank(rcond);
+            _private::solveUpper(r, _qr.data(), rows(), b.data());
+            std::vector<T> x(cols(), T(0));
+            for (size_type i = 0; i < r; ++i) {
+                x[_perm[i]] = b[i];
+            }
+            return x;
+        }
+
+        const Matrix<T>& factors() const noexcept { return _qr; }
+
+    private:
+        Matrix<T>               _qr;
+        std::vector<T>          _tau;
+        std::vector<size_type>  _perm;
+
+        void factor() {
+            const size_type m = rows();
+            const size_type n = cols();
+            const T tol3z = std::sqrt(std::numeric_limits<T>::epsilon());
+            std::vector<T> vn1(n), vn2(n);
+            for (size_type j = 0; j < n; ++j) {
+                vn1[j] = vn2[j] = blas::nrm2(m, _qr.column(j));
+            }
+
+            for (size_type i = 0; i < _tau.size(); ++i) {
+                const size_type pvt = size_type(std::max_element(vn1.begin() + i, vn1.end()) - vn1.begin());
+                if (pvt != i) {
+                    std::swap_ranges(_qr.column(i), _qr.column(i) + m, _qr.column(pvt));
+                    std::swap(_perm[i], _perm[pvt]);
+                    vn1[pvt] = vn1[i];
+                    vn2[pvt] = vn2[i];
+                }
+
+                T* aii = &_qr(i, i);
+                _tau[i] = _private::householder(m - i, aii);
+                _private::applyReflector(m - i, n - i - 1, aii, _tau[i], aii + m, m);
+
+                for (size_type j = i + 1; j < n; ++j) {
+                    if (vn1[j] == T(0)) {
+                        continue;
+                    }
+                    const T ratio = std::abs(_qr(i, j)) / vn1[j];
+                    const T temp = std::max(T(0), T(1) - ratio * ratio);
+                    const T temp2 = temp * (vn1[j] / vn2[j]) * (vn1[j] / vn2[j]);
+                    if (temp2 <= tol3z) {
+                        vn1[j] = vn2[j] = blas::nrm2(m - i - 1, _qr.column(j) + i + 1);
+                    }
+                    else {
+                        vn1[j] *= std::sqrt(temp);
+                    }
+                }
+            }
+        }
+    };
+
+}}
+
+#endif
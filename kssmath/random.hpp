@@ -0,0 +1,52 @@
+//
+//  random.hpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#ifndef kssmath_random_hpp
+#define kssmath_random_hpp
+
+#include <cmath>
+#include <cstdint>
+
+namespace kss { namespace math { namespace _private {
+
+    // Standard normal deviates by Box-Muller on a 64 bit LCG, so that results
+    // depend only on the seed and not on the standard library implementation.
+    template <class T>
+    class NormalGenerator {
+    public:
+        explicit NormalGenerator(std::uint64_t seed) : _state(seed) {}
+
+        T operator()() noexcept {
+            if (_haveSpare) {
+                _haveSpare = false;
+                return _spare;
+            }
+            const double u1 = (double(next() >> 11) + 0.5) / 9007199254740992.0;
+            const double u2 = double(next() >> 11) / 9007199254740992.0;
+            const double r = std::sqrt(-2.0 * std::log(u1));
+            const double theta = 6.283185307179586 * u2;
+            _spare = T(r * std::sin(theta));
+            _haveSpare = true;
+            return T(r * std::cos(theta));
+        }
+
+    private:
+        std::uint64_t   _state;
+        T               _spare = T(0);
+        bool            _haveSpare = false;
+
+        std::uint64_t next() noexcept {
+            _state = _state * 6364136223846793005ull + 1442695040888963407ull;
+            return _state;
+        }
+    };
+
+}}}
+
+#endif
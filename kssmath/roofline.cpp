@@ -0,0 +1,227 @@
+//
+//  roofline.cpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <ostream>
+
+#if defined(__x86_64__) || defined(__i386__)
+#   define KSSMATH_X86_VARIANTS 1
+#endif
+
+#include "aligned_buffer.hpp"
+#include "parallel.hpp"
+#include "roofline.hpp"
+#include "simd.hpp"
+#include "task_graph.hpp"
+
+using namespace std;
+using namespace kss::math;
+
+
+namespace {
+
+    using Clock = chrono::steady_clock;
+
+    double secondsSince(Clock::time_point start) {
+        return chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    // The number of independent chains of multiply-adds. This must cover the
+    // latency of an FMA times the number of FMA units (4 x 2 on current x86
+    // cores) so that a new one can start every cycle on every unit.
+    constexpr size_t chains = 12;
+
+    // Runs the chains, each of iterations multiply-adds of W lanes, and returns
+    // their sum so that they cannot be optimized away. With a slightly less
+    // than 1 and b small the values stay normal.
+    template <size_t W>
+    inline double fmaChains(size_t iterations, double a, double b) noexcept {
+        using B = simd::Batch<double, W>;
+        B acc[chains];
+        for (size_t k = 0; k < chains; ++k) {
+            acc[k] = B(double(k));
+        }
+        const B x(a), y(b);
+        for (size_t i = 0; i < iterations; ++i) {
+#if defined(__GNUC__) && !defined(__clang__)
+#   pragma GCC unroll 12
+#endif
+            for (size_t k = 0; k < chains; ++k) {
+                acc[k] = simd::fma(acc[k], x, y);
+            }
+        }
+        B sum = acc[0];
+        for (size_t k = 1; k < chains; ++k) {
+            sum = sum + acc[k];
+        }
+        return simd::reduceAdd(sum);
+    }
+
+    // The variants for each instruction set, as in cpu_features.cpp.
+    double fmaGeneric(size_t iterations, double a, double b) {
+        return fmaChains<simd::nativeLanes<double>()>(iterations, a, b);
+    }
+
+#if defined(KSSMATH_X86_VARIANTS)
+    __attribute__((target("avx2,fma"), flatten))
+    double fmaAVX2(size_t iterations, double a, double b) {
+        return fmaChains<4>(iterations, a, b);
+    }
+
+    __attribute__((target("avx512f,avx2,fma"), flatten))
+    double fmaAVX512(size_t iterations, double a, double b) {
+        return fmaChains<8>(iterations, a, b);
+    }
+#endif
+
+    struct FmaVariant {
+        double (*run)(size_t, double, double);
+        size_t lanes;
+    };
+
+    FmaVariant fmaVariant(InstructionSet isa) noexcept {
+        switch (isa) {
+#if defined(KSSMATH_X86_VARIANTS)
+        case InstructionSet::AVX2:
+            return { fmaAVX2, 4 };
+        case InstructionSet::AVX512:
+            return { fmaAVX512, 8 };
+#endif
+        default:
+            return { fmaGeneric, simd::nativeLanes<double>() };
+        }
+    }
+
+    double measureFlops(const FmaVariant& fma, unsigned threads, const RooflineOptions& opts) {
+        // Time a run on every thread, with the iterations doubled until a run
+        // takes the minimum time.
+        volatile double sink = 0;
+        auto timed = [&](size_t iterations) {
+            const auto start = Clock::now();
+            parallelFor(threads, 1, [&](size_t, size_t) {
+                sink = fma.run(iterations, 0.9999999, 1e-8);
+            }, threads);
+            return secondsSince(start);
+        };
+
+        size_t iterations = 1024;
+        while (timed(iterations) < opts.minTime && iterations < (size_t(1) << 40)) {
+            iterations *= 2;
+        }
+        double best = 0;
+        for (unsigned rep = 0; rep < max(opts.repetitions, 1u); ++rep) {
+            best = max(best, 2.0 * double(fma.lanes * chains * iterations) * threads / timed(iterations));
+        }
+        return best * 1e-9;
+    }
+
+    double measureBandwidth(unsigned threads, const RooflineOptions& opts) {
+        const size_t n = max<size_t>(opts.streamBytes / sizeof(double), 1024);
+        AlignedBufferOptions bufferOpts;
+        bufferOpts.threads = threads;
+        AlignedBuffer<double> a(n, 0.0, bufferOpts), b(n, 1.0, bufferOpts), c(n, 2.0, bufferOpts);
+
+        // The same range per pool worker as the first touch, so that on a NUMA
+        // machine each thread streams from its own node.
+        double* pa = a.data();
+        const double* pb = b.data();
+        const double* pc = c.data();
+        auto triad = [&] {
+            const auto start = Clock::now();
+            a.parallelRanges([=](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    pa[i] = pb[i] + 3.0 * pc[i];
+                }
+            }, threads);
+            return secondsSince(start);
+        };
+
+        triad();
+        double best = 0;
+        for (unsigned rep = 0; rep < max(opts.repetitions, 1u); ++rep) {
+            best = max(best, 3.0 * double(n) * sizeof(double) / triad());
+        }
+        return best * 1e-9;
+    }
+
+}
+
+
+MachinePeak kss::math::measureMachinePeak(const RooflineOptions& opts) {
+    MachinePeak peak;
+    peak.threads = (opts.threads == 0 ? defaultThreadCount() : opts.threads);
+    peak.instructionSet = activeInstructionSet();
+    peak.gflops = measureFlops(fmaVariant(peak.instructionSet), peak.threads, opts);
+    peak.gbytesPerSecond = measureBandwidth(peak.threads, opts);
+    return peak;
+}
+
+const char* kss::math::rooflineBoundName(RooflineBound bound) noexcept {
+    switch (bound) {
+    case RooflineBound::Memory:     return "memory";
+    case RooflineBound::Compute:    return "compute";
+    default:                        return "unknown";
+    }
+}
+
+RooflinePoint kss::math::rooflinePoint(const MachinePeak& peak, double flops, double bytes, double seconds) noexcept {
+    RooflinePoint p;
+    if (seconds <= 0) {
+        return p;
+    }
+    p.achievedGflops = flops / seconds * 1e-9;
+    p.achievedGbytesPerSecond = bytes / seconds * 1e-9;
+    if (flops > 0 && bytes > 0) {
+        p.intensity = flops / bytes;
+        p.attainableGflops = min(peak.gflops, p.intensity * peak.gbytesPerSecond);
+        p.bound = (p.intensity < peak.ridgeIntensity() ? RooflineBound::Memory : RooflineBound::Compute);
+    }
+    else if (flops > 0) {
+        p.attainableGflops = peak.gflops;
+        p.bound = RooflineBound::Compute;
+    }
+    else if (bytes > 0) {
+        p.bound = RooflineBound::Memory;
+        p.fraction = (peak.gbytesPerSecond > 0 ? p.achievedGbytesPerSecond / peak.gbytesPerSecond : 0.0);
+        return p;
+    }
+    p.fraction = (p.attainableGflops > 0 ? p.achievedGflops / p.attainableGflops : 0.0);
+    return p;
+}
+
+void kss::math::writeRooflineReport(ostream& out, const MachinePeak& peak, const vector<KernelStatistics>& stats) {
+    const auto flags = out.flags();
+    const auto precision = out.precision();
+    out << fixed << setprecision(2)
+        << "peak " << peak.gflops << " GFLOP/s, " << peak.gbytesPerSecond << " GB/s, ridge at "
+        << peak.ridgeIntensity() << " flop/byte (" << peak.threads << " threads, "
+        << instructionSetName(peak.instructionSet) << ")\n";
+    out << left << setw(32) << "kernel" << right
+        << setw(12) << "flop/byte" << setw(10) << "GFLOP/s" << setw(10) << "GB/s"
+        << setw(10) << "roof" << setw(8) << "%roof" << setw(10) << "bound" << '\n';
+    for (const auto& s : stats) {
+        const RooflinePoint p = rooflinePoint(peak, s.flops, s.bytes, s.seconds);
+        out << left << setw(32) << s.name << right;
+        if (p.intensity > 0) {
+            out << setw(12) << setprecision(3) << p.intensity;
+        }
+        else {
+            out << setw(12) << "-";
+        }
+        out << setprecision(2)
+            << setw(10) << p.achievedGflops << setw(10) << p.achievedGbytesPerSecond
+            << setw(10) << p.attainableGflops << setw(7) << setprecision(1) << 100 * p.fraction << "%"
+            << setw(10) << rooflineBoundName(p.bound) << '\n';
+    }
+    out.flush();
+    out.flags(flags);
+    out.precision(precision);
+}
@@ -0,0 +1,129 @@
+//
+//  roofline.hpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#ifndef kssmath_roofline_hpp
+#define kssmath_roofline_hpp
+
+#include <cstddef>
+#include <iosfwd>
+#include <vector>
+
+#include "cpu_features.hpp"
+#include "instrumentation.hpp"
+
+namespace kss { namespace math {
+
+    /*!
+     The roofline model bounds the rate of a kernel by the peak floating point
+     rate of the machine and by its memory bandwidth times the kernel's
+     arithmetic intensity (flops per byte of memory traffic). Kernels whose
+     intensity is below the ridge point (peak rate / bandwidth) are bound by
+     memory, the others by computation. Comparing the achieved rate with the
+     bound shows how much room a kernel has, and the bound itself whether a job
+     would gain more from faster cores or from more memory bandwidth.
+
+     The peaks are measured rather than taken from a specification: the
+     floating point rate by chains of independent double precision fused
+     multiply-adds in SIMD registers of the active instruction set, and the
+     bandwidth by a STREAM triad (a[i] = b[i] + s*c[i]) over arrays much larger
+     than the caches. Both are measured on the given number of threads, which
+     should be the number the kernels use.
+     */
+    struct RooflineOptions {
+        /*!
+         The number of threads to measure with; 0 uses defaultThreadCount().
+         */
+        unsigned    threads = 0;
+
+        /*!
+         The size in bytes of each of the three arrays of the triad. It should be
+         several times the size of the last level cache.
+         */
+        std::size_t streamBytes = std::size_t(64) << 20;
+
+        /*!
+         The number of times each measurement is repeated. The best is kept, as
+         STREAM does, since interference only slows a run down.
+         */
+        unsigned    repetitions = 5;
+
+        /*!
+         The minimum time, in seconds, of each repetition of the floating point
+         measurement.
+         */
+        double      minTime = 0.05;
+    };
+
+    /*!
+     The measured peaks of the machine.
+     */
+    struct MachinePeak {
+        double          gflops = 0;             ///< Double precision GFLOP/s.
+        double          gbytesPerSecond = 0;    ///< Triad bandwidth, counting the three arrays.
+        unsigned        threads = 0;
+        InstructionSet  instructionSet = InstructionSet::Generic;
+
+        /*!
+         Returns the arithmetic intensity (flops per byte) at which a kernel
+         stops being bound by memory.
+         */
+        double ridgeIntensity() const noexcept {
+            return (gbytesPerSecond > 0 ? gflops / gbytesPerSecond : 0.0);
+        }
+    };
+
+    /*!
+     Measure the peak floating point rate and memory bandwidth. This takes
+     roughly a second, so it is meant to be called once at startup.
+     @throws std::bad_alloc if the triad arrays cannot be allocated.
+     */
+    MachinePeak measureMachinePeak(const RooflineOptions& opts = RooflineOptions());
+
+    /*!
+     What limits a kernel under the roofline model. Unknown is given when the
+     kernel reports neither its operations nor its traffic.
+     */
+    enum class RooflineBound { Unknown, Memory, Compute };
+
+    /*!
+     Returns "unknown", "memory" or "compute".
+     */
+    const char* rooflineBoundName(RooflineBound bound) noexcept;
+
+    /*!
+     Where a kernel lies relative to the roofline. The fraction is the achieved
+     rate over the attainable one: GFLOP/s if the kernel reports its operations,
+     otherwise (for kernels that only report their traffic) the bandwidth. The
+     bandwidth of the roofline is that of main memory, so a memory bound kernel
+     whose data is in cache can exceed a fraction of 1.
+     */
+    struct RooflinePoint {
+        double          intensity = 0;              ///< Flops per byte, 0 if either is unknown.
+        double          achievedGflops = 0;
+        double          achievedGbytesPerSecond = 0;
+        double          attainableGflops = 0;       ///< The roofline at the kernel's intensity.
+        double          fraction = 0;
+        RooflineBound   bound = RooflineBound::Unknown;
+    };
+
+    /*!
+     Place a kernel that did the given work in the given time on the roofline.
+     */
+    RooflinePoint rooflinePoint(const MachinePeak& peak, double flops, double bytes, double seconds) noexcept;
+
+    /*!
+     Write the peaks and a table placing each of the instrumented kernels (see
+     instrumentation.hpp) on the roofline, ordered by decreasing time.
+     */
+    void writeRooflineReport(std::ostream& out, const MachinePeak& peak,
+                             const std::vector<KernelStatistics>& stats);
+
+}}
+
+#endif
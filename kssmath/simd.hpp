@@ -0,0 +1,432 @@
+//
+//  simd.hpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#ifndef kssmath_simd_hpp
+#define kssmath_simd_hpp
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#if defined(__GNUC__) || defined(__clang__)
+#   define KSSMATH_SIMD_VECTOR_EXTENSIONS 1
+#endif
+
+// Everything here is inlined, so GCC's notes that passing wide vectors changes
+// the calling convention when AVX is not enabled do not apply.
+#if defined(__GNUC__) && !defined(__clang__)
+#   pragma GCC diagnostic push
+#   pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+namespace kss { namespace math { namespace simd {
+
+    /*!
+     A portable vocabulary for writing kernels once for every instruction set.
+
+     Batch<T, N> holds N lanes of float or double, and Mask<T, N> the result of
+     comparing two batches. With GCC and Clang they are built on the compilers'
+     generic vector types, so the operations compile to the instructions of
+     whatever target the calling function is compiled for: SSE, AVX or AVX-512 on
+     x86 (including the multiversioned kernels of cpu_features.cpp, which are
+     compiled with target attributes) and NEON on ARM. With other compilers the
+     lanes are plain arrays processed by scalar loops.
+
+     A batch wider than the registers of the target still works, but the
+     compilers handle it poorly (it tends to go through memory), so kernels
+     should use batches of nativeLanes<T>() lanes, or take the width as a
+     template parameter when they are compiled for several targets.
+
+     N must be a power of two. Batches are meant to live in registers, as the
+     locals of inner loops; they are aligned to their size, so they should not
+     be stored in standard containers.
+     */
+
+    /*!
+     True for the lane types that Batch supports.
+     */
+    template <class T>
+    struct IsVectorizable : std::integral_constant<bool, std::is_same<T, float>::value
+                                                         || std::is_same<T, double>::value> {};
+
+    namespace _private {
+
+        // The signed integer of the same size as T, used for the lanes of masks.
+        template <class T> struct LaneInteger;
+        template <> struct LaneInteger<float> { using type = std::int32_t; };
+        template <> struct LaneInteger<double> { using type = std::int64_t; };
+
+#if defined(KSSMATH_SIMD_VECTOR_EXTENSIONS)
+
+        template <class T, std::size_t N>
+        struct Lanes {
+            typedef T type __attribute__((vector_size(N * sizeof(T))));
+        };
+
+#else
+
+        // The scalar fallback: an array with the element-wise operators of the
+        // vector extensions.
+        template <class T, std::size_t N>
+        struct Array {
+            T v[N];
+
+            T& operator[](std::size_t i) noexcept { return v[i]; }
+            const T& operator[](std::size_t i) const noexcept { return v[i]; }
+
+            template <class Op>
+            friend Array apply(const Array& a, const Array& b, Op op) noexcept {
+                Array r;
+                for (std::size_t i = 0; i < N; ++i) {
+                    r.v[i] = op(a.v[i], b.v[i]);
+                }
+                return r;
+            }
+
+            friend Array operator+(const Array& a, const Array& b) noexcept { return apply(a, b, [](T x, T y) { return x + y; }); }
+            friend Array operator-(const Array& a, const Array& b) noexcept { return apply(a, b, [](T x, T y) { return x - y; }); }
+            friend Array operator*(const Array& a, const Array& b) noexcept { return apply(a, b, [](T x, T y) { return x * y; }); }
+            friend Array operator/(const Array& a, const Array& b) noexcept { return apply(a, b, [](T x, T y) { return x / y; }); }
+            friend Array operator&(const Array& a, const Array& b) noexcept { return apply(a, b, [](T x, T y) { return T(x & y); }); }
+            friend Array operator|(const Array& a, const Array& b) noexcept { return apply(a, b, [](T x, T y) { return T(x | y); }); }
+            friend Array operator^(const Array& a, const Array& b) noexcept { return apply(a, b, [](T x, T y) { return T(x ^ y); }); }
+            friend Array operator-(const Array& a) noexcept { return Array() - a; }
+            friend Array operator~(const Array& a) noexcept { return a ^ apply(a, a, [](T, T) { return T(-1); }); }
+        };
+
+        template <class T, std::size_t N>
+        struct Lanes {
+            using type = Array<T, N>;
+        };
+
+        // Comparisons of the fallback arrays, giving all ones for true as the
+        // vector extensions do.
+        template <class T, std::size_t N, class Op>
+        Array<typename LaneInteger<T>::type, N> compare(const Array<T, N>& a, const Array<T, N>& b, Op op) noexcept {
+            Array<typename LaneInteger<T>::type, N> r;
+            for (std::size_t i = 0; i < N; ++i) {
+                r.v[i] = (op(a.v[i], b.v[i]) ? -1 : 0);
+            }
+            return r;
+        }
+
+#endif
+
+        // Reinterpret the bits of one lane type as another of the same size.
+        template <class To, class From>
+        inline To bitCast(const From& from) noexcept {
+            static_assert(sizeof(To) == sizeof(From), "bitCast: the sizes must match");
+            To to;
+            std::memcpy(&to, &from, sizeof(To));
+            return to;
+        }
+
+        template <class V, class T>
+        inline V broadcast(T value, std::size_t n) noexcept {
+            V v;
+            for (std::size_t i = 0; i < n; ++i) {
+                v[i] = value;
+            }
+            return v;
+        }
+
+    }
+
+    template <class T, std::size_t N> class Batch;
+
+    /*!
+     The result of a lane-wise comparison of two batches: all bits of a lane are
+     set where the comparison holds.
+     */
+    template <class T, std::size_t N>
+    class Mask {
+    public:
+        using integer_type = typename _private::LaneInteger<T>::type;
+        using storage_type = typename _private::Lanes<integer_type, N>::type;
+
+        /*!
+         Construct a mask with every lane set to value.
+         */
+        explicit Mask(bool value = false) noexcept
+        : _m(_private::broadcast<storage_type>(integer_type(value ? -1 : 0), N)) {}
+
+        explicit Mask(const storage_type& m) noexcept : _m(m) {}
+
+        static constexpr std::size_t size() noexcept { return N; }
+
+        bool operator[](std::size_t i) const noexcept { return _m[i] != 0; }
+
+        /*!
+         Returns true if any or all of the lanes are set.
+         */
+        bool any() const noexcept {
+            for (std::size_t i = 0; i < N; ++i) {
+                if (_m[i] != 0) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool all() const noexcept {
+            for (std::size_t i = 0; i < N; ++i) {
+                if (_m[i] == 0) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        Mask operator&(const Mask& o) const noexcept { return Mask(storage_type(_m & o._m)); }
+        Mask operator|(const Mask& o) const noexcept { return Mask(storage_type(_m | o._m)); }
+        Mask operator^(const Mask& o) const noexcept { return Mask(storage_type(_m ^ o._m)); }
+        Mask operator~() const noexcept { return Mask(storage_type(~_m)); }
+
+        const storage_type& bits() const noexcept { return _m; }
+
+    private:
+        storage_type _m;
+    };
+
+    /*!
+     N lanes of float or double. Scalars convert implicitly to a batch with every
+     lane set to the scalar, so expressions such as alpha * x + y may mix them.
+     */
+    template <class T, std::size_t N>
+    class Batch {
+    public:
+        static_assert(IsVectorizable<T>::value, "Batch: T must be float or double");
+        static_assert(N > 0 && (N & (N - 1)) == 0, "Batch: N must be a power of two");
+
+        using value_type = T;
+        using mask_type = Mask<T, N>;
+        using storage_type = typename _private::Lanes<T, N>::type;
+
+        /*!
+         Construct a batch with every lane zero, or set to value.
+         */
+        Batch() noexcept : _v(_private::broadcast<storage_type>(T(0), N)) {}
+        Batch(T value) noexcept : _v(_private::broadcast<storage_type>(value, N)) {}
+        explicit Batch(const storage_type& v) noexcept : _v(v) {}
+
+        static constexpr std::size_t size() noexcept { return N; }
+
+        /*!
+         Load N consecutive values from p, which need not be aligned (loadAligned
+         requires alignment to the size of the batch).
+         */
+        static Batch load(const T* p) noexcept {
+            Batch b;
+            std::memcpy(&b._v, p, sizeof(storage_type));
+            return b;
+        }
+
+        static Batch loadAligned(const T* p) noexcept {
+            return Batch(*reinterpret_cast<const storage_type*>(p));
+        }
+
+        /*!
+         Load the first count (at most N) values from p, setting the other lanes
+         to zero. This handles the remainder of a loop.
+         */
+        static Batch loadPartial(const T* p, std::size_t count) noexcept {
+            Batch b;
+            for (std::size_t i = 0; i < count; ++i) {
+                b._v[i] = p[i];
+            }
+            return b;
+        }
+
+        /*!
+         Load lane i from base[index[i]], for index arrays of any integer type.
+         */
+        template <class I>
+        static Batch gather(const T* base, const I* index) noexcept {
+            Batch b;
+            for (std::size_t i = 0; i < N; ++i) {
+                b._v[i] = base[index[i]];
+            }
+            return b;
+        }
+
+        void store(T* p) const noexcept {
+            std::memcpy(p, &_v, sizeof(storage_type));
+        }
+
+        void storeAligned(T* p) const noexcept {
+            *reinterpret_cast<storage_type*>(p) = _v;
+        }
+
+        void storePartial(T* p, std::size_t count) const noexcept {
+            for (std::size_t i = 0; i < count; ++i) {
+                p[i] = _v[i];
+            }
+        }
+
+        T operator[](std::size_t i) const noexcept { return _v[i]; }
+
+        const storage_type& lanes() const noexcept { return _v; }
+
+        Batch& operator+=(const Batch& o) noexcept { _v = _v + o._v; return *this; }
+        Batch& operator-=(const Batch& o) noexcept { _v = _v - o._v; return *this; }
+        Batch& operator*=(const Batch& o) noexcept { _v = _v * o._v; return *this; }
+        Batch& operator/=(const Batch& o) noexcept { _v = _v / o._v; return *this; }
+
+        friend Batch operator+(const Batch& a, const Batch& b) noexcept { return Batch(storage_type(a._v + b._v)); }
+        friend Batch operator-(const Batch& a, const Batch& b) noexcept { return Batch(storage_type(a._v - b._v)); }
+        friend Batch operator*(const Batch& a, const Batch& b) noexcept { return Batch(storage_type(a._v * b._v)); }
+        friend Batch operator/(const Batch& a, const Batch& b) noexcept { return Batch(storage_type(a._v / b._v)); }
+        friend Batch operator-(const Batch& a) noexcept { return Batch(storage_type(-a._v)); }
+
+#if defined(KSSMATH_SIMD_VECTOR_EXTENSIONS)
+#   define KSSMATH_SIMD_COMPARE(OP) \
+        friend mask_type operator OP(const Batch& a, const Batch& b) noexcept { \
+            return mask_type((typename mask_type::storage_type)(a._v OP b._v)); \
+        }
+#else
+#   define KSSMATH_SIMD_COMPARE(OP) \
+        friend mask_type operator OP(const Batch& a, const Batch& b) noexcept { \
+            return mask_type(_private::compare(a._v, b._v, [](T x, T y) { return x OP y; })); \
+        }
+#endif
+        KSSMATH_SIMD_COMPARE(==)
+        KSSMATH_SIMD_COMPARE(!=)
+        KSSMATH_SIMD_COMPARE(<)
+        KSSMATH_SIMD_COMPARE(<=)
+        KSSMATH_SIMD_COMPARE(>)
+        KSSMATH_SIMD_COMPARE(>=)
+#undef KSSMATH_SIMD_COMPARE
+
+    private:
+        storage_type _v;
+    };
+
+    /*!
+     Returns a*b + c. Where the target has fused multiply-add instructions the
+     compiler contracts this into them, so the result may be rounded once
+     rather than twice.
+     */
+    template <class T, std::size_t N>
+    inline Batch<T, N> fma(const Batch<T, N>& a, const Batch<T, N>& b, const Batch<T, N>& c) noexcept {
+        return a * b + c;
+    }
+
+    /*!
+     Returns a where the mask is set and b elsewhere.
+     */
+    template <class T, std::size_t N>
+    inline Batch<T, N> select(const Mask<T, N>& m, const Batch<T, N>& a, const Batch<T, N>& b) noexcept {
+        using S = typename Mask<T, N>::storage_type;
+        const S bits = (_private::bitCast<S>(a.lanes()) & m.bits()) | (_private::bitCast<S>(b.lanes()) & ~m.bits());
+        return Batch<T, N>(_private::bitCast<typename Batch<T, N>::storage_type>(bits));
+    }
+
+    /*!
+     The lane-wise minimum and maximum. As with std::min and std::max, a is
+     returned where the comparison with b is false (for instance if b is NaN).
+     */
+    template <class T, std::size_t N>
+    inline Batch<T, N> min(const Batch<T, N>& a, const Batch<T, N>& b) noexcept {
+        return select(b < a, b, a);
+    }
+
+    template <class T, std::size_t N>
+    inline Batch<T, N> max(const Batch<T, N>& a, const Batch<T, N>& b) noexcept {
+        return select(a < b, b, a);
+    }
+
+    /*!
+     The lane-wise absolute value, computed by clearing the sign bits.
+     */
+    template <class T, std::size_t N>
+    inline Batch<T, N> abs(const Batch<T, N>& a) noexcept {
+        using I = typename Mask<T, N>::integer_type;
+        using S = typename Mask<T, N>::storage_type;
+        const S magnitude = _private::bitCast<S>(a.lanes())
+                            & _private::broadcast<S>(std::numeric_limits<I>::max(), N);
+        return Batch<T, N>(_private::bitCast<typename Batch<T, N>::storage_type>(magnitude));
+    }
+
+    /*!
+     The lane-wise square root. The vector types have no square root operation,
+     so this is computed lane by lane.
+     */
+    template <class T, std::size_t N>
+    inline Batch<T, N> sqrt(const Batch<T, N>& a) noexcept {
+        typename Batch<T, N>::storage_type v = a.lanes();
+        for (std::size_t i = 0; i < N; ++i) {
+            v[i] = std::sqrt(v[i]);
+        }
+        return Batch<T, N>(v);
+    }
+
+    /*!
+     Horizontal reductions: the sum, minimum and maximum of the lanes. The sum
+     adds the lanes pairwise (the upper half to the lower half, repeatedly), so
+     the result is the same on every target.
+     */
+    template <class T, std::size_t N>
+    inline T reduceAdd(const Batch<T, N>& a) noexcept {
+        T lanes[N];
+        a.store(lanes);
+        for (std::size_t w = N / 2; w > 0; w /= 2) {
+            for (std::size_t i = 0; i < w; ++i) {
+                lanes[i] += lanes[i + w];
+            }
+        }
+        return lanes[0];
+    }
+
+    template <class T, std::size_t N>
+    inline T reduceMin(const Batch<T, N>& a) noexcept {
+        T r = a[0];
+        for (std::size_t i = 1; i < N; ++i) {
+            r = (a[i] < r ? a[i] : r);
+        }
+        return r;
+    }
+
+    template <class T, std::size_t N>
+    inline T reduceMax(const Batch<T, N>& a) noexcept {
+        T r = a[0];
+        for (std::size_t i = 1; i < N; ++i) {
+            r = (r < a[i] ? a[i] : r);
+        }
+        return r;
+    }
+
+    /*!
+     The number of lanes of the widest vector registers that the translation
+     unit is compiled for: 64 bytes with AVX-512, 32 with AVX and 16 otherwise
+     (SSE, NEON and the scalar fallback).
+     */
+    template <class T>
+    constexpr std::size_t nativeLanes() noexcept {
+#if defined(__AVX512F__)
+        return 64 / sizeof(T);
+#elif defined(__AVX__)
+        return 32 / sizeof(T);
+#else
+        return 16 / sizeof(T);
+#endif
+    }
+
+    template <class T>
+    using NativeBatch = Batch<T, nativeLanes<T>()>;
+
+}}}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#   pragma GCC diagnostic pop
+#endif
+
+#endif
@@ -0,0 +1,254 @@
+//
+//  sliced_ell_matrix.hpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#ifndef kssmath_sliced_ell_matrix_hpp
+#define kssmath_sliced_ell_matrix_hpp
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "instrumentation.hpp"
+#include "parallel.hpp"
+#include "simd.hpp"
+#include "sparse_matrix.hpp"
+#include "tuning.hpp"
+
+namespace kss { namespace math {
+
+    /*!
+     Options for SlicedEllMatrix.
+     */
+    struct SlicedEllOptions {
+        /*!
+         The number of rows in a slice (C). This should be a multiple of the SIMD
+         width and may be at most 64. The default is tuned for the machine (see
+         tuning.hpp).
+         */
+        std::size_t sliceHeight = tuningParameters().sliceHeight;
+
+        /*!
+         The rows are sorted by length within windows of this many rows (sigma) to
+         reduce the padding. 1 disables the sorting.
+         */
+        std::size_t sortWindow = 256;
+    };
+
+    namespace _private {
+
+        constexpr std::size_t maxSliceHeight = 64;
+
+        // The order of the rows in a SELL-C-sigma matrix: sorted by decreasing
+        // length within each window.
+        template <class T>
+        std::vector<std::size_t> slicedEllRowOrder(const SparseMatrix<T>& a, std::size_t window) {
+            const auto& ptr = a.rowPointers();
+            std::vector<std::size_t> order(a.rows());
+            std::iota(order.begin(), order.end(), std::size_t(0));
+            window = std::max<std::size_t>(window, 1);
+            for (std::size_t w = 0; w < order.size(); w += window) {
+                std::stable_sort(order.begin() + long(w), order.begin() + long(std::min(w + window, order.size())),
+                                 [&ptr](std::size_t i, std::size_t j) {
+                                     return ptr[i + 1] - ptr[i] > ptr[j + 1] - ptr[j];
+                                 });
+            }
+            return order;
+        }
+
+        // The number of entries (including padding) that a SELL-C-sigma form of a
+        // would store.
+        template <class T>
+        std::size_t slicedEllStorage(const SparseMatrix<T>& a, const std::vector<std::size_t>& order,
+                                     std::size_t sliceHeight)
+        {
+            const auto& ptr = a.rowPointers();
+            std::size_t total = 0;
+            for (std::size_t s = 0; s < order.size(); s += sliceHeight) {
+                std::size_t width = 0;
+                for (std::size_t p = s; p < std::min(s + sliceHeight, order.size()); ++p) {
+                    width = std::max(width, ptr[order[p] + 1] - ptr[order[p]]);
+                }
+                total += width * sliceHeight;
+            }
+            return total;
+        }
+
+        // Computes the c rows of one slice, whose entries (c per column of the
+        // slice) start at col and val, into acc.
+        template <class T, class I>
+        void slicedEllSlice(std::size_t c, std::size_t entries, const I* col, const T* val, const T* x,
+                            T* acc, std::false_type) noexcept
+        {
+            std::fill(acc, acc + c, T(0));
+            for (std::size_t k = 0; k < entries; k += c) {
+                for (std::size_t r = 0; r < c; ++r) {
+                    acc[r] += val[k + r] * x[col[k + r]];
+                }
+            }
+        }
+
+        template <class T, class I>
+        void slicedEllSlice(std::size_t c, std::size_t entries, const I* col, const T* val, const T* x,
+                            T* acc, std::true_type) noexcept
+        {
+            using B = simd::NativeBatch<T>;
+            const std::size_t w = B::size();
+            std::size_t r0 = 0;
+            for (; r0 + w <= c; r0 += w) {
+                B sum;
+                for (std::size_t k = r0; k < entries; k += c) {
+                    sum = simd::fma(B::load(val + k), B::gather(x, col + k), sum);
+                }
+                sum.store(acc + r0);
+            }
+            if (r0 < c) {
+                std::fill(acc + r0, acc + c, T(0));
+                for (std::size_t k = 0; k < entries; k += c) {
+                    for (std::size_t r = r0; r < c; ++r) {
+                        acc[r] += val[k + r] * x[col[k + r]];
+                    }
+                }
+            }
+        }
+
+    }
+
+    /*!
+     A sparse matrix in the SELL-C-sigma format. The rows are grouped into slices
+     of C rows, and each slice is stored as a small dense ELLPACK block (padded to
+     its longest row) in column major order, so the C rows of a slice are
+     processed together, SIMD batches of rows at a time.
+     Sorting the rows by length within windows of sigma rows keeps the padding
+     small when the row lengths vary. Column indices are stored as 32 bits to
+     reduce the memory traffic.
+
+     The matrix is built from a SparseMatrix and is read-only.
+     */
+    template <class T>
+    class SlicedEllMatrix {
+    public:
+        using value_type = T;
+        using size_type = std::size_t;
+        using index_type = std::uint32_t;
+
+        SlicedEllMatrix() = default;
+
+        /*!
+         Convert a CSR matrix.
+         @throws std::invalid_argument if the slice height is not in [1, 64] or
+            the matrix has too many columns for 32 bit indices.
+         */
+        explicit SlicedEllMatrix(const SparseMatrix<T>& a, const SlicedEllOptions& opts = SlicedEllOptions())
+        : _rows(a.rows()), _cols(a.cols()), _nnz(a.nonZeros()), _c(opts.sliceHeight),
+          _sigma(std::max<size_type>(opts.sortWindow, 1))
+        {
+            if (_c == 0 || _c > _private::maxSliceHeight) {
+                throw std::invalid_argument("SlicedEllMatrix: slice height must be in [1, 64]");
+            }
+            if (_cols > std::numeric_limits<index_type>::max()) {
+                throw std::invalid_argument("SlicedEllMatrix: too many columns for 32 bit indices");
+            }
+            const auto& ptr = a.rowPointers();
+            const auto& idx = a.columnIndices();
+            const auto& val = a.values();
+            _order = _private::slicedEllRowOrder(a, _sigma);
+
+            const size_type slices = (_rows + _c - 1) / _c;
+            _sliceStart.assign(slices + 1, 0);
+            for (size_type s = 0; s < slices; ++s) {
+                size_type width = 0;
+                for (size_type p = s * _c; p < std::min((s + 1) * _c, _rows); ++p) {
+                    width = std::max(width, ptr[_order[p] + 1] - ptr[_order[p]]);
+                }
+                _sliceStart[s + 1] = _sliceStart[s] + width * _c;
+            }
+
+            // The padding refers to column 0 with a zero value.
+            _colIdx.assign(_sliceStart.back(), 0);
+            _values.assign(_sliceStart.back(), T(0));
+            for (size_type s = 0; s < slices; ++s) {
+                for (size_type r = 0; r < _c && s * _c + r < _rows; ++r) {
+                    const size_type i = _order[s * _c + r];
+                    for (size_type k = 0; k < ptr[i + 1] - ptr[i]; ++k) {
+                        _colIdx[_sliceStart[s] + k * _c + r] = index_type(idx[ptr[i] + k]);
+                        _values[_sliceStart[s] + k * _c + r] = val[ptr[i] + k];
+                    }
+                }
+            }
+        }
+
+        size_type rows() const noexcept { return _rows; }
+        size_type cols() const noexcept { return _cols; }
+        size_type nonZeros() const noexcept { return _nnz; }
+        size_type sliceHeight() const noexcept { return _c; }
+        size_type sortWindow() const noexcept { return _sigma; }
+
+        /*!
+         Returns the number of stored entries, including the padding.
+         */
+        size_type storedEntries() const noexcept { return _values.size(); }
+
+        /*!
+         Returns storedEntries() / nonZeros(), which is 1 if there is no padding.
+         */
+        double fillRatio() const noexcept {
+            return (_nnz == 0 ? 1.0 : double(storedEntries()) / double(_nnz));
+        }
+
+        /*!
+         Computes y = A*x, splitting the slices over the given number of threads.
+         */
+        void multiply(const T* x, T* y, unsigned threads = 0) const {
+            KSSMATH_INSTRUMENT("SlicedEllMatrix::multiply", 2.0 * nonZeros(),
+                               double(storedEntries()) * (sizeof(T) + sizeof(index_type)) + 2.0 * _rows * sizeof(T));
+            const size_type slices = _sliceStart.size() - 1;
+            const size_type c = _c;
+            parallelFor(slices, std::max<size_type>(1, tuningParameters().spmvChunkRows / c), [&](std::size_t s0, std::size_t s1) {
+                T acc[_private::maxSliceHeight];
+                for (size_type s = s0; s < s1; ++s) {
+                    const size_type k = _sliceStart[s];
+                    _private::slicedEllSlice(c, _sliceStart[s + 1] - k, _colIdx.data() + k, _values.data() + k,
+                                             x, acc, simd::IsVectorizable<T>());
+                    const size_type p0 = s * c;
+                    for (size_type r = 0; r < c && p0 + r < _rows; ++r) {
+                        y[_order[p0 + r]] = acc[r];
+                    }
+                }
+            }, threads);
+        }
+
+    private:
+        size_type               _rows = 0;
+        size_type               _cols = 0;
+        size_type               _nnz = 0;
+        size_type               _c = 1;
+        size_type               _sigma = 1;
+        std::vector<size_type>  _order;         // the row stored at each position
+        std::vector<size_type>  _sliceStart;    // offset of each slice in _colIdx and _values
+        std::vector<index_type> _colIdx;
+        std::vector<T>          _values;
+    };
+
+    /*!
+     Returns an operator computing the product with a, which must outlive it.
+     */
+    template <class T>
+    LinearOperator<T> sparseOperator(const SlicedEllMatrix<T>& a, unsigned threads = 0) {
+        const SlicedEllMatrix<T>* pa = &a;
+        return [pa, threads](const T* x, T* y) { pa->multiply(x, y, threads); };
+    }
+
+}}
+
+#endif
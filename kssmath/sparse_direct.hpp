@@ -0,0 +1,622 @@
+//
+//  sparse_direct.hpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#ifndef kssmath_sparse_direct_hpp
+#define kssmath_sparse_direct_hpp
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "blas.hpp"
+#include "cholesky.hpp"
+#include "error.hpp"
+#include "instrumentation.hpp"
+#include "matrix.hpp"
+#include "parallel.hpp"
+#include "sparse_matrix.hpp"
+#include "sparse_ordering.hpp"
+#include "sparse_symbolic.hpp"
+#include "task_graph.hpp"
+
+namespace kss { namespace math {
+
+    namespace _private {
+
+        // Fronts with at least this many update rows have their Schur complement
+        // computed in parallel column blocks.
+        constexpr std::size_t parallelFrontSize = 512;
+        constexpr std::size_t frontBlockSize = 64;
+
+        // Runs fn(s) for every supernode as a task that depends on the tasks of its
+        // children, so independent subtrees of the assembly tree are factored
+        // concurrently.
+        template <class Fn>
+        void supernodalTasks(const std::vector<Supernode>& supernodes, const Fn& fn, unsigned threads) {
+            TaskGraph graph;
+            std::vector<TaskGraph::task_id> ids(supernodes.size());
+            for (std::size_t s = 0; s < supernodes.size(); ++s) {
+                std::vector<TaskGraph::task_id> deps;
+                for (auto c : supernodes[s].children) {
+                    deps.push_back(ids[c]);
+                }
+                ids[s] = graph.add([&fn, s] { fn(s); }, deps);
+            }
+            graph.run(threads);
+        }
+
+        // Returns a copy of the rows x cols block at a.
+        template <class T>
+        Matrix<T> copyBlock(std::size_t rows, std::size_t cols, const T* a, std::size_t lda) {
+            Matrix<T> res(rows, cols);
+            for (std::size_t j = 0; j < cols; ++j) {
+                std::copy(a + j * lda, a + j * lda + rows, res.column(j));
+            }
+            return res;
+        }
+
+        // Adds the update matrix of a child into the front f, where pos gives the
+        // row of f for each row of the update. Only the lower triangle is added if
+        // lowerOnly is true.
+        template <class T>
+        void extendAdd(const Matrix<T>& update, const std::vector<std::size_t>& pos, Matrix<T>& f, bool lowerOnly) {
+            const std::size_t m = update.rows();
+            for (std::size_t j = 0; j < m; ++j) {
+                const T* uj = update.column(j);
+                T* fj = f.column(pos[j]);
+                for (std::size_t i = (lowerOnly ? j : 0); i < m; ++i) {
+                    fj[pos[i]] += uj[i];
+                }
+            }
+        }
+
+        // Lower triangle of C -= A*A' where A is m x k, split into column blocks
+        // that are computed in parallel when C is large.
+        template <class T>
+        void schurUpdateLower(std::size_t m, std::size_t k, const T* a, std::size_t lda,
+                              T* c, std::size_t ldc, unsigned threads)
+        {
+            const std::size_t nb = frontBlockSize;
+            const std::size_t blocks = (m + nb - 1) / nb;
+            parallelFor(blocks, (m >= parallelFrontSize ? 1 : blocks), [&](std::size_t b0, std::size_t b1) {
+                for (std::size_t b = b0; b < b1; ++b) {
+                    const std::size_t j0 = b * nb;
+                    const std::size_t jb = std::min(nb, m - j0);
+                    blas::syrkLower(jb, k, T(-1), a + j0, lda, T(1), c + j0 + j0 * ldc, ldc);
+                    if (j0 + jb < m) {
+                        blas::gemm(blas::Op::NoTrans, blas::Op::Trans, m - j0 - jb, jb, k, T(-1),
+                                   a + j0 + jb, lda, a + j0, lda, T(1), c + j0 + jb + j0 * ldc, ldc);
+                    }
+                }
+            }, threads);
+        }
+
+        // C -= A*B where A is m x k and B is k x m, in parallel column blocks when
+        // C is large.
+        template <class T>
+        void schurUpdate(std::size_t m, std::size_t k, const T* a, std::size_t lda, const T* b, std::size_t ldb,
+                         T* c, std::size_t ldc, unsigned threads)
+        {
+            const std::size_t nb = frontBlockSize;
+            const std::size_t blocks = (m + nb - 1) / nb;
+            parallelFor(blocks, (m >= parallelFrontSize ? 1 : blocks), [&](std::size_t b0, std::size_t b1) {
+                const std::size_t j0 = b0 * nb;
+                const std::size_t jb = std::min(b1 * nb, m) - j0;
+                blas::gemm(blas::Op::NoTrans, blas::Op::NoTrans, m, jb, k, T(-1), a, lda,
+                           b + j0 * ldb, ldb, T(1), c + j0 * ldc, ldc);
+            }, threads);
+        }
+
+        inline std::shared_ptr<const SparseSymbolic> checkedSymbolic(std::shared_ptr<const SparseSymbolic> symbolic) {
+            if (!symbolic) {
+                throw std::invalid_argument("sparse factorization: symbolic analysis is required");
+            }
+            return symbolic;
+        }
+
+    }
+
+    /*!
+     Sparse Cholesky factorization PAP' = LL' of a symmetric positive definite
+     matrix. Only the lower triangle of A is referenced (the pattern may contain
+     either or both triangles).
+
+     The factorization is supernodal and multifrontal. Columns of L with the same
+     structure are grouped into supernodes whose fronts are dense, so nearly all of
+     the arithmetic is done by the dense POTRF/TRSM/SYRK kernels. Each supernode is
+     a task in a TaskGraph that depends on its children, which factors the
+     independent subtrees of the assembly tree in parallel, and the Schur updates
+     of the large fronts near the root are themselves split over the threads.
+
+     The symbolic analysis (ordering and structure) is held in a shared
+     SparseSymbolic so it can be reused. refactor() computes a new numeric
+     factorization of a matrix with the same pattern without repeating it.
+     */
+    template <class T>
+    class SparseCholesky {
+    public:
+        using size_type = std::size_t;
+
+        /*!
+         Analyze and factor the matrix a.
+         @throws std::invalid_argument if a is not square.
+         @throws NotPositiveDefiniteError if a is not positive definite.
+         */
+        explicit SparseCholesky(const SparseMatrix<T>& a, SparseOrdering ordering = SparseOrdering::MinimumDegree,
+                                unsigned threads = 0)
+        : SparseCholesky(std::make_shared<const SparseSymbolic>(a, ordering), a, threads)
+        {}
+
+        /*!
+         Factor the matrix a using an existing symbolic analysis of its pattern.
+         @throws std::invalid_argument if symbolic is null or does not match a.
+         @throws NotPositiveDefiniteError if a is not positive definite.
+         */
+        SparseCholesky(std::shared_ptr<const SparseSymbolic> symbolic, const SparseMatrix<T>& a,
+                       unsigned threads = 0)
+        : _symbolic(_private::checkedSymbolic(std::move(symbolic))), _threads(threads)
+        {
+            refactor(a);
+        }
+
+        size_type size() const noexcept { return _symbolic->size(); }
+
+        /*!
+         Returns the symbolic analysis, which may be shared with other factorizations.
+         */
+        const std::shared_ptr<const SparseSymbolic>& symbolic() const noexcept { return _symbolic; }
+
+        /*!
+         Compute the numeric factorization of a, which must have the pattern of the
+         symbolic analysis.
+         @throws std::invalid_argument if a does not match the symbolic analysis.
+         @throws NotPositiveDefiniteError if a is not positive definite.
+         */
+        void refactor(const SparseMatrix<T>& a) {
+            if (!_symbolic->matches(a)) {
+                throw std::invalid_argument("SparseCholesky: matrix does not match the symbolic analysis");
+            }
+            KSSMATH_INSTRUMENT("SparseCholesky", 0, double(_symbolic->factorNonZeros()) * sizeof(T));
+            factor(a.values());
+        }
+
+        /*!
+         Solve Ax = b in place. On entry x holds b, on exit it holds the solution.
+         */
+        void solveInPlace(T* x) const {
+            const auto& sns = _symbolic->_supernodes;
+            const auto& perm = _symbolic->_perm;
+            const size_type n = size();
+            std::vector<T> y(n), tmp;
+            for (size_type k = 0; k < n; ++k) {
+                y[k] = x[perm[k]];
+            }
+            for (size_type s = 0; s < sns.size(); ++s) {
+                const auto& sn = sns[s];
+                const Matrix<T>& l = _blocks[s];
+                const size_type r = sn.rows.size(), c = sn.cols(), m = r - c;
+                T* ys = y.data() + sn.first;
+                blas::trsvLower(blas::Op::NoTrans, c, l.data(), r, ys);
+                if (m > 0) {
+                    tmp.resize(m);
+                    blas::gemv(m, c, T(1), l.data() + c, r, ys, T(0), tmp.data());
+                    for (size_type i = 0; i < m; ++i) {
+                        y[sn.rows[c + i]] -= tmp[i];
+                    }
+                }
+            }
+            for (size_type s = sns.size(); s-- > 0;) {
+                const auto& sn = sns[s];
+                const Matrix<T>& l = _blocks[s];
+                const size_type r = sn.rows.size(), c = sn.cols(), m = r - c;
+                T* ys = y.data() + sn.first;
+                if (m > 0) {
+                    tmp.resize(m);
+                    for (size_type i = 0; i < m; ++i) {
+                        tmp[i] = y[sn.rows[c + i]];
+                    }
+                    blas::gemvTranspose(m, c, T(-1), l.data() + c, r, tmp.data(), T(1), ys);
+                }
+                blas::trsvLower(blas::Op::Trans, c, l.data(), r, ys);
+            }
+            for (size_type k = 0; k < n; ++k) {
+                x[perm[k]] = y[k];
+            }
+        }
+
+        /*!
+         Returns the solution of Ax = b.
+         @throws std::invalid_argument if b is not the correct length.
+         */
+        std::vector<T> solve(std::vector<T> b) const {
+            if (b.size() != size()) {
+                throw std::invalid_argument("SparseCholesky::solve: b has the wrong length");
+            }
+            solveInPlace(b.data());
+            return b;
+        }
+
+        /*!
+         Returns log(det(A)).
+         */
+        T logDeterminant() const noexcept {
+            T sum = T(0);
+            for (size_type s = 0; s < _blocks.size(); ++s) {
+                for (size_type j = 0; j < _blocks[s].cols(); ++j) {
+                    sum += std::log(_blocks[s](j, j));
+                }
+            }
+            return T(2) * sum;
+        }
+
+    private:
+        std::shared_ptr<const SparseSymbolic>   _symbolic;
+        unsigned                                _threads;
+        std::vector<Matrix<T>>                  _blocks;    // supernode s: L(rows, first..last), rows x cols
+
+        void factor(const std::vector<T>& values) {
+            const auto& sns = _symbolic->_supernodes;
+            const unsigned threads = _threads;
+            std::vector<Matrix<T>> updates(sns.size());
+            _blocks.assign(sns.size(), Matrix<T>());
+            _private::supernodalTasks(sns, [&](size_type s) {
+                const auto& sn = sns[s];
+                const size_type r = sn.rows.size(), c = sn.cols(), m = r - c;
+                Matrix<T> f(r, r);
+                for (const auto& e : sn.entries) {
+                    if (e.lower) {
+                        f(std::max(e.i, e.j), std::min(e.i, e.j)) += values[e.k];
+                    }
+                }
+                for (auto child : sn.children) {
+                    _private::extendAdd(updates[child], sns[child].parentPositions, f, true);
+                    updates[child] = Matrix<T>();
+                }
+
+                _private::potrfLower(c, f.data(), r);
+                if (m > 0) {
+                    blas::trsmRightLowerTrans(m, c, f.data(), r, f.data() + c, r);
+                    _private::schurUpdateLower(m, c, f.data() + c, r, f.data() + c + c * r, r, threads);
+                    updates[s] = _private::copyBlock(m, m, f.data() + c + c * r, r);
+                }
+                _blocks[s] = _private::copyBlock(r, c, f.data(), r);
+            }, threads);
+        }
+    };
+
+    /*!
+     Options for SparseLU.
+     */
+    struct SparseLUOptions {
+        SparseOrdering  ordering = SparseOrdering::MinimumDegree;
+
+        /*!
+         Pivots smaller than pivotThreshold*max|a_ij| are replaced by that value
+         (with the same sign) rather than stopping the factorization.
+         */
+        double          pivotThreshold = 1e-8;
+
+        /*!
+         The maximum number of steps of iterative refinement performed by solve()
+         when the backward error of the solution is above the rounding level.
+         */
+        std::size_t     refinementSteps = 2;
+
+        unsigned        threads = 0;
+    };
+
+    /*!
+     Sparse LU factorization of a general square matrix.
+
+     This uses the same supernodal multifrontal structure as SparseCholesky,
+     computed from the pattern of A + A', with full (square) fronts. That suits
+     matrices whose pattern is close to symmetric, such as those from the
+     discretization of PDEs and circuit or Jacobian matrices. Pivoting is
+     restricted to the rows within each pivot block so that the structure is
+     known in advance, and pivots that are still too small are perturbed. The
+     restricted pivoting can let the elements of the factors grow, so solve()
+     checks the residual of every solution and applies iterative refinement
+     against the original matrix whenever the backward error is above the
+     rounding level. A factorization whose growth leaves no correct digits, or
+     a solution that refinement cannot repair, is reported as a
+     SingularMatrixError: matrices that are only stable with pivoting far from
+     the diagonal should use the dense LU instead.
+
+     Like SparseCholesky, the symbolic analysis is shared and refactor() reuses it.
+     */
+    template <class T>
+    class SparseLU {
+    public:
+        using size_type = std::size_t;
+
+        /*!
+         Analyze and factor the matrix a.
+         @throws std::invalid_argument if a is not square.
+         @throws SingularMatrixError if a is zero or contains non-finite values, or
+            the factors are useless because of pivot growth.
+         */
+        explicit SparseLU(const SparseMatrix<T>& a, const SparseLUOptions& opts = SparseLUOptions())
+        : SparseLU(std::make_shared<const SparseSymbolic>(a, opts.ordering), a, opts)
+        {}
+
+        /*!
+         Factor the matrix a using an existing symbolic analysis of its pattern.
+         @throws std::invalid_argument if symbolic is null or does not match a.
+         @throws SingularMatrixError if a is zero or contains non-finite values, or
+            the factors are useless because of pivot growth.
+         */
+        SparseLU(std::shared_ptr<const SparseSymbolic> symbolic, const SparseMatrix<T>& a,
+                 const SparseLUOptions& opts = SparseLUOptions())
+        : _symbolic(_private::checkedSymbolic(std::move(symbolic))), _opts(opts)
+        {
+            refactor(a);
+        }
+
+        size_type size() const noexcept { return _symbolic->size(); }
+        const std::shared_ptr<const SparseSymbolic>& symbolic() const noexcept { return _symbolic; }
+
+        /*!
+         Returns the number of pivots that were perturbed by the last factorization.
+         If this is nonzero the factors are those of a nearby matrix.
+         */
+        size_type perturbedPivots() const noexcept { return _perturbed; }
+
+        /*!
+         Returns the pivot growth of the last factorization, the largest element
+         of the factors divided by the largest element of A.
+         */
+        T pivotGrowth() const noexcept { return _growth; }
+
+        /*!
+         Compute the numeric factorization of a, which must have the pattern of the
+         symbolic analysis.
+         @throws std::invalid_argument if a does not match the symbolic analysis.
+         @throws SingularMatrixError if a is zero or contains non-finite values, or
+            the factors are useless because of pivot growth.
+         */
+        void refactor(const SparseMatrix<T>& a) {
+            if (!_symbolic->matches(a)) {
+                throw std::invalid_argument("SparseLU: matrix does not match the symbolic analysis");
+            }
+            KSSMATH_INSTRUMENT("SparseLU", 0, 2.0 * double(_symbolic->factorNonZeros()) * sizeof(T));
+            _a = a;
+            factor();
+        }
+
+        /*!
+         Solve Ax = b in place using the factors only, without checking the
+         residual or refining the solution.
+         */
+        void solveInPlace(T* x) const {
+            const auto& sns = _symbolic->_supernodes;
+            const auto& perm = _symbolic->_perm;
+            const size_type n = size();
+            std::vector<T> y(n), tmp;
+            for (size_type k = 0; k < n; ++k) {
+                y[k] = x[perm[k]];
+            }
+            for (size_type s = 0; s < sns.size(); ++s) {
+                const auto& sn = sns[s];
+                const Matrix<T>& l = _lower[s];
+                const size_type r = sn.rows.size(), c = sn.cols(), m = r - c;
+                T* ys = y.data() + sn.first;
+                for (size_type k = 0; k < c; ++k) {
+                    std::swap(ys[k], ys[_pivots[s][k]]);
+                }
+                blas::trsvLower(blas::Op::NoTrans, c, l.data(), r, ys, true);
+                if (m > 0) {
+                    tmp.resize(m);
+                    blas::gemv(m, c, T(1), l.data() + c, r, ys, T(0), tmp.data());
+                    for (size_type i = 0; i < m; ++i) {
+                        y[sn.rows[c + i]] -= tmp[i];
+                    }
+                }
+            }
+            for (size_type s = sns.size(); s-- > 0;) {
+                const auto& sn = sns[s];
+                const Matrix<T>& l = _lower[s];
+                const size_type r = sn.rows.size(), c = sn.cols(), m = r - c;
+                T* ys = y.data() + sn.first;
+                if (m > 0) {
+                    tmp.resize(m);
+                    for (size_type i = 0; i < m; ++i) {
+                        tmp[i] = y[sn.rows[c + i]];
+                    }
+                    blas::gemv(c, m, T(-1), _upper[s].data(), c, tmp.data(), T(1), ys);
+                }
+                blas::trsvUpper(c, l.data(), r, ys);
+            }
+            for (size_type k = 0; k < n; ++k) {
+                x[perm[k]] = y[k];
+            }
+        }
+
+        /*!
+         Returns the solution of Ax = b. Whenever its normwise backward error
+         ||b - Ax|| / (||A|| ||x|| + ||b||) is above the rounding level this is
+         followed by up to the configured number of steps of iterative refinement,
+         stopping early if a step does not reduce the residual.
+         @throws std::invalid_argument if b is not the correct length.
+         @throws SingularMatrixError if the backward error of the best solution
+            found is still above sqrt(eps), which means that the factors are too
+            far from A (or the solution is not finite).
+         */
+        std::vector<T> solve(const std::vector<T>& b) const {
+            if (b.size() != size()) {
+                throw std::invalid_argument("SparseLU::solve: b has the wrong length");
+            }
+            const T eps = std::numeric_limits<T>::epsilon();
+            const T bnorm = maxAbs(b);
+            std::vector<T> x = b, r(b.size()), best;
+            T bestError = std::numeric_limits<T>::infinity();
+            solveInPlace(x.data());
+            for (size_type step = 0; ; ++step) {
+                _a.multiply(x.data(), r.data(), _opts.threads);
+                T rnorm = T(0);
+                for (size_type i = 0; i < r.size(); ++i) {
+                    r[i] = b[i] - r[i];
+                    rnorm = std::max(rnorm, std::abs(r[i]));
+                }
+                const T denom = _anorm * maxAbs(x) + bnorm;
+                const T error = (denom > T(0) ? rnorm / denom : rnorm);
+                if (!(error < bestError)) {
+                    break;
+                }
+                bestError = error;
+                best = x;
+                if (error <= eps || step == _opts.refinementSteps) {
+                    break;
+                }
+                solveInPlace(r.data());
+                for (size_type i = 0; i < r.size(); ++i) {
+                    x[i] += r[i];
+                }
+            }
+            if (!(bestError <= std::sqrt(eps))) {
+                throw SingularMatrixError("SparseLU::solve: iterative refinement failed, "
+                                          "the matrix needs pivoting outside the supernodes");
+            }
+            return best;
+        }
+
+    private:
+        std::shared_ptr<const SparseSymbolic>   _symbolic;
+        SparseLUOptions                         _opts;
+        SparseMatrix<T>                         _a;
+        std::vector<Matrix<T>>                  _lower;     // supernode s: L11\U11 over L21, rows x cols
+        std::vector<Matrix<T>>                  _upper;     // supernode s: U12, cols x (rows-cols)
+        std::vector<std::vector<size_type>>     _pivots;    // supernode s: row k was swapped with row pivots[k]
+        size_type                               _perturbed = 0;
+        T                                       _growth = T(0);
+        T                                       _anorm = T(0);  // ||A|| in the infinity norm
+
+        // Returns the largest absolute value, which is NaN if any value is.
+        static T maxAbs(const std::vector<T>& v) noexcept {
+            T m = T(0);
+            for (auto x : v) {
+                if (!(std::abs(x) <= m)) {
+                    m = std::abs(x);
+                }
+            }
+            return m;
+        }
+
+        void factor() {
+            const auto& sns = _symbolic->_supernodes;
+            const auto& values = _a.values();
+            T anorm = T(0);
+            for (auto v : values) {
+                if (!std::isfinite(v)) {
+                    throw SingularMatrixError("SparseLU: matrix contains non-finite values");
+                }
+                anorm = std::max(anorm, std::abs(v));
+            }
+            if (anorm == T(0)) {
+                throw SingularMatrixError("SparseLU: matrix is zero");
+            }
+            const T tiny = T(_opts.pivotThreshold) * anorm;
+            const unsigned threads = _opts.threads;
+
+            _anorm = T(0);
+            for (size_type i = 0; i < _a.rows(); ++i) {
+                T sum = T(0);
+                for (size_type k = _a.rowPointers()[i]; k < _a.rowPointers()[i + 1]; ++k) {
+                    sum += std::abs(values[k]);
+                }
+                _anorm = std::max(_anorm, sum);
+            }
+
+            std::vector<Matrix<T>> updates(sns.size());
+            std::vector<size_type> perturbed(sns.size(), 0);
+            std::vector<T> largest(sns.size(), T(0));
+            _lower.assign(sns.size(), Matrix<T>());
+            _upper.assign(sns.size(), Matrix<T>());
+            _pivots.assign(sns.size(), std::vector<size_type>());
+            _private::supernodalTasks(sns, [&](size_type s) {
+                const auto& sn = sns[s];
+                const size_type r = sn.rows.size(), c = sn.cols(), m = r - c;
+                Matrix<T> f(r, r);
+                for (const auto& e : sn.entries) {
+                    f(e.i, e.j) += values[e.k];
+                }
+                for (auto child : sn.children) {
+                    _private::extendAdd(updates[child], sns[child].parentPositions, f, false);
+                    updates[child] = Matrix<T>();
+                }
+
+                // Partial pivoting within the pivot block, right-looking over the
+                // pivot columns, with the whole front rows swapped.
+                auto& piv = _pivots[s];
+                piv.resize(c);
+                for (size_type k = 0; k < c; ++k) {
+                    T* fk = f.column(k);
+                    const size_type p = k + size_type(std::max_element(fk + k, fk + c, [](T x, T y) {
+                        return std::abs(x) < std::abs(y);
+                    }) - (fk + k));
+                    piv[k] = p;
+                    if (p != k) {
+                        for (size_type j = 0; j < r; ++j) {
+                            std::swap(f(k, j), f(p, j));
+                        }
+                    }
+                    if (!(std::abs(fk[k]) >= tiny)) {
+                        fk[k] = (fk[k] < T(0) ? -tiny : tiny);
+                        ++perturbed[s];
+                    }
+                    blas::scal(r - k - 1, T(1) / fk[k], fk + k + 1);
+                    for (size_type j = k + 1; j < c; ++j) {
+                        blas::axpy(r - k - 1, -f(k, j), fk + k + 1, f.column(j) + k + 1);
+                    }
+                }
+                if (m > 0) {
+                    blas::trsmLeftLower(c, m, f.data(), r, f.data() + c * r, r, true);
+                    _private::schurUpdate(m, c, f.data() + c, r, f.data() + c * r, r, f.data() + c + c * r, r,
+                                          threads);
+                    updates[s] = _private::copyBlock(m, m, f.data() + c + c * r, r);
+                    _upper[s] = _private::copyBlock(c, m, f.data() + c * r, r);
+                }
+                _lower[s] = _private::copyBlock(r, c, f.data(), r);
+
+                // The largest element of the front, which is NaN if any is, since
+                // the pivoting cannot control the growth across supernodes.
+                T big = T(0);
+                for (size_type i = 0; i < f.size(); ++i) {
+                    if (!(std::abs(f.data()[i]) <= big)) {
+                        big = std::abs(f.data()[i]);
+                    }
+                }
+                largest[s] = big;
+            }, threads);
+
+            _perturbed = 0;
+            for (auto p : perturbed) {
+                _perturbed += p;
+            }
+            T big = T(0);
+            for (auto l : largest) {
+                if (!(l <= big)) {
+                    big = l;
+                }
+            }
+            _growth = big / anorm;
+            if (!(_growth * std::numeric_limits<T>::epsilon() < T(1))) {
+                throw SingularMatrixError("SparseLU: pivot growth is too large, "
+                                          "the matrix needs pivoting outside the supernodes");
+            }
+        }
+    };
+
+}}
+
+#endif
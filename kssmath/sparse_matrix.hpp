@@ -0,0 +1,269 @@
+//
+//  sparse_matrix.hpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#ifndef kssmath_sparse_matrix_hpp
+#define kssmath_sparse_matrix_hpp
+
+#include <algorithm>
+#include <cstddef>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "instrumentation.hpp"
+#include "linear_operator.hpp"
+#include "matrix.hpp"
+#include "parallel.hpp"
+#include "tuning.hpp"
+
+namespace kss { namespace math {
+
+    /*!
+     A single entry of a sparse matrix, used to build a SparseMatrix.
+     */
+    template <class T>
+    struct Triplet {
+        std::size_t row;
+        std::size_t col;
+        T           value;
+    };
+
+    /*!
+     A sparse matrix in compressed sparse row (CSR) form. Row i has its column
+     indices in columnIndices()[rowPointers()[i] .. rowPointers()[i+1]), strictly
+     increasing, with the matching entries in values().
+
+     The sparsity pattern is fixed once the matrix is constructed, but the values
+     may be modified in place, which lets solvers reuse work that only depends on
+     the pattern.
+     */
+    template <class T>
+    class SparseMatrix {
+    public:
+        using value_type = T;
+        using size_type = std::size_t;
+
+        /*!
+         Construct an empty (0 x 0) matrix.
+         */
+        SparseMatrix() : _rowPtr(1, 0) {}
+
+        /*!
+         Construct an empty rows x cols matrix, with no nonzero entries.
+         */
+        SparseMatrix(size_type rows, size_type cols) : _rows(rows), _cols(cols), _rowPtr(rows + 1, 0) {}
+
+        /*!
+         Construct a matrix from its CSR arrays.
+         @throws std::invalid_argument if the arrays are not consistent or the column
+            indices of a row are not strictly increasing.
+         */
+        SparseMatrix(size_type rows, size_type cols, std::vector<size_type> rowPointers,
+                     std::vector<size_type> columnIndices, std::vector<T> values)
+        : _rows(rows), _cols(cols), _rowPtr(std::move(rowPointers)), _colIdx(std::move(columnIndices)),
+          _values(std::move(values))
+        {
+            if (_rowPtr.size() != rows + 1 || _rowPtr.front() != 0 || _rowPtr.back() != _colIdx.size()
+                || _values.size() != _colIdx.size())
+            {
+                throw std::invalid_argument("SparseMatrix: inconsistent CSR arrays");
+            }
+            for (size_type i = 0; i < rows; ++i) {
+                if (_rowPtr[i] > _rowPtr[i + 1]) {
+                    throw std::invalid_argument("SparseMatrix: row pointers must be nondecreasing");
+                }
+                for (size_type k = _rowPtr[i]; k < _rowPtr[i + 1]; ++k) {
+                    if (_colIdx[k] >= cols || (k > _rowPtr[i] && _colIdx[k] <= _colIdx[k - 1])) {
+                        throw std::invalid_argument("SparseMatrix: column indices must be increasing and in range");
+                    }
+                }
+            }
+        }
+
+        /*!
+         Construct a matrix from a list of entries in any order. Duplicate entries
+         are summed.
+         @throws std::out_of_range if an entry lies outside the matrix.
+         */
+        static SparseMatrix fromTriplets(size_type rows, size_type cols, const std::vector<Triplet<T>>& entries) {
+            SparseMatrix res(rows, cols);
+            for (const auto& t : entries) {
+                if (t.row >= rows || t.col >= cols) {
+                    throw std::out_of_range("SparseMatrix::fromTriplets: entry is outside the matrix");
+                }
+                ++res._rowPtr[t.row + 1];
+            }
+            std::partial_sum(res._rowPtr.begin(), res._rowPtr.end(), res._rowPtr.begin());
+            std::vector<size_type> next(res._rowPtr.begin(), res._rowPtr.end() - 1);
+            std::vector<std::pair<size_type, T>> tmp(entries.size());
+            for (const auto& t : entries) {
+                tmp[next[t.row]++] = std::make_pair(t.col, t.value);
+            }
+
+            // Sort each row and merge the duplicates.
+            size_type out = 0;
+            for (size_type i = 0; i < rows; ++i) {
+                const auto first = tmp.begin() + long(res._rowPtr[i]);
+                const auto last = tmp.begin() + long(res._rowPtr[i + 1]);
+                std::sort(first, last, [](const std::pair<size_type, T>& a, const std::pair<size_type, T>& b) {
+                    return a.first < b.first;
+                });
+                res._rowPtr[i] = out;
+                for (auto it = first; it != last; ++it) {
+                    if (out > res._rowPtr[i] && tmp[out - 1].first == it->first) {
+                        tmp[out - 1].second += it->second;
+                    }
+                    else {
+                        tmp[out++] = *it;
+                    }
+                }
+            }
+            res._rowPtr[rows] = out;
+            res._colIdx.resize(out);
+            res._values.resize(out);
+            for (size_type k = 0; k < out; ++k) {
+                res._colIdx[k] = tmp[k].first;
+                res._values[k] = tmp[k].second;
+            }
+            return res;
+        }
+
+        /*!
+         Construct a sparse matrix from the nonzero entries of a dense one.
+         */
+        explicit SparseMatrix(const Matrix<T>& a) : SparseMatrix(a.rows(), a.cols()) {
+            for (size_type i = 0; i < _rows; ++i) {
+                for (size_type j = 0; j < _cols; ++j) {
+                    if (a(i, j) != T(0)) {
+                        _colIdx.push_back(j);
+                        _values.push_back(a(i, j));
+                    }
+                }
+                _rowPtr[i + 1] = _colIdx.size();
+            }
+        }
+
+        size_type rows() const noexcept { return _rows; }
+        size_type cols() const noexcept { return _cols; }
+        size_type nonZeros() const noexcept { return _colIdx.size(); }
+        bool isSquare() const noexcept { return _rows == _cols; }
+
+        const std::vector<size_type>& rowPointers() const noexcept { return _rowPtr; }
+        const std::vector<size_type>& columnIndices() const noexcept { return _colIdx; }
+        const std::vector<T>& values() const noexcept { return _values; }
+        std::vector<T>& values() noexcept { return _values; }
+
+        /*!
+         Returns the entry (i, j), which is zero if it is not stored.
+         @throws std::out_of_range if (i, j) is outside the matrix.
+         */
+        T at(size_type i, size_type j) const {
+            if (i >= _rows || j >= _cols) {
+                throw std::out_of_range("SparseMatrix::at: index is outside the matrix");
+            }
+            const auto first = _colIdx.begin() + long(_rowPtr[i]);
+            const auto last = _colIdx.begin() + long(_rowPtr[i + 1]);
+            const auto it = std::lower_bound(first, last, j);
+            return (it != last && *it == j ? _values[size_type(it - _colIdx.begin())] : T(0));
+        }
+
+        /*!
+         Returns true if the two matrices have the same dimensions and sparsity
+         pattern (the values may differ).
+         */
+        bool samePattern(const SparseMatrix& other) const noexcept {
+            return _rows == other._rows && _cols == other._cols && _rowPtr == other._rowPtr
+                && _colIdx == other._colIdx;
+        }
+
+        /*!
+         Computes y = A*x, splitting the rows over the given number of threads.
+         */
+        void multiply(const T* x, T* y, unsigned threads = 0) const {
+            KSSMATH_INSTRUMENT("SparseMatrix::multiply", 2.0 * nonZeros(),
+                               double(nonZeros()) * (sizeof(T) + sizeof(size_type)) + 2.0 * _rows * sizeof(T));
+            parallelFor(_rows, tuningParameters().spmvChunkRows, [&](std::size_t r0, std::size_t r1) {
+                for (size_type i = r0; i < r1; ++i) {
+                    T sum = T(0);
+                    for (size_type k = _rowPtr[i]; k < _rowPtr[i + 1]; ++k) {
+                        sum += _values[k] * x[_colIdx[k]];
+                    }
+                    y[i] = sum;
+                }
+            }, threads);
+        }
+
+        /*!
+         Returns the main diagonal (zero where it is not stored).
+         */
+        std::vector<T> diagonal() const {
+            std::vector<T> d(std::min(_rows, _cols), T(0));
+            for (size_type i = 0; i < d.size(); ++i) {
+                d[i] = at(i, i);
+            }
+            return d;
+        }
+
+        /*!
+         Returns the transpose.
+         */
+        SparseMatrix transpose() const {
+            SparseMatrix res(_cols, _rows);
+            for (auto j : _colIdx) {
+                ++res._rowPtr[j + 1];
+            }
+            std::partial_sum(res._rowPtr.begin(), res._rowPtr.end(), res._rowPtr.begin());
+            res._colIdx.resize(nonZeros());
+            res._values.resize(nonZeros());
+            std::vector<size_type> next(res._rowPtr.begin(), res._rowPtr.end() - 1);
+            for (size_type i = 0; i < _rows; ++i) {
+                for (size_type k = _rowPtr[i]; k < _rowPtr[i + 1]; ++k) {
+                    const size_type pos = next[_colIdx[k]]++;
+                    res._colIdx[pos] = i;
+                    res._values[pos] = _values[k];
+                }
+            }
+            return res;
+        }
+
+        /*!
+         Returns the equivalent dense matrix.
+         */
+        Matrix<T> toDense() const {
+            Matrix<T> res(_rows, _cols);
+            for (size_type i = 0; i < _rows; ++i) {
+                for (size_type k = _rowPtr[i]; k < _rowPtr[i + 1]; ++k) {
+                    res(i, _colIdx[k]) = _values[k];
+                }
+            }
+            return res;
+        }
+
+    private:
+        size_type               _rows = 0;
+        size_type               _cols = 0;
+        std::vector<size_type>  _rowPtr;
+        std::vector<size_type>  _colIdx;
+        std::vector<T>          _values;
+    };
+
+    /*!
+     Returns an operator computing the product with the sparse matrix a. The
+     operator refers to a, which must outlive it.
+     */
+    template <class T>
+    LinearOperator<T> sparseOperator(const SparseMatrix<T>& a, unsigned threads = 0) {
+        const SparseMatrix<T>* pa = &a;
+        return [pa, threads](const T* x, T* y) { pa->multiply(x, y, threads); };
+    }
+
+}}
+
+#endif
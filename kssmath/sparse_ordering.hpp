@@ -0,0 +1,434 @@
+//
+//  sparse_ordering.hpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#ifndef kssmath_sparse_ordering_hpp
+#define kssmath_sparse_ordering_hpp
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <numeric>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "sparse_matrix.hpp"
+
+namespace kss { namespace math {
+
+    /*!
+     Fill reducing orderings for sparse factorizations.
+     */
+    enum class SparseOrdering {
+        Natural,            ///< No reordering.
+        MinimumDegree,      ///< Approximate minimum degree on the quotient graph.
+        NestedDissection    ///< Recursive level structure bisection, minimum degree on the small parts.
+    };
+
+    namespace _private {
+
+        // An undirected graph in CSR form without self loops.
+        struct AdjacencyGraph {
+            std::vector<std::size_t> ptr;
+            std::vector<std::size_t> adj;
+
+            std::size_t size() const noexcept { return ptr.size() - 1; }
+        };
+
+        // Returns the graph of the pattern of A + A'.
+        template <class T>
+        AdjacencyGraph symmetricGraph(const SparseMatrix<T>& a) {
+            const std::size_t n = a.rows();
+            const auto& rp = a.rowPointers();
+            const auto& ci = a.columnIndices();
+            std::vector<std::size_t> degree(n, 0);
+            for (std::size_t i = 0; i < n; ++i) {
+                for (std::size_t k = rp[i]; k < rp[i + 1]; ++k) {
+                    if (ci[k] != i) {
+                        ++degree[i];
+                        ++degree[ci[k]];
+                    }
+                }
+            }
+            AdjacencyGraph g;
+            g.ptr.assign(n + 1, 0);
+            std::partial_sum(degree.begin(), degree.end(), g.ptr.begin() + 1);
+            g.adj.resize(g.ptr[n]);
+            std::vector<std::size_t> next(g.ptr.begin(), g.ptr.end() - 1);
+            for (std::size_t i = 0; i < n; ++i) {
+                for (std::size_t k = rp[i]; k < rp[i + 1]; ++k) {
+                    if (ci[k] != i) {
+                        g.adj[next[i]++] = ci[k];
+                        g.adj[next[ci[k]]++] = i;
+                    }
+                }
+            }
+
+            // Sort and remove the duplicates from symmetric entries.
+            std::size_t out = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                const std::size_t first = g.ptr[i];
+                std::sort(g.adj.begin() + long(first), g.adj.begin() + long(g.ptr[i + 1]));
+                g.ptr[i] = out;
+                for (std::size_t k = first; k < g.ptr[i + 1]; ++k) {
+                    if (k == first || g.adj[k] != g.adj[k - 1]) {
+                        g.adj[out++] = g.adj[k];
+                    }
+                }
+            }
+            g.ptr[n] = out;
+            g.adj.resize(out);
+            return g;
+        }
+
+        // Approximate minimum degree ordering. The elimination is simulated on the
+        // quotient graph, where each eliminated node becomes an element
+        // representing the clique it created, so the storage never exceeds that of
+        // the original graph. Degrees are the approximate external degrees of AMD
+        // (Amestoy, Davis and Duff), and elements that become subsets of the new
+        // element are absorbed. Dense nodes are ordered last.
+        //
+        // Returns perm with perm[k] the node eliminated in position k.
+        inline std::vector<std::size_t> minimumDegree(const AdjacencyGraph& g) {
+            const std::size_t n = g.size();
+            std::vector<std::size_t> perm;
+            perm.reserve(n);
+            if (n == 0) {
+                return perm;
+            }
+
+            std::vector<std::vector<std::size_t>> vars(n), elems(n);
+            std::vector<std::size_t> degree(n);
+            std::vector<char> eliminated(n, 0), absorbed(n, 0);
+            std::vector<std::size_t> stamp(n, 0), ext(n, 0);
+            std::size_t tag = 0;
+            const std::size_t dense = std::max<std::size_t>(16, std::size_t(10 * std::sqrt(double(n))));
+
+            using entry = std::pair<std::size_t, std::size_t>;
+            std::priority_queue<entry, std::vector<entry>, std::greater<entry>> queue;
+            std::vector<std::size_t> denseNodes;
+            for (std::size_t i = 0; i < n; ++i) {
+                vars[i].assign(g.adj.begin() + long(g.ptr[i]), g.adj.begin() + long(g.ptr[i + 1]));
+                degree[i] = vars[i].size();
+                if (degree[i] > dense) {
+                    denseNodes.push_back(i);
+                    eliminated[i] = 1;
+                }
+            }
+            for (std::size_t i = 0; i < n; ++i) {
+                if (!eliminated[i]) {
+                    auto& v = vars[i];
+                    v.erase(std::remove_if(v.begin(), v.end(), [&](std::size_t j) { return eliminated[j] != 0; }),
+                            v.end());
+                    degree[i] = v.size();
+                    queue.push(entry(degree[i], i));
+                }
+            }
+
+            std::size_t remaining = n - denseNodes.size();
+            std::vector<std::size_t> lp;
+            while (!queue.empty()) {
+                const entry top = queue.top();
+                queue.pop();
+                const std::size_t p = top.second;
+                if (eliminated[p] || top.first != degree[p]) {
+                    continue;
+                }
+
+                // Form the new element L_p, absorbing the elements adjacent to p.
+                ++tag;
+                stamp[p] = tag;
+                lp.clear();
+                for (auto v : vars[p]) {
+                    if (!eliminated[v] && stamp[v] != tag) {
+                        stamp[v] = tag;
+                        lp.push_back(v);
+                    }
+                }
+                for (auto e : elems[p]) {
+                    if (absorbed[e]) {
+                        continue;
+                    }
+                    for (auto v : vars[e]) {
+                        if (!eliminated[v] && stamp[v] != tag) {
+                            stamp[v] = tag;
+                            lp.push_back(v);
+                        }
+                    }
+                    absorbed[e] = 1;
+                    std::vector<std::size_t>().swap(vars[e]);
+                }
+                eliminated[p] = 1;
+                perm.push_back(p);
+                --remaining;
+                std::vector<std::size_t>().swap(elems[p]);
+                vars[p] = lp;   // element p now lists its variables
+
+                // Prune the adjacency of the nodes in L_p: variables in L_p are now
+                // reached through element p.
+                for (auto i : lp) {
+                    auto& ev = elems[i];
+                    ev.erase(std::remove_if(ev.begin(), ev.end(), [&](std::size_t e) { return absorbed[e] != 0; }),
+                             ev.end());
+                    ev.push_back(p);
+                    auto& vv = vars[i];
+                    vv.erase(std::remove_if(vv.begin(), vv.end(), [&](std::size_t j) {
+                        return eliminated[j] || stamp[j] == tag;
+                    }), vv.end());
+                }
+
+                // |L_e \ L_p| for the other elements adjacent to L_p.
+                const std::size_t etag = ++tag;
+                for (auto i : lp) {
+                    for (auto e : elems[i]) {
+                        if (e == p) {
+                            continue;
+                        }
+                        if (stamp[e] != etag) {
+                            stamp[e] = etag;
+                            auto& ve = vars[e];
+                            ve.erase(std::remove_if(ve.begin(), ve.end(), [&](std::size_t j) {
+                                return eliminated[j] != 0;
+                            }), ve.end());
+                            ext[e] = ve.size();
+                        }
+                        --ext[e];
+                    }
+                }
+                for (auto i : lp) {
+                    std::size_t d = vars[i].size() + lp.size() - 1;
+                    for (auto e : elems[i]) {
+                        if (e == p) {
+                            continue;
+                        }
+                        if (ext[e] == 0) {
+                            absorbed[e] = 1;    // aggressive absorption: L_e is inside L_p
+                        }
+                        d += ext[e];
+                    }
+                    d = std::min(d, remaining - 1);
+                    if (d != degree[i]) {
+                        degree[i] = d;
+                        queue.push(entry(d, i));
+                    }
+                }
+            }
+            perm.insert(perm.end(), denseNodes.begin(), denseNodes.end());
+            return perm;
+        }
+
+        // Returns the subgraph induced by nodes (global indices), renumbered in the
+        // order given.
+        inline AdjacencyGraph inducedSubgraph(const AdjacencyGraph& g, const std::vector<std::size_t>& nodes,
+                                              std::vector<std::size_t>& local)
+        {
+            AdjacencyGraph sub;
+            sub.ptr.assign(nodes.size() + 1, 0);
+            for (std::size_t k = 0; k < nodes.size(); ++k) {
+                local[nodes[k]] = k;
+            }
+            for (std::size_t k = 0; k < nodes.size(); ++k) {
+                const std::size_t i = nodes[k];
+                for (std::size_t q = g.ptr[i]; q < g.ptr[i + 1]; ++q) {
+                    const std::size_t j = g.adj[q];
+                    if (local[j] < nodes.size() && nodes[local[j]] == j) {
+                        sub.adj.push_back(local[j]);
+                    }
+                }
+                sub.ptr[k + 1] = sub.adj.size();
+            }
+            return sub;
+        }
+
+        // Nested dissection by recursive bisection of level structures. Each part
+        // is split at the middle level of a breadth first search from a pseudo
+        // peripheral node, the separator (that level, trimmed to the nodes that
+        // actually touch the far side) is numbered last, and parts smaller than
+        // leafSize are ordered by minimum degree.
+        class NestedDissection {
+        public:
+            NestedDissection(const AdjacencyGraph& g, std::size_t leafSize)
+            : _g(g), _leafSize(leafSize), _region(g.size(), 0), _level(g.size(), 0), _local(g.size(), g.size())
+            {}
+
+            std::vector<std::size_t> order() {
+                std::vector<std::size_t> all(_g.size());
+                std::iota(all.begin(), all.end(), std::size_t(0));
+                _perm.clear();
+                _perm.reserve(all.size());
+                dissect(std::move(all), 0);
+                return _perm;
+            }
+
+        private:
+            const AdjacencyGraph&       _g;
+            std::size_t                 _leafSize;
+            std::vector<std::size_t>    _region;
+            std::vector<std::size_t>    _level;
+            std::vector<std::size_t>    _local;
+            std::vector<std::size_t>    _perm;
+            std::size_t                 _nextRegion = 1;
+
+            // BFS from start over region; returns the nodes in visit order and sets
+            // _level. The last node visited is at the greatest distance.
+            std::vector<std::size_t> bfs(std::size_t start, std::size_t region) {
+                std::vector<std::size_t> visit;
+                const std::size_t seen = _nextRegion++;
+                _region[start] = seen;
+                _level[start] = 0;
+                visit.push_back(start);
+                for (std::size_t head = 0; head < visit.size(); ++head) {
+                    const std::size_t i = visit[head];
+                    for (std::size_t q = _g.ptr[i]; q < _g.ptr[i + 1]; ++q) {
+                        const std::size_t j = _g.adj[q];
+                        if (_region[j] == region) {
+                            _region[j] = seen;
+                            _level[j] = _level[i] + 1;
+                            visit.push_back(j);
+                        }
+                    }
+                }
+                // Restore the region marks.
+                for (auto i : visit) {
+                    _region[i] = region;
+                }
+                return visit;
+            }
+
+            void leaf(const std::vector<std::size_t>& nodes) {
+                const auto sub = inducedSubgraph(_g, nodes, _local);
+                for (auto k : minimumDegree(sub)) {
+                    _perm.push_back(nodes[k]);
+                }
+                for (auto i : nodes) {
+                    _local[i] = _g.size();
+                }
+            }
+
+            void dissect(std::vector<std::size_t> nodes, std::size_t region) {
+                if (nodes.size() <= _leafSize) {
+                    leaf(nodes);
+                    return;
+                }
+
+                // A disconnected part: order each component separately.
+                std::vector<std::size_t> visit = bfs(nodes.front(), region);
+                if (visit.size() < nodes.size()) {
+                    std::vector<std::vector<std::size_t>> components;
+                    std::vector<std::size_t> regions;
+                    for (auto i : nodes) {
+                        if (_region[i] != region) {
+                            continue;
+                        }
+                        std::vector<std::size_t> comp = bfs(i, region);
+                        const std::size_t rc = _nextRegion++;
+                        for (auto j : comp) {
+                            _region[j] = rc;
+                        }
+                        components.push_back(std::move(comp));
+                        regions.push_back(rc);
+                    }
+                    for (std::size_t c = 0; c < components.size(); ++c) {
+                        dissect(std::move(components[c]), regions[c]);
+                    }
+                    return;
+                }
+
+                // Pseudo peripheral node: repeat BFS from the farthest node while the
+                // eccentricity keeps growing.
+                for (int iter = 0; iter < 4; ++iter) {
+                    const std::size_t far = visit.back();
+                    const std::size_t height = _level[far];
+                    std::vector<std::size_t> next = bfs(far, region);
+                    const bool better = _level[next.back()] > height;
+                    visit = std::move(next);
+                    if (!better) {
+                        break;
+                    }
+                }
+
+                const std::size_t height = _level[visit.back()];
+                if (height < 2) {
+                    leaf(nodes);
+                    return;
+                }
+                std::size_t mid = _level[visit[visit.size() / 2]];
+                mid = std::max<std::size_t>(1, std::min(mid, height - 1));
+
+                const std::size_t ra = _nextRegion++;
+                const std::size_t rb = _nextRegion++;
+                const std::size_t rs = _nextRegion++;
+                std::vector<std::size_t> partA, partB, sep;
+                for (auto i : visit) {
+                    _region[i] = (_level[i] < mid ? ra : (_level[i] > mid ? rb : rs));
+                }
+                for (auto i : visit) {
+                    if (_region[i] == rs) {
+                        bool touchesB = false;
+                        for (std::size_t q = _g.ptr[i]; q < _g.ptr[i + 1] && !touchesB; ++q) {
+                            touchesB = (_region[_g.adj[q]] == rb);
+                        }
+                        if (!touchesB) {
+                            _region[i] = ra;
+                        }
+                    }
+                }
+                for (auto i : visit) {
+                    if (_region[i] == ra) {
+                        partA.push_back(i);
+                    }
+                    else if (_region[i] == rb) {
+                        partB.push_back(i);
+                    }
+                    else {
+                        sep.push_back(i);
+                    }
+                }
+                dissect(std::move(partA), ra);
+                dissect(std::move(partB), rb);
+                _perm.insert(_perm.end(), sep.begin(), sep.end());
+            }
+        };
+
+    }
+
+    /*!
+     Returns a fill reducing symmetric permutation for the sparse square matrix a,
+     based on the pattern of A + A'. perm[k] is the index of the row and column
+     of a that is eliminated k-th.
+     @throws std::invalid_argument if a is not square.
+     */
+    template <class T>
+    std::vector<std::size_t> fillReducingOrdering(const SparseMatrix<T>& a, SparseOrdering ordering) {
+        if (!a.isSquare()) {
+            throw std::invalid_argument("fillReducingOrdering: matrix must be square");
+        }
+        std::vector<std::size_t> perm;
+        switch (ordering) {
+            case SparseOrdering::Natural:
+                perm.resize(a.rows());
+                std::iota(perm.begin(), perm.end(), std::size_t(0));
+                break;
+            case SparseOrdering::MinimumDegree:
+                perm = _private::minimumDegree(_private::symmetricGraph(a));
+                break;
+            case SparseOrdering::NestedDissection: {
+                const auto g = _private::symmetricGraph(a);
+                perm = _private::NestedDissection(g, 128).order();
+                break;
+            }
+        }
+        return perm;
+    }
+
+}}
+
+#endif
@@ -0,0 +1,236 @@
+//
+//  sparse_product.hpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#ifndef kssmath_sparse_product_hpp
+#define kssmath_sparse_product_hpp
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "instrumentation.hpp"
+#include "parallel.hpp"
+#include "sparse_matrix.hpp"
+#include "task_graph.hpp"
+
+namespace kss { namespace math {
+
+    /*!
+     The accumulator used to merge the partial products of a row in sparseProduct.
+     */
+    enum class SparseAccumulator {
+        Automatic,  ///< Choose for each row from its number of partial products.
+        Hash,       ///< Open addressing hash table sized for the row.
+        Dense       ///< Dense array with the length of a row of the result.
+    };
+
+    /*!
+     Options for sparseProduct.
+     */
+    struct SparseProductOptions {
+        SparseAccumulator   accumulator = SparseAccumulator::Automatic;
+        unsigned            threads = 0;
+    };
+
+    namespace _private {
+
+        constexpr std::size_t noColumn = std::size_t(-1);
+
+        // Accumulates the entries of one row of a product. Each worker has its own,
+        // reused for all the rows of its chunk. The hash table only grows, and is
+        // cleared by resetting the slots used by the previous row. The dense arrays
+        // are only allocated if a row is found to need them.
+        template <class T>
+        class RowAccumulator {
+        public:
+            RowAccumulator(std::size_t cols, SparseAccumulator kind) : _cols(cols), _kind(kind) {}
+
+            // Start a new row with at most bound distinct columns.
+            void start(std::size_t bound) {
+                _useDense = (_kind == SparseAccumulator::Dense
+                             || (_kind == SparseAccumulator::Automatic && bound * 16 >= _cols));
+                _columns.clear();
+                for (auto h : _slots) {
+                    _keys[h] = noColumn;
+                }
+                _slots.clear();
+                if (_useDense) {
+                    if (_marker.empty()) {
+                        _marker.assign(_cols, noColumn);
+                        _dense.assign(_cols, T(0));
+                    }
+                    ++_row;
+                }
+                else {
+                    std::size_t capacity = 16;
+                    unsigned bits = 4;
+                    while (capacity < 2 * bound) {
+                        capacity *= 2;
+                        ++bits;
+                    }
+                    if (_keys.size() < capacity) {
+                        _keys.assign(capacity, noColumn);
+                        _values.resize(capacity);
+                    }
+                    _mask = capacity - 1;
+                    _shift = 64 - bits;
+                }
+            }
+
+            void add(std::size_t j, T value) {
+                if (_useDense) {
+                    if (_marker[j] != _row) {
+                        _marker[j] = _row;
+                        _dense[j] = value;
+                        _columns.push_back(j);
+                    }
+                    else {
+                        _dense[j] += value;
+                    }
+                    return;
+                }
+                for (std::size_t h = slot(j);; h = (h + 1) & _mask) {
+                    if (_keys[h] == j) {
+                        _values[h] += value;
+                        return;
+                    }
+                    if (_keys[h] == noColumn) {
+                        _keys[h] = j;
+                        _values[h] = value;
+                        _columns.push_back(j);
+                        _slots.push_back(h);
+                        return;
+                    }
+                }
+            }
+
+            std::size_t count() const noexcept { return _columns.size(); }
+
+            // Write the row, sorted by column.
+            void gather(std::size_t* colIdx, T* values) {
+                std::sort(_columns.begin(), _columns.end());
+                for (std::size_t k = 0; k < _columns.size(); ++k) {
+                    const std::size_t j = _columns[k];
+                    colIdx[k] = j;
+                    values[k] = (_useDense ? _dense[j] : lookup(j));
+                }
+            }
+
+        private:
+            std::size_t                 _cols;
+            SparseAccumulator           _kind;
+            bool                        _useDense = false;
+            std::vector<std::size_t>    _columns;
+            std::vector<std::size_t>    _slots;
+            std::size_t                 _row = 0;
+            std::vector<std::size_t>    _marker;
+            std::vector<T>              _dense;
+            std::vector<std::size_t>    _keys;
+            std::vector<T>              _values;
+            std::size_t                 _mask = 0;
+            unsigned                    _shift = 0;
+
+            // The first slot to probe for column j: the high bits of a
+            // multiplicative (Fibonacci) hash. The low bits would depend only on
+            // the low bits of j, so columns with a power of two stride, as in
+            // blocked and banded patterns, would share a few slots.
+            std::size_t slot(std::size_t j) const noexcept {
+                return std::size_t((std::uint64_t(j) * 0x9e3779b97f4a7c15ULL) >> _shift);
+            }
+
+            T lookup(std::size_t j) const noexcept {
+                std::size_t h = slot(j);
+                while (_keys[h] != j) {
+                    h = (h + 1) & _mask;
+                }
+                return _values[h];
+            }
+        };
+
+    }
+
+    /*!
+     Returns the product a*b of two sparse matrices.
+
+     The product is computed row by row (Gustavson's algorithm) in two phases over
+     the given number of threads. The symbolic phase counts the entries of each row
+     of the result, so that the result can be allocated exactly, and the numeric
+     phase then fills each row in place. Each worker merges the partial products of
+     a row in its own accumulator: a small hash table for rows with few partial
+     products, or a dense array for rows with many, so that the work is
+     proportional to the number of multiplications rather than the width of b.
+     @throws std::invalid_argument if the dimensions are not compatible.
+     */
+    template <class T>
+    SparseMatrix<T> sparseProduct(const SparseMatrix<T>& a, const SparseMatrix<T>& b,
+                                  const SparseProductOptions& opts = SparseProductOptions())
+    {
+        if (a.cols() != b.rows()) {
+            throw std::invalid_argument("sparseProduct: incompatible dimensions");
+        }
+        KSSMATH_INSTRUMENT("sparseProduct", 0,
+                           double(a.nonZeros() + b.nonZeros()) * (sizeof(T) + sizeof(std::size_t)));
+        const auto& ap = a.rowPointers();
+        const auto& ai = a.columnIndices();
+        const auto& av = a.values();
+        const auto& bp = b.rowPointers();
+        const auto& bi = b.columnIndices();
+        const auto& bv = b.values();
+        const std::size_t rows = a.rows();
+        const unsigned threads = (opts.threads == 0 ? defaultThreadCount() : opts.threads);
+        const std::size_t chunk = std::max<std::size_t>(64, rows / (8 * threads) + 1);
+
+        // Symbolic phase: the number of multiplications (an upper bound on the
+        // entries) and then the actual number of entries of each row.
+        std::vector<std::size_t> bound(rows), rowPtr(rows + 1, 0);
+        parallelFor(rows, chunk, [&](std::size_t r0, std::size_t r1) {
+            _private::RowAccumulator<T> acc(b.cols(), opts.accumulator);
+            for (std::size_t i = r0; i < r1; ++i) {
+                std::size_t ub = 0;
+                for (std::size_t ka = ap[i]; ka < ap[i + 1]; ++ka) {
+                    ub += bp[ai[ka] + 1] - bp[ai[ka]];
+                }
+                bound[i] = std::min(ub, b.cols());
+                acc.start(bound[i]);
+                for (std::size_t ka = ap[i]; ka < ap[i + 1]; ++ka) {
+                    for (std::size_t kb = bp[ai[ka]]; kb < bp[ai[ka] + 1]; ++kb) {
+                        acc.add(bi[kb], T(0));
+                    }
+                }
+                rowPtr[i + 1] = acc.count();
+            }
+        }, threads);
+        std::partial_sum(rowPtr.begin(), rowPtr.end(), rowPtr.begin());
+
+        // Numeric phase.
+        std::vector<std::size_t> colIdx(rowPtr.back());
+        std::vector<T> values(rowPtr.back());
+        parallelFor(rows, chunk, [&](std::size_t r0, std::size_t r1) {
+            _private::RowAccumulator<T> acc(b.cols(), opts.accumulator);
+            for (std::size_t i = r0; i < r1; ++i) {
+                acc.start(bound[i]);
+                for (std::size_t ka = ap[i]; ka < ap[i + 1]; ++ka) {
+                    const T aik = av[ka];
+                    for (std::size_t kb = bp[ai[ka]]; kb < bp[ai[ka] + 1]; ++kb) {
+                        acc.add(bi[kb], aik * bv[kb]);
+                    }
+                }
+                acc.gather(colIdx.data() + rowPtr[i], values.data() + rowPtr[i]);
+            }
+        }, threads);
+        return SparseMatrix<T>(rows, b.cols(), std::move(rowPtr), std::move(colIdx), std::move(values));
+    }
+
+}}
+
+#endif
@@ -0,0 +1,353 @@
+//
+//  sparse_symbolic.hpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#ifndef kssmath_sparse_symbolic_hpp
+#define kssmath_sparse_symbolic_hpp
+
+#include <algorithm>
+#include <cstddef>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#include "sparse_matrix.hpp"
+#include "sparse_ordering.hpp"
+
+namespace kss { namespace math {
+
+    template <class T> class SparseCholesky;
+    template <class T> class SparseLU;
+
+    namespace _private {
+
+        // An entry of A and where it is assembled: in the front of its supernode at
+        // local row i and column j (for the permuted entry). lower is true if the
+        // entry is in the lower triangle of the original matrix.
+        struct AssemblyEntry {
+            std::size_t k;
+            std::size_t i;
+            std::size_t j;
+            bool        lower;
+        };
+
+        // A supernode: the consecutive (permuted) columns [first, last) of the
+        // factor, which share the row structure rows. The first last-first rows are
+        // the columns themselves, the rest are in ascending order.
+        struct Supernode {
+            std::size_t                 first = 0;
+            std::size_t                 last = 0;
+            std::vector<std::size_t>    rows;
+            std::size_t                 parent = std::size_t(-1);
+            std::vector<std::size_t>    children;
+            std::vector<std::size_t>    parentPositions;    // local positions of rows[ncols..] in the parent
+            std::vector<AssemblyEntry>  entries;
+
+            std::size_t cols() const noexcept { return last - first; }
+        };
+
+    }
+
+    /*!
+     The symbolic analysis for a sparse factorization: the fill reducing ordering,
+     the elimination tree and the supernodal structure of the factor. It depends
+     only on the sparsity pattern, so it can be computed once and shared by the
+     numeric factorizations of any matrices with the same pattern, such as the
+     Jacobians of a Newton iteration.
+
+     The analysis is based on the pattern of A + A', so the same analysis serves
+     both SparseCholesky and SparseLU.
+     */
+    class SparseSymbolic {
+    public:
+        using size_type = std::size_t;
+
+        /*!
+         Analyze the pattern of the square matrix a.
+         @throws std::invalid_argument if a is not square.
+         */
+        template <class T>
+        explicit SparseSymbolic(const SparseMatrix<T>& a, SparseOrdering ordering = SparseOrdering::MinimumDegree)
+        : _n(a.rows()), _rowPtr(a.rowPointers()), _colIdx(a.columnIndices())
+        {
+            _perm = fillReducingOrdering(a, ordering);
+            analyze(_private::symmetricGraph(a));
+        }
+
+        /*!
+         Returns the dimension of the matrix.
+         */
+        size_type size() const noexcept { return _n; }
+
+        /*!
+         Returns the ordering: perm[k] is the row and column of the original matrix
+         that is eliminated k-th.
+         */
+        const std::vector<size_type>& permutation() const noexcept { return _perm; }
+
+        /*!
+         Returns the number of supernodes.
+         */
+        size_type supernodeCount() const noexcept { return _supernodes.size(); }
+
+        /*!
+         Returns the number of entries stored for the lower triangular factor,
+         including the explicit zeros introduced by merging supernodes.
+         */
+        size_type factorNonZeros() const noexcept { return _factorNonZeros; }
+
+        /*!
+         Returns true if a has the sparsity pattern this analysis was made for.
+         */
+        template <class T>
+        bool matches(const SparseMatrix<T>& a) const noexcept {
+            return a.rows() == _n && a.cols() == _n && a.rowPointers() == _rowPtr && a.columnIndices() == _colIdx;
+        }
+
+    private:
+        template <class T> friend class SparseCholesky;
+        template <class T> friend class SparseLU;
+
+        size_type                           _n;
+        std::vector<size_type>              _rowPtr;
+        std::vector<size_type>              _colIdx;
+        std::vector<size_type>              _perm;
+        std::vector<_private::Supernode>    _supernodes;
+        size_type                           _factorNonZeros = 0;
+
+        void analyze(const _private::AdjacencyGraph& g) {
+            const size_type n = _n;
+            const size_type none = size_type(-1);
+            std::vector<size_type> iperm(n);
+            for (size_type k = 0; k < n; ++k) {
+                iperm[_perm[k]] = k;
+            }
+
+            // Elimination tree (Liu's algorithm with path compression).
+            std::vector<size_type> parent(n, none), ancestor(n, none);
+            for (size_type k = 0; k < n; ++k) {
+                const size_type orig = _perm[k];
+                for (size_type q = g.ptr[orig]; q < g.ptr[orig + 1]; ++q) {
+                    size_type i = iperm[g.adj[q]];
+                    while (i < k) {
+                        const size_type next = ancestor[i];
+                        ancestor[i] = k;
+                        if (next == none) {
+                            parent[i] = k;
+                            break;
+                        }
+                        i = next;
+                    }
+                }
+            }
+
+            // Renumber by a postorder of the tree so that subtrees, and so the
+            // supernodes, are contiguous.
+            std::vector<size_type> head(n, none), sibling(n, none);
+            for (size_type j = n; j-- > 0;) {
+                if (parent[j] != none) {
+                    sibling[j] = head[parent[j]];
+                    head[parent[j]] = j;
+                }
+            }
+            std::vector<size_type> post;
+            post.reserve(n);
+            std::vector<size_type> stack;
+            for (size_type r = 0; r < n; ++r) {
+                if (parent[r] != none) {
+                    continue;
+                }
+                stack.push_back(r);
+                while (!stack.empty()) {
+                    const size_type j = stack.back();
+                    if (head[j] != none) {
+                        const size_type child = head[j];
+                        head[j] = sibling[child];
+                        stack.push_back(child);
+                    }
+                    else {
+                        post.push_back(j);
+                        stack.pop_back();
+                    }
+                }
+            }
+            std::vector<size_type> ipost(n);
+            for (size_type k = 0; k < n; ++k) {
+                ipost[post[k]] = k;
+            }
+            std::vector<size_type> perm(n), newParent(n, none);
+            for (size_type k = 0; k < n; ++k) {
+                perm[k] = _perm[post[k]];
+                if (parent[post[k]] != none) {
+                    newParent[k] = ipost[parent[post[k]]];
+                }
+            }
+            _perm = std::move(perm);
+            parent = std::move(newParent);
+            for (size_type k = 0; k < n; ++k) {
+                iperm[_perm[k]] = k;
+            }
+
+            // Permuted adjacency, then the column counts from the row subtrees.
+            std::vector<size_type> adjPtr(n + 1, 0), adj(g.adj.size());
+            for (size_type k = 0; k < n; ++k) {
+                const size_type orig = _perm[k];
+                adjPtr[k + 1] = adjPtr[k] + (g.ptr[orig + 1] - g.ptr[orig]);
+                for (size_type q = g.ptr[orig], p = adjPtr[k]; q < g.ptr[orig + 1]; ++q, ++p) {
+                    adj[p] = iperm[g.adj[q]];
+                }
+            }
+            std::vector<size_type> colCount(n, 1), mark(n, none), childCount(n, 0);
+            for (size_type k = 0; k < n; ++k) {
+                mark[k] = k;
+                if (parent[k] != none) {
+                    ++childCount[parent[k]];
+                }
+                for (size_type q = adjPtr[k]; q < adjPtr[k + 1]; ++q) {
+                    for (size_type j = adj[q]; j < k && mark[j] != k; j = parent[j]) {
+                        ++colCount[j];
+                        mark[j] = k;
+                    }
+                }
+            }
+
+            // Fundamental supernodes, then relaxed amalgamation of small ones.
+            std::vector<size_type> start;
+            for (size_type j = 0; j < n; ++j) {
+                const bool extend = (j > 0 && parent[j - 1] == j && colCount[j - 1] == colCount[j] + 1
+                                     && childCount[j] == 1);
+                if (!extend) {
+                    start.push_back(j);
+                }
+            }
+            start.push_back(n);
+            amalgamate(start, parent, colCount);
+
+            // Row structures, parents and children of the supernodes.
+            const size_type ns = start.size() - 1;
+            std::vector<size_type> snodeOf(n);
+            _supernodes.assign(ns, _private::Supernode());
+            for (size_type s = 0; s < ns; ++s) {
+                _supernodes[s].first = start[s];
+                _supernodes[s].last = start[s + 1];
+                for (size_type j = start[s]; j < start[s + 1]; ++j) {
+                    snodeOf[j] = s;
+                }
+            }
+            std::vector<size_type> position(n, none);
+            std::fill(mark.begin(), mark.end(), none);
+            for (size_type s = 0; s < ns; ++s) {
+                auto& sn = _supernodes[s];
+                std::vector<size_type> extra;
+                auto add = [&](size_type i) {
+                    if (i >= sn.last && mark[i] != s) {
+                        mark[i] = s;
+                        extra.push_back(i);
+                    }
+                };
+                for (size_type j = sn.first; j < sn.last; ++j) {
+                    for (size_type q = adjPtr[j]; q < adjPtr[j + 1]; ++q) {
+                        add(adj[q]);
+                    }
+                }
+                for (auto c : sn.children) {
+                    const auto& cn = _supernodes[c];
+                    for (size_type r = cn.cols(); r < cn.rows.size(); ++r) {
+                        add(cn.rows[r]);
+                    }
+                }
+                std::sort(extra.begin(), extra.end());
+                sn.rows.resize(sn.cols());
+                std::iota(sn.rows.begin(), sn.rows.end(), sn.first);
+                sn.rows.insert(sn.rows.end(), extra.begin(), extra.end());
+                for (size_type r = 0; r < sn.rows.size(); ++r) {
+                    position[sn.rows[r]] = r;
+                }
+                for (auto c : sn.children) {
+                    auto& cn = _supernodes[c];
+                    cn.parentPositions.resize(cn.rows.size() - cn.cols());
+                    for (size_type r = cn.cols(); r < cn.rows.size(); ++r) {
+                        cn.parentPositions[r - cn.cols()] = position[cn.rows[r]];
+                    }
+                }
+                if (!extra.empty()) {
+                    sn.parent = snodeOf[extra.front()];
+                    _supernodes[sn.parent].children.push_back(s);
+                }
+                const size_type nc = sn.cols();
+                const size_type nr = sn.rows.size();
+                _factorNonZeros += nc * nr - nc * (nc - 1) / 2;
+            }
+
+            // Where each entry of A is assembled.
+            for (size_type i = 0; i < n; ++i) {
+                for (size_type k = _rowPtr[i]; k < _rowPtr[i + 1]; ++k) {
+                    const size_type j = _colIdx[k];
+                    const size_type pi = iperm[i];
+                    const size_type pj = iperm[j];
+                    auto& sn = _supernodes[snodeOf[std::min(pi, pj)]];
+                    auto local = [&sn](size_type r) {
+                        return size_type(std::lower_bound(sn.rows.begin(), sn.rows.end(), r) - sn.rows.begin());
+                    };
+                    sn.entries.push_back(_private::AssemblyEntry { k, local(pi), local(pj), i >= j });
+                }
+            }
+        }
+
+        // Merge a supernode into its parent when it is the parent's last child
+        // (so the columns stay contiguous) and the explicit zeros this introduces
+        // are few relative to the size, following the relaxation rules of CHOLMOD.
+        // Larger dense blocks make the numeric factorization much more efficient.
+        static void amalgamate(std::vector<size_type>& start, const std::vector<size_type>& parent,
+                               const std::vector<size_type>& colCount)
+        {
+            const size_type n = parent.size();
+            std::vector<size_type> trueCount(n + 1, 0);
+            for (size_type j = 0; j < n; ++j) {
+                trueCount[j + 1] = trueCount[j] + colCount[j];
+            }
+            auto entries = [](size_type nc, size_type nr) { return nc * nr - nc * (nc - 1) / 2; };
+
+            // Each merged supernode: first column and number of rows of its front.
+            struct Merged { size_type first; size_type rows; };
+            std::vector<Merged> stack;
+            for (size_type s = 0; s + 1 < start.size(); ++s) {
+                Merged cur { start[s], colCount[start[s]] };
+                const size_type last = start[s + 1];
+                while (!stack.empty()) {
+                    const Merged& prev = stack.back();
+                    const size_type prevLast = cur.first;
+                    if (parent[prevLast - 1] < cur.first || parent[prevLast - 1] >= last) {
+                        break;
+                    }
+                    const size_type nc = last - prev.first;
+                    const size_type nr = (cur.first - prev.first) + cur.rows;
+                    const size_type total = entries(nc, nr);
+                    const double zeros = double(total - (trueCount[last] - trueCount[prev.first])) / double(total);
+                    const bool merge = nc <= 4 || (nc <= 16 && zeros < 0.8) || (nc <= 48 && zeros < 0.1)
+                        || zeros < 0.05;
+                    if (!merge) {
+                        break;
+                    }
+                    cur = Merged { prev.first, nr };
+                    stack.pop_back();
+                }
+                stack.push_back(cur);
+            }
+            std::vector<size_type> merged;
+            for (const auto& m : stack) {
+                merged.push_back(m.first);
+            }
+            merged.push_back(n);
+            start = std::move(merged);
+        }
+    };
+
+}}
+
+#endif
@@ -0,0 +1,457 @@
+//
+//  svd.hpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#ifndef kssmath_svd_hpp
+#define kssmath_svd_hpp
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "blas.hpp"
+#include "blocking.hpp"
+#include "instrumentation.hpp"
+#include "matrix.hpp"
+#include "parallel.hpp"
+#include "qr.hpp"
+#include "random.hpp"
+#include "tridiagonal_eigen.hpp"
+
+namespace kss { namespace math {
+
+    /*!
+     Options for the full SVD.
+     */
+    struct SVDOptions {
+        /*!
+         If false only the singular values are computed.
+         */
+        bool computeVectors = true;
+
+        BlockingOptions blocking;
+    };
+
+    /*!
+     Options for the randomized truncated SVD.
+     */
+    struct RandomizedSVDOptions {
+        /*!
+         The number of extra random samples beyond the requested rank. Larger values
+         improve the accuracy of the trailing singular values.
+         */
+        std::size_t oversampling = 10;
+
+        /*!
+         The number of power (subspace) iterations. Each iteration sharpens the
+         spectrum, which matters when the singular values decay slowly, at the cost
+         of two more passes over the matrix.
+         */
+        unsigned powerIterations = 2;
+
+        /*!
+         Seed for the random test matrix. The same seed gives the same result.
+         */
+        std::uint64_t seed = 0x6b73736d617468ull;
+
+        BlockingOptions blocking;
+    };
+
+    namespace _private {
+
+        // Computes C := op(A)*B splitting the rows of C over the threads. Each thread
+        // reads only its own rows (NoTrans) or columns (Trans) of A, so a large A is
+        // streamed through memory just once.
+        template <class T>
+        void gemmRowsParallel(blas::Op opA, std::size_t m, std::size_t n, std::size_t k,
+                              const T* a, std::size_t lda, const T* b, std::size_t ldb,
+                              T* c, std::size_t ldc, unsigned threads)
+        {
+            parallelFor(m, 256, [&](std::size_t r0, std::size_t r1) {
+                const T* ablk = (opA == blas::Op::NoTrans ? a + r0 : a + r0 * lda);
+                blas::gemm(opA, blas::Op::NoTrans, r1 - r0, n, k, T(1), ablk, lda, b, ldb,
+                           T(0), c + r0, ldc);
+            }, threads);
+        }
+
+        // Returns an orthonormal basis for the columns of y.
+        template <class T>
+        Matrix<T> orthonormalBasis(Matrix<T> y, const BlockingOptions& opts) {
+            return QR<T>(std::move(y), opts).Q();
+        }
+
+        // Add the candidate vector x to the orthonormal columns [0, r) of q if it is
+        // sufficiently independent of them. Returns true if it was added as column r.
+        template <class T>
+        bool extendBasis(Matrix<T>& q, std::size_t r, std::vector<T> x) {
+            const std::size_t n = q.rows();
+            const T original = blas::nrm2(n, x.data());
+            if (original == T(0)) {
+                return false;
+            }
+            for (int pass = 0; pass < 2; ++pass) {
+                for (std::size_t j = 0; j < r; ++j) {
+                    blas::axpy(n, -blas::dot(n, q.column(j), x.data()), q.column(j), x.data());
+                }
+            }
+            const T remaining = blas::nrm2(n, x.data());
+            if (remaining <= T(0.1) * original) {
+                return false;
+            }
+            blas::scal(n, T(1) / remaining, x.data());
+            std::copy(x.begin(), x.end(), q.column(r));
+            return true;
+        }
+
+        // SVD of the n x n upper bidiagonal matrix with diagonal d and superdiagonal e.
+        //
+        // This uses the Golub-Kahan form: the 2n x 2n tridiagonal matrix with zero
+        // diagonal and off diagonal (d0, e0, d1, e1, ...) has eigenvalues +/- sigma,
+        // with eigenvectors interleaving the right and left singular vectors. That
+        // lets us use the divide and conquer tridiagonal solver. For (nearly) zero
+        // singular values the +sigma and -sigma eigenvectors mix, so those singular
+        // vectors are instead rebuilt as an orthonormal completion from both.
+        //
+        // On exit s holds the singular values in descending order, and if u and v
+        // are not null they hold the singular vectors.
+        template <class T>
+        void bidiagonalSVD(std::size_t n, const T* d, const T* e, std::vector<T>& s,
+                           Matrix<T>* u, Matrix<T>* v, unsigned threads)
+        {
+            const std::size_t nn = 2 * n;
+            std::vector<T> td(nn, T(0)), te(nn, T(0));
+            for (std::size_t i = 0; i < n; ++i) {
+                te[2 * i] = d[i];
+                if (i + 1 < n) {
+                    te[2 * i + 1] = e[i];
+                }
+            }
+            s.resize(n);
+            if (!u) {
+                tridiagonalQL(nn, td.data(), te.data(), static_cast<T*>(nullptr), 0, 0);
+                for (std::size_t i = 0; i < n; ++i) {
+                    s[i] = std::abs(td[nn - 1 - i]);
+                }
+                std::sort(s.begin(), s.end(), [](T a, T b) { return a > b; });
+                return;
+            }
+
+            Matrix<T> x(nn, nn);
+            tridiagonalDivideAndConquer(nn, td.data(), te.data(), x.data(), nn, threads);
+            const T tol = T(nn) * std::numeric_limits<T>::epsilon() * std::max(std::abs(td[0]), std::abs(td[nn - 1]));
+
+            *u = Matrix<T>(n, n);
+            *v = Matrix<T>(n, n);
+            std::vector<T> vx(n), ux(n);
+            std::size_t good = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                s[i] = std::max(td[nn - 1 - i], T(0));
+                if (s[i] <= tol) {
+                    break;
+                }
+                const T* xi = x.column(nn - 1 - i);
+                for (std::size_t r = 0; r < n; ++r) {
+                    vx[r] = xi[2 * r];
+                    ux[r] = xi[2 * r + 1];
+                }
+                blas::scal(n, T(1) / blas::nrm2(n, vx.data()), vx.data());
+                blas::scal(n, T(1) / blas::nrm2(n, ux.data()), ux.data());
+                std::copy(vx.begin(), vx.end(), v->column(i));
+                std::copy(ux.begin(), ux.end(), u->column(i));
+                ++good;
+            }
+
+            // Complete the bases for the negligible singular values using the halves
+            // of both the +sigma and -sigma eigenvectors, then the unit vectors.
+            std::size_t ru = good, rv = good;
+            for (std::size_t i = good; i < n; ++i) {
+                s[i] = std::max(td[nn - 1 - i], T(0));
+            }
+            for (std::size_t i = good; i < n && (ru < n || rv < n); ++i) {
+                for (std::size_t col : { nn - 1 - i, i }) {
+                    const T* xi = x.column(col);
+                    for (std::size_t r = 0; r < n; ++r) {
+                        vx[r] = xi[2 * r];
+                        ux[r] = xi[2 * r + 1];
+                    }
+                    if (rv < n && extendBasis(*v, rv, vx)) {
+                        ++rv;
+                    }
+                    if (ru < n && extendBasis(*u, ru, ux)) {
+                        ++ru;
+                    }
+                }
+            }
+            for (std::size_t r = 0; r < n && (ru < n || rv < n); ++r) {
+                std::vector<T> unit(n, T(0));
+                unit[r] = T(1);
+                if (rv < n && extendBasis(*v, rv, unit)) {
+                    ++rv;
+                }
+                if (ru < n && extendBasis(*u, ru, unit)) {
+                    ++ru;
+                }
+            }
+        }
+
+        // Reduce the m x n (m >= n) matrix a to upper bidiagonal form Q'AP = B. The
+        // left reflectors are left in the columns of a below the diagonal (as for
+        // QR) and the right reflectors in the rows of a right of the superdiagonal.
+        template <class T>
+        void bidiagonalize(Matrix<T>& a, std::vector<T>& d, std::vector<T>& e,
+                           std::vector<T>& tauq, std::vector<T>& taup, unsigned threads)
+        {
+            const std::size_t m = a.rows();
+            const std::size_t n = a.cols();
+            d.assign(n, T(0));
+            e.assign(n > 0 ? n - 1 : 0, T(0));
+            tauq.assign(n, T(0));
+            taup.assign(n > 0 ? n - 1 : 0, T(0));
+            std::vector<T> w(n), y(m);
+            for (std::size_t i = 0; i < n; ++i) {
+                T* aii = &a(i, i);
+                tauq[i] = householder(m - i, aii);
+                d[i] = aii[0];
+                if (i + 1 == n) {
+                    break;
+                }
+                parallelFor(n - i - 1, 64, [&](std::size_t j0, std::size_t j1) {
+                    applyReflector(m - i, j1 - j0, aii, tauq[i], aii + (1 + j0) * m, m);
+                }, threads);
+
+                // Right reflector for row i, working on a contiguous copy of the row.
+                const std::size_t len = n - i - 1;
+                for (std::size_t j = 0; j < len; ++j) {
+                    w[j] = a(i, i + 1 + j);
+                }
+                const T tp = householder(len, w.data());
+                taup[i] = tp;
+                e[i] = w[0];
+                w[0] = T(1);
+                for (std::size_t j = 0; j < len; ++j) {
+                    a(i, i + 1 + j) = w[j];
+                }
+                a(i, i + 1) = e[i];
+                if (tp != T(0) && i + 1 < m) {
+                    // A(i+1:m, i+1:n) := A(i+1:m, i+1:n) * (I - tp*w*w')
+                    const std::size_t rows = m - i - 1;
+                    T* sub = &a(i + 1, i + 1);
+                    blas::gemv(rows, len, T(1), sub, m, w.data(), T(0), y.data());
+                    parallelFor(len, 64, [&](std::size_t j0, std::size_t j1) {
+                        for (std::size_t j = j0; j < j1; ++j) {
+                            blas::axpy(rows, -tp * w[j], y.data(), sub + j * m);
+                        }
+                    }, threads);
+                }
+            }
+        }
+
+    }
+
+    /*!
+     Singular value decomposition A = U*S*V' of an m x n matrix, in the thin form:
+     with k = min(m, n), U is m x k, S is k x k and V is n x k. The singular values
+     are in descending order.
+
+     The full decomposition reduces A to bidiagonal form (after a preliminary QR
+     factorization when A is much taller than it is wide) and solves the bidiagonal
+     problem by divide and conquer.
+
+     For large matrices where only the leading singular triplets are wanted use
+     SVD::randomized, which is far cheaper than the full decomposition.
+     */
+    template <class T>
+    class SVD {
+    public:
+        using size_type = std::size_t;
+
+        /*!
+         Compute the singular value decomposition of a.
+         */
+        explicit SVD(const Matrix<T>& a, const SVDOptions& opts = SVDOptions()) {
+            KSSMATH_INSTRUMENT("SVD", 0, 0);
+            if (a.rows() >= a.cols()) {
+                compute(a, opts);
+            }
+            else {
+                compute(transpose(a), opts);
+                std::swap(_u, _v);
+            }
+        }
+
+        /*!
+         Compute a rank k approximation of a using the randomized range finder of
+         Halko, Martinsson and Tropp: the range of A is sampled with a random test
+         matrix, refined with power iterations, and the small projected problem is
+         solved with the full SVD. Only a handful of passes over A are needed.
+         @throws std::invalid_argument if rank is 0 or larger than min(m, n).
+         */
+        static SVD randomized(const Matrix<T>& a, size_type rank,
+                              const RandomizedSVDOptions& opts = RandomizedSVDOptions())
+        {
+            const size_type m = a.rows();
+            const size_type n = a.cols();
+            if (rank == 0 || rank > std::min(m, n)) {
+                throw std::invalid_argument("SVD::randomized: rank must be in [1, min(m, n)]");
+            }
+            const size_type l = std::min(rank + opts.oversampling, std::min(m, n));
+            const unsigned threads = opts.blocking.threads;
+
+            Matrix<T> omega(n, l);
+            _private::NormalGenerator<T> gen(opts.seed);
+            for (size_type i = 0; i < omega.size(); ++i) {
+                omega.data()[i] = gen();
+            }
+
+            Matrix<T> y(m, l);
+            _private::gemmRowsParallel(blas::Op::NoTrans, m, l, n, a.data(), m, omega.data(), n, y.data(), m, threads);
+            Matrix<T> q = _private::orthonormalBasis(std::move(y), opts.blocking);
+            for (unsigned iter = 0; iter < opts.powerIterations; ++iter) {
+                Matrix<T> z(n, l);
+                _private::gemmRowsParallel(blas::Op::Trans, n, l, m, a.data(), m, q.data(), m, z.data(), n, threads);
+                z = _private::orthonormalBasis(std::move(z), opts.blocking);
+                Matrix<T> yy(m, l);
+                _private::gemmRowsParallel(blas::Op::NoTrans, m, l, n, a.data(), m, z.data(), n, yy.data(), m, threads);
+                q = _private::orthonormalBasis(std::move(yy), opts.blocking);
+            }
+
+            // B' = A'Q is n x l, and B = U_b S V_b' gives A ~ (Q U_b) S V_b'.
+            Matrix<T> bt(n, l);
+            _private::gemmRowsParallel(blas::Op::Trans, n, l, m, a.data(), m, q.data(), m, bt.data(), n, threads);
+            SVDOptions small;
+            small.blocking = opts.blocking;
+            SVD inner(bt, small);
+
+            SVD res;
+            res._s.assign(inner._s.begin(), inner._s.begin() + long(rank));
+            res._v = Matrix<T>(n, rank);
+            std::copy(inner._u.data(), inner._u.data() + n * rank, res._v.data());
+            res._u = Matrix<T>(m, rank);
+            blas::gemm(blas::Op::NoTrans, blas::Op::NoTrans, m, rank, l, T(1), q.data(), m,
+                       inner._v.data(), l, T(0), res._u.data(), m);
+            return res;
+        }
+
+        /*!
+         Returns the singular values in descending order.
+         */
+        const std::vector<T>& singularValues() const noexcept { return _s; }
+
+        /*!
+         Returns the left singular vectors, one per column. This is empty if the
+         vectors were not requested.
+         */
+        const Matrix<T>& U() const noexcept { return _u; }
+
+        /*!
+         Returns the right singular vectors, one per column. This is empty if the
+         vectors were not requested.
+         */
+        const Matrix<T>& V() const noexcept { return _v; }
+
+        /*!
+         Returns the 2-norm condition number, the ratio of the largest to the
+         smallest singular value.
+         */
+        T conditionNumber() const noexcept {
+            if (_s.empty()) {
+                return T(0);
+            }
+            return (_s.back() == T(0) ? std::numeric_limits<T>::infinity() : _s.front() / _s.back());
+        }
+
+    private:
+        std::vector<T>  _s;
+        Matrix<T>       _u;
+        Matrix<T>       _v;
+
+        SVD() = default;
+
+        static Matrix<T> transpose(const Matrix<T>& a) {
+            Matrix<T> at(a.cols(), a.rows());
+            for (size_type j = 0; j < a.cols(); ++j) {
+                for (size_type i = 0; i < a.rows(); ++i) {
+                    at(j, i) = a(i, j);
+                }
+            }
+            return at;
+        }
+
+        // Compute the SVD for m >= n.
+        void compute(const Matrix<T>& a, const SVDOptions& opts) {
+            const size_type m = a.rows();
+            const size_type n = a.cols();
+            if (n == 0) {
+                return;
+            }
+
+            // When A is much taller than wide, first reduce it to its n x n R factor.
+            const bool useQR = (m * 5 >= n * 8);
+            std::unique_ptr<QR<T>> qr;
+            Matrix<T> work;
+            if (useQR) {
+                qr.reset(new QR<T>(a, opts.blocking));
+                work = qr->R();
+            }
+            else {
+                work = a;
+            }
+            const size_type mw = work.rows();
+
+            std::vector<T> d, e, tauq, taup;
+            _private::bidiagonalize(work, d, e, tauq, taup, opts.blocking.threads);
+            if (!opts.computeVectors) {
+                _private::bidiagonalSVD(n, d.data(), e.data(), _s, static_cast<Matrix<T>*>(nullptr),
+                                        static_cast<Matrix<T>*>(nullptr), opts.blocking.threads);
+                return;
+            }
+
+            Matrix<T> ub, vb;
+            _private::bidiagonalSVD(n, d.data(), e.data(), _s, &ub, &vb, opts.blocking.threads);
+
+            // V = P * V_b, where the right reflectors are moved into column storage.
+            Matrix<T> p(n, n);
+            for (size_type i = 0; i + 1 < n; ++i) {
+                for (size_type j = i + 2; j < n; ++j) {
+                    p(j, i) = work(i, j);
+                }
+            }
+            _private::applyReflectors(false, n, taup.size(), 1, p.data(), n, taup.data(),
+                                      n, vb.data(), n, opts.blocking);
+            _v = std::move(vb);
+
+            // U = Q_qr * Q_b * [U_b; 0]
+            Matrix<T> u(mw, n);
+            for (size_type j = 0; j < n; ++j) {
+                std::copy(ub.column(j), ub.column(j) + n, u.column(j));
+            }
+            _private::applyReflectors(false, mw, tauq.size(), 0, work.data(), mw, tauq.data(),
+                                      n, u.data(), mw, opts.blocking);
+            if (qr) {
+                Matrix<T> full(m, n);
+                for (size_type j = 0; j < n; ++j) {
+                    std::copy(u.column(j), u.column(j) + n, full.column(j));
+                }
+                qr->applyQ(full);
+                _u = std::move(full);
+            }
+            else {
+                _u = std::move(u);
+            }
+        }
+    };
+
+}}
+
+#endif
@@ -0,0 +1,245 @@
+//
+//  symmetric_eigen.hpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#ifndef kssmath_symmetric_eigen_hpp
+#define kssmath_symmetric_eigen_hpp
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include "blas.hpp"
+#include "blocking.hpp"
+#include "instrumentation.hpp"
+#include "matrix.hpp"
+#include "parallel.hpp"
+#include "qr.hpp"
+#include "tridiagonal_eigen.hpp"
+
+namespace kss { namespace math {
+
+    /*!
+     Selects which end of the spectrum is wanted when only some eigenvalues are
+     computed.
+     */
+    enum class Which {
+        Largest,    ///< The algebraically largest eigenvalues.
+        Smallest    ///< The algebraically smallest eigenvalues.
+    };
+
+    /*!
+     Options for SymmetricEigen.
+     */
+    struct SymmetricEigenOptions {
+        /*!
+         If false only the eigenvalues are computed.
+         */
+        bool computeVectors = true;
+
+        /*!
+         The number of eigenpairs to compute, taken from the end of the spectrum
+         given by which. A value of 0 computes all of them.
+         */
+        std::size_t count = 0;
+        Which which = Which::Largest;
+
+        BlockingOptions blocking;
+    };
+
+    namespace _private {
+
+        // Reduce the lower triangle of the symmetric n x n matrix a to tridiagonal
+        // form Q'AQ = T using the blocked algorithm of LAPACK's sytrd. The diagonal
+        // and off diagonal of T are written to d and e, and Q is left in a and tau as
+        // n-1 Householder reflectors, reflector i acting on rows i+1..n.
+        template <class T>
+        void tridiagonalize(Matrix<T>& a, std::vector<T>& d, std::vector<T>& e, std::vector<T>& tau,
+                            const BlockingOptions& opts)
+        {
+            const std::size_t n = a.rows();
+            const std::size_t nb = std::max<std::size_t>(opts.blockSize, 1);
+            d.assign(n, T(0));
+            e.assign(n > 0 ? n - 1 : 0, T(0));
+            tau.assign(n > 0 ? n - 1 : 0, T(0));
+            std::vector<T> xrow(nb);
+
+            std::size_t p = 0;
+            if (n > 2 * nb) {
+                Matrix<T> w(n, nb);
+                for (; n - p > 2 * nb; p += nb) {
+                    // Reduce columns p..p+nb (lasyf style) computing W so that the trailing
+                    // matrix can be updated by A := A - V*W' - W*V'.
+                    const std::size_t N = n - p;
+                    const std::size_t lda = n;
+                    T* ap = &a(p, p);
+                    auto A = [=](std::size_t i, std::size_t j) -> T& { return ap[i + j * lda]; };
+                    auto W = [&w](std::size_t i, std::size_t j) -> T& { return w(i, j); };
+
+                    for (std::size_t i = 0; i < nb; ++i) {
+                        if (i > 0) {
+                            for (std::size_t c = 0; c < i; ++c) {
+                                xrow[c] = W(i, c);
+                            }
+                            blas::gemv(N - i, i, T(-1), &A(i, 0), lda, xrow.data(), T(1), &A(i, i));
+                            for (std::size_t c = 0; c < i; ++c) {
+                                xrow[c] = A(i, c);
+                            }
+                            blas::gemv(N - i, i, T(-1), &W(i, 0), n, xrow.data(), T(1), &A(i, i));
+                        }
+                        T* v = &A(i + 1, i);
+                        const std::size_t len = N - i - 1;
+                        const T t = householder(len, v);
+                        tau[p + i] = t;
+                        e[p + i] = v[0];
+                        v[0] = T(1);
+
+                        T* wi = &W(i + 1, i);
+                        blas::symvLower(len, T(1), &A(i + 1, i + 1), lda, v, T(0), wi);
+                        if (i > 0) {
+                            T* wtop = &W(0, i);
+                            blas::gemvTranspose(len, i, T(1), &W(i + 1, 0), n, v, T(0), wtop);
+                            blas::gemv(len, i, T(-1), &A(i + 1, 0), lda, wtop, T(1), wi);
+                            blas::gemvTranspose(len, i, T(1), &A(i + 1, 0), lda, v, T(0), wtop);
+                            blas::gemv(len, i, T(-1), &W(i + 1, 0), n, wtop, T(1), wi);
+                        }
+                        blas::scal(len, t, wi);
+                        const T alpha = T(-0.5) * t * blas::dot(len, wi, v);
+                        blas::axpy(len, alpha, v, wi);
+                    }
+
+                    // Rank-2k update of the trailing matrix, divided by column.
+                    const std::size_t nt = N - nb;
+                    T* a22 = &A(nb, nb);
+                    const T* vv = &A(nb, 0);
+                    const T* ww = &W(nb, 0);
+                    parallelFor(nt, std::max<std::size_t>(nb / 2, 16), [=](std::size_t j0, std::size_t j1) {
+                        blas::syr2kLower(nt, nb, T(-1), vv, lda, ww, n, a22, lda, j0, j1);
+                    }, opts.threads);
+
+                    for (std::size_t j = 0; j < nb; ++j) {
+                        A(j + 1, j) = e[p + j];
+                        d[p + j] = A(j, j);
+                    }
+                }
+            }
+
+            // Unblocked reduction of the remainder.
+            std::vector<T> x(n);
+            for (std::size_t i = p; i + 1 < n; ++i) {
+                T* v = &a(i + 1, i);
+                const std::size_t len = n - i - 1;
+                const T t = householder(len, v);
+                e[i] = v[0];
+                tau[i] = t;
+                if (t != T(0)) {
+                    v[0] = T(1);
+                    T* a22 = &a(i + 1, i + 1);
+                    blas::symvLower(len, t, a22, n, v, T(0), x.data());
+                    const T alpha = T(-0.5) * t * blas::dot(len, x.data(), v);
+                    blas::axpy(len, alpha, v, x.data());
+                    blas::syr2kLower(len, 1, T(-1), v, len, x.data(), len, a22, n, 0, len);
+                    v[0] = e[i];
+                }
+                d[i] = a(i, i);
+            }
+            if (n > 0) {
+                d[n - 1] = a(n - 1, n - 1);
+            }
+        }
+
+    }
+
+    /*!
+     Eigenvalues and (optionally) eigenvectors of a dense symmetric matrix. Only
+     the lower triangle of the matrix is referenced.
+
+     The matrix is first reduced to tridiagonal form using blocked Householder
+     transformations, with the bulk of the work in a parallel rank-2k update.
+     When all the eigenpairs are wanted the tridiagonal problem is solved by
+     divide and conquer. When only a few are wanted, they are found by bisection
+     and inverse iteration, and only those eigenvectors are transformed back,
+     avoiding the O(n^3) cost of both the tridiagonal solve and the back
+     transformation.
+
+     The eigenvalues are always reported in ascending order, with the eigenvectors
+     as the corresponding columns of eigenvectors().
+     */
+    template <class T>
+    class SymmetricEigen {
+    public:
+        using size_type = std::size_t;
+
+        /*!
+         Compute the eigen decomposition of a.
+         @throws std::invalid_argument if a is not square or more eigenpairs are
+            requested than the size of a.
+         */
+        explicit SymmetricEigen(Matrix<T> a, const SymmetricEigenOptions& opts = SymmetricEigenOptions()) {
+            if (!a.isSquare()) {
+                throw std::invalid_argument("SymmetricEigen: matrix must be square");
+            }
+            const size_type n = a.rows();
+            if (opts.count > n) {
+                throw std::invalid_argument("SymmetricEigen: count exceeds the matrix size");
+            }
+            if (n == 0) {
+                return;
+            }
+            KSSMATH_INSTRUMENT("SymmetricEigen", 0, 0);
+
+            std::vector<T> d, e, tau;
+            _private::tridiagonalize(a, d, e, tau, opts.blocking);
+
+            if (opts.count == 0 || opts.count == n) {
+                if (!opts.computeVectors) {
+                    e.push_back(T(0));
+                    _private::tridiagonalQL(n, d.data(), e.data(), static_cast<T*>(nullptr), 0, 0);
+                    _values = std::move(d);
+                    return;
+                }
+                _vectors = Matrix<T>(n, n);
+                _private::tridiagonalDivideAndConquer(n, d.data(), e.data(), _vectors.data(), n,
+                                                      opts.blocking.threads);
+                _values = std::move(d);
+            }
+            else {
+                const size_type first = (opts.which == Which::Largest ? n - opts.count : 0);
+                _values = _private::tridiagonalBisection(n, d.data(), e.data(), first, first + opts.count,
+                                                         opts.blocking.threads);
+                if (!opts.computeVectors) {
+                    return;
+                }
+                _vectors = Matrix<T>(n, opts.count);
+                _private::tridiagonalInverseIteration(n, d.data(), e.data(), _values, _vectors.data(), n);
+            }
+            _private::applyReflectors(false, n, tau.size(), 1, a.data(), n, tau.data(),
+                                      _vectors.cols(), _vectors.data(), n, opts.blocking);
+        }
+
+        /*!
+         Returns the computed eigenvalues in ascending order.
+         */
+        const std::vector<T>& eigenvalues() const noexcept { return _values; }
+
+        /*!
+         Returns the eigenvectors, one per column, in the same order as the
+         eigenvalues. This is empty if the vectors were not requested.
+         */
+        const Matrix<T>& eigenvectors() const noexcept { return _vectors; }
+
+    private:
+        std::vector<T>  _values;
+        Matrix<T>       _vectors;
+    };
+
+}}
+
+#endif
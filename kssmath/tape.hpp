@@ -0,0 +1,661 @@
+//
+//  tape.hpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#ifndef kssmath_tape_hpp
+#define kssmath_tape_hpp
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "instrumentation.hpp"
+#include "workspace.hpp"
+
+namespace kss { namespace math {
+
+    template <class T> class Tape;
+
+    namespace _private {
+
+        // The operations and comparisons recorded on a tape.
+        enum class TapeOp : std::uint8_t {
+            Input, External, Neg, Add, Sub, Mul, Div, Pow, Atan2, Hypot, Min, Max,
+            Abs, Sqrt, Cbrt, Exp, Expm1, Log, Log1p, Log10, Sin, Cos, Tan, Asin, Acos, Atan,
+            Sinh, Cosh, Tanh, Erf
+        };
+
+        enum class TapeCompare : std::uint8_t { Equal, Less, LessEqual };
+
+    }
+
+    /*!
+     A number whose operations are recorded on a Tape, for reverse mode automatic
+     differentiation. A TapeValue is either a constant, which is not on any tape
+     (scalars convert implicitly to constants), or the result of an operation
+     recorded on a tape. Operations that involve only constants are evaluated
+     without recording anything.
+
+     A TapeValue refers to its tape, so it must not be used after the tape is
+     cleared or destroyed. Comparisons compare the values, and those involving a
+     recorded value are themselves recorded so that Tape::replay() can tell when
+     the control flow would change.
+     */
+    template <class T>
+    class TapeValue {
+    public:
+        static_assert(std::is_floating_point<T>::value, "TapeValue: T must be a floating point type");
+
+        using value_type = T;
+
+        /*!
+         Construct a constant.
+         */
+        TapeValue(T value = T(0)) noexcept : _value(value) {}
+
+        /*!
+         Returns the value when the operation was recorded. After Tape::replay()
+         use Tape::value() instead.
+         */
+        T value() const noexcept { return _value; }
+
+        /*!
+         Returns the tape this is recorded on, or nullptr for a constant.
+         */
+        Tape<T>* tape() const noexcept { return _tape; }
+
+        TapeValue& operator+=(const TapeValue& o) { return *this = *this + o; }
+        TapeValue& operator-=(const TapeValue& o) { return *this = *this - o; }
+        TapeValue& operator*=(const TapeValue& o) { return *this = *this * o; }
+        TapeValue& operator/=(const TapeValue& o) { return *this = *this / o; }
+
+        friend TapeValue operator+(const TapeValue& a) { return a; }
+        friend TapeValue operator-(const TapeValue& a) { return unary(Op::Neg, a); }
+        friend TapeValue operator+(const TapeValue& a, const TapeValue& b) { return binary(Op::Add, a, b); }
+        friend TapeValue operator-(const TapeValue& a, const TapeValue& b) { return binary(Op::Sub, a, b); }
+        friend TapeValue operator*(const TapeValue& a, const TapeValue& b) { return binary(Op::Mul, a, b); }
+        friend TapeValue operator/(const TapeValue& a, const TapeValue& b) { return binary(Op::Div, a, b); }
+
+        friend bool operator==(const TapeValue& a, const TapeValue& b) { return compare(Compare::Equal, a, b); }
+        friend bool operator!=(const TapeValue& a, const TapeValue& b) { return !(a == b); }
+        friend bool operator<(const TapeValue& a, const TapeValue& b) { return compare(Compare::Less, a, b); }
+        friend bool operator<=(const TapeValue& a, const TapeValue& b) { return compare(Compare::LessEqual, a, b); }
+        friend bool operator>(const TapeValue& a, const TapeValue& b) { return b < a; }
+        friend bool operator>=(const TapeValue& a, const TapeValue& b) { return b <= a; }
+
+        // The elementary functions, recorded as single operations. Like the
+        // operators they are found by argument dependent lookup.
+
+        friend TapeValue abs(const TapeValue& a) { return unary(Op::Abs, a); }
+        friend TapeValue sqrt(const TapeValue& a) { return unary(Op::Sqrt, a); }
+        friend TapeValue cbrt(const TapeValue& a) { return unary(Op::Cbrt, a); }
+        friend TapeValue exp(const TapeValue& a) { return unary(Op::Exp, a); }
+        friend TapeValue expm1(const TapeValue& a) { return unary(Op::Expm1, a); }
+        friend TapeValue log(const TapeValue& a) { return unary(Op::Log, a); }
+        friend TapeValue log1p(const TapeValue& a) { return unary(Op::Log1p, a); }
+        friend TapeValue log10(const TapeValue& a) { return unary(Op::Log10, a); }
+        friend TapeValue sin(const TapeValue& a) { return unary(Op::Sin, a); }
+        friend TapeValue cos(const TapeValue& a) { return unary(Op::Cos, a); }
+        friend TapeValue tan(const TapeValue& a) { return unary(Op::Tan, a); }
+        friend TapeValue asin(const TapeValue& a) { return unary(Op::Asin, a); }
+        friend TapeValue acos(const TapeValue& a) { return unary(Op::Acos, a); }
+        friend TapeValue atan(const TapeValue& a) { return unary(Op::Atan, a); }
+        friend TapeValue sinh(const TapeValue& a) { return unary(Op::Sinh, a); }
+        friend TapeValue cosh(const TapeValue& a) { return unary(Op::Cosh, a); }
+        friend TapeValue tanh(const TapeValue& a) { return unary(Op::Tanh, a); }
+        friend TapeValue erf(const TapeValue& a) { return unary(Op::Erf, a); }
+        friend TapeValue fabs(const TapeValue& a) { return abs(a); }
+
+        friend TapeValue pow(const TapeValue& a, const TapeValue& p) { return binary(Op::Pow, a, p); }
+        friend TapeValue atan2(const TapeValue& y, const TapeValue& x) { return binary(Op::Atan2, y, x); }
+        friend TapeValue hypot(const TapeValue& x, const TapeValue& y) { return binary(Op::Hypot, x, y); }
+
+        /*!
+         The smaller and larger of two values. These are recorded as operations
+         rather than comparisons, so a replay that changes which one is smaller
+         stays valid.
+         */
+        friend TapeValue fmin(const TapeValue& a, const TapeValue& b) { return binary(Op::Min, a, b); }
+        friend TapeValue fmax(const TapeValue& a, const TapeValue& b) { return binary(Op::Max, a, b); }
+
+    private:
+        friend class Tape<T>;
+
+        using Op = _private::TapeOp;
+        using Compare = _private::TapeCompare;
+
+        // The operators and functions record through these, since they are not
+        // members and so have no access to the tape.
+        static TapeValue unary(Op op, const TapeValue& a) { return Tape<T>::unary(op, a); }
+        static TapeValue binary(Op op, const TapeValue& a, const TapeValue& b) { return Tape<T>::binary(op, a, b); }
+        static bool compare(Compare op, const TapeValue& a, const TapeValue& b) { return Tape<T>::compare(op, a, b); }
+
+        TapeValue(T value, std::size_t index, Tape<T>* tape) noexcept : _value(value), _index(index), _tape(tape) {}
+
+        T           _value;
+        std::size_t _index = 0;
+        Tape<T>*    _tape = nullptr;
+    };
+
+    /*!
+     A record of the operations of a computation, for reverse mode automatic
+     differentiation. After recording a function of n inputs, a single reverse
+     sweep over the tape gives the derivatives of an output with respect to all
+     of them, at a cost of a few times that of the function whatever n is, where
+     forward mode (see dual.hpp) needs an evaluation per N inputs.
+
+     Each operation is a fixed size node of its value, the partial derivatives
+     with respect to its (at most two) arguments and their positions. The nodes
+     are taken in large blocks from a Workspace owned by the tape, so recording
+     allocates no memory per operation, and clear() keeps the memory for the next
+     recording.
+
+     If the control flow of the function does not depend on the inputs (or does
+     not change), replay() re-evaluates the recorded operations at new inputs,
+     which is much cheaper than recording again. Long loops can be recorded with
+     checkpointedLoop(), which stores only some of the intermediate states and
+     records the rest again, one stretch at a time, during the reverse sweep.
+
+     A Tape is not thread safe: each thread needs its own. It is not copyable or
+     movable, since the values recorded on it refer to it.
+     */
+    template <class T>
+    class Tape {
+    public:
+        static_assert(std::is_floating_point<T>::value, "Tape: T must be a floating point type");
+
+        using size_type = std::size_t;
+        using value_type = T;
+
+        /*!
+         Construct a tape with room for the given number of operations before it
+         needs to grow.
+         @throws std::bad_alloc if the memory cannot be allocated.
+         */
+        explicit Tape(size_type capacity = 0) : _workspace(capacity * sizeof(Node)) {}
+
+        Tape(const Tape&) = delete;
+        Tape& operator=(const Tape&) = delete;
+
+        /*!
+         Record an independent variable, an input of the computation, with the
+         given value. The inputs are numbered in the order they are recorded.
+         */
+        TapeValue<T> variable(T value) {
+            const TapeValue<T> v = push(Op::Input, npos, value, npos, T(0));
+            _inputs.push_back(v._index);
+            return v;
+        }
+
+        /*!
+         Returns the numbers of recorded operations and inputs.
+         */
+        size_type size() const noexcept { return _size; }
+        size_type inputs() const noexcept { return _inputs.size(); }
+
+        /*!
+         Forget everything recorded, keeping the memory for the next recording.
+         The values recorded on the tape become invalid.
+         */
+        void clear() noexcept {
+            _workspace.reset();
+            _blocks.clear();
+            _size = 0;
+            _inputs.clear();
+            _conditions.clear();
+            _externals.clear();
+        }
+
+        /*!
+         Compute the adjoints of all the recorded values for the given output:
+         the derivatives of the output with respect to them. The derivatives
+         with respect to the inputs are then given by adjoint() and gradient().
+         @throws std::invalid_argument if the output is recorded on another tape.
+         */
+        void computeAdjoints(const TapeValue<T>& output) {
+            const T seed = T(1);
+            computeAdjoints(&output, &seed, 1);
+        }
+
+        /*!
+         Compute the adjoints for the sum of seeds[i] * outputs[i], which gives a
+         vector-Jacobian product of a function with several outputs. Constant
+         outputs are ignored.
+         @throws std::invalid_argument if an output is recorded on another tape.
+         */
+        void computeAdjoints(const TapeValue<T>* outputs, const T* seeds, size_type n) {
+            KSSMATH_INSTRUMENT("Tape::computeAdjoints", 4.0 * _size, double(_size) * sizeof(Node));
+            for (size_type i = 0; i < _size; ++i) {
+                node(i).adjoint = T(0);
+            }
+            for (size_type i = 0; i < n; ++i) {
+                if (outputs[i]._tape == this) {
+                    node(outputs[i]._index).adjoint += seeds[i];
+                }
+                else if (outputs[i]._tape) {
+                    throw std::invalid_argument("Tape::computeAdjoints: the output is recorded on another tape");
+                }
+            }
+
+            // The outputs of an external computation have no arguments on the
+            // tape, so their adjoints are complete once the later operations
+            // are swept, and the computation passes them on to its inputs.
+            size_type end = _size;
+            for (auto e = _externals.rbegin(); e != _externals.rend(); ++e) {
+                sweep(e->end, end);
+                e->reverse(*this);
+                end = e->begin;
+            }
+            sweep(0, end);
+        }
+
+        /*!
+         Returns the adjoint of a value computed by computeAdjoints(), 0 for a
+         constant.
+         */
+        T adjoint(const TapeValue<T>& v) const noexcept {
+            return (v._tape == this ? node(v._index).adjoint : T(0));
+        }
+
+        /*!
+         Set grad, which must have room for inputs() entries, to the adjoints of
+         the inputs in the order they were recorded.
+         */
+        void gradient(T* grad) const noexcept {
+            for (size_type i = 0; i < _inputs.size(); ++i) {
+                grad[i] = node(_inputs[i]).adjoint;
+            }
+        }
+
+        /*!
+         Re-evaluate the recorded operations with new values, in the order they
+         were recorded, of the inputs, without recording them again. Afterwards
+         value() gives the new values and computeAdjoints() the new derivatives.
+         Returns false if a recorded comparison now has the other result, in
+         which case the function would have taken another path and must be
+         recorded again.
+         */
+        bool replay(const T* inputs) {
+            KSSMATH_INSTRUMENT("Tape::replay", 0, double(_size) * sizeof(Node));
+            for (size_type i = 0; i < _inputs.size(); ++i) {
+                node(_inputs[i]).value = inputs[i];
+            }
+            size_type begin = 0;
+            for (auto& e : _externals) {
+                evaluateRange(begin, e.begin);
+                e.forward(*this);
+                begin = e.end;
+            }
+            evaluateRange(begin, _size);
+
+            for (const auto& c : _conditions) {
+                if (compareValues(c.op, currentValue(c.a, c.ca), currentValue(c.b, c.cb)) != c.result) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /*!
+         Returns the current value of a recorded value: the value it was recorded
+         with, or the one given by the last replay().
+         */
+        T value(const TapeValue<T>& v) const noexcept {
+            return (v._tape == this ? node(v._index).value : v._value);
+        }
+
+        /*!
+         Run steps iterations of state = step(state) with checkpointing. step is
+         called as step(s, k) for k = 0, 1, ..., steps - 1 to update the state s
+         in place; it must be generic in the number type (for example a generic
+         lambda taking auto& s), since it is called with a std::vector<T> to run
+         the loop and with a std::vector<TapeValue<T>> on a private tape to record
+         a stretch of it again. It may depend only on the state, k and constants;
+         parameters to differentiate with respect to must be carried in the state.
+
+         Only the state every interval iterations is stored, so the memory is
+         that of steps / interval states and of recording interval iterations,
+         instead of recording all of them, at the cost of running the loop about
+         twice. The default interval, about sqrt(steps), balances the two.
+         @throws std::invalid_argument if the state is on another tape or the
+            step changes its size.
+         */
+        template <class Step>
+        void checkpointedLoop(std::vector<TapeValue<T>>& state, size_type steps, Step step, size_type interval = 0);
+
+    private:
+        friend class TapeValue<T>;
+
+        static constexpr size_type npos = ~size_type(0);
+        static constexpr size_type blockShift = 12;
+        static constexpr size_type blockNodes = size_type(1) << blockShift;
+
+        using Op = _private::TapeOp;
+        using Compare = _private::TapeCompare;
+
+        // An operation. An argument that is a constant has no position (npos)
+        // and its value is kept in constant; an operation has at most one.
+        struct Node {
+            T           value;
+            T           adjoint;
+            T           partial[2];
+            T           constant;
+            size_type   arg[2];
+            Op          op;
+        };
+
+        struct Condition {
+            Compare     op;
+            bool        result;
+            size_type   a, b;
+            T           ca, cb;
+        };
+
+        // A computation recorded as a whole, whose outputs are the operations
+        // [begin, end). forward evaluates them from the current values of the
+        // inputs, and reverse adds the adjoints of the outputs, times the
+        // derivatives, into the adjoints of the inputs.
+        struct External {
+            size_type                   begin, end;
+            std::function<void(Tape&)>  forward;
+            std::function<void(Tape&)>  reverse;
+        };
+
+        Workspace               _workspace;
+        std::vector<Node*>      _blocks;
+        size_type               _size = 0;
+        std::vector<size_type>  _inputs;
+        std::vector<Condition>  _conditions;
+        std::vector<External>   _externals;
+
+        Node& node(size_type i) noexcept { return _blocks[i >> blockShift][i & (blockNodes - 1)]; }
+        const Node& node(size_type i) const noexcept { return _blocks[i >> blockShift][i & (blockNodes - 1)]; }
+
+        T currentValue(size_type i, T constant) const noexcept {
+            return (i == npos ? constant : node(i).value);
+        }
+
+        // Sets the value and partial derivatives of an operation with arguments
+        // of the given values. Recording and replay both use this.
+        static void evaluate(Node& n, T a, T b) noexcept {
+            T& v = n.value;
+            T* p = n.partial;
+            p[0] = p[1] = T(0);
+            switch (n.op) {
+            case Op::Input:
+            case Op::External:
+                break;
+            case Op::Neg:   v = -a; p[0] = T(-1); break;
+            case Op::Add:   v = a + b; p[0] = T(1); p[1] = T(1); break;
+            case Op::Sub:   v = a - b; p[0] = T(1); p[1] = T(-1); break;
+            case Op::Mul:   v = a * b; p[0] = b; p[1] = a; break;
+            case Op::Div:   v = a / b; p[0] = T(1) / b; p[1] = -v / b; break;
+            case Op::Pow:
+                // The derivative with respect to the exponent is taken as 0 at a
+                // zero base, its limit for positive exponents.
+                v = std::pow(a, b);
+                p[0] = (b == T(0) ? T(0) : b * std::pow(a, b - T(1)));
+                p[1] = (a == T(0) ? T(0) : v * std::log(a));
+                break;
+            case Op::Atan2: {
+                const T r = T(1) / (a * a + b * b);
+                v = std::atan2(a, b); p[0] = b * r; p[1] = -a * r;
+                break;
+            }
+            case Op::Hypot:
+                v = std::hypot(a, b);
+                if (v != T(0)) { p[0] = a / v; p[1] = b / v; }
+                break;
+            case Op::Min:   v = (b < a ? b : a); p[b < a ? 1 : 0] = T(1); break;
+            case Op::Max:   v = (a < b ? b : a); p[a < b ? 1 : 0] = T(1); break;
+            case Op::Abs:   v = std::abs(a); p[0] = (a < T(0) ? T(-1) : T(1)); break;
+            case Op::Sqrt:  v = std::sqrt(a); p[0] = T(0.5) / v; break;
+            case Op::Cbrt:  v = std::cbrt(a); p[0] = T(1) / (T(3) * v * v); break;
+            case Op::Exp:   v = std::exp(a); p[0] = v; break;
+            case Op::Expm1: v = std::expm1(a); p[0] = v + T(1); break;
+            case Op::Log:   v = std::log(a); p[0] = T(1) / a; break;
+            case Op::Log1p: v = std::log1p(a); p[0] = T(1) / (T(1) + a); break;
+            case Op::Log10: v = std::log10(a); p[0] = T(1) / (a * std::log(T(10))); break;
+            case Op::Sin:   v = std::sin(a); p[0] = std::cos(a); break;
+            case Op::Cos:   v = std::cos(a); p[0] = -std::sin(a); break;
+            case Op::Tan:   v = std::tan(a); p[0] = T(1) + v * v; break;
+            case Op::Asin:  v = std::asin(a); p[0] = T(1) / std::sqrt(T(1) - a * a); break;
+            case Op::Acos:  v = std::acos(a); p[0] = T(-1) / std::sqrt(T(1) - a * a); break;
+            case Op::Atan:  v = std::atan(a); p[0] = T(1) / (T(1) + a * a); break;
+            case Op::Sinh:  v = std::sinh(a); p[0] = std::cosh(a); break;
+            case Op::Cosh:  v = std::cosh(a); p[0] = std::sinh(a); break;
+            case Op::Tanh:  v = std::tanh(a); p[0] = T(1) - v * v; break;
+            case Op::Erf:
+                // 2 / sqrt(pi)
+                v = std::erf(a); p[0] = T(1.1283791670955125738961589031215452) * std::exp(-a * a);
+                break;
+            }
+        }
+
+        static bool compareValues(Compare op, T a, T b) noexcept {
+            switch (op) {
+            case Compare::Equal:    return a == b;
+            case Compare::Less:     return a < b;
+            default:                return a <= b;
+            }
+        }
+
+        TapeValue<T> push(Op op, size_type a, T va, size_type b, T vb) {
+            if ((_size & (blockNodes - 1)) == 0 && (_size >> blockShift) == _blocks.size()) {
+                _blocks.push_back(_workspace.allocate<Node>(blockNodes));
+            }
+            const size_type index = _size++;
+            Node& n = node(index);
+            n.op = op;
+            n.arg[0] = a;
+            n.arg[1] = b;
+            n.constant = (a == npos ? va : (b == npos ? vb : T(0)));
+            n.value = va;
+            n.adjoint = T(0);
+            evaluate(n, va, vb);
+            return TapeValue<T>(n.value, index, this);
+        }
+
+        static Tape* tapeOf(const TapeValue<T>& a, const TapeValue<T>& b) {
+            if (a._tape && b._tape && a._tape != b._tape) {
+                throw std::invalid_argument("Tape: the values are recorded on different tapes");
+            }
+            return (a._tape ? a._tape : b._tape);
+        }
+
+        static TapeValue<T> unary(Op op, const TapeValue<T>& a) {
+            if (!a._tape) {
+                Node n;
+                n.op = op;
+                evaluate(n, a._value, T(0));
+                return TapeValue<T>(n.value);
+            }
+            return a._tape->push(op, a._index, a._value, npos, T(0));
+        }
+
+        static TapeValue<T> binary(Op op, const TapeValue<T>& a, const TapeValue<T>& b) {
+            Tape* tape = tapeOf(a, b);
+            if (!tape) {
+                Node n;
+                n.op = op;
+                evaluate(n, a._value, b._value);
+                return TapeValue<T>(n.value);
+            }
+            return tape->push(op, (a._tape ? a._index : npos), a._value, (b._tape ? b._index : npos), b._value);
+        }
+
+        static bool compare(Compare op, const TapeValue<T>& a, const TapeValue<T>& b) {
+            const bool result = compareValues(op, a._value, b._value);
+            if (Tape* tape = tapeOf(a, b)) {
+                tape->_conditions.push_back(Condition {
+                    op, result, (a._tape ? a._index : npos), (b._tape ? b._index : npos), a._value, b._value
+                });
+            }
+            return result;
+        }
+
+        void sweep(size_type begin, size_type end) noexcept {
+            for (size_type i = end; i-- > begin; ) {
+                const Node& n = node(i);
+                if (n.adjoint == T(0)) {
+                    continue;
+                }
+                if (n.arg[0] != npos) {
+                    node(n.arg[0]).adjoint += n.partial[0] * n.adjoint;
+                }
+                if (n.arg[1] != npos) {
+                    node(n.arg[1]).adjoint += n.partial[1] * n.adjoint;
+                }
+            }
+        }
+
+        void evaluateRange(size_type begin, size_type end) noexcept {
+            for (size_type i = begin; i < end; ++i) {
+                Node& n = node(i);
+                if (n.op != Op::Input) {
+                    evaluate(n, currentValue(n.arg[0], n.constant), currentValue(n.arg[1], n.constant));
+                }
+            }
+        }
+    };
+
+    template <class T>
+    template <class Step>
+    void Tape<T>::checkpointedLoop(std::vector<TapeValue<T>>& state, size_type steps, Step step, size_type interval) {
+        const size_type n = state.size();
+        if (interval == 0) {
+            interval = std::max<size_type>(1, size_type(std::ceil(std::sqrt(double(steps)))));
+        }
+        for (const auto& s : state) {
+            if (s._tape && s._tape != this) {
+                throw std::invalid_argument("Tape::checkpointedLoop: the state is recorded on another tape");
+            }
+        }
+
+        // What the forward and reverse computations share: the positions (or
+        // values, for constants) of the initial state, and the stored states.
+        struct Checkpoints {
+            size_type               begin = 0;
+            std::vector<size_type>  inputs;
+            std::vector<T>          constants;
+            std::vector<T>          states;
+            std::unique_ptr<Tape>   inner;
+        };
+        auto cp = std::make_shared<Checkpoints>();
+        cp->inputs.resize(n);
+        cp->constants.resize(n);
+        for (size_type i = 0; i < n; ++i) {
+            cp->inputs[i] = (state[i]._tape ? state[i]._index : npos);
+            cp->constants[i] = state[i]._value;
+        }
+
+        auto checkSize = [n](size_type size) {
+            if (size != n) {
+                throw std::invalid_argument("Tape::checkpointedLoop: the step changed the size of the state");
+            }
+        };
+
+        // Run the loop from the current values of the initial state, keeping
+        // the state at the start of every stretch, and leave the final state.
+        auto run = [cp, step, steps, interval, n, checkSize](Tape& tape, std::vector<T>& s) {
+            s.resize(n);
+            for (size_type i = 0; i < n; ++i) {
+                s[i] = tape.currentValue(cp->inputs[i], cp->constants[i]);
+            }
+            cp->states.clear();
+            for (size_type k = 0; k < steps; ++k) {
+                if (k % interval == 0) {
+                    cp->states.insert(cp->states.end(), s.begin(), s.end());
+                }
+                step(s, k);
+                checkSize(s.size());
+            }
+        };
+
+        // Record each stretch again, last first, on a private tape, and take the
+        // adjoints of its final state back to its initial state.
+        auto reverse = [cp, step, steps, interval, n, checkSize](Tape& tape) {
+            std::vector<T> lambda(n);
+            for (size_type i = 0; i < n; ++i) {
+                lambda[i] = tape.node(cp->begin + i).adjoint;
+            }
+            if (!cp->inner) {
+                cp->inner.reset(new Tape());
+            }
+            Tape& inner = *cp->inner;
+            std::vector<TapeValue<T>> initial(n), s;
+            for (size_type stretch = (steps + interval - 1) / interval; stretch-- > 0; ) {
+                inner.clear();
+                for (size_type i = 0; i < n; ++i) {
+                    initial[i] = inner.variable(cp->states[stretch * n + i]);
+                }
+                s = initial;
+                for (size_type k = stretch * interval; k < std::min(steps, (stretch + 1) * interval); ++k) {
+                    step(s, k);
+                    checkSize(s.size());
+                }
+                inner.computeAdjoints(s.data(), lambda.data(), n);
+                inner.gradient(lambda.data());
+            }
+            inner.clear();
+            for (size_type i = 0; i < n; ++i) {
+                if (cp->inputs[i] != npos) {
+                    tape.node(cp->inputs[i]).adjoint += lambda[i];
+                }
+            }
+        };
+
+        auto forward = [cp, run](Tape& tape) {
+            std::vector<T> s;
+            run(tape, s);
+            for (size_type i = 0; i < s.size(); ++i) {
+                tape.node(cp->begin + i).value = s[i];
+            }
+        };
+
+        std::vector<T> s;
+        run(*this, s);
+        cp->begin = _size;
+        for (size_type i = 0; i < n; ++i) {
+            state[i] = push(Op::External, npos, s[i], npos, T(0));
+        }
+        _externals.push_back(External { cp->begin, _size, forward, reverse });
+    }
+
+    /*!
+     Returns f(x) and sets grad to its gradient by reverse mode, where x has n
+     entries, grad has room for n, and f is a function (typically a generic
+     lambda) of a const std::vector<TapeValue<T>>& that returns a TapeValue<T>.
+     f is evaluated once, and the cost is a few times that of an evaluation
+     whatever n is. To differentiate repeatedly at different points, record on
+     a Tape and use Tape::replay() instead.
+     */
+    template <class T, class F>
+    T reverseGradient(F&& f, const T* x, std::size_t n, T* grad) {
+        Tape<T> tape;
+        std::vector<TapeValue<T>> args;
+        args.reserve(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            args.push_back(tape.variable(x[i]));
+        }
+        const std::vector<TapeValue<T>>& cargs = args;
+        const TapeValue<T> y = f(cargs);
+        tape.computeAdjoints(y);
+        tape.gradient(grad);
+        return y.value();
+    }
+
+}}
+
+#endif
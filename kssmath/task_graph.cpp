@@ -0,0 +1,124 @@
+//
+//  task_graph.cpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include "task_graph.hpp"
+
+using namespace std;
+using namespace kss::math;
+
+
+TaskGraph::task_id TaskGraph::add(task_fn fn, initializer_list<task_id> deps) {
+    return add(move(fn), vector<task_id>(deps));
+}
+
+TaskGraph::task_id TaskGraph::add(task_fn fn, const vector<task_id>& deps) {
+    const task_id id = _tasks.size();
+    for (auto dep : deps) {
+        if (dep >= id) {
+            throw invalid_argument("TaskGraph::add: dependency does not refer to an existing task");
+        }
+    }
+
+    Task t;
+    t.fn = move(fn);
+    _tasks.push_back(move(t));
+    for (auto dep : deps) {
+        auto& succ = _tasks[dep].successors;
+        if (find(succ.begin(), succ.end(), id) == succ.end()) {
+            succ.push_back(id);
+            ++_tasks[id].numDependencies;
+        }
+    }
+    return id;
+}
+
+void TaskGraph::run(unsigned threads) {
+    if (_tasks.empty()) {
+        return;
+    }
+    if (threads == 0) {
+        threads = defaultThreadCount();
+    }
+
+    vector<size_t> remaining(_tasks.size());
+    deque<task_id> ready;
+    for (task_id i = 0; i < _tasks.size(); ++i) {
+        remaining[i] = _tasks[i].numDependencies;
+        if (remaining[i] == 0) {
+            ready.push_back(i);
+        }
+    }
+
+    mutex lock;
+    condition_variable cv;
+    size_t completed = 0;
+    exception_ptr firstError;
+
+    auto worker = [&] {
+        unique_lock<mutex> l(lock);
+        while (true) {
+            cv.wait(l, [&] {
+                return !ready.empty() || completed == _tasks.size() || firstError;
+            });
+            if (completed == _tasks.size() || firstError) {
+                return;
+            }
+
+            const task_id id = ready.front();
+            ready.pop_front();
+            l.unlock();
+            exception_ptr err;
+            try {
+                _tasks[id].fn();
+            }
+            catch (...) {
+                err = current_exception();
+            }
+            l.lock();
+
+            if (err) {
+                if (!firstError) {
+                    firstError = err;
+                }
+            }
+            else {
+                ++completed;
+                for (auto succ : _tasks[id].successors) {
+                    if (--remaining[succ] == 0) {
+                        ready.push_back(succ);
+                    }
+                }
+            }
+            cv.notify_all();
+        }
+    };
+
+    const unsigned numThreads = static_cast<unsigned>(min<size_t>(threads, _tasks.size()));
+    vector<thread> pool;
+    pool.reserve(numThreads - 1);
+    for (unsigned i = 1; i < numThreads; ++i) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto& t : pool) {
+        t.join();
+    }
+
+    if (firstError) {
+        rethrow_exception(firstError);
+    }
+}
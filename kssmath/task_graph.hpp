@@ -0,0 +1,77 @@
+//
+//  task_graph.hpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#ifndef kssmath_task_graph_hpp
+#define kssmath_task_graph_hpp
+
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <vector>
+
+namespace kss { namespace math {
+
+    /*!
+     A directed acyclic graph of tasks. Tasks are added along with the tasks they
+     depend on, and run() executes the graph on a set of worker threads, starting
+     each task as soon as all of its dependencies have completed.
+
+     This is used by the blocked factorizations to express the tile level
+     dependencies so that trailing updates from different steps may overlap.
+
+     Since a task may only depend on tasks that were added before it, the graph
+     is acyclic by construction.
+     */
+    class TaskGraph {
+    public:
+        using task_id = std::size_t;
+        using task_fn = std::function<void()>;
+
+        /*!
+         Add a task that will be run only after all the tasks in deps have
+         completed.
+         @throws std::invalid_argument if any of deps does not refer to an existing task.
+         */
+        task_id add(task_fn fn, std::initializer_list<task_id> deps = {});
+        task_id add(task_fn fn, const std::vector<task_id>& deps);
+
+        /*!
+         Returns the number of tasks in the graph.
+         */
+        std::size_t size() const noexcept { return _tasks.size(); }
+
+        /*!
+         Run all the tasks using the given number of threads. A value of 0 will use
+         defaultThreadCount(). The calling thread participates as
+         one of the workers. The graph may be run more than once.
+
+         If a task throws an exception no further tasks are started, and once the
+         running tasks have completed the first exception is rethrown.
+         */
+        void run(unsigned threads = 0);
+
+    private:
+        struct Task {
+            task_fn                 fn;
+            std::vector<task_id>    successors;
+            std::size_t             numDependencies = 0;
+        };
+        std::vector<Task> _tasks;
+    };
+
+    /*!
+     Returns the number of threads that a "threads" option of 0 resolves to:
+     the number of CPUs the process may run on (its affinity when it started,
+     on Linux), otherwise the number of hardware threads.
+     */
+    unsigned defaultThreadCount() noexcept;
+
+}}
+
+#endif
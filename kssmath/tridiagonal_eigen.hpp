@@ -0,0 +1,495 @@
+//
+//  tridiagonal_eigen.hpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#ifndef kssmath_tridiagonal_eigen_hpp
+#define kssmath_tridiagonal_eigen_hpp
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#include "blas.hpp"
+#include "matrix.hpp"
+#include "parallel.hpp"
+
+// Eigensolvers for a symmetric tridiagonal matrix given by its diagonal d[0..n)
+// and off diagonal e[0..n-1), where e[i] couples rows i and i+1. These are the
+// building blocks for SymmetricEigen and the Lanczos solver and are not intended
+// to be used directly.
+
+namespace kss { namespace math { namespace _private {
+
+    // Sort the eigenvalues in d ascending, permuting the columns of z (n rows,
+    // leading dimension ldz) to match. z may be null.
+    template <class T>
+    void sortEigenpairs(std::size_t n, T* d, T* z, std::size_t ldz, std::size_t zrows) {
+        std::vector<std::size_t> idx(n);
+        std::iota(idx.begin(), idx.end(), std::size_t(0));
+        std::stable_sort(idx.begin(), idx.end(), [d](std::size_t a, std::size_t b) { return d[a] < d[b]; });
+        std::vector<T> dd(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            dd[i] = d[idx[i]];
+        }
+        std::copy(dd.begin(), dd.end(), d);
+        if (z) {
+            Matrix<T> zz(zrows, n);
+            for (std::size_t j = 0; j < n; ++j) {
+                std::copy(z + idx[j] * ldz, z + idx[j] * ldz + zrows, zz.column(j));
+            }
+            for (std::size_t j = 0; j < n; ++j) {
+                std::copy(zz.column(j), zz.column(j) + zrows, z + j * ldz);
+            }
+        }
+    }
+
+    // Implicit QL with Wilkinson shifts. On exit d holds the eigenvalues in
+    // ascending order and e is destroyed. If z is not null, its zrows x n leading
+    // part is post-multiplied by the accumulated rotations, so passing the identity
+    // yields the eigenvectors.
+    template <class T>
+    void tridiagonalQL(std::size_t n, T* d, T* e, T* z, std::size_t ldz, std::size_t zrows) {
+        if (n == 0) {
+            return;
+        }
+        const T eps = std::numeric_limits<T>::epsilon();
+        e[n - 1] = T(0);
+        for (std::size_t l = 0; l < n; ++l) {
+            unsigned iter = 0;
+            std::size_t m;
+            do {
+                for (m = l; m + 1 < n; ++m) {
+                    const T dd = std::abs(d[m]) + std::abs(d[m + 1]);
+                    if (std::abs(e[m]) <= eps * dd) {
+                        break;
+                    }
+                }
+                if (m != l) {
+                    if (++iter > 60) {
+                        throw std::runtime_error("tridiagonalQL: failed to converge");
+                    }
+                    T g = (d[l + 1] - d[l]) / (T(2) * e[l]);
+                    T r = std::hypot(g, T(1));
+                    g = d[m] - d[l] + e[l] / (g + std::copysign(r, g));
+                    T s = T(1), c = T(1), p = T(0);
+                    bool underflow = false;
+                    for (std::size_t i = m; i-- > l;) {
+                        T f = s * e[i];
+                        const T b = c * e[i];
+                        e[i + 1] = (r = std::hypot(f, g));
+                        if (r == T(0)) {
+                            d[i + 1] -= p;
+                            e[m] = T(0);
+                            underflow = true;
+                            break;
+                        }
+                        s = f / r;
+                        c = g / r;
+                        g = d[i + 1] - p;
+                        r = (d[i] - g) * s + T(2) * c * b;
+                        d[i + 1] = g + (p = s * r);
+                        g = c * r - b;
+                        if (z) {
+                            T* zi = z + i * ldz;
+                            T* zi1 = z + (i + 1) * ldz;
+                            for (std::size_t k = 0; k < zrows; ++k) {
+                                f = zi1[k];
+                                zi1[k] = s * zi[k] + c * f;
+                                zi[k] = c * zi[k] - s * f;
+                            }
+                        }
+                    }
+                    if (underflow) {
+                        continue;
+                    }
+                    d[l] -= p;
+                    e[l] = g;
+                    e[m] = T(0);
+                }
+            } while (m != l);
+        }
+        sortEigenpairs(n, d, z, ldz, zrows);
+    }
+
+    // Merge step of the divide and conquer algorithm: compute the eigen-
+    // decomposition of diag(d) + rho*z*z' (rho > 0) and post-multiply the n x n
+    // matrix q by its eigenvectors. Deflation and the Gu-Eisenstat recomputation of
+    // z follow LAPACK's laed2/laed3.
+    template <class T>
+    void mergeRankOne(std::size_t n, T rho, T* d, T* z, T* q, std::size_t ldq, unsigned threads) {
+        const T eps = std::numeric_limits<T>::epsilon();
+        const T znorm = blas::nrm2(n, z);
+        blas::scal(n, T(1) / znorm, z);
+        rho *= znorm * znorm;
+
+        std::vector<std::size_t> order(n);
+        std::iota(order.begin(), order.end(), std::size_t(0));
+        std::sort(order.begin(), order.end(), [d](std::size_t a, std::size_t b) { return d[a] < d[b]; });
+        const T tol = T(8) * eps * std::max(blas::amax(n, d), blas::amax(n, z));
+
+        // Deflate small components of z and nearly equal diagonal entries.
+        std::vector<std::size_t> kept;
+        kept.reserve(n);
+        const std::size_t none = n;
+        std::size_t pj = none;
+        for (auto nj : order) {
+            if (rho * std::abs(z[nj]) <= tol) {
+                continue;
+            }
+            if (pj == none) {
+                pj = nj;
+                continue;
+            }
+            const T s0 = z[pj];
+            const T c0 = z[nj];
+            const T tau = std::hypot(c0, s0);
+            const T c = c0 / tau;
+            const T s = -s0 / tau;
+            if (std::abs((d[nj] - d[pj]) * c * s) <= tol) {
+                z[nj] = tau;
+                z[pj] = T(0);
+                T* qp = q + pj * ldq;
+                T* qn = q + nj * ldq;
+                for (std::size_t r = 0; r < n; ++r) {
+                    const T x = qp[r];
+                    const T y = qn[r];
+                    qp[r] = c * x + s * y;
+                    qn[r] = c * y - s * x;
+                }
+                const T t = d[pj] * c * c + d[nj] * s * s;
+                d[nj] = d[pj] * s * s + d[nj] * c * c;
+                d[pj] = t;
+            }
+            else {
+                kept.push_back(pj);
+            }
+            pj = nj;
+        }
+        if (pj != none) {
+            kept.push_back(pj);
+        }
+        const std::size_t k = kept.size();
+        if (k == 0) {
+            return;
+        }
+        std::sort(kept.begin(), kept.end(), [d](std::size_t a, std::size_t b) { return d[a] < d[b]; });
+
+        std::vector<T> dk(k), zk(k), lambda(k);
+        T sumz2 = T(0);
+        for (std::size_t i = 0; i < k; ++i) {
+            dk[i] = d[kept[i]];
+            zk[i] = z[kept[i]];
+            sumz2 += zk[i] * zk[i];
+        }
+
+        // Solve the secular equation 1 + rho*sum(z_i^2 / (d_i - lambda)) = 0 for each
+        // root. Each root is computed as an offset tau from its nearest pole so that
+        // the differences d_i - lambda_j, stored in delta(i, j), are accurate.
+        Matrix<T> delta(k, k);
+        parallelFor(k, 16, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t j = begin; j < end; ++j) {
+                const bool last = (j + 1 == k);
+                const T hi = (last ? dk[j] + rho * sumz2 : dk[j + 1]);
+                const T mid = (dk[j] + hi) / T(2);
+                T fmid = T(1);
+                for (std::size_t i = 0; i < k; ++i) {
+                    fmid += rho * zk[i] * zk[i] / (dk[i] - mid);
+                }
+                const bool fromLeft = (last || fmid >= T(0));
+                const T origin = (fromLeft ? dk[j] : dk[j + 1]);
+                T lo = (fromLeft ? T(0) : mid - origin);
+                T up = (fromLeft ? (last ? hi : mid) - origin : T(0));
+
+                T* dj = delta.column(j);
+                T tau = (lo + up) / T(2);
+                for (unsigned iter = 0; iter < 200; ++iter) {
+                    T f = T(1), fp = T(0);
+                    for (std::size_t i = 0; i < k; ++i) {
+                        dj[i] = (dk[i] - origin) - tau;
+                        const T t = zk[i] / dj[i];
+                        f += rho * zk[i] * t;
+                        fp += rho * t * t;
+                    }
+                    if (f == T(0)) {
+                        break;
+                    }
+                    (f < T(0) ? lo : up) = tau;
+                    T next = tau - f / fp;
+                    if (!(next > lo && next < up)) {
+                        next = (lo + up) / T(2);
+                    }
+                    if (up - lo <= T(2) * eps * std::max(std::abs(lo), std::abs(up))
+                        || next == tau)
+                    {
+                        break;
+                    }
+                    tau = next;
+                }
+                for (std::size_t i = 0; i < k; ++i) {
+                    dj[i] = (dk[i] - origin) - tau;
+                }
+                lambda[j] = origin + tau;
+            }
+        }, threads);
+
+        // Recompute z so that the computed eigenvalues are exact for a nearby
+        // problem, which makes the eigenvectors numerically orthogonal.
+        std::vector<T> zhat(k);
+        for (std::size_t i = 0; i < k; ++i) {
+            T prod = -delta(i, i) / rho;
+            for (std::size_t j = 0; j < k; ++j) {
+                if (j != i) {
+                    prod *= -delta(i, j) / (dk[j] - dk[i]);
+                }
+            }
+            zhat[i] = std::copysign(std::sqrt(std::abs(prod)), zk[i]);
+        }
+        for (std::size_t j = 0; j < k; ++j) {
+            T* vj = delta.column(j);
+            for (std::size_t i = 0; i < k; ++i) {
+                vj[i] = zhat[i] / vj[i];
+            }
+            blas::scal(k, T(1) / blas::nrm2(k, vj), vj);
+        }
+
+        // q(:, kept) := q(:, kept) * V
+        Matrix<T> qk(n, k);
+        for (std::size_t j = 0; j < k; ++j) {
+            std::copy(q + kept[j] * ldq, q + kept[j] * ldq + n, qk.column(j));
+        }
+        parallelFor(k, 32, [&](std::size_t begin, std::size_t end) {
+            Matrix<T> out(n, end - begin);
+            blas::gemm(blas::Op::NoTrans, blas::Op::NoTrans, n, end - begin, k,
+                       T(1), qk.data(), n, delta.column(begin), k, T(0), out.data(), n);
+            for (std::size_t j = begin; j < end; ++j) {
+                std::copy(out.column(j - begin), out.column(j - begin) + n, q + kept[j] * ldq);
+                d[kept[j]] = lambda[j];
+            }
+        }, threads);
+    }
+
+    // Divide and conquer (Cuppen's method). On exit d holds the eigenvalues in
+    // ascending order and q (n x n) the corresponding eigenvectors.
+    template <class T>
+    void tridiagonalDivideAndConquer(std::size_t n, T* d, T* e, T* q, std::size_t ldq, unsigned threads) {
+        const std::size_t leafSize = 32;
+        for (std::size_t j = 0; j < n; ++j) {
+            std::fill(q + j * ldq, q + j * ldq + n, T(0));
+        }
+        if (n <= leafSize) {
+            for (std::size_t i = 0; i < n; ++i) {
+                q[i + i * ldq] = T(1);
+            }
+            std::vector<T> ee(e, e + (n ? n - 1 : 0));
+            ee.push_back(T(0));
+            tridiagonalQL(n, d, ee.data(), q, ldq, n);
+            return;
+        }
+
+        // T = diag(T1, T2) + rho*u*u' with u = e(m-1) + sign(beta)*e(m).
+        const std::size_t m = n / 2;
+        const T beta = e[m - 1];
+        const T rho = std::abs(beta);
+        const T sgn = (beta < T(0) ? T(-1) : T(1));
+        d[m - 1] -= rho;
+        d[m] -= rho;
+        tridiagonalDivideAndConquer(m, d, e, q, ldq, threads);
+        tridiagonalDivideAndConquer(n - m, d + m, e + m, q + m + m * ldq, ldq, threads);
+        if (rho == T(0)) {
+            sortEigenpairs(n, d, q, ldq, n);
+            return;
+        }
+
+        std::vector<T> z(n);
+        for (std::size_t j = 0; j < m; ++j) {
+            z[j] = q[(m - 1) + j * ldq];
+        }
+        for (std::size_t j = m; j < n; ++j) {
+            z[j] = sgn * q[m + j * ldq];
+        }
+        mergeRankOne(n, rho, d, z.data(), q, ldq, threads);
+        sortEigenpairs(n, d, q, ldq, n);
+    }
+
+    // Returns the number of eigenvalues less than x (Sturm sequence count).
+    template <class T>
+    std::size_t sturmCount(std::size_t n, const T* d, const T* e, T x, T pivmin) noexcept {
+        std::size_t count = 0;
+        T q = d[0] - x;
+        for (std::size_t i = 0; ; ++i) {
+            if (std::abs(q) < pivmin) {
+                q = -pivmin;
+            }
+            if (q < T(0)) {
+                ++count;
+            }
+            if (i + 1 == n) {
+                break;
+            }
+            q = d[i + 1] - x - e[i] * e[i] / q;
+        }
+        return count;
+    }
+
+    // Returns the eigenvalues with (0 based, ascending) indices [first, last) using
+    // bisection on the Sturm count.
+    template <class T>
+    std::vector<T> tridiagonalBisection(std::size_t n, const T* d, const T* e,
+                                        std::size_t first, std::size_t last, unsigned threads)
+    {
+        const T eps = std::numeric_limits<T>::epsilon();
+        T lo = std::numeric_limits<T>::max();
+        T hi = -lo;
+        T emax = T(0);
+        for (std::size_t i = 0; i < n; ++i) {
+            const T r = (i > 0 ? std::abs(e[i - 1]) : T(0)) + (i + 1 < n ? std::abs(e[i]) : T(0));
+            lo = std::min(lo, d[i] - r);
+            hi = std::max(hi, d[i] + r);
+            if (i + 1 < n) {
+                emax = std::max(emax, e[i] * e[i]);
+            }
+        }
+        const T tnorm = std::max(std::abs(lo), std::abs(hi));
+        const T pivmin = std::max(std::numeric_limits<T>::min(), std::numeric_limits<T>::min() * emax);
+        lo -= T(2) * eps * tnorm + pivmin;
+        hi += T(2) * eps * tnorm + pivmin;
+
+        std::vector<T> values(last - first);
+        parallelFor(last - first, 8, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t idx = begin; idx < end; ++idx) {
+                const std::size_t target = first + idx;
+                T a = lo, b = hi;
+                while (b - a > T(2) * eps * std::max(std::abs(a), std::abs(b)) + pivmin) {
+                    const T mid = a + (b - a) / T(2);
+                    if (mid == a || mid == b) {
+                        break;
+                    }
+                    if (sturmCount(n, d, e, mid, pivmin) > target) {
+                        b = mid;
+                    }
+                    else {
+                        a = mid;
+                    }
+                }
+                values[idx] = a + (b - a) / T(2);
+            }
+        }, threads);
+        return values;
+    }
+
+    // Eigenvectors for the given (ascending) eigenvalues by inverse iteration. The
+    // vectors of clustered eigenvalues are reorthogonalized against each other, as
+    // in LAPACK's stein. The vectors are written to the columns of z (n x count).
+    template <class T>
+    void tridiagonalInverseIteration(std::size_t n, const T* d, const T* e,
+                                     const std::vector<T>& values, T* z, std::size_t ldz)
+    {
+        const T eps = std::numeric_limits<T>::epsilon();
+        T tnorm = T(0);
+        for (std::size_t i = 0; i < n; ++i) {
+            tnorm = std::max(tnorm, std::abs(d[i]) + (i > 0 ? std::abs(e[i - 1]) : T(0))
+                             + (i + 1 < n ? std::abs(e[i]) : T(0)));
+        }
+        if (tnorm == T(0)) {
+            tnorm = T(1);
+        }
+        const T clusterTol = T(1e-3) * tnorm;
+        const T tiny = eps * tnorm;
+
+        std::vector<T> u0(n), u1(n), u2(n), mult(n), x(n);
+        std::vector<char> swapped(n);
+        std::uint64_t seed = 0x9E3779B97F4A7C15ull;
+        std::size_t clusterStart = 0;
+        T prev = T(0);
+
+        for (std::size_t j = 0; j < values.size(); ++j) {
+            T lambda = values[j];
+            if (j > 0) {
+                if (lambda - values[j - 1] > clusterTol) {
+                    clusterStart = j;
+                }
+                else if (lambda - prev < T(10) * tiny) {
+                    lambda = prev + T(10) * tiny;
+                }
+            }
+            prev = lambda;
+
+            // LU factorization of T - lambda*I with partial pivoting.
+            T c0 = d[0] - lambda;
+            T c1 = (n > 1 ? e[0] : T(0));
+            T c2 = T(0);
+            for (std::size_t i = 0; i + 1 < n; ++i) {
+                const T a1 = d[i + 1] - lambda;
+                const T e1 = (i + 2 < n ? e[i + 1] : T(0));
+                if (std::abs(e[i]) > std::abs(c0)) {
+                    swapped[i] = 1;
+                    u0[i] = e[i];
+                    u1[i] = a1;
+                    u2[i] = e1;
+                    mult[i] = c0 / e[i];
+                    const T n0 = c1 - mult[i] * a1;
+                    const T n1 = c2 - mult[i] * e1;
+                    c0 = n0;
+                    c1 = n1;
+                }
+                else {
+                    swapped[i] = 0;
+                    if (c0 == T(0)) {
+                        c0 = tiny;
+                    }
+                    u0[i] = c0;
+                    u1[i] = c1;
+                    u2[i] = c2;
+                    mult[i] = e[i] / c0;
+                    c0 = a1 - mult[i] * c1;
+                    c1 = e1 - mult[i] * c2;
+                }
+                c2 = T(0);
+            }
+            u0[n - 1] = (c0 == T(0) ? tiny : c0);
+
+            for (std::size_t i = 0; i < n; ++i) {
+                seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+                x[i] = T(int((seed >> 33) % 2001) - 1000) / T(1000);
+            }
+
+            for (unsigned iter = 0; iter < 5; ++iter) {
+                blas::scal(n, T(1) / std::max(blas::amax(n, x.data()), std::numeric_limits<T>::min()), x.data());
+                for (std::size_t i = 0; i + 1 < n; ++i) {
+                    if (swapped[i]) {
+                        std::swap(x[i], x[i + 1]);
+                    }
+                    x[i + 1] -= mult[i] * x[i];
+                }
+                for (std::size_t i = n; i-- > 0;) {
+                    T v = x[i];
+                    if (i + 1 < n) v -= u1[i] * x[i + 1];
+                    if (i + 2 < n) v -= u2[i] * x[i + 2];
+                    x[i] = v / (std::abs(u0[i]) < tiny ? std::copysign(tiny, u0[i]) : u0[i]);
+                }
+                for (std::size_t p = clusterStart; p < j; ++p) {
+                    const T* zp = z + p * ldz;
+                    blas::axpy(n, -blas::dot(n, zp, x.data()), zp, x.data());
+                }
+            }
+            T* zj = z + j * ldz;
+            const T nrm = blas::nrm2(n, x.data());
+            for (std::size_t i = 0; i < n; ++i) {
+                zj[i] = x[i] / nrm;
+            }
+        }
+    }
+
+}}}
+
+#endif
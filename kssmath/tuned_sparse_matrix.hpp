@@ -0,0 +1,195 @@
+//
+//  tuned_sparse_matrix.hpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#ifndef kssmath_tuned_sparse_matrix_hpp
+#define kssmath_tuned_sparse_matrix_hpp
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "block_sparse_matrix.hpp"
+#include "linear_operator.hpp"
+#include "sliced_ell_matrix.hpp"
+#include "sparse_matrix.hpp"
+
+namespace kss { namespace math {
+
+    /*!
+     The storage formats that a TunedSparseMatrix may use.
+     */
+    enum class SparseFormat {
+        CSR,        ///< SparseMatrix
+        SlicedEll,  ///< SlicedEllMatrix
+        BlockCSR    ///< BlockSparseMatrix
+    };
+
+    /*!
+     The statistics of a sparse matrix used to select its storage format.
+     */
+    struct SparseMatrixStatistics {
+        double      meanRowLength = 0;
+        std::size_t maxRowLength = 0;
+        double      rowLengthDeviation = 0;     ///< Standard deviation of the row lengths.
+        double      slicedEllFill = 1;          ///< Fill ratio of SELL-C-sigma with the default options.
+        std::size_t blockSize = 1;              ///< The square block size (2 to 4) with the least fill.
+        double      blockFill = 1;              ///< Fill ratio of BCSR with that block size.
+        bool        smallIndices = true;        ///< True if the column indices fit in 32 bits.
+    };
+
+    /*!
+     Compute the statistics of a. This makes a few passes over the pattern, which
+     is much less than the conversion to another format.
+     */
+    template <class T>
+    SparseMatrixStatistics sparseMatrixStatistics(const SparseMatrix<T>& a) {
+        SparseMatrixStatistics st;
+        const auto& ptr = a.rowPointers();
+        const std::size_t rows = a.rows();
+        if (rows > 0) {
+            st.meanRowLength = double(a.nonZeros()) / double(rows);
+            double var = 0;
+            for (std::size_t i = 0; i < rows; ++i) {
+                const std::size_t len = ptr[i + 1] - ptr[i];
+                st.maxRowLength = std::max(st.maxRowLength, len);
+                var += (double(len) - st.meanRowLength) * (double(len) - st.meanRowLength);
+            }
+            st.rowLengthDeviation = std::sqrt(var / double(rows));
+        }
+        st.smallIndices = (a.cols() <= std::numeric_limits<std::uint32_t>::max());
+        if (a.nonZeros() == 0) {
+            return st;
+        }
+
+        const SlicedEllOptions sell;
+        const auto order = _private::slicedEllRowOrder(a, sell.sortWindow);
+        st.slicedEllFill = double(_private::slicedEllStorage(a, order, sell.sliceHeight)) / double(a.nonZeros());
+        for (std::size_t b = 2; b <= 4; ++b) {
+            const double fill = double(_private::nonZeroBlocks(a, b, b) * b * b) / double(a.nonZeros());
+            if (st.blockSize == 1 || fill <= st.blockFill) {
+                st.blockSize = b;
+                st.blockFill = fill;
+            }
+        }
+        return st;
+    }
+
+    /*!
+     Choose the storage format for a matrix of value type T that minimizes the
+     estimated number of bytes read per nonzero by SpMV: the values and indices,
+     including any padding, with 32 bit indices for the SELL and BCSR formats and
+     std::size_t indices for CSR. This strongly favors BCSR when the blocks are
+     nearly full, and favors SELL-C-sigma over CSR unless the row lengths vary so
+     much that the padding outweighs the smaller indices.
+     */
+    template <class T>
+    SparseFormat selectSparseFormat(const SparseMatrixStatistics& st) {
+        if (!st.smallIndices) {
+            return SparseFormat::CSR;
+        }
+        const double index = double(sizeof(std::uint32_t));
+        const double csr = double(sizeof(T) + sizeof(std::size_t));
+        const double sell = st.slicedEllFill * (double(sizeof(T)) + index);
+        const double bcsr = st.blockFill * (double(sizeof(T)) + index / double(st.blockSize * st.blockSize));
+        if (st.blockSize > 1 && bcsr < sell && bcsr < csr) {
+            return SparseFormat::BlockCSR;
+        }
+        return (sell < csr ? SparseFormat::SlicedEll : SparseFormat::CSR);
+    }
+
+    /*!
+     A read-only sparse matrix stored in the format best suited to SpMV, chosen
+     from the statistics of the matrix by selectSparseFormat or given explicitly.
+     */
+    template <class T>
+    class TunedSparseMatrix {
+    public:
+        using value_type = T;
+        using size_type = std::size_t;
+
+        /*!
+         Convert a to the format selected from its statistics.
+         */
+        explicit TunedSparseMatrix(const SparseMatrix<T>& a) : _stats(sparseMatrixStatistics(a)) {
+            convert(a, selectSparseFormat<T>(_stats));
+        }
+
+        /*!
+         Convert a to the given format. BlockCSR uses the block size with the
+         least fill.
+         @throws std::invalid_argument if the matrix is too large for the format.
+         */
+        TunedSparseMatrix(const SparseMatrix<T>& a, SparseFormat format) : _stats(sparseMatrixStatistics(a)) {
+            convert(a, format);
+        }
+
+        size_type rows() const noexcept { return _rows; }
+        size_type cols() const noexcept { return _cols; }
+        SparseFormat format() const noexcept { return _format; }
+        const SparseMatrixStatistics& statistics() const noexcept { return _stats; }
+
+        /*!
+         Computes y = A*x, using the given number of threads.
+         */
+        void multiply(const T* x, T* y, unsigned threads = 0) const {
+            switch (_format) {
+            case SparseFormat::CSR:
+                _csr.multiply(x, y, threads);
+                break;
+            case SparseFormat::SlicedEll:
+                _sell.multiply(x, y, threads);
+                break;
+            case SparseFormat::BlockCSR:
+                _bcsr.multiply(x, y, threads);
+                break;
+            }
+        }
+
+    private:
+        SparseMatrixStatistics  _stats;
+        SparseFormat            _format = SparseFormat::CSR;
+        size_type               _rows = 0;
+        size_type               _cols = 0;
+        SparseMatrix<T>         _csr;
+        SlicedEllMatrix<T>      _sell;
+        BlockSparseMatrix<T>    _bcsr;
+
+        void convert(const SparseMatrix<T>& a, SparseFormat format) {
+            _format = format;
+            _rows = a.rows();
+            _cols = a.cols();
+            switch (format) {
+            case SparseFormat::CSR:
+                _csr = a;
+                break;
+            case SparseFormat::SlicedEll:
+                _sell = SlicedEllMatrix<T>(a);
+                break;
+            case SparseFormat::BlockCSR:
+                _bcsr = BlockSparseMatrix<T>(a, _stats.blockSize, _stats.blockSize);
+                break;
+            }
+        }
+    };
+
+    /*!
+     Returns an operator computing the product with a, which must outlive it.
+     */
+    template <class T>
+    LinearOperator<T> sparseOperator(const TunedSparseMatrix<T>& a, unsigned threads = 0) {
+        const TunedSparseMatrix<T>* pa = &a;
+        return [pa, threads](const T* x, T* y) { pa->multiply(x, y, threads); };
+    }
+
+}}
+
+#endif
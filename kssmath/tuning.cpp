@@ -0,0 +1,498 @@
+//
+//  tuning.cpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <ostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__APPLE__)
+#   include <sys/sysctl.h>
+#endif
+
+#include "blas.hpp"
+#include "cholesky.hpp"
+#include "matrix.hpp"
+#include "parallel.hpp"
+#include "sliced_ell_matrix.hpp"
+#include "sparse_matrix.hpp"
+#include "tuning.hpp"
+
+using namespace std;
+using namespace kss::math;
+
+
+namespace {
+
+    using Clock = chrono::steady_clock;
+
+    constexpr InstructionSet instructionSets[] = {
+        InstructionSet::Generic, InstructionSet::AVX2, InstructionSet::AVX512
+    };
+
+    InstructionSet bestSupported() noexcept {
+        InstructionSet best = InstructionSet::Generic;
+        for (auto isa : instructionSets) {
+            if (isSupported(isa)) {
+                best = isa;
+            }
+        }
+        return best;
+    }
+
+    // Read the parameters for this machine when they are first used. A missing
+    // or unreadable file is not an error here, the defaults are used instead.
+    TuningParameters loadTuningParameters() noexcept {
+        try {
+            const string path = tuningFilePath();
+            if (!path.empty() && ifstream(path)) {
+                TuningParameters params = readTuningFile(path);
+                if (isSupported(params.instructionSet)) {
+                    return params;
+                }
+            }
+        }
+        catch (...) {
+        }
+        return defaultTuningParameters();
+    }
+
+    TuningParameters& current() noexcept {
+        static TuningParameters params = loadTuningParameters();
+        return params;
+    }
+
+    string trim(const string& s) {
+        const auto begin = s.find_first_not_of(" \t\r");
+        if (begin == string::npos) {
+            return string();
+        }
+        return s.substr(begin, s.find_last_not_of(" \t\r") - begin + 1);
+    }
+
+    bool isSectionHeader(const string& line) {
+        return line.size() >= 2 && line.front() == '[' && line.back() == ']';
+    }
+
+    template <class T>
+    T parseNumber(const string& key, const string& value) {
+        istringstream in(value);
+        unsigned long long n = 0;
+        if (value.empty() || value[0] == '-' || !(in >> n) || !in.eof()
+            || n > numeric_limits<T>::max())
+        {
+            throw runtime_error("readTuningFile: bad value for " + key + ": " + value);
+        }
+        return T(n);
+    }
+
+    InstructionSet parseInstructionSet(const string& value) {
+        for (auto isa : instructionSets) {
+            if (value == instructionSetName(isa)) {
+                return isa;
+            }
+        }
+        throw runtime_error("readTuningFile: unknown instruction set: " + value);
+    }
+
+    // Create the directories leading to path, ignoring those that exist.
+    void makeParentDirectories(const string& path) {
+        for (auto pos = path.find('/', 1); pos != string::npos; pos = path.find('/', pos + 1)) {
+            const string dir = path.substr(0, pos);
+            if (::mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST) {
+                throw system_error(errno, system_category(), "mkdir " + dir);
+            }
+        }
+    }
+
+    // Returns the best, over the repetitions, of the average time of a call of
+    // fn, with each repetition calling it for at least the minimum time.
+    template <class Fn>
+    double bestTime(const AutotuneOptions& opts, Fn&& fn) {
+        fn();
+        double best = numeric_limits<double>::max();
+        for (unsigned rep = 0; rep < max(opts.repetitions, 1u); ++rep) {
+            const auto start = Clock::now();
+            size_t calls = 0;
+            double elapsed = 0;
+            do {
+                fn();
+                ++calls;
+                elapsed = chrono::duration<double>(Clock::now() - start).count();
+            } while (elapsed < opts.minTime);
+            best = min(best, elapsed / double(calls));
+        }
+        return best;
+    }
+
+    ostream& operator<<(ostream& out, InstructionSet isa) {
+        return out << instructionSetName(isa);
+    }
+
+    // Measure each candidate and return the fastest, logging the times.
+    template <class Candidate, class Fn>
+    Candidate fastest(const AutotuneOptions& opts, const char* what,
+                      const vector<Candidate>& candidates, Fn&& measure)
+    {
+        Candidate best = candidates.front();
+        double bestSeconds = numeric_limits<double>::max();
+        for (const auto& candidate : candidates) {
+            const double seconds = measure(candidate);
+            if (opts.log) {
+                *opts.log << "autotune: " << what << " " << candidate << ": "
+                          << seconds * 1e3 << " ms" << endl;
+            }
+            if (seconds < bestSeconds) {
+                bestSeconds = seconds;
+                best = candidate;
+            }
+        }
+        if (opts.log) {
+            *opts.log << "autotune: " << what << " = " << best << endl;
+        }
+        return best;
+    }
+
+    Matrix<double> randomMatrix(size_t rows, size_t cols, uint64_t seed) {
+        mt19937_64 gen(seed);
+        uniform_real_distribution<double> dist(-1.0, 1.0);
+        Matrix<double> a(rows, cols);
+        generate(a.data(), a.data() + a.size(), [&] { return dist(gen); });
+        return a;
+    }
+
+    // A symmetric positive definite matrix: a random symmetric one with its
+    // diagonal raised enough to dominate.
+    Matrix<double> spdMatrix(size_t n) {
+        Matrix<double> a = randomMatrix(n, n, 1);
+        for (size_t j = 0; j < n; ++j) {
+            for (size_t i = 0; i < j; ++i) {
+                a(i, j) = a(j, i);
+            }
+            a(j, j) = 2.0 * double(n);
+        }
+        return a;
+    }
+
+    SparseMatrix<double> laplacian(size_t k) {
+        const size_t n = k * k;
+        vector<size_t> ptr(1, 0), idx;
+        vector<double> val;
+        idx.reserve(5 * n);
+        val.reserve(5 * n);
+        for (size_t r = 0; r < n; ++r) {
+            const size_t i = r % k, j = r / k;
+            auto entry = [&](size_t c, double v) { idx.push_back(c); val.push_back(v); };
+            if (j > 0) { entry(r - k, -1.0); }
+            if (i > 0) { entry(r - 1, -1.0); }
+            entry(r, 4.0);
+            if (i + 1 < k) { entry(r + 1, -1.0); }
+            if (j + 1 < k) { entry(r + k, -1.0); }
+            ptr.push_back(idx.size());
+        }
+        return SparseMatrix<double>(n, n, move(ptr), move(idx), move(val));
+    }
+
+}
+
+
+TuningParameters kss::math::defaultTuningParameters() noexcept {
+    TuningParameters params;
+    params.instructionSet = bestSupported();
+    return params;
+}
+
+const TuningParameters& kss::math::tuningParameters() noexcept {
+    return current();
+}
+
+void kss::math::setTuningParameters(const TuningParameters& params) {
+    if (!isSupported(params.instructionSet)) {
+        throw invalid_argument(string("setTuningParameters: ") + instructionSetName(params.instructionSet)
+                               + " is not supported");
+    }
+    if (params.blockSize == 0 || params.spmvChunkRows == 0) {
+        throw invalid_argument("setTuningParameters: sizes must be positive");
+    }
+    if (params.sliceHeight == 0 || params.sliceHeight > _private::maxSliceHeight) {
+        throw invalid_argument("setTuningParameters: the slice height must be between 1 and "
+                               + to_string(_private::maxSliceHeight));
+    }
+    selectInstructionSet(params.instructionSet);
+    current() = params;
+}
+
+TuningParameters kss::math::autotune(const AutotuneOptions& opts) {
+    const TuningParameters original = current();
+    const unsigned hardwareThreads = defaultThreadCount();
+    const unsigned maxThreads = (opts.maxThreads == 0 ? hardwareThreads : min(opts.maxThreads, hardwareThreads));
+    TuningParameters params = original;
+    params.tuned = true;
+
+    try {
+        // The instruction set, by a GEMM small enough to stay in the caches so
+        // that it measures the kernel rather than the memory.
+        {
+            const size_t n = 256;
+            const Matrix<double> a = randomMatrix(n, n, 1), b = randomMatrix(n, n, 2);
+            Matrix<double> c(n, n);
+            vector<InstructionSet> candidates;
+            for (auto isa : instructionSets) {
+                if (isSupported(isa)) {
+                    candidates.push_back(isa);
+                }
+            }
+            params.instructionSet = fastest(opts, "instruction set", candidates, [&](InstructionSet isa) {
+                selectInstructionSet(isa);
+                return bestTime(opts, [&] {
+                    blas::gemm(blas::Op::NoTrans, blas::Op::NoTrans, n, n, n, 1.0, a.data(), n,
+                               b.data(), n, 0.0, c.data(), n);
+                });
+            });
+            selectInstructionSet(params.instructionSet);
+        }
+
+        // The block size and then the thread count, by a blocked Cholesky
+        // factorization.
+        {
+            const size_t n = max<size_t>(opts.denseSize, 64);
+            const Matrix<double> a = spdMatrix(n);
+            auto factor = [&](size_t blockSize, unsigned threads) {
+                BlockingOptions blocking;
+                blocking.blockSize = blockSize;
+                blocking.threads = threads;
+                return bestTime(opts, [&] { Cholesky<double> chol(a, blocking); });
+            };
+
+            vector<size_t> blockSizes;
+            for (size_t b : { 32, 48, 64, 96, 128, 192, 256 }) {
+                if (b <= n / 2) {
+                    blockSizes.push_back(b);
+                }
+            }
+            params.blockSize = fastest(opts, "block size", blockSizes, [&](size_t b) {
+                return factor(b, maxThreads);
+            });
+
+            vector<unsigned> threadCounts;
+            for (unsigned t = 1; t < maxThreads; t *= 2) {
+                threadCounts.push_back(t);
+            }
+            threadCounts.push_back(maxThreads);
+            const unsigned threads = fastest(opts, "threads", threadCounts, [&](unsigned t) {
+                return factor(params.blockSize, t);
+            });
+            params.threads = (threads == hardwareThreads ? 0 : threads);
+        }
+
+        // The sparse products, on the threads chosen above.
+        {
+            const SparseMatrix<double> csr = laplacian(max<size_t>(opts.sparseGrid, 16));
+            const vector<double> x(csr.cols(), 1.0);
+            vector<double> y(csr.rows());
+
+            vector<size_t> sliceHeights;
+            for (size_t c : { 4, 8, 16, 32 }) {
+                if (c <= _private::maxSliceHeight) {
+                    sliceHeights.push_back(c);
+                }
+            }
+            params.sliceHeight = fastest(opts, "slice height", sliceHeights, [&](size_t c) {
+                SlicedEllOptions sell;
+                sell.sliceHeight = c;
+                const SlicedEllMatrix<double> a(csr, sell);
+                return bestTime(opts, [&] { a.multiply(x.data(), y.data(), params.threads); });
+            });
+
+            const vector<size_t> chunks = { 256, 512, 1024, 2048, 4096, 8192 };
+            params.spmvChunkRows = fastest(opts, "spmv chunk rows", chunks, [&](size_t rows) {
+                current().spmvChunkRows = rows;
+                return bestTime(opts, [&] { csr.multiply(x.data(), y.data(), params.threads); });
+            });
+        }
+    }
+    catch (...) {
+        setTuningParameters(original);
+        throw;
+    }
+
+    setTuningParameters(params);
+    return params;
+}
+
+string kss::math::machineName() {
+    string model;
+#if defined(__APPLE__)
+    char brand[256] = { 0 };
+    size_t length = sizeof(brand);
+    if (sysctlbyname("machdep.cpu.brand_string", brand, &length, nullptr, 0) == 0) {
+        model = brand;
+    }
+#else
+    ifstream cpuinfo("/proc/cpuinfo");
+    string line;
+    while (getline(cpuinfo, line)) {
+        const auto colon = line.find(':');
+        if (colon != string::npos && trim(line.substr(0, colon)) == "model name") {
+            model = trim(line.substr(colon + 1));
+            break;
+        }
+    }
+#endif
+    if (model.empty()) {
+        model = "unknown CPU";
+    }
+    // The name must fit in a section header of the file.
+    replace(model.begin(), model.end(), '[', '(');
+    replace(model.begin(), model.end(), ']', ')');
+    return model + "; " + to_string(max(thread::hardware_concurrency(), 1u)) + " threads";
+}
+
+string kss::math::tuningFilePath() {
+    if (const char* path = getenv("KSSMATH_TUNING_FILE")) {
+        return path;
+    }
+    const char* home = getenv("HOME");
+#if defined(__APPLE__)
+    return (home ? string(home) + "/Library/Caches/kssmath/tuning.conf" : string());
+#else
+    if (const char* cache = getenv("XDG_CACHE_HOME")) {
+        if (*cache) {
+            return string(cache) + "/kssmath/tuning.conf";
+        }
+    }
+    return (home ? string(home) + "/.cache/kssmath/tuning.conf" : string());
+#endif
+}
+
+TuningParameters kss::math::readTuningFile(const string& path) {
+    ifstream in(path);
+    if (!in) {
+        throw system_error(errno, system_category(), "readTuningFile: " + path);
+    }
+
+    const string section = "[" + machineName() + "]";
+    TuningParameters params = defaultTuningParameters();
+    bool inSection = false;
+    string line;
+    while (getline(in, line)) {
+        line = trim(line);
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        if (isSectionHeader(line)) {
+            inSection = (line == section);
+            params.tuned = params.tuned || inSection;
+            continue;
+        }
+        if (!inSection) {
+            continue;
+        }
+
+        const auto equals = line.find('=');
+        if (equals == string::npos) {
+            throw runtime_error("readTuningFile: expected key = value: " + line);
+        }
+        const string key = trim(line.substr(0, equals));
+        const string value = trim(line.substr(equals + 1));
+        // Keys that are not known are ignored, so that a file written by a
+        // later version can still be read.
+        if (key == "instruction_set") {
+            params.instructionSet = parseInstructionSet(value);
+        }
+        else if (key == "block_size") {
+            params.blockSize = parseNumber<size_t>(key, value);
+        }
+        else if (key == "threads") {
+            params.threads = parseNumber<unsigned>(key, value);
+        }
+        else if (key == "slice_height") {
+            params.sliceHeight = parseNumber<size_t>(key, value);
+        }
+        else if (key == "spmv_chunk_rows") {
+            params.spmvChunkRows = parseNumber<size_t>(key, value);
+        }
+    }
+    if (in.bad()) {
+        throw system_error(errno, system_category(), "readTuningFile: " + path);
+    }
+
+    if (params.blockSize == 0 || params.spmvChunkRows == 0 || params.sliceHeight == 0
+        || params.sliceHeight > _private::maxSliceHeight)
+    {
+        throw runtime_error("readTuningFile: a size is out of range in " + path);
+    }
+    return params;
+}
+
+void kss::math::writeTuningFile(const string& path, const TuningParameters& params) {
+    // Keep the lines of the sections of other machines.
+    const string section = "[" + machineName() + "]";
+    vector<string> kept;
+    {
+        ifstream in(path);
+        bool inSection = false;
+        string line;
+        while (getline(in, line)) {
+            const string trimmed = trim(line);
+            if (isSectionHeader(trimmed)) {
+                inSection = (trimmed == section);
+            }
+            if (!inSection && !(kept.empty() && (trimmed.empty() || trimmed[0] == '#'))) {
+                kept.push_back(line);
+            }
+        }
+    }
+    while (!kept.empty() && trim(kept.back()).empty()) {
+        kept.pop_back();
+    }
+
+    makeParentDirectories(path);
+    const string temporary = path + "." + to_string(::getpid()) + ".tmp";
+    {
+        ofstream out(temporary, ios::trunc);
+        out << "# kssmath tuning parameters, written by writeTuningFile()\n\n";
+        for (const auto& line : kept) {
+            out << line << '\n';
+        }
+        if (!kept.empty()) {
+            out << '\n';
+        }
+        out << section << '\n'
+            << "instruction_set = " << instructionSetName(params.instructionSet) << '\n'
+            << "block_size = " << params.blockSize << '\n'
+            << "threads = " << params.threads << '\n'
+            << "slice_height = " << params.sliceHeight << '\n'
+            << "spmv_chunk_rows = " << params.spmvChunkRows << '\n';
+        out.flush();
+        if (!out) {
+            const int err = errno;
+            std::remove(temporary.c_str());
+            throw system_error(err, system_category(), "writeTuningFile: " + temporary);
+        }
+    }
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        const int err = errno;
+        std::remove(temporary.c_str());
+        throw system_error(err, system_category(), "writeTuningFile: " + path);
+    }
+}
@@ -0,0 +1,169 @@
+//
+//  tuning.hpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#ifndef kssmath_tuning_hpp
+#define kssmath_tuning_hpp
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+
+#include "cpu_features.hpp"
+
+namespace kss { namespace math {
+
+    /*!
+     The machine dependent parameters of the kernels. These are the defaults of
+     the corresponding options (BlockingOptions, SlicedEllOptions) and of the
+     sparse products, so code that does not set the options explicitly uses
+     the values tuned for the machine it runs on.
+
+     When the library is first used the parameters for the machine are read
+     from the tuning file (see tuningFilePath()) if it has a section for this
+     machine; otherwise the built in defaults are used. The file is written by
+     running autotune() and then writeTuningFile(), for example with
+     kssmath_benchmarks --autotune on each type of machine. One file can hold
+     the parameters of several machines, so it may be shared between hosts.
+     */
+    struct TuningParameters {
+        /*!
+         True if the values were measured by autotune() rather than defaults.
+         */
+        bool            tuned = false;
+
+        /*!
+         The instruction set whose dispatched BLAS kernels are used. This is not
+         always the widest one supported: on some CPUs the clock slows down
+         enough when running 512 bit instructions that AVX2 is faster.
+         */
+        InstructionSet  instructionSet = InstructionSet::Generic;
+
+        /*!
+         The default BlockingOptions::blockSize, the tile size of the blocked
+         dense factorizations and of their matrix multiply updates.
+         */
+        std::size_t     blockSize = 96;
+
+        /*!
+         The default BlockingOptions::threads. 0 uses defaultThreadCount(),
+         which is not always the fastest (for example when the hardware threads
+         share cores).
+         */
+        unsigned        threads = 0;
+
+        /*!
+         The default SlicedEllOptions::sliceHeight.
+         */
+        std::size_t     sliceHeight = 8;
+
+        /*!
+         The number of rows handed to a thread at a time by the sparse
+         matrix-vector products.
+         */
+        std::size_t     spmvChunkRows = 1024;
+    };
+
+    /*!
+     Returns the built in parameters, with the best instruction set that the
+     machine supports.
+     */
+    TuningParameters defaultTuningParameters() noexcept;
+
+    /*!
+     Returns the parameters in use.
+     */
+    const TuningParameters& tuningParameters() noexcept;
+
+    /*!
+     Replace the parameters in use, and select their instruction set. Options
+     created before this keep the values they were created with. This must not
+     be called while other threads may be running the kernels.
+     @throws std::invalid_argument if the instruction set is not supported or a
+        size is zero or out of range.
+     */
+    void setTuningParameters(const TuningParameters& params);
+
+    /*!
+     Options of autotune().
+     */
+    struct AutotuneOptions {
+        /*!
+         The order of the dense matrices that the block size and thread count
+         are tuned on. The results suit matrices of this order and larger.
+         */
+        std::size_t     denseSize = 768;
+
+        /*!
+         The sparse parameters are tuned on a 5 point Laplacian on a square grid
+         of this many points per side.
+         */
+        std::size_t     sparseGrid = 512;
+
+        /*!
+         The largest number of threads to try. 0 tries up to all the hardware
+         threads.
+         */
+        unsigned        maxThreads = 0;
+
+        /*!
+         The minimum time, in seconds, of a measurement. Each candidate is
+         measured repetitions times and the best time is kept.
+         */
+        double          minTime = 0.05;
+        unsigned        repetitions = 3;
+
+        /*!
+         If not null, a line is written here for each candidate measured.
+         */
+        std::ostream*   log = nullptr;
+    };
+
+    /*!
+     Measure candidate parameters on this machine, in turn: the instruction set
+     by a double precision GEMM; the block size and then the thread count by a
+     blocked Cholesky factorization; the slice height by a SELL-C-sigma
+     product; and the chunk size by a CSR product on all threads. The best of
+     each is kept, the result is made current with setTuningParameters() and
+     returned. This takes several seconds.
+     */
+    TuningParameters autotune(const AutotuneOptions& opts = AutotuneOptions());
+
+    /*!
+     Returns the name that identifies this machine in the tuning file: the CPU
+     model and the number of hardware threads.
+     */
+    std::string machineName();
+
+    /*!
+     Returns the path of the tuning file: the value of the environment variable
+     KSSMATH_TUNING_FILE if it is set, otherwise kssmath/tuning.conf in the
+     user's cache directory (~/Library/Caches on macOS, $XDG_CACHE_HOME or
+     ~/.cache elsewhere).
+     */
+    std::string tuningFilePath();
+
+    /*!
+     Returns the parameters for this machine from a tuning file, or the
+     defaults (with tuned false) if the file has no section for this machine.
+     @throws std::system_error if the file cannot be read.
+     @throws std::runtime_error if the section for this machine is malformed.
+     */
+    TuningParameters readTuningFile(const std::string& path);
+
+    /*!
+     Write the parameters as the section for this machine of a tuning file,
+     keeping the sections of other machines and creating the file (and its
+     directory) if needed. The file is replaced atomically.
+     @throws std::system_error if the file cannot be written.
+     */
+    void writeTuningFile(const std::string& path, const TuningParameters& params);
+
+}}
+
+#endif
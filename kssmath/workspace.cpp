@@ -0,0 +1,237 @@
+//
+//  workspace.cpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+#include <sys/mman.h>
+
+#include "workspace.hpp"
+
+using namespace std;
+using namespace kss::math;
+using kss::math::_private::MemoryRegion;
+using kss::math::_private::workspaceAlignment;
+
+
+namespace {
+
+    // Regions of at least this size are mapped directly, and rounded up to a
+    // whole number of huge pages.
+    constexpr size_t hugePageSize = size_t(2) << 20;
+
+    // The smallest region a workspace allocates.
+    constexpr size_t minimumRegion = size_t(64) << 10;
+
+    size_t roundUp(size_t n, size_t alignment) noexcept {
+        return (n + alignment - 1) / alignment * alignment;
+    }
+
+}
+
+
+MemoryRegion kss::math::_private::allocateRegion(size_t size, bool hugePages) {
+    MemoryRegion r;
+    if (size >= hugePageSize) {
+        r.size = roundUp(size, hugePageSize);
+        void* p = ::mmap(nullptr, r.size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) {
+            throw bad_alloc();
+        }
+#if defined(MADV_HUGEPAGE)
+        if (hugePages) {
+            ::madvise(p, r.size, MADV_HUGEPAGE);
+        }
+#endif
+        r.data = static_cast<char*>(p);
+        r.mapped = true;
+    }
+    else {
+        r.size = roundUp(max<size_t>(size, 1), workspaceAlignment);
+        void* p = nullptr;
+        if (::posix_memalign(&p, workspaceAlignment, r.size) != 0) {
+            throw bad_alloc();
+        }
+        r.data = static_cast<char*>(p);
+    }
+    return r;
+}
+
+void kss::math::_private::freeRegion(const MemoryRegion& region) noexcept {
+    if (region.mapped) {
+        ::munmap(region.data, region.size);
+    }
+    else {
+        ::free(region.data);
+    }
+}
+
+
+Workspace::Workspace(size_type capacity) {
+    if (capacity > 0) {
+        _regions.push_back(_private::allocateRegion(capacity));
+    }
+}
+
+Workspace::Workspace(Workspace&& other) noexcept
+: _regions(move(other._regions)), _region(other._region), _offset(other._offset)
+{
+    other._regions.clear();
+    other._region = other._offset = 0;
+}
+
+Workspace& Workspace::operator=(Workspace&& other) noexcept {
+    if (this != &other) {
+        freeAll();
+        _regions = move(other._regions);
+        _region = other._region;
+        _offset = other._offset;
+        other._regions.clear();
+        other._region = other._offset = 0;
+    }
+    return *this;
+}
+
+Workspace::~Workspace() noexcept {
+    freeAll();
+}
+
+void* Workspace::allocate(size_type size) {
+    size = roundUp(max<size_type>(size, 1), workspaceAlignment);
+    if (_region < _regions.size() && _regions[_region].size - _offset >= size) {
+        void* p = _regions[_region].data + _offset;
+        _offset += size;
+        return p;
+    }
+
+    // Move on to the next region, replacing it if it is too small (the regions
+    // after the current one hold nothing).
+    const size_type next = (_region < _regions.size() && _offset > 0 ? _region + 1 : _region);
+    if (next < _regions.size() && _regions[next].size < size) {
+        _private::freeRegion(_regions[next]);
+        _regions.erase(_regions.begin() + long(next));
+    }
+    if (next >= _regions.size() || _regions[next].size < size) {
+        const size_type previous = (_regions.empty() ? 0 : _regions.back().size);
+        _regions.insert(_regions.begin() + long(next),
+                        _private::allocateRegion(max(size, max(2 * previous, minimumRegion))));
+    }
+    _region = next;
+    _offset = size;
+    return _regions[_region].data;
+}
+
+void Workspace::release(const Marker& marker) noexcept {
+    _region = marker.region;
+    _offset = marker.offset;
+
+    // Once everything is released, merge several regions into one large enough
+    // for all of them, so that the next use fits without growing.
+    if (_region == 0 && _offset == 0 && _regions.size() > 1) {
+        const size_type total = capacity();
+        freeAll();
+        try {
+            _regions.push_back(_private::allocateRegion(total));
+        }
+        catch (const bad_alloc&) {
+            // The workspace will grow again when needed.
+        }
+    }
+}
+
+Workspace::size_type Workspace::used() const noexcept {
+    size_type n = _offset;
+    for (size_type r = 0; r < _region && r < _regions.size(); ++r) {
+        n += _regions[r].size;
+    }
+    return n;
+}
+
+Workspace::size_type Workspace::capacity() const noexcept {
+    size_type n = 0;
+    for (const auto& r : _regions) {
+        n += r.size;
+    }
+    return n;
+}
+
+void Workspace::freeAll() noexcept {
+    for (const auto& r : _regions) {
+        _private::freeRegion(r);
+    }
+    _regions.clear();
+    _region = _offset = 0;
+}
+
+
+BlockPool::BlockPool(size_type blockSize, size_type blocksPerRegion)
+: _blockSize(roundUp(max<size_type>(blockSize, sizeof(void*)), 16)), _blocksPerRegion(blocksPerRegion)
+{
+    if (blockSize == 0 || blocksPerRegion == 0) {
+        throw invalid_argument("BlockPool: block size and blocks per region must be positive");
+    }
+}
+
+BlockPool::BlockPool(BlockPool&& other) noexcept
+: _regions(move(other._regions)), _blockSize(other._blockSize), _blocksPerRegion(other._blocksPerRegion),
+  _free(other._free)
+{
+    other._regions.clear();
+    other._free = nullptr;
+}
+
+BlockPool& BlockPool::operator=(BlockPool&& other) noexcept {
+    if (this != &other) {
+        freeAll();
+        _regions = move(other._regions);
+        _blockSize = other._blockSize;
+        _blocksPerRegion = other._blocksPerRegion;
+        _free = other._free;
+        other._regions.clear();
+        other._free = nullptr;
+    }
+    return *this;
+}
+
+BlockPool::~BlockPool() noexcept {
+    freeAll();
+}
+
+void* BlockPool::allocate() {
+    if (_free == nullptr) {
+        const MemoryRegion r = _private::allocateRegion(_blockSize * _blocksPerRegion);
+        _regions.push_back(r);
+        const size_type blocks = r.size / _blockSize;
+        for (size_type b = blocks; b-- > 0;) {
+            char* p = r.data + b * _blockSize;
+            *reinterpret_cast<void**>(p) = _free;
+            _free = p;
+        }
+    }
+    void* p = _free;
+    _free = *static_cast<void**>(p);
+    return p;
+}
+
+void BlockPool::deallocate(void* p) noexcept {
+    if (p != nullptr) {
+        *static_cast<void**>(p) = _free;
+        _free = p;
+    }
+}
+
+void BlockPool::freeAll() noexcept {
+    for (const auto& r : _regions) {
+        _private::freeRegion(r);
+    }
+    _regions.clear();
+    _free = nullptr;
+}
@@ -0,0 +1,330 @@
+//
+//  workspace.hpp
+//  kssmath
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#ifndef kssmath_workspace_hpp
+#define kssmath_workspace_hpp
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace kss { namespace math {
+
+    namespace _private {
+
+        // The alignment of all workspace and pool memory: a cache line, and enough
+        // for any SIMD type.
+        constexpr std::size_t workspaceAlignment = 64;
+
+        // Memory of at least the given size aligned to workspaceAlignment. Large
+        // regions are mapped directly, so their pages are not touched until they
+        // are first written, and (if hugePages is true and the system supports it)
+        // backed by transparent huge pages.
+        // @throws std::bad_alloc if the memory cannot be allocated.
+        struct MemoryRegion {
+            char*       data = nullptr;
+            std::size_t size = 0;
+            bool        mapped = false;
+        };
+        MemoryRegion allocateRegion(std::size_t size, bool hugePages = true);
+        void freeRegion(const MemoryRegion& region) noexcept;
+
+    }
+
+    /*!
+     An arena for temporary numeric storage. Allocation bumps a pointer within a
+     large region, and memory is only given back by releasing everything allocated
+     since a marker, so it suits the workspaces of algorithms that are called
+     repeatedly. After the first call the memory is reused without any calls to
+     the system allocator, and a long running process does not fragment its heap.
+
+     Only some algorithms take one: conjugateGradient (CGOptions::workspace), the
+     V-cycles of SmoothedAggregationAMG (AMGOptions::workspace), lbfgs
+     (LbfgsOptions::workspace), and Tape, which owns its own. The other solvers,
+     including the Krylov eigensolvers, the sparse direct solvers and the out of
+     core kernels, allocate their work storage from the heap.
+
+     All allocations are aligned to 64 bytes. The arena grows by adding regions
+     as needed; regions of 2 MB and more are backed by huge pages where the
+     system supports it. Once everything is released the regions are merged into
+     one, so a workspace that is reused settles to a single region.
+
+     A Workspace is not thread safe: each thread needs its own. It is movable but
+     not copyable.
+     */
+    class Workspace {
+    public:
+        using size_type = std::size_t;
+
+        /*!
+         A position in the workspace, returned by mark() and passed to release().
+         */
+        struct Marker {
+            size_type region = 0;
+            size_type offset = 0;
+        };
+
+        /*!
+         Releases everything allocated in a scope when the scope ends.
+         */
+        class Scope {
+        public:
+            explicit Scope(Workspace& w) noexcept : _w(w), _marker(w.mark()) {}
+            ~Scope() noexcept { _w.release(_marker); }
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+
+        private:
+            Workspace&  _w;
+            Marker      _marker;
+        };
+
+        /*!
+         Construct a workspace, allocating the given capacity up front (if nonzero).
+         @throws std::bad_alloc if the memory cannot be allocated.
+         */
+        explicit Workspace(size_type capacity = 0);
+
+        Workspace(Workspace&& other) noexcept;
+        Workspace& operator=(Workspace&& other) noexcept;
+        Workspace(const Workspace&) = delete;
+        Workspace& operator=(const Workspace&) = delete;
+        ~Workspace() noexcept;
+
+        /*!
+         Returns size bytes of uninitialized memory aligned to 64 bytes.
+         @throws std::bad_alloc if the workspace cannot grow.
+         */
+        void* allocate(size_type size);
+
+        /*!
+         Returns uninitialized storage for n elements of the trivial type T.
+         @throws std::bad_alloc if the workspace cannot grow.
+         */
+        template <class T>
+        T* allocate(size_type n) {
+            static_assert(std::is_trivially_destructible<T>::value, "Workspace: T must be trivial");
+            return static_cast<T*>(allocate(n * sizeof(T)));
+        }
+
+        Marker mark() const noexcept { return Marker { _region, _offset }; }
+
+        /*!
+         Release everything allocated since the marker was taken. Markers taken
+         after it become invalid.
+         */
+        void release(const Marker& marker) noexcept;
+
+        /*!
+         Release everything.
+         */
+        void reset() noexcept { release(Marker()); }
+
+        /*!
+         Returns the number of bytes currently allocated (including the alignment
+         padding) and the total size of the regions.
+         */
+        size_type used() const noexcept;
+        size_type capacity() const noexcept;
+
+    private:
+        std::vector<_private::MemoryRegion> _regions;
+        size_type                           _region = 0;
+        size_type                           _offset = 0;
+
+        void freeAll() noexcept;
+    };
+
+    /*!
+     A standard library allocator that takes its memory from a Workspace, so that
+     containers can be used for temporary storage. Deallocation does nothing; the
+     memory is reclaimed when the workspace is released.
+     */
+    template <class T>
+    class WorkspaceAllocator {
+    public:
+        using value_type = T;
+
+        explicit WorkspaceAllocator(Workspace& w) noexcept : _w(&w) {}
+
+        template <class U>
+        WorkspaceAllocator(const WorkspaceAllocator<U>& other) noexcept : _w(other.workspace()) {}
+
+        T* allocate(std::size_t n) { return static_cast<T*>(_w->allocate(n * sizeof(T))); }
+        void deallocate(T*, std::size_t) noexcept {}
+
+        Workspace* workspace() const noexcept { return _w; }
+
+    private:
+        Workspace* _w;
+    };
+
+    template <class T, class U>
+    bool operator==(const WorkspaceAllocator<T>& a, const WorkspaceAllocator<U>& b) noexcept {
+        return a.workspace() == b.workspace();
+    }
+
+    template <class T, class U>
+    bool operator!=(const WorkspaceAllocator<T>& a, const WorkspaceAllocator<U>& b) noexcept {
+        return !(a == b);
+    }
+
+    /*!
+     A pool of fixed size blocks, which are allocated and freed in constant time
+     from a free list without calling the system allocator, for objects that are
+     created and destroyed individually and often, such as the nodes of linked
+     structures. Blocks are carved from 64 byte aligned regions of blocksPerRegion
+     blocks, and are aligned to the block size rounded up to a multiple of 16.
+
+     A BlockPool is not thread safe. It is movable but not copyable, and all its
+     memory is freed when it is destroyed.
+     */
+    class BlockPool {
+    public:
+        using size_type = std::size_t;
+
+        /*!
+         @throws std::invalid_argument if blockSize or blocksPerRegion is zero.
+         */
+        explicit BlockPool(size_type blockSize, size_type blocksPerRegion = 1024);
+
+        BlockPool(BlockPool&& other) noexcept;
+        BlockPool& operator=(BlockPool&& other) noexcept;
+        BlockPool(const BlockPool&) = delete;
+        BlockPool& operator=(const BlockPool&) = delete;
+        ~BlockPool() noexcept;
+
+        size_type blockSize() const noexcept { return _blockSize; }
+
+        /*!
+         @throws std::bad_alloc if the pool cannot grow.
+         */
+        void* allocate();
+
+        /*!
+         Return a block given by allocate() to the pool.
+         */
+        void deallocate(void* p) noexcept;
+
+    private:
+        std::vector<_private::MemoryRegion> _regions;
+        size_type                           _blockSize = 0;
+        size_type                           _blocksPerRegion = 0;
+        void*                               _free = nullptr;
+
+        void freeAll() noexcept;
+    };
+
+    /*!
+     A standard library allocator for single objects (such as the nodes of
+     std::list or std::map) taken from a BlockPool. The pool's block size must be
+     at least sizeof(T); requests for more than one object go to the heap.
+     */
+    template <class T>
+    class PoolAllocator {
+    public:
+        using value_type = T;
+
+        explicit PoolAllocator(BlockPool& p) noexcept : _p(&p) {}
+
+        template <class U>
+        PoolAllocator(const PoolAllocator<U>& other) noexcept : _p(other.pool()) {}
+
+        T* allocate(std::size_t n) {
+            if (n == 1 && sizeof(T) <= _p->blockSize()) {
+                return static_cast<T*>(_p->allocate());
+            }
+            return std::allocator<T>().allocate(n);
+        }
+
+        void deallocate(T* p, std::size_t n) noexcept {
+            if (n == 1 && sizeof(T) <= _p->blockSize()) {
+                _p->deallocate(p);
+            }
+            else {
+                std::allocator<T>().deallocate(p, n);
+            }
+        }
+
+        BlockPool* pool() const noexcept { return _p; }
+
+    private:
+        BlockPool* _p;
+    };
+
+    template <class T, class U>
+    bool operator==(const PoolAllocator<T>& a, const PoolAllocator<U>& b) noexcept {
+        return a.pool() == b.pool();
+    }
+
+    template <class T, class U>
+    bool operator!=(const PoolAllocator<T>& a, const PoolAllocator<U>& b) noexcept {
+        return !(a == b);
+    }
+
+    namespace _private {
+
+        // Scratch storage for n elements, taken from the workspace if there is one
+        // (and released when the buffer is destroyed, so buffers must be destroyed
+        // in the reverse order of their creation, as locals are), and from the
+        // heap otherwise.
+        template <class T>
+        class ScratchBuffer {
+        public:
+            ScratchBuffer(Workspace* w, std::size_t n) : _w(w), _size(n) {
+                if (_w) {
+                    _marker = _w->mark();
+                    _data = _w->allocate<T>(n);
+                }
+                else {
+                    _heap.reset(new T[n]);
+                    _data = _heap.get();
+                }
+            }
+
+            ScratchBuffer(Workspace* w, std::size_t n, const T& value) : ScratchBuffer(w, n) {
+                std::fill(_data, _data + n, value);
+            }
+
+            ScratchBuffer(Workspace* w, const T* first, const T* last) : ScratchBuffer(w, std::size_t(last - first)) {
+                std::copy(first, last, _data);
+            }
+
+            ~ScratchBuffer() noexcept {
+                if (_w) {
+                    _w->release(_marker);
+                }
+            }
+
+            ScratchBuffer(const ScratchBuffer&) = delete;
+            ScratchBuffer& operator=(const ScratchBuffer&) = delete;
+
+            std::size_t size() const noexcept { return _size; }
+            T* data() noexcept { return _data; }
+            const T* data() const noexcept { return _data; }
+            T* begin() noexcept { return _data; }
+            T* end() noexcept { return _data + _size; }
+            T& operator[](std::size_t i) noexcept { return _data[i]; }
+            const T& operator[](std::size_t i) const noexcept { return _data[i]; }
+
+        private:
+            Workspace*              _w;
+            Workspace::Marker       _marker;
+            std::unique_ptr<T[]>    _heap;
+            T*                      _data = nullptr;
+            std::size_t             _size;
+        };
+
+    }
+
+}}
+
+#endif
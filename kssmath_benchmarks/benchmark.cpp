@@ -0,0 +1,372 @@
+//
+//  benchmark.cpp
+//  kssmath_benchmarks
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+#include <regex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+#include <pthread.h>
+#include <unistd.h>
+#if defined(__APPLE__)
+#   include <sys/sysctl.h>
+#endif
+
+#include "kssmath/cpu_features.hpp"
+#include "kssmath/roofline.hpp"
+#include "kssmath/task_graph.hpp"
+
+#include "benchmark.hpp"
+
+using namespace std;
+using namespace kss::math;
+using namespace kss::math::benchmark;
+
+
+namespace {
+
+    using Clock = chrono::steady_clock;
+
+    vector<pair<string, Factory>>& registry() {
+        static vector<pair<string, Factory>> benchmarks;
+        return benchmarks;
+    }
+
+    double secondsSince(Clock::time_point start) {
+        return chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    void pinToCpu(int cpu) {
+#if defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        const int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (err != 0) {
+            throw system_error(err, system_category(), "pthread_setaffinity_np");
+        }
+#else
+        (void)cpu;
+        throw system_error(ENOTSUP, generic_category(), "pinning to a CPU is not supported on this system");
+#endif
+    }
+
+    double median(vector<double> v) {
+        sort(v.begin(), v.end());
+        const size_t n = v.size();
+        return (n % 2 == 1 ? v[n / 2] : (v[n / 2 - 1] + v[n / 2]) / 2);
+    }
+
+    Result measure(const string& name, const Case& c, const RunOptions& opts, const MachinePeak* peak) {
+        // Warm up, which also estimates the time of an iteration.
+        size_t warmupIterations = 0;
+        const auto warmupStart = Clock::now();
+        do {
+            c.run();
+            ++warmupIterations;
+        } while (secondsSince(warmupStart) < opts.warmupTime);
+        const double estimate = secondsSince(warmupStart) / double(warmupIterations);
+
+        Result r;
+        r.name = name;
+        r.repetitions = max(opts.repetitions, 1u);
+        r.iterations = max<size_t>(1, size_t(ceil(opts.minTime / max(estimate, 1e-9))));
+
+        vector<double> times;
+        times.reserve(r.repetitions);
+        for (size_t rep = 0; rep < r.repetitions; ++rep) {
+            const auto start = Clock::now();
+            for (size_t i = 0; i < r.iterations; ++i) {
+                c.run();
+            }
+            times.push_back(secondsSince(start) * 1e9 / double(r.iterations));
+        }
+
+        r.minimum = *min_element(times.begin(), times.end());
+        r.maximum = *max_element(times.begin(), times.end());
+        r.median = median(times);
+        double sum = 0;
+        for (double t : times) {
+            sum += t;
+        }
+        r.mean = sum / double(times.size());
+        double ss = 0;
+        for (double t : times) {
+            ss += (t - r.mean) * (t - r.mean);
+        }
+        r.standardDeviation = (times.size() > 1 ? sqrt(ss / double(times.size() - 1)) : 0.0);
+
+        if (r.median > 0) {
+            r.gflops = c.flops / r.median;
+            r.gbytesPerSecond = c.bytes / r.median;
+            r.nsPerElement = (c.elements > 0 ? r.median / c.elements : 0.0);
+        }
+        if (peak) {
+            r.roofline = rooflinePoint(*peak, c.flops, c.bytes, r.median * 1e-9);
+        }
+        return r;
+    }
+
+    string formatTime(double ns) {
+        ostringstream s;
+        s << fixed << setprecision(ns < 10 ? 2 : 1);
+        if (ns < 1e3) {
+            s << ns << " ns";
+        }
+        else if (ns < 1e6) {
+            s << ns / 1e3 << " us";
+        }
+        else if (ns < 1e9) {
+            s << ns / 1e6 << " ms";
+        }
+        else {
+            s << ns / 1e9 << " s";
+        }
+        return s.str();
+    }
+
+    // Rates that do not apply to a benchmark are left blank, keeping the
+    // columns aligned.
+    void printResult(ostream& out, const Result& r, bool roofline) {
+        out << left << setw(40) << r.name << right
+            << setw(12) << formatTime(r.median)
+            << setw(8) << fixed << setprecision(1) << (r.median > 0 ? 100 * r.standardDeviation / r.mean : 0.0) << "%";
+        if (r.gflops > 0) {
+            out << setw(10) << setprecision(2) << r.gflops << " GFLOP/s";
+        }
+        else {
+            out << setw(18) << "";
+        }
+        if (r.gbytesPerSecond > 0) {
+            out << setw(10) << setprecision(2) << r.gbytesPerSecond << " GB/s";
+        }
+        else {
+            out << setw(15) << "";
+        }
+        if (r.nsPerElement > 0) {
+            out << setw(12) << setprecision(3) << r.nsPerElement << " ns/elem";
+        }
+        else {
+            out << setw(20) << "";
+        }
+        if (roofline && r.roofline.bound != RooflineBound::Unknown) {
+            out << setw(8) << setprecision(1) << 100 * r.roofline.fraction << "% of roof ("
+                << rooflineBoundName(r.roofline.bound) << ")";
+        }
+        out << endl;
+    }
+
+    string jsonString(const string& s) {
+        string r = "\"";
+        for (char ch : s) {
+            switch (ch) {
+            case '"':   r += "\\\""; break;
+            case '\\':  r += "\\\\"; break;
+            case '\n':  r += "\\n"; break;
+            case '\t':  r += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(ch) < 0x20) {
+                    char buf[8];
+                    snprintf(buf, sizeof(buf), "\\u%04x", ch);
+                    r += buf;
+                }
+                else {
+                    r += ch;
+                }
+            }
+        }
+        return r + "\"";
+    }
+
+    // Rates that are not reported are written as null.
+    string jsonNumber(double v, bool nullIfZero = false) {
+        if ((nullIfZero && v == 0) || !isfinite(v)) {
+            return "null";
+        }
+        ostringstream s;
+        s << setprecision(10) << v;
+        return s.str();
+    }
+
+    string hostName() {
+        char buf[256] = {};
+        if (gethostname(buf, sizeof(buf) - 1) != 0) {
+            return "unknown";
+        }
+        return buf;
+    }
+
+    string cpuModel() {
+#if defined(__APPLE__)
+        char buf[256] = {};
+        size_t size = sizeof(buf) - 1;
+        if (sysctlbyname("machdep.cpu.brand_string", buf, &size, nullptr, 0) == 0) {
+            return buf;
+        }
+#else
+        ifstream in("/proc/cpuinfo");
+        string line;
+        while (getline(in, line)) {
+            if (line.compare(0, 10, "model name") == 0) {
+                const auto colon = line.find(':');
+                if (colon != string::npos) {
+                    return line.substr(line.find_first_not_of(' ', colon + 1));
+                }
+            }
+        }
+#endif
+        return "unknown";
+    }
+
+    string compilerVersion() {
+#if defined(__clang__)
+        return string("clang ") + __clang_version__;
+#elif defined(__GNUC__)
+        return string("gcc ") + __VERSION__;
+#else
+        return "unknown";
+#endif
+    }
+
+    string utcTimestamp() {
+        const time_t now = time(nullptr);
+        struct tm tm;
+        gmtime_r(&now, &tm);
+        char buf[32];
+        strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%SZ", &tm);
+        return buf;
+    }
+
+}
+
+
+void kss::math::benchmark::add(const string& name, Factory factory) {
+    auto& benchmarks = registry();
+    for (const auto& b : benchmarks) {
+        if (b.first == name) {
+            throw invalid_argument("benchmark " + name + " is already registered");
+        }
+    }
+    benchmarks.emplace_back(name, move(factory));
+}
+
+vector<string> kss::math::benchmark::names() {
+    vector<string> v;
+    for (const auto& b : registry()) {
+        v.push_back(b.first);
+    }
+    return v;
+}
+
+vector<Result> kss::math::benchmark::run(const Context& context, const RunOptions& opts, ostream& out,
+                                         const MachinePeak* peak)
+{
+    const regex filter(opts.filter);
+    if (opts.cpu >= 0) {
+        if (context.threads != 1) {
+            throw invalid_argument("pinning to a CPU requires a single thread");
+        }
+        pinToCpu(opts.cpu);
+    }
+
+    vector<Result> results;
+    for (const auto& b : registry()) {
+        if (!regex_search(b.first, filter)) {
+            continue;
+        }
+        const Case c = b.second(context);
+        results.push_back(measure(b.first, c, opts, peak));
+        printResult(out, results.back(), peak != nullptr);
+    }
+    return results;
+}
+
+void kss::math::benchmark::writeJson(ostream& out, const Context& context, const RunOptions& opts,
+                                     const vector<Result>& results, const MachinePeak* peak)
+{
+    const CpuFeatures& f = cpuFeatures();
+    out << "{\n";
+    out << "  \"format\": \"kssmath-benchmarks\",\n";
+    out << "  \"version\": 1,\n";
+    out << "  \"context\": {\n";
+    out << "    \"date\": " << jsonString(utcTimestamp()) << ",\n";
+    out << "    \"host\": " << jsonString(hostName()) << ",\n";
+    out << "    \"cpu\": " << jsonString(cpuModel()) << ",\n";
+    out << "    \"hardware_threads\": " << thread::hardware_concurrency() << ",\n";
+    out << "    \"cpu_features\": {"
+        << "\"sse42\": " << boolalpha << f.sse42
+        << ", \"avx\": " << f.avx
+        << ", \"avx2\": " << f.avx2
+        << ", \"fma\": " << f.fma
+        << ", \"avx512f\": " << f.avx512f
+        << ", \"neon\": " << f.neon << "},\n";
+    out << "    \"instruction_set\": " << jsonString(instructionSetName(activeInstructionSet())) << ",\n";
+    out << "    \"compiler\": " << jsonString(compilerVersion()) << ",\n";
+#if defined(NDEBUG)
+    out << "    \"assertions\": false,\n";
+#else
+    out << "    \"assertions\": true,\n";
+#endif
+    out << "    \"threads\": " << (context.threads == 0 ? defaultThreadCount() : context.threads) << ",\n";
+    out << "    \"seed\": " << context.seed << ",\n";
+    out << "    \"filter\": " << jsonString(opts.filter) << ",\n";
+    out << "    \"repetitions\": " << opts.repetitions << ",\n";
+    out << "    \"min_time\": " << jsonNumber(opts.minTime) << ",\n";
+    out << "    \"warmup_time\": " << jsonNumber(opts.warmupTime) << ",\n";
+    out << "    \"pinned_cpu\": " << (opts.cpu >= 0 ? to_string(opts.cpu) : string("null")) << ",\n";
+    if (peak) {
+        out << "    \"machine_peak\": {\"gflops\": " << jsonNumber(peak->gflops)
+            << ", \"gbytes_per_second\": " << jsonNumber(peak->gbytesPerSecond)
+            << ", \"ridge_intensity\": " << jsonNumber(peak->ridgeIntensity())
+            << ", \"threads\": " << peak->threads
+            << ", \"instruction_set\": " << jsonString(instructionSetName(peak->instructionSet)) << "}\n";
+    }
+    else {
+        out << "    \"machine_peak\": null\n";
+    }
+    out << "  },\n";
+    out << "  \"benchmarks\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        out << (i == 0 ? "\n" : ",\n");
+        out << "    {\"name\": " << jsonString(r.name)
+            << ", \"iterations\": " << r.iterations
+            << ", \"repetitions\": " << r.repetitions
+            << ", \"time_ns\": {\"min\": " << jsonNumber(r.minimum)
+            << ", \"median\": " << jsonNumber(r.median)
+            << ", \"mean\": " << jsonNumber(r.mean)
+            << ", \"max\": " << jsonNumber(r.maximum)
+            << ", \"stddev\": " << jsonNumber(r.standardDeviation) << "}"
+            << ", \"gflops\": " << jsonNumber(r.gflops, true)
+            << ", \"gbytes_per_second\": " << jsonNumber(r.gbytesPerSecond, true)
+            << ", \"ns_per_element\": " << jsonNumber(r.nsPerElement, true);
+        if (peak) {
+            const RooflinePoint& p = r.roofline;
+            out << ", \"roofline\": {\"intensity\": " << jsonNumber(p.intensity, true)
+                << ", \"attainable_gflops\": " << jsonNumber(p.attainableGflops, true)
+                << ", \"fraction\": " << jsonNumber(p.fraction, p.bound == RooflineBound::Unknown)
+                << ", \"bound\": " << jsonString(rooflineBoundName(p.bound)) << "}";
+        }
+        out << "}";
+    }
+    out << (results.empty() ? "]\n" : "\n  ]\n");
+    out << "}\n";
+}
@@ -0,0 +1,247 @@
+//
+//  benchmark.hpp
+//  kssmath_benchmarks
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#ifndef kssmath_benchmarks_benchmark_hpp
+#define kssmath_benchmarks_benchmark_hpp
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "kssmath/matrix.hpp"
+#include "kssmath/roofline.hpp"
+#include "kssmath/sparse_matrix.hpp"
+
+namespace kss { namespace math { namespace benchmark {
+
+    /*!
+     The settings that the benchmarks are set up with.
+     */
+    struct Context {
+        /*!
+         The threads passed to the kernels that take a threads option. The default
+         of 1 gives the most reproducible results; 0 uses defaultThreadCount().
+         */
+        unsigned        threads = 1;
+
+        /*!
+         The seed of the random data, so that every run measures the same inputs.
+         */
+        std::uint64_t   seed = 0x6b73736d617468ull;
+
+        /*!
+         A directory for the benchmarks that read and write files.
+         */
+        std::string     tempDirectory = "/tmp";
+    };
+
+    /*!
+     A benchmark ready to run: one iteration of the kernel, and the work done by
+     an iteration, from which the rates are reported. A zero amount of work
+     means that the corresponding rate is not reported.
+     */
+    struct Case {
+        std::function<void()>   run;
+        double                  flops = 0;      ///< Floating point operations per iteration.
+        double                  bytes = 0;      ///< Bytes of memory (or file) traffic per iteration.
+        double                  elements = 0;   ///< Elements processed per iteration.
+    };
+
+    /*!
+     Sets up the data of a benchmark and returns its case. This is only called
+     for the benchmarks that are selected, and the data lives as long as the
+     case (typically captured by run in a shared_ptr).
+     */
+    using Factory = std::function<Case(const Context&)>;
+
+    /*!
+     Add a benchmark. Names are paths such as "blas/dgemm/256", so that groups
+     can be selected with a regular expression.
+     @throws std::invalid_argument if the name is already registered.
+     */
+    void add(const std::string& name, Factory factory);
+
+    /*!
+     Returns the names of the registered benchmarks, in the order added.
+     */
+    std::vector<std::string> names();
+
+    /*!
+     Options of a run.
+     */
+    struct RunOptions {
+        /*!
+         Only the benchmarks whose names contain a match of this regular
+         expression (ECMAScript syntax) are run.
+         */
+        std::string filter;
+
+        /*!
+         The number of timed repetitions, over which the statistics are taken.
+         */
+        unsigned    repetitions = 10;
+
+        /*!
+         The minimum time, in seconds, of each repetition. A repetition runs the
+         kernel enough times to last this long, so that the timer resolution does
+         not matter.
+         */
+        double      minTime = 0.1;
+
+        /*!
+         The time, in seconds, that the kernel is run before the repetitions, to
+         bring the caches, page tables and clock frequency to a steady state. It
+         is always run at least once.
+         */
+        double      warmupTime = 0.2;
+
+        /*!
+         If not negative, the calling thread is pinned to this CPU for the whole
+         run, so that it does not migrate between cores (and caches) while being
+         measured. This is not supported on every system. It requires
+         Context::threads to be 1, since threads that the kernels start inherit
+         the pinning and would all share the one CPU.
+         */
+        int         cpu = -1;
+    };
+
+    /*!
+     The measurements of one benchmark. The times are of one iteration, in
+     nanoseconds; the rates are computed from the median time and are zero if
+     the benchmark does not report the amount of work they need.
+     */
+    struct Result {
+        std::string     name;
+        std::size_t     iterations = 0;     ///< Iterations per repetition.
+        std::size_t     repetitions = 0;
+        double          minimum = 0;
+        double          median = 0;
+        double          mean = 0;
+        double          maximum = 0;
+        double          standardDeviation = 0;
+        double          gflops = 0;
+        double          gbytesPerSecond = 0;
+        double          nsPerElement = 0;
+        RooflinePoint   roofline;           ///< Only set if the run was given the machine peak.
+    };
+
+    /*!
+     Run the selected benchmarks, printing a line of results to out as each
+     completes, and return the results. If the peak of the machine is given,
+     each result is also placed on the roofline (see roofline.hpp).
+     @throws std::regex_error if the filter is not a valid regular expression.
+     @throws std::invalid_argument if opts.cpu is set and context.threads is
+        not 1.
+     @throws std::system_error if the thread cannot be pinned to the CPU.
+     */
+    std::vector<Result> run(const Context& context, const RunOptions& opts, std::ostream& out,
+                            const MachinePeak* peak = nullptr);
+
+    /*!
+     Write a report of the results as JSON, including a description of the
+     machine and the build, so that runs can be compared, and the roofline
+     placement of the results if the peak of the machine is given.
+     */
+    void writeJson(std::ostream& out, const Context& context, const RunOptions& opts,
+                   const std::vector<Result>& results, const MachinePeak* peak = nullptr);
+
+    /*!
+     Keeps the compiler from optimizing away the computation of value (such as
+     the result of a kernel that is otherwise unused).
+     */
+    template <class T>
+    inline void doNotOptimize(const T& value) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+        __asm__ volatile("" : : "g"(&value) : "memory");
+#else
+        static volatile const void* sink;
+        sink = &value;
+#endif
+    }
+
+    /*!
+     Random inputs, uniform in [-1, 1). These are generated from the raw output
+     of std::mt19937_64 (whose sequence is fixed by the standard, unlike those of
+     the standard distributions), so they are the same on every platform.
+     */
+    template <class T>
+    std::vector<T> randomVector(std::size_t n, std::uint64_t seed) {
+        std::mt19937_64 g(seed);
+        std::vector<T> v(n);
+        for (auto& x : v) {
+            x = T(double(g() >> 11) / 4503599627370496.0 - 1.0);
+        }
+        return v;
+    }
+
+    template <class T>
+    Matrix<T> randomMatrix(std::size_t rows, std::size_t cols, std::uint64_t seed) {
+        Matrix<T> a(rows, cols);
+        const auto v = randomVector<T>(rows * cols, seed);
+        std::copy(v.begin(), v.end(), a.data());
+        return a;
+    }
+
+    /*!
+     Returns a random symmetric matrix with n added to its diagonal, which makes
+     it positive definite.
+     */
+    template <class T>
+    Matrix<T> randomSpdMatrix(std::size_t n, std::uint64_t seed) {
+        Matrix<T> a = randomMatrix<T>(n, n, seed);
+        for (std::size_t j = 0; j < n; ++j) {
+            for (std::size_t i = j; i < n; ++i) {
+                a(j, i) = a(i, j) = (i == j ? std::abs(a(i, j)) + T(n) : a(i, j));
+            }
+        }
+        return a;
+    }
+
+    /*!
+     Returns the 5 point finite difference Laplacian on a k x k grid, the
+     standard symmetric positive definite sparse test matrix.
+     */
+    template <class T>
+    SparseMatrix<T> laplacian2d(std::size_t k) {
+        const std::size_t n = k * k;
+        std::vector<std::size_t> ptr(1, 0), idx;
+        std::vector<T> val;
+        idx.reserve(5 * n);
+        val.reserve(5 * n);
+        for (std::size_t r = 0; r < n; ++r) {
+            const std::size_t i = r % k, j = r / k;
+            auto entry = [&](std::size_t c, T v) { idx.push_back(c); val.push_back(v); };
+            if (j > 0) { entry(r - k, T(-1)); }
+            if (i > 0) { entry(r - 1, T(-1)); }
+            entry(r, T(4));
+            if (i + 1 < k) { entry(r + 1, T(-1)); }
+            if (j + 1 < k) { entry(r + k, T(-1)); }
+            ptr.push_back(idx.size());
+        }
+        return SparseMatrix<T>(n, n, std::move(ptr), std::move(idx), std::move(val));
+    }
+
+    /*!
+     The benchmarks of each part of the library, which are added by main.
+     */
+    void addBlasBenchmarks();
+    void addDenseBenchmarks();
+    void addSparseBenchmarks();
+    void addSystemBenchmarks();
+
+}}}
+
+#endif
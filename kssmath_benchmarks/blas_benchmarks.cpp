@@ -0,0 +1,222 @@
+//
+//  blas_benchmarks.cpp
+//  kssmath_benchmarks
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "kssmath/blas.hpp"
+
+#include "benchmark.hpp"
+
+using namespace std;
+using namespace kss::math;
+using namespace kss::math::benchmark;
+using kss::math::blas::Op;
+
+
+namespace {
+
+    template <class T> const char* prefix();
+    template <> const char* prefix<float>() { return "s"; }
+    template <> const char* prefix<double>() { return "d"; }
+
+    template <class T>
+    string name(const char* kernel, size_t n) {
+        return string("blas/") + prefix<T>() + kernel + "/" + to_string(n);
+    }
+
+    // The level 1 kernels, on vectors of n elements.
+    template <class T>
+    void addLevel1(size_t n) {
+        const double sz = sizeof(T);
+
+        add(name<T>("dot", n), [n, sz](const Context& ctx) {
+            auto x = make_shared<vector<T>>(randomVector<T>(n, ctx.seed));
+            auto y = make_shared<vector<T>>(randomVector<T>(n, ctx.seed + 1));
+            Case c;
+            c.run = [=] { doNotOptimize(blas::dot(n, x->data(), y->data())); };
+            c.flops = 2.0 * n;
+            c.bytes = 2 * n * sz;
+            c.elements = n;
+            return c;
+        });
+
+        add(name<T>("axpy", n), [n, sz](const Context& ctx) {
+            auto x = make_shared<vector<T>>(randomVector<T>(n, ctx.seed));
+            auto y = make_shared<vector<T>>(randomVector<T>(n, ctx.seed + 1));
+            Case c;
+            // Alternate the sign of alpha so that y does not grow without bound.
+            auto alpha = make_shared<T>(T(1e-3));
+            c.run = [=] {
+                *alpha = -*alpha;
+                blas::axpy(n, *alpha, x->data(), y->data());
+            };
+            c.flops = 2.0 * n;
+            c.bytes = 3 * n * sz;
+            c.elements = n;
+            return c;
+        });
+
+        add(name<T>("scal", n), [n, sz](const Context& ctx) {
+            auto x = make_shared<vector<T>>(randomVector<T>(n, ctx.seed));
+            auto alpha = make_shared<T>(T(2));
+            Case c;
+            c.run = [=] {
+                *alpha = T(1) / *alpha;
+                blas::scal(n, *alpha, x->data());
+            };
+            c.flops = n;
+            c.bytes = 2 * n * sz;
+            c.elements = n;
+            return c;
+        });
+
+        add(name<T>("nrm2", n), [n, sz](const Context& ctx) {
+            auto x = make_shared<vector<T>>(randomVector<T>(n, ctx.seed));
+            Case c;
+            c.run = [=] { doNotOptimize(blas::nrm2(n, x->data())); };
+            c.flops = 3.0 * n;
+            c.bytes = 2 * n * sz;
+            c.elements = n;
+            return c;
+        });
+    }
+
+    // The level 2 kernels, on n x n matrices.
+    template <class T>
+    void addLevel2(size_t n) {
+        const double sz = sizeof(T);
+
+        add(name<T>("gemv", n), [n, sz](const Context& ctx) {
+            auto a = make_shared<Matrix<T>>(randomMatrix<T>(n, n, ctx.seed));
+            auto x = make_shared<vector<T>>(randomVector<T>(n, ctx.seed + 1));
+            auto y = make_shared<vector<T>>(n);
+            Case c;
+            c.run = [=] { blas::gemv(n, n, T(1), a->data(), n, x->data(), T(0), y->data()); };
+            c.flops = 2.0 * n * n;
+            c.bytes = (double(n) * n + 2 * n) * sz;
+            c.elements = double(n) * n;
+            return c;
+        });
+
+        add(name<T>("gemvTranspose", n), [n, sz](const Context& ctx) {
+            auto a = make_shared<Matrix<T>>(randomMatrix<T>(n, n, ctx.seed));
+            auto x = make_shared<vector<T>>(randomVector<T>(n, ctx.seed + 1));
+            auto y = make_shared<vector<T>>(n);
+            Case c;
+            c.run = [=] { blas::gemvTranspose(n, n, T(1), a->data(), n, x->data(), T(0), y->data()); };
+            c.flops = 2.0 * n * n;
+            c.bytes = (double(n) * n + 2 * n) * sz;
+            c.elements = double(n) * n;
+            return c;
+        });
+
+        add(name<T>("symvLower", n), [n, sz](const Context& ctx) {
+            auto a = make_shared<Matrix<T>>(randomSpdMatrix<T>(n, ctx.seed));
+            auto x = make_shared<vector<T>>(randomVector<T>(n, ctx.seed + 1));
+            auto y = make_shared<vector<T>>(n);
+            Case c;
+            c.run = [=] { blas::symvLower(n, T(1), a->data(), n, x->data(), T(0), y->data()); };
+            c.flops = 2.0 * n * n;
+            c.bytes = (double(n) * n / 2 + 2 * n) * sz;
+            c.elements = double(n) * n / 2;
+            return c;
+        });
+
+        add(name<T>("trsvLower", n), [n, sz](const Context& ctx) {
+            auto l = make_shared<Matrix<T>>(randomSpdMatrix<T>(n, ctx.seed));
+            auto b = make_shared<vector<T>>(randomVector<T>(n, ctx.seed + 1));
+            auto x = make_shared<vector<T>>(n);
+            Case c;
+            c.run = [=] {
+                *x = *b;
+                blas::trsvLower(Op::NoTrans, n, l->data(), n, x->data());
+            };
+            c.flops = double(n) * n;
+            c.bytes = (double(n) * n / 2 + 2 * n) * sz;
+            c.elements = double(n) * n / 2;
+            return c;
+        });
+    }
+
+    // The level 3 kernels, on n x n matrices.
+    template <class T>
+    void addLevel3(size_t n) {
+        const double sz = sizeof(T);
+
+        for (Op opA : { Op::NoTrans, Op::Trans }) {
+            const string suffix = (opA == Op::NoTrans ? "NN" : "TN");
+            add(name<T>(("gemm" + suffix).c_str(), n), [n, sz, opA](const Context& ctx) {
+                auto a = make_shared<Matrix<T>>(randomMatrix<T>(n, n, ctx.seed));
+                auto b = make_shared<Matrix<T>>(randomMatrix<T>(n, n, ctx.seed + 1));
+                auto cm = make_shared<Matrix<T>>(n, n);
+                Case c;
+                c.run = [=] {
+                    blas::gemm(opA, Op::NoTrans, n, n, n, T(1), a->data(), n, b->data(), n, T(0), cm->data(), n);
+                };
+                c.flops = 2.0 * n * n * n;
+                c.bytes = 3.0 * n * n * sz;
+                c.elements = double(n) * n;
+                return c;
+            });
+        }
+
+        add(name<T>("syrkLower", n), [n, sz](const Context& ctx) {
+            auto a = make_shared<Matrix<T>>(randomMatrix<T>(n, n, ctx.seed));
+            auto cm = make_shared<Matrix<T>>(n, n);
+            Case c;
+            c.run = [=] { blas::syrkLower(n, n, T(1), a->data(), n, T(0), cm->data(), n); };
+            c.flops = double(n) * n * n;
+            c.bytes = 1.5 * n * n * sz;
+            c.elements = double(n) * n / 2;
+            return c;
+        });
+
+        add(name<T>("syr2kLower", n), [n, sz](const Context& ctx) {
+            auto a = make_shared<Matrix<T>>(randomMatrix<T>(n, n, ctx.seed));
+            auto b = make_shared<Matrix<T>>(randomMatrix<T>(n, n, ctx.seed + 1));
+            auto cm = make_shared<Matrix<T>>(n, n);
+            Case c;
+            c.run = [=] { blas::syr2kLower(n, n, T(1), a->data(), n, b->data(), n, cm->data(), n, 0, n); };
+            c.flops = 2.0 * n * n * n;
+            c.bytes = 2.5 * n * n * sz;
+            c.elements = double(n) * n / 2;
+            return c;
+        });
+
+        add(name<T>("trsmLeftLower", n), [n, sz](const Context& ctx) {
+            auto l = make_shared<Matrix<T>>(randomSpdMatrix<T>(n, ctx.seed));
+            auto b = make_shared<Matrix<T>>(randomMatrix<T>(n, n, ctx.seed + 1));
+            auto x = make_shared<Matrix<T>>(n, n);
+            Case c;
+            c.run = [=] {
+                *x = *b;
+                blas::trsmLeftLower(n, n, l->data(), n, x->data(), n);
+            };
+            c.flops = double(n) * n * n;
+            c.bytes = 2.5 * n * n * sz;
+            c.elements = double(n) * n;
+            return c;
+        });
+    }
+
+}
+
+
+void kss::math::benchmark::addBlasBenchmarks() {
+    addLevel1<double>(4096);
+    addLevel1<double>(size_t(1) << 22);
+    addLevel1<float>(4096);
+    addLevel1<float>(size_t(1) << 22);
+    addLevel2<double>(1024);
+    addLevel2<float>(1024);
+    addLevel3<double>(256);
+    addLevel3<float>(256);
+}
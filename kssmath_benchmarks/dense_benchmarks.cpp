@@ -0,0 +1,170 @@
+//
+//  dense_benchmarks.cpp
+//  kssmath_benchmarks
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "kssmath/cholesky.hpp"
+#include "kssmath/ldlt.hpp"
+#include "kssmath/least_squares.hpp"
+#include "kssmath/lu.hpp"
+#include "kssmath/mixed_precision.hpp"
+#include "kssmath/qr.hpp"
+#include "kssmath/svd.hpp"
+#include "kssmath/symmetric_eigen.hpp"
+
+#include "benchmark.hpp"
+
+using namespace std;
+using namespace kss::math;
+using namespace kss::math::benchmark;
+
+
+namespace {
+
+    string name(const char* algorithm, size_t n) {
+        return string("dense/") + algorithm + "/" + to_string(n);
+    }
+
+    BlockingOptions blocking(const Context& ctx) {
+        BlockingOptions opts;
+        opts.threads = ctx.threads;
+        return opts;
+    }
+
+    // A factorization of an n x n matrix, copied each iteration since the
+    // factorizations take their matrix by value. The copy is O(n^2) against
+    // the O(n^3) of the factorization.
+    template <class Factor>
+    void addFactorization(const char* algorithm, size_t n, double flops, bool spd) {
+        add(name(algorithm, n), [n, flops, spd](const Context& ctx) {
+            auto a = make_shared<Matrix<double>>(spd ? randomSpdMatrix<double>(n, ctx.seed)
+                                                     : randomMatrix<double>(n, n, ctx.seed));
+            Case c;
+            c.run = [a, ctx] { doNotOptimize(Factor::factor(*a, ctx)); };
+            c.flops = flops;
+            c.bytes = (flops > 0 ? double(n) * n * sizeof(double) : 0.0);
+            c.elements = double(n) * n;
+            return c;
+        });
+    }
+
+    struct CholeskyFactor {
+        static Cholesky<double> factor(const Matrix<double>& a, const Context& ctx) {
+            return Cholesky<double>(a, blocking(ctx));
+        }
+    };
+
+    struct LDLTFactor {
+        static LDLT<double> factor(const Matrix<double>& a, const Context& ctx) {
+            return LDLT<double>(a, blocking(ctx));
+        }
+    };
+
+    struct LUFactor {
+        static LU<double> factor(const Matrix<double>& a, const Context&) {
+            return LU<double>(a);
+        }
+    };
+
+    struct QRFactor {
+        static QR<double> factor(const Matrix<double>& a, const Context& ctx) {
+            return QR<double>(a, blocking(ctx));
+        }
+    };
+
+    struct PivotedQRFactor {
+        static PivotedQR<double> factor(const Matrix<double>& a, const Context&) {
+            return PivotedQR<double>(a);
+        }
+    };
+
+    struct SVDFactor {
+        static SVD<double> factor(const Matrix<double>& a, const Context& ctx) {
+            SVDOptions opts;
+            opts.blocking = blocking(ctx);
+            return SVD<double>(a, opts);
+        }
+    };
+
+    struct SymmetricEigenFactor {
+        static SymmetricEigen<double> factor(const Matrix<double>& a, const Context& ctx) {
+            SymmetricEigenOptions opts;
+            opts.blocking = blocking(ctx);
+            return SymmetricEigen<double>(a, opts);
+        }
+    };
+
+}
+
+
+void kss::math::benchmark::addDenseBenchmarks() {
+    const size_t n = 512;
+    const double n3 = double(n) * n * n;
+    addFactorization<CholeskyFactor>("cholesky", n, n3 / 3, true);
+    addFactorization<LDLTFactor>("ldlt", n, n3 / 3, true);
+    addFactorization<LUFactor>("lu", n, 2 * n3 / 3, false);
+    addFactorization<QRFactor>("qr", n, 4 * n3 / 3, false);
+    addFactorization<PivotedQRFactor>("pivotedQR", n, 4 * n3 / 3, false);
+
+    // The flop counts (and passes over the matrix) of the iterative parts of
+    // these depend on the matrix, so only the times are reported.
+    const size_t m = 256;
+    addFactorization<SVDFactor>("svd", m, 0, false);
+    addFactorization<SymmetricEigenFactor>("symmetricEigen", m, 0, true);
+
+    add("dense/randomizedSVD/1024x512/rank16", [](const Context& ctx) {
+        auto a = make_shared<Matrix<double>>(randomMatrix<double>(1024, 512, ctx.seed));
+        RandomizedSVDOptions opts;
+        opts.blocking = blocking(ctx);
+        Case c;
+        c.run = [a, opts] { doNotOptimize(SVD<double>::randomized(*a, 16, opts)); };
+        c.elements = 1024.0 * 512;
+        return c;
+    });
+
+    add(name("choleskySolve", n), [n](const Context& ctx) {
+        auto f = make_shared<Cholesky<double>>(randomSpdMatrix<double>(n, ctx.seed), blocking(ctx));
+        auto b = make_shared<vector<double>>(randomVector<double>(n, ctx.seed + 1));
+        auto x = make_shared<vector<double>>(n);
+        Case c;
+        c.run = [=] {
+            *x = *b;
+            f->solveInPlace(x->data());
+        };
+        c.flops = 2.0 * n * n;
+        c.bytes = double(n) * n * sizeof(double);
+        c.elements = n;
+        return c;
+    });
+
+    add(name("mixedPrecisionSolve", n), [n](const Context& ctx) {
+        auto a = make_shared<Matrix<double>>(randomSpdMatrix<double>(n, ctx.seed));
+        auto b = make_shared<vector<double>>(randomVector<double>(n, ctx.seed + 1));
+        Case c;
+        c.run = [a, b] { doNotOptimize(solveMixedPrecision<float, double>(*a, *b)); };
+        c.flops = 2.0 * n * n * n / 3;
+        c.elements = double(n) * n;
+        return c;
+    });
+
+    add("dense/lstsq/4096x256", [](const Context& ctx) {
+        auto a = make_shared<Matrix<double>>(randomMatrix<double>(4096, 256, ctx.seed));
+        auto b = make_shared<vector<double>>(randomVector<double>(4096, ctx.seed + 1));
+        LeastSquaresOptions opts;
+        opts.blocking = blocking(ctx);
+        Case c;
+        c.run = [a, b, opts] { doNotOptimize(lstsq(*a, *b, opts)); };
+        c.flops = 2.0 * 4096 * 256 * 256 - 2.0 * 256 * 256 * 256 / 3;
+        c.bytes = 4096.0 * 256 * sizeof(double);
+        c.elements = 4096.0 * 256;
+        return c;
+    });
+}
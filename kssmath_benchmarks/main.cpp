@@ -0,0 +1,235 @@
+//
+//  main.cpp
+//  kssmath_benchmarks
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <system_error>
+
+#include "kssmath/cpu_features.hpp"
+#include "kssmath/roofline.hpp"
+#include "kssmath/tuning.hpp"
+
+#include "benchmark.hpp"
+
+using namespace std;
+using namespace kss::math;
+using namespace kss::math::benchmark;
+
+
+namespace {
+
+    const char* usage =
+    "usage: kssmath_benchmarks [options]\n"
+    "\n"
+    "Runs the kssmath benchmarks, printing a line per benchmark with the median\n"
+    "time of an iteration, its relative standard deviation and the rates.\n"
+    "\n"
+    "options:\n"
+    "  --filter=REGEX       run only the benchmarks whose names match REGEX\n"
+    "  --list               list the benchmarks and exit\n"
+    "  --json=FILE          also write the results as JSON to FILE\n"
+    "  --repetitions=N      timed repetitions per benchmark (default 10)\n"
+    "  --min-time=SECONDS   minimum time of a repetition (default 0.1)\n"
+    "  --warmup=SECONDS     time to run before measuring (default 0.2)\n"
+    "  --cpu=N              pin the benchmark thread to CPU N (only with\n"
+    "                       --threads=1)\n"
+    "  --threads=N          threads used by the kernels (default 1, 0 for all)\n"
+    "  --seed=N             seed of the random inputs\n"
+    "  --isa=NAME           use the kernels for an instruction set (generic,\n"
+    "                       avx2 or avx512) instead of the best supported one\n"
+    "  --temp=DIRECTORY     directory for the I/O benchmarks (default /tmp)\n"
+    "  --roofline           measure the peak FLOP/s and memory bandwidth first,\n"
+    "                       and report each benchmark's fraction of the roofline\n"
+    "  --autotune           tune the kernel parameters for this machine, write\n"
+    "                       them to the tuning file and exit\n"
+    "  --tuning-file=FILE   the tuning file to write (default $KSSMATH_TUNING_FILE\n"
+    "                       or kssmath/tuning.conf in the user's cache directory)\n";
+
+    // Returns the value of an option of the form --name=value, or nullptr if arg
+    // is not that option.
+    const char* optionValue(const char* arg, const char* name) {
+        const size_t len = strlen(name);
+        if (strncmp(arg, name, len) == 0 && arg[len] == '=') {
+            return arg + len + 1;
+        }
+        return nullptr;
+    }
+
+    unsigned long long parseNumber(const char* name, const char* value) {
+        errno = 0;
+        char* end = nullptr;
+        const unsigned long long v = strtoull(value, &end, 0);
+        if (errno != 0 || end == value || *end != '\0') {
+            throw invalid_argument(string(name) + ": not a number: " + value);
+        }
+        return v;
+    }
+
+    double parseSeconds(const char* name, const char* value) {
+        errno = 0;
+        char* end = nullptr;
+        const double v = strtod(value, &end);
+        if (errno != 0 || end == value || *end != '\0' || v < 0) {
+            throw invalid_argument(string(name) + ": not a time: " + value);
+        }
+        return v;
+    }
+
+    InstructionSet parseInstructionSet(const char* value) {
+        for (auto isa : { InstructionSet::Generic, InstructionSet::AVX2, InstructionSet::AVX512 }) {
+            if (strcmp(value, instructionSetName(isa)) == 0) {
+                return isa;
+            }
+        }
+        throw invalid_argument(string("--isa: unknown instruction set: ") + value);
+    }
+
+}
+
+
+int main(int argc, const char* argv[]) {
+    addBlasBenchmarks();
+    addDenseBenchmarks();
+    addSparseBenchmarks();
+    addSystemBenchmarks();
+
+    try {
+        Context context;
+        RunOptions opts;
+        string jsonPath;
+        bool list = false;
+        bool roofline = false;
+        bool tune = false;
+        string tuningPath;
+
+        for (int i = 1; i < argc; ++i) {
+            const char* arg = argv[i];
+            const char* v = nullptr;
+            if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0) {
+                cout << usage;
+                return 0;
+            }
+            else if (strcmp(arg, "--list") == 0) {
+                list = true;
+            }
+            else if (strcmp(arg, "--roofline") == 0) {
+                roofline = true;
+            }
+            else if (strcmp(arg, "--autotune") == 0) {
+                tune = true;
+            }
+            else if ((v = optionValue(arg, "--tuning-file"))) {
+                tuningPath = v;
+            }
+            else if ((v = optionValue(arg, "--filter"))) {
+                opts.filter = v;
+            }
+            else if ((v = optionValue(arg, "--json"))) {
+                jsonPath = v;
+            }
+            else if ((v = optionValue(arg, "--repetitions"))) {
+                opts.repetitions = unsigned(parseNumber("--repetitions", v));
+            }
+            else if ((v = optionValue(arg, "--min-time"))) {
+                opts.minTime = parseSeconds("--min-time", v);
+            }
+            else if ((v = optionValue(arg, "--warmup"))) {
+                opts.warmupTime = parseSeconds("--warmup", v);
+            }
+            else if ((v = optionValue(arg, "--cpu"))) {
+                opts.cpu = int(parseNumber("--cpu", v));
+            }
+            else if ((v = optionValue(arg, "--threads"))) {
+                context.threads = unsigned(parseNumber("--threads", v));
+            }
+            else if ((v = optionValue(arg, "--seed"))) {
+                context.seed = parseNumber("--seed", v);
+            }
+            else if ((v = optionValue(arg, "--isa"))) {
+                selectInstructionSet(parseInstructionSet(v));
+            }
+            else if ((v = optionValue(arg, "--temp"))) {
+                context.tempDirectory = v;
+            }
+            else {
+                cerr << "kssmath_benchmarks: unknown option " << arg << "\n\n" << usage;
+                return 2;
+            }
+        }
+
+        if (opts.cpu >= 0 && context.threads != 1) {
+            cerr << "kssmath_benchmarks: --cpu requires --threads=1\n\n" << usage;
+            return 2;
+        }
+
+        if (list) {
+            for (const auto& name : names()) {
+                cout << name << endl;
+            }
+            return 0;
+        }
+
+        // Autotuning tries up to all the hardware threads, whatever --threads says,
+        // since the thread count is one of the parameters it tunes.
+        if (tune) {
+            if (tuningPath.empty()) {
+                tuningPath = tuningFilePath();
+            }
+            cout << "tuning kssmath for " << machineName() << endl;
+            AutotuneOptions tuneOpts;
+            tuneOpts.log = &cout;
+            writeTuningFile(tuningPath, autotune(tuneOpts));
+            cout << "wrote " << tuningPath << endl;
+            return 0;
+        }
+
+        // Open the report first, so that a bad path is found before the run.
+        ofstream json;
+        if (!jsonPath.empty()) {
+            json.open(jsonPath);
+            if (!json) {
+                throw system_error(errno, generic_category(), "cannot open " + jsonPath);
+            }
+        }
+
+        cout << "kssmath benchmarks, " << instructionSetName(activeInstructionSet()) << " kernels" << endl;
+
+        // The peak is measured on the threads the kernels are given.
+        unique_ptr<MachinePeak> peak;
+        if (roofline) {
+            RooflineOptions rooflineOpts;
+            rooflineOpts.threads = context.threads;
+            peak.reset(new MachinePeak(measureMachinePeak(rooflineOpts)));
+            cout << fixed << setprecision(2) << "peak " << peak->gflops << " GFLOP/s, "
+                 << peak->gbytesPerSecond << " GB/s (triad), ridge at " << peak->ridgeIntensity()
+                 << " flop/byte" << endl;
+        }
+
+        const auto results = run(context, opts, cout, peak.get());
+        if (json.is_open()) {
+            writeJson(json, context, opts, results, peak.get());
+            json.close();
+            if (!json) {
+                throw system_error(errno, generic_category(), "cannot write " + jsonPath);
+            }
+        }
+    }
+    catch (const exception& e) {
+        cerr << "kssmath_benchmarks: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,246 @@
+//
+//  sparse_benchmarks.cpp
+//  kssmath_benchmarks
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "kssmath/amg.hpp"
+#include "kssmath/block_sparse_matrix.hpp"
+#include "kssmath/conjugate_gradient.hpp"
+#include "kssmath/krylov_eigen.hpp"
+#include "kssmath/sliced_ell_matrix.hpp"
+#include "kssmath/sparse_direct.hpp"
+#include "kssmath/sparse_ordering.hpp"
+#include "kssmath/sparse_product.hpp"
+#include "kssmath/sparse_symbolic.hpp"
+#include "kssmath/tuned_sparse_matrix.hpp"
+
+#include "benchmark.hpp"
+
+using namespace std;
+using namespace kss::math;
+using namespace kss::math::benchmark;
+
+
+namespace {
+
+    string name(const char* algorithm, size_t k) {
+        return string("sparse/") + algorithm + "/laplacian" + to_string(k);
+    }
+
+    // A sparse matrix-vector product with the matrix in the given format. The
+    // traffic is that of the stored matrix (as given by matrixBytes) and of the
+    // vectors.
+    template <class Format>
+    void addProduct(const char* format, size_t k, Format (*convert)(const SparseMatrix<double>&),
+                    double (*matrixBytes)(const Format&))
+    {
+        add(name(format, k), [=](const Context& ctx) {
+            const SparseMatrix<double> csr = laplacian2d<double>(k);
+            auto a = make_shared<Format>(convert(csr));
+            auto x = make_shared<vector<double>>(randomVector<double>(csr.cols(), ctx.seed));
+            auto y = make_shared<vector<double>>(csr.rows());
+            const unsigned threads = ctx.threads;
+            Case c;
+            c.run = [a, x, y, threads] { a->multiply(x->data(), y->data(), threads); };
+            c.flops = 2.0 * csr.nonZeros();
+            c.bytes = matrixBytes(*a) + 2.0 * csr.rows() * sizeof(double);
+            c.elements = csr.nonZeros();
+            return c;
+        });
+    }
+
+    SparseMatrix<double> asCsr(const SparseMatrix<double>& a) { return a; }
+    SlicedEllMatrix<double> asSlicedEll(const SparseMatrix<double>& a) { return SlicedEllMatrix<double>(a); }
+    BlockSparseMatrix<double> asBlockCsr(const SparseMatrix<double>& a) { return BlockSparseMatrix<double>(a, 2, 2); }
+    TunedSparseMatrix<double> asTuned(const SparseMatrix<double>& a) { return TunedSparseMatrix<double>(a); }
+
+    double csrBytes(const SparseMatrix<double>& a) {
+        return double(a.nonZeros()) * (sizeof(double) + sizeof(size_t)) + double(a.rows() + 1) * sizeof(size_t);
+    }
+
+    double slicedEllBytes(const SlicedEllMatrix<double>& a) {
+        return double(a.storedEntries()) * (sizeof(double) + sizeof(uint32_t)) + double(a.rows()) * sizeof(size_t);
+    }
+
+    double blockCsrBytes(const BlockSparseMatrix<double>& a) {
+        return double(a.storedEntries()) * sizeof(double) + double(a.blocks() + a.rows() / a.blockRows() + 1) * sizeof(uint32_t);
+    }
+
+    // The tuned matrix does not expose its storage, so this is estimated from
+    // the statistics the format was chosen by.
+    double tunedBytes(const TunedSparseMatrix<double>& a) {
+        const auto& st = a.statistics();
+        const double nnz = st.meanRowLength * double(a.rows());
+        switch (a.format()) {
+        case SparseFormat::SlicedEll:
+            return nnz * st.slicedEllFill * (sizeof(double) + sizeof(uint32_t));
+        case SparseFormat::BlockCSR:
+            return nnz * st.blockFill * sizeof(double);
+        default:
+            return nnz * (sizeof(double) + sizeof(size_t));
+        }
+    }
+
+    // The number of multiplications in the product a*b.
+    double productMultiplications(const SparseMatrix<double>& a, const SparseMatrix<double>& b) {
+        const auto& ap = a.rowPointers();
+        const auto& ai = a.columnIndices();
+        const auto& bp = b.rowPointers();
+        double n = 0;
+        for (size_t p = 0; p < ap.back(); ++p) {
+            n += double(bp[ai[p] + 1] - bp[ai[p]]);
+        }
+        return n;
+    }
+
+}
+
+
+void kss::math::benchmark::addSparseBenchmarks() {
+    const size_t k = 512;
+    addProduct<SparseMatrix<double>>("spmvCsr", k, asCsr, csrBytes);
+    addProduct<SlicedEllMatrix<double>>("spmvSlicedEll", k, asSlicedEll, slicedEllBytes);
+    addProduct<BlockSparseMatrix<double>>("spmvBlockCsr", k, asBlockCsr, blockCsrBytes);
+    addProduct<TunedSparseMatrix<double>>("spmvTuned", k, asTuned, tunedBytes);
+
+    const size_t m = 256;
+    add(name("product", m), [m](const Context& ctx) {
+        auto a = make_shared<SparseMatrix<double>>(laplacian2d<double>(m));
+        SparseProductOptions opts;
+        opts.threads = ctx.threads;
+        Case c;
+        c.run = [a, opts] { doNotOptimize(sparseProduct(*a, *a, opts)); };
+        c.flops = 2 * productMultiplications(*a, *a);
+        c.elements = double(a->nonZeros());
+        return c;
+    });
+
+    add(name("minimumDegree", m), [m](const Context&) {
+        auto a = make_shared<SparseMatrix<double>>(laplacian2d<double>(m));
+        Case c;
+        c.run = [a] { doNotOptimize(fillReducingOrdering(*a, SparseOrdering::MinimumDegree)); };
+        c.elements = double(a->rows());
+        return c;
+    });
+
+    add(name("nestedDissection", m), [m](const Context&) {
+        auto a = make_shared<SparseMatrix<double>>(laplacian2d<double>(m));
+        Case c;
+        c.run = [a] { doNotOptimize(fillReducingOrdering(*a, SparseOrdering::NestedDissection)); };
+        c.elements = double(a->rows());
+        return c;
+    });
+
+    add(name("symbolic", m), [m](const Context&) {
+        auto a = make_shared<SparseMatrix<double>>(laplacian2d<double>(m));
+        Case c;
+        c.run = [a] { doNotOptimize(SparseSymbolic(*a, SparseOrdering::NestedDissection)); };
+        c.elements = double(a->rows());
+        return c;
+    });
+
+    // The numeric factorizations reuse one symbolic analysis, as an application
+    // refactoring matrices of a fixed pattern would.
+    add(name("sparseCholesky", m), [m](const Context& ctx) {
+        auto a = make_shared<SparseMatrix<double>>(laplacian2d<double>(m));
+        auto symbolic = make_shared<const SparseSymbolic>(*a, SparseOrdering::NestedDissection);
+        const unsigned threads = ctx.threads;
+        Case c;
+        c.run = [a, symbolic, threads] { doNotOptimize(SparseCholesky<double>(symbolic, *a, threads)); };
+        c.elements = double(a->rows());
+        return c;
+    });
+
+    add(name("sparseCholeskySolve", m), [m](const Context& ctx) {
+        const SparseMatrix<double> a = laplacian2d<double>(m);
+        auto f = make_shared<SparseCholesky<double>>(a, SparseOrdering::NestedDissection, ctx.threads);
+        auto b = make_shared<vector<double>>(randomVector<double>(a.rows(), ctx.seed));
+        auto x = make_shared<vector<double>>(a.rows());
+        Case c;
+        c.run = [f, b, x] {
+            *x = *b;
+            f->solveInPlace(x->data());
+        };
+        c.elements = double(a.rows());
+        return c;
+    });
+
+    add(name("sparseLU", m), [m](const Context& ctx) {
+        auto a = make_shared<SparseMatrix<double>>(laplacian2d<double>(m));
+        SparseLUOptions opts;
+        opts.ordering = SparseOrdering::NestedDissection;
+        opts.threads = ctx.threads;
+        auto symbolic = make_shared<const SparseSymbolic>(*a, opts.ordering);
+        Case c;
+        c.run = [a, symbolic, opts] { doNotOptimize(SparseLU<double>(symbolic, *a, opts)); };
+        c.elements = double(a->rows());
+        return c;
+    });
+
+    add(name("amgSetup", m), [m](const Context& ctx) {
+        auto a = make_shared<SparseMatrix<double>>(laplacian2d<double>(m));
+        AMGOptions opts;
+        opts.threads = ctx.threads;
+        Case c;
+        c.run = [a, opts] { doNotOptimize(SmoothedAggregationAMG<double>(*a, opts)); };
+        c.elements = double(a->rows());
+        return c;
+    });
+
+    // The solves run to a fixed tolerance, so their times include the number of
+    // iterations needed as well as the cost of each.
+    add(name("cg", m), [m](const Context& ctx) {
+        auto a = make_shared<SparseMatrix<double>>(laplacian2d<double>(m));
+        auto b = make_shared<vector<double>>(randomVector<double>(a->rows(), ctx.seed));
+        CGOptions opts;
+        opts.tolerance = 1e-6;
+        opts.threads = ctx.threads;
+        const LinearOperator<double> op = sparseOperator(*a, ctx.threads);
+        Case c;
+        c.run = [a, b, opts, op] { doNotOptimize(conjugateGradient(op, *b, LinearOperator<double>(), opts)); };
+        c.elements = double(a->rows());
+        return c;
+    });
+
+    add(name("cgAmg", m), [m](const Context& ctx) {
+        auto a = make_shared<SparseMatrix<double>>(laplacian2d<double>(m));
+        auto b = make_shared<vector<double>>(randomVector<double>(a->rows(), ctx.seed));
+        AMGOptions amgOpts;
+        amgOpts.threads = ctx.threads;
+        auto amg = make_shared<SmoothedAggregationAMG<double>>(*a, amgOpts);
+        CGOptions opts;
+        opts.tolerance = 1e-8;
+        opts.threads = ctx.threads;
+        const LinearOperator<double> op = sparseOperator(*a, ctx.threads);
+        Case c;
+        c.run = [a, b, amg, opts, op] { doNotOptimize(conjugateGradient(op, *b, amg->preconditioner(), opts)); };
+        c.elements = double(a->rows());
+        return c;
+    });
+
+    // The extreme eigenvalues of the Laplacian cluster as it grows, so this uses
+    // a smaller grid to keep the iteration count reasonable.
+    const size_t l = 64;
+    add(name("lanczos", l), [l](const Context& ctx) {
+        auto a = make_shared<SparseMatrix<double>>(laplacian2d<double>(l));
+        LanczosOptions opts;
+        opts.count = 6;
+        opts.tolerance = 1e-8;
+        opts.seed = ctx.seed;
+        opts.threads = ctx.threads;
+        const LinearOperator<double> op = sparseOperator(*a, ctx.threads);
+        Case c;
+        c.run = [a, opts, op] { doNotOptimize(LanczosEigen<double>(a->rows(), op, opts)); };
+        c.elements = double(a->rows());
+        return c;
+    });
+}
@@ -0,0 +1,197 @@
+//
+//  system_benchmarks.cpp
+//  kssmath_benchmarks
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "kssmath/aligned_buffer.hpp"
+#include "kssmath/matrix_file.hpp"
+#include "kssmath/matrix_market.hpp"
+#include "kssmath/npy.hpp"
+#include "kssmath/out_of_core.hpp"
+#include "kssmath/parallel.hpp"
+#include "kssmath/task_graph.hpp"
+#include "kssmath/workspace.hpp"
+
+#include "benchmark.hpp"
+
+using namespace std;
+using namespace kss::math;
+using namespace kss::math::benchmark;
+
+
+namespace {
+
+    // A file in the temporary directory that is removed when the benchmark
+    // using it is destroyed.
+    class TempFile {
+    public:
+        TempFile(const Context& ctx, const string& name)
+        : _path(ctx.tempDirectory + "/kssmath_benchmark_" + to_string(getpid()) + "_" + name) {}
+        ~TempFile() noexcept { ::unlink(_path.c_str()); }
+        TempFile(const TempFile&) = delete;
+        TempFile& operator=(const TempFile&) = delete;
+
+        const string& path() const noexcept { return _path; }
+
+    private:
+        string _path;
+    };
+
+}
+
+
+void kss::math::benchmark::addSystemBenchmarks() {
+    // The overhead of the parallel runtime, with no work in the tasks. On one
+    // thread parallelFor is a plain loop, so this uses at least two to measure
+    // handing the chunks to the pool workers.
+    add("runtime/parallelFor/1024chunks", [](const Context& ctx) {
+        const unsigned threads = (ctx.threads == 1 ? 2 : ctx.threads);
+        Case c;
+        c.run = [threads] { parallelFor(1024, 1, [](size_t, size_t) {}, threads); };
+        c.elements = 1024;
+        return c;
+    });
+
+    add("runtime/taskGraph/1024tasks", [](const Context& ctx) {
+        auto graph = make_shared<TaskGraph>();
+        for (size_t i = 0; i < 1024; ++i) {
+            if (i < 32) {
+                graph->add([] {});
+            }
+            else {
+                graph->add([] {}, { i - 32, i - 1 });
+            }
+        }
+        const unsigned threads = ctx.threads;
+        Case c;
+        c.run = [graph, threads] { graph->run(threads); };
+        c.elements = 1024;
+        return c;
+    });
+
+    add("memory/workspace/64x4KB", [](const Context&) {
+        auto w = make_shared<Workspace>();
+        Case c;
+        c.run = [w] {
+            Workspace::Scope scope(*w);
+            for (int i = 0; i < 64; ++i) {
+                doNotOptimize(w->allocate(4096));
+            }
+        };
+        c.elements = 64;
+        return c;
+    });
+
+    add("memory/blockPool/64x64B", [](const Context&) {
+        auto pool = make_shared<BlockPool>(64);
+        Case c;
+        c.run = [pool] {
+            void* blocks[64];
+            for (int i = 0; i < 64; ++i) {
+                blocks[i] = pool->allocate();
+            }
+            doNotOptimize(blocks);
+            for (int i = 0; i < 64; ++i) {
+                pool->deallocate(blocks[i]);
+            }
+        };
+        c.elements = 64;
+        return c;
+    });
+
+    // Allocation, first touch and release of 64 MB.
+    add("memory/alignedBuffer/64MB", [](const Context& ctx) {
+        const size_t n = (size_t(64) << 20) / sizeof(double);
+        AlignedBufferOptions opts;
+        opts.threads = ctx.threads;
+        Case c;
+        c.run = [n, opts] { doNotOptimize(AlignedBuffer<double>(n, 0.0, opts).data()); };
+        c.bytes = double(n) * sizeof(double);
+        c.elements = double(n);
+        return c;
+    });
+
+    const size_t k = 256;
+    const string laplacian = "/laplacian" + to_string(k);
+
+    add("io/matrixMarketWrite" + laplacian, [k](const Context& ctx) {
+        auto file = make_shared<TempFile>(ctx, "write.mtx");
+        auto a = make_shared<SparseMatrix<double>>(laplacian2d<double>(k));
+        const unsigned threads = ctx.threads;
+        Case c;
+        c.run = [file, a, threads] { writeMatrixMarket(file->path(), *a, threads); };
+        c.elements = double(a->nonZeros());
+        return c;
+    });
+
+    add("io/matrixMarketRead" + laplacian, [k](const Context& ctx) {
+        auto file = make_shared<TempFile>(ctx, "read.mtx");
+        writeMatrixMarket(file->path(), laplacian2d<double>(k), ctx.threads);
+        const double size = double(MappedFile(file->path()).size());
+        const unsigned threads = ctx.threads;
+        Case c;
+        c.run = [file, threads] { doNotOptimize(readSparseMatrixMarket<double>(file->path(), threads)); };
+        c.bytes = size;
+        c.elements = 5.0 * k * k;
+        return c;
+    });
+
+    const size_t n = 2048;
+    const double matrixBytes = double(n) * n * sizeof(double);
+
+    add("io/npyWrite/2048", [n, matrixBytes](const Context& ctx) {
+        auto file = make_shared<TempFile>(ctx, "write.npy");
+        auto a = make_shared<Matrix<double>>(randomMatrix<double>(n, n, ctx.seed));
+        Case c;
+        c.run = [file, a] { writeNpy(file->path(), *a); };
+        c.bytes = matrixBytes;
+        c.elements = double(n) * n;
+        return c;
+    });
+
+    // Reading maps the file, so this copies the array to a Matrix to include the
+    // cost of reading the data.
+    add("io/npyRead/2048", [n, matrixBytes](const Context& ctx) {
+        auto file = make_shared<TempFile>(ctx, "read.npy");
+        writeNpy(file->path(), randomMatrix<double>(n, n, ctx.seed));
+        Case c;
+        c.run = [file] { doNotOptimize(readNpy(file->path()).toMatrix<double>()); };
+        c.bytes = matrixBytes;
+        c.elements = double(n) * n;
+        return c;
+    });
+
+    add("io/outOfCoreGemm/2048", [n](const Context& ctx) {
+        auto fa = make_shared<TempFile>(ctx, "a.kmf");
+        auto fb = make_shared<TempFile>(ctx, "b.kmf");
+        auto fc = make_shared<TempFile>(ctx, "c.kmf");
+        MatrixFile::write(fa->path(), randomMatrix<double>(n, n, ctx.seed));
+        MatrixFile::write(fb->path(), randomMatrix<double>(n, n, ctx.seed + 1));
+        auto a = make_shared<MatrixFile>(fa->path());
+        auto b = make_shared<MatrixFile>(fb->path());
+        auto cm = make_shared<MatrixFile>(MatrixFile::createDense<double>(fc->path(), n, n));
+        OutOfCoreOptions opts;
+        opts.tileSize = 512;
+        opts.threads = ctx.threads;
+        Case c;
+        c.run = [fa, fb, fc, a, b, cm, opts] {
+            outOfCoreGemm(1.0, a->denseView<double>(), b->denseView<double>(), 0.0,
+                          cm->mutableDenseView<double>(), opts);
+        };
+        c.flops = 2.0 * n * n * n;
+        c.bytes = 3.0 * n * n * sizeof(double);
+        c.elements = double(n) * n;
+        return c;
+    });
+}
@@ -0,0 +1,687 @@
+//
+//  dense_tests.cpp
+//  kssmath_tests
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "kssmath/blas.hpp"
+#include "kssmath/cholesky.hpp"
+#include "kssmath/cpu_features.hpp"
+#include "kssmath/ldlt.hpp"
+#include "kssmath/least_squares.hpp"
+#include "kssmath/mixed_precision.hpp"
+#include "kssmath/qr.hpp"
+#include "kssmath/svd.hpp"
+#include "kssmath/symmetric_eigen.hpp"
+#include "kssmath/task_graph.hpp"
+
+#include "test.hpp"
+
+using namespace std;
+using namespace kss::math;
+using namespace kss::math::test;
+
+
+namespace {
+
+    const double eps = numeric_limits<double>::epsilon();
+
+    // The n x n Hilbert matrix, whose condition number grows like e^(3.5n), so
+    // that it defeats a single precision factorization for quite small n.
+    Matrix<double> hilbert(size_t n) {
+        Matrix<double> a(n, n);
+        for (size_t j = 0; j < n; ++j) {
+            for (size_t i = 0; i < n; ++i) {
+                a(i, j) = 1.0 / double(i + j + 1);
+            }
+        }
+        return a;
+    }
+
+    // Returns B*D*B' for a random B, which by Sylvester's law has as many
+    // positive and negative eigenvalues as d has positive and negative elements.
+    Matrix<double> withInertia(const vector<double>& d, uint64_t seed) {
+        const size_t n = d.size();
+        const auto b = randomMatrix<double>(n, n, seed);
+        Matrix<double> a(n, n);
+        for (size_t j = 0; j < n; ++j) {
+            for (size_t i = 0; i < n; ++i) {
+                double s = 0;
+                for (size_t k = 0; k < n; ++k) {
+                    s += b(i, k) * d[k] * b(j, k);
+                }
+                a(i, j) = s;
+            }
+        }
+        return a;
+    }
+
+    // Returns Q*diag(d)*Q' for a random orthogonal Q, a symmetric matrix with
+    // the eigenvalues d.
+    Matrix<double> withEigenvalues(const vector<double>& d, uint64_t seed) {
+        const size_t n = d.size();
+        const auto q = QR<double>(randomMatrix<double>(n, n, seed)).Q();
+        Matrix<double> a(n, n);
+        for (size_t j = 0; j < n; ++j) {
+            for (size_t i = 0; i < n; ++i) {
+                double s = 0;
+                for (size_t k = 0; k < n; ++k) {
+                    s += q(i, k) * d[k] * q(j, k);
+                }
+                a(i, j) = s;
+            }
+        }
+        return a;
+    }
+
+    // Checks that the columns of v are orthonormal eigenvectors of the
+    // symmetric matrix a, with the eigenvalues lambda.
+    void checkEigenpairs(const Matrix<double>& a, const vector<double>& lambda, const Matrix<double>& v) {
+        const size_t n = a.rows();
+        const double tolerance = 100 * eps * n * max(abs(lambda.front()), abs(lambda.back()));
+        const auto av = multiply(a, v);
+        for (size_t k = 0; k < lambda.size(); ++k) {
+            for (size_t i = 0; i < n; ++i) {
+                KSSMATH_CHECK_CLOSE(av(i, k), lambda[k] * v(i, k), tolerance);
+            }
+            for (size_t l = 0; l <= k; ++l) {
+                double vv = 0;
+                for (size_t i = 0; i < n; ++i) {
+                    vv += v(i, k) * v(i, l);
+                }
+                KSSMATH_CHECK_CLOSE(vv, (k == l ? 1.0 : 0.0), 100 * eps * n);
+            }
+        }
+    }
+
+    // Returns A'*r, which is zero at the least squares solution.
+    vector<double> normalResidual(const Matrix<double>& a, const vector<double>& x, const vector<double>& b) {
+        auto r = multiply(a, x);
+        for (size_t i = 0; i < r.size(); ++i) {
+            r[i] = b[i] - r[i];
+        }
+        vector<double> g(a.cols(), 0.0);
+        for (size_t j = 0; j < a.cols(); ++j) {
+            for (size_t i = 0; i < a.rows(); ++i) {
+                g[j] += a(i, j) * r[i];
+            }
+        }
+        return g;
+    }
+
+    // Restores the instruction set that was active when it was created.
+    class InstructionSetGuard {
+    public:
+        InstructionSetGuard() noexcept : _isa(activeInstructionSet()) {}
+        ~InstructionSetGuard() noexcept { selectInstructionSet(_isa); }
+        InstructionSetGuard(const InstructionSetGuard&) = delete;
+        InstructionSetGuard& operator=(const InstructionSetGuard&) = delete;
+
+    private:
+        InstructionSet _isa;
+    };
+
+    // Returns element (i, p) of op(A), where A is stored with leading dimension lda.
+    template <class T>
+    T element(blas::Op op, const T* a, size_t lda, size_t i, size_t p) {
+        return (op == blas::Op::NoTrans ? a[i + p * lda] : a[p + i * lda]);
+    }
+
+    // Checks the dispatched kernels of the active instruction set against
+    // direct loops in double precision. The sizes are not multiples of the
+    // vector widths, so the remainder loops are covered too.
+    template <class T>
+    void checkBlasKernels() {
+        const double tolerance = 8 * numeric_limits<T>::epsilon();
+        const size_t m = 37, n = 29, k = 23;
+        const auto x = randomVector<T>(k, 11), y0 = randomVector<T>(k, 12);
+
+        double expected = 0, bound = 0;
+        for (size_t i = 0; i < k; ++i) {
+            expected += double(x[i]) * y0[i];
+            bound += abs(double(x[i]) * y0[i]);
+        }
+        KSSMATH_CHECK_CLOSE(double(blas::dot(k, x.data(), y0.data())), expected, tolerance * k * bound);
+
+        auto y = y0;
+        blas::axpy(k, T(0.75), x.data(), y.data());
+        for (size_t i = 0; i < k; ++i) {
+            KSSMATH_CHECK_CLOSE(double(y[i]), double(y0[i]) + 0.75 * x[i], tolerance * 2);
+        }
+
+        // a is m x k with leading dimension m + 3; b and c are big enough for
+        // either orientation.
+        const size_t lda = m + 3, ldb = max(k, n) + 2, ldc = m + 1;
+        const auto a = randomVector<T>(lda * max(k, m), 13);
+        const auto b = randomVector<T>(ldb * max(k, n), 14);
+        const auto c0 = randomVector<T>(ldc * max(n, m), 15);
+        const auto xm = randomVector<T>(m, 16);
+
+        auto yv = randomVector<T>(m, 17);
+        const auto yv0 = yv;
+        blas::gemv(m, k, T(1.5), a.data(), lda, x.data(), T(-0.5), yv.data());
+        for (size_t i = 0; i < m; ++i) {
+            double s = -0.5 * yv0[i];
+            for (size_t p = 0; p < k; ++p) {
+                s += 1.5 * a[i + p * lda] * x[p];
+            }
+            KSSMATH_CHECK_CLOSE(double(yv[i]), s, tolerance * 2 * k);
+        }
+
+        auto yt = randomVector<T>(k, 18);
+        const auto yt0 = yt;
+        blas::gemvTranspose(m, k, T(1.5), a.data(), lda, xm.data(), T(2), yt.data());
+        for (size_t p = 0; p < k; ++p) {
+            double s = 2.0 * yt0[p];
+            for (size_t i = 0; i < m; ++i) {
+                s += 1.5 * a[i + p * lda] * xm[i];
+            }
+            KSSMATH_CHECK_CLOSE(double(yt[p]), s, tolerance * 2 * m);
+        }
+
+        for (auto opA : { blas::Op::NoTrans, blas::Op::Trans }) {
+            for (auto opB : { blas::Op::NoTrans, blas::Op::Trans }) {
+                // op(A) is m x k and op(B) is k x n.
+                const size_t ldA = (opA == blas::Op::NoTrans ? lda : k + 1);
+                const size_t ldB = (opB == blas::Op::NoTrans ? ldb : n + 1);
+                auto c = c0;
+                blas::gemm(opA, opB, m, n, k, T(0.5), a.data(), ldA, b.data(), ldB, T(1), c.data(), ldc);
+                for (size_t j = 0; j < n; ++j) {
+                    for (size_t i = 0; i < m; ++i) {
+                        double s = c0[i + j * ldc];
+                        for (size_t p = 0; p < k; ++p) {
+                            s += 0.5 * element(opA, a.data(), ldA, i, p) * element(opB, b.data(), ldB, p, j);
+                        }
+                        KSSMATH_CHECK_CLOSE(double(c[i + j * ldc]), s, tolerance * 2 * k);
+                    }
+                }
+            }
+        }
+
+        auto c = c0;
+        blas::syrkLower(m, k, T(-1), a.data(), lda, T(0.5), c.data(), ldc);
+        for (size_t j = 0; j < m; ++j) {
+            for (size_t i = 0; i < m; ++i) {
+                double s = 0.5 * c0[i + j * ldc];
+                for (size_t p = 0; p < k; ++p) {
+                    s -= double(a[i + p * lda]) * a[j + p * lda];
+                }
+                // The strictly upper triangle is not touched.
+                KSSMATH_CHECK_CLOSE(double(c[i + j * ldc]), (i >= j ? s : double(c0[i + j * ldc])), tolerance * 2 * k);
+            }
+        }
+    }
+
+    void addBlasTests() {
+        add("dense/blas/dispatch", [] {
+            // Every supported instruction set gives the same results, to
+            // rounding, as the reference loops.
+            InstructionSetGuard guard;
+            KSSMATH_CHECK(isSupported(InstructionSet::Generic));
+            for (auto isa : { InstructionSet::Generic, InstructionSet::AVX2, InstructionSet::AVX512 }) {
+                if (!isSupported(isa)) {
+                    KSSMATH_CHECK_THROWS(selectInstructionSet(isa), invalid_argument);
+                    continue;
+                }
+                selectInstructionSet(isa);
+                KSSMATH_CHECK(activeInstructionSet() == isa);
+                checkBlasKernels<float>();
+                checkBlasKernels<double>();
+            }
+        });
+
+        add("dense/blas/cpuFeatures", [] {
+            const auto& f = cpuFeatures();
+            KSSMATH_CHECK(!f.avx2 || f.avx);
+            KSSMATH_CHECK(!f.avx512f || f.avx2);
+            KSSMATH_CHECK(!isSupported(InstructionSet::AVX2) || (f.avx2 && f.fma));
+            KSSMATH_CHECK(!isSupported(InstructionSet::AVX512) || f.avx512f);
+            KSSMATH_CHECK(isSupported(activeInstructionSet()));
+            KSSMATH_CHECK(string(instructionSetName(InstructionSet::Generic)) == "generic");
+            KSSMATH_CHECK(string(instructionSetName(InstructionSet::AVX2)) == "avx2");
+            KSSMATH_CHECK(string(instructionSetName(InstructionSet::AVX512)) == "avx512");
+        });
+    }
+
+    void addMixedPrecisionTests() {
+        add("dense/mixedPrecision/refines", [] {
+            const size_t n = 200;
+            const auto a = randomMatrix<double>(n, n, 1);
+            MixedPrecisionSolver<float, double> solver(a);
+            for (uint64_t seed = 2; seed < 5; ++seed) {
+                const auto b = randomVector<double>(n, seed);
+                const auto res = solver.solve(b);
+                KSSMATH_CHECK(!res.usedFallback);
+                KSSMATH_CHECK(res.iterations > 0);
+                KSSMATH_CHECK(res.backwardError <= eps * sqrt(double(n)));
+                KSSMATH_CHECK(relativeResidual(a, res.x, b) < 10 * eps);
+            }
+            KSSMATH_CHECK(solver.usingLowPrecision());
+        });
+
+        add("dense/mixedPrecision/fallsBack", [] {
+            const size_t n = 10;
+            const auto a = hilbert(n);
+            const auto b = randomVector<double>(n, 1);
+            const auto res = solveMixedPrecision(a, b);
+            KSSMATH_CHECK(res.usedFallback);
+            KSSMATH_CHECK(relativeResidual(a, res.x, b) < 10 * eps);
+        });
+
+        add("dense/mixedPrecision/arguments", [] {
+            KSSMATH_CHECK_THROWS(MixedPrecisionSolver<>(Matrix<double>(3, 2)), invalid_argument);
+            MixedPrecisionSolver<> solver(randomMatrix<double>(3, 3, 1));
+            KSSMATH_CHECK_THROWS(solver.solve(vector<double>(2)), invalid_argument);
+            KSSMATH_CHECK_THROWS(solveMixedPrecision(Matrix<double>(2, 2), vector<double>(2, 1.0)),
+                                 SingularMatrixError);
+        });
+    }
+
+    void addFactorizationTests() {
+        add("dense/taskGraph/dependencies", [] {
+            TaskGraph graph;
+            atomic<int> next(0);
+            vector<int> finished(64, -1);
+            for (size_t i = 0; i < 64; ++i) {
+                if (i < 4) {
+                    graph.add([&, i] { finished[i] = next++; });
+                }
+                else {
+                    graph.add([&, i] { finished[i] = next++; }, { i - 4, i - 1 });
+                }
+            }
+            graph.run(4);
+            for (size_t i = 4; i < 64; ++i) {
+                KSSMATH_CHECK(finished[i] > finished[i - 4] && finished[i] > finished[i - 1]);
+            }
+            graph.add([] { throw runtime_error("task failed"); });
+            KSSMATH_CHECK_THROWS(graph.run(4), runtime_error);
+            KSSMATH_CHECK_THROWS(graph.add([] {}, { 1000 }), invalid_argument);
+        });
+
+        add("dense/cholesky/residual", [] {
+            const size_t n = 150;
+            const auto a = randomSpdMatrix<double>(n, 1);
+            const auto b = randomVector<double>(n, 2);
+            for (unsigned threads : { 1u, 4u }) {
+                BlockingOptions opts;
+                opts.blockSize = 32;
+                opts.threads = threads;
+                const Cholesky<double> chol(a, opts);
+                const auto& l = chol.factor();
+                Matrix<double> lt(n, n);
+                for (size_t j = 0; j < n; ++j) {
+                    for (size_t i = 0; i < j; ++i) {
+                        KSSMATH_CHECK(l(i, j) == 0);
+                    }
+                    for (size_t i = 0; i < n; ++i) {
+                        lt(i, j) = l(j, i);
+                    }
+                }
+                const auto llt = multiply(l, lt);
+                for (size_t j = 0; j < n; ++j) {
+                    for (size_t i = 0; i < n; ++i) {
+                        KSSMATH_CHECK_CLOSE(llt(i, j), a(i, j), 100 * eps * n);
+                    }
+                }
+                KSSMATH_CHECK(relativeResidual(a, chol.solve(b), b) < 10 * eps);
+            }
+        });
+
+        add("dense/cholesky/logDeterminant", [] {
+            Matrix<double> a(3, 3);
+            a(0, 0) = 2;
+            a(1, 1) = 3;
+            a(2, 2) = 1e300;
+            a(1, 0) = a(0, 1) = 1;
+            KSSMATH_CHECK_CLOSE(Cholesky<double>(a).logDeterminant(), log(5.0) + log(1e300), 1e-12);
+        });
+
+        add("dense/cholesky/notPositiveDefinite", [] {
+            auto a = randomSpdMatrix<double>(100, 1);
+            a(70, 70) = -1;
+            BlockingOptions opts;
+            opts.blockSize = 16;
+            KSSMATH_CHECK_THROWS(Cholesky<double>(a, opts), NotPositiveDefiniteError);
+            KSSMATH_CHECK_THROWS(Cholesky<double>(Matrix<double>(2, 3)), invalid_argument);
+        });
+
+        add("dense/ldlt/residualAndInertia", [] {
+            const size_t n = 120;
+            vector<double> d(n);
+            for (size_t i = 0; i < n; ++i) {
+                d[i] = (i % 3 == 0 ? -1.0 - double(i) : 1.0 + double(i));
+            }
+            const auto a = withInertia(d, 1);
+            const auto b = randomVector<double>(n, 2);
+
+            // Only the lower triangle is referenced.
+            auto lower = a;
+            for (size_t j = 1; j < n; ++j) {
+                for (size_t i = 0; i < j; ++i) {
+                    lower(i, j) = numeric_limits<double>::quiet_NaN();
+                }
+            }
+            for (unsigned threads : { 1u, 4u }) {
+                BlockingOptions opts;
+                opts.blockSize = 16;
+                opts.threads = threads;
+                const LDLT<double> ldlt(lower, opts);
+                KSSMATH_CHECK(relativeResidual(a, ldlt.solve(b), b) < 100 * eps);
+                const auto inertia = ldlt.inertia();
+                KSSMATH_CHECK(inertia.negative == 40);
+                KSSMATH_CHECK(inertia.positive == 80);
+                KSSMATH_CHECK(inertia.zero == 0);
+            }
+            KSSMATH_CHECK_THROWS(LDLT<double>(Matrix<double>(3, 3)), SingularMatrixError);
+        });
+    }
+
+    void addLeastSquaresTests() {
+        add("dense/qr/reconstruction", [] {
+            const size_t m = 90, n = 70;
+            const auto a = randomMatrix<double>(m, n, 1);
+            for (unsigned threads : { 1u, 4u }) {
+                BlockingOptions opts;
+                opts.blockSize = 8;
+                opts.threads = threads;
+                const QR<double> qr(a, opts);
+                const auto q = qr.Q();
+                const auto qra = multiply(q, qr.R());
+                for (size_t j = 0; j < n; ++j) {
+                    for (size_t i = 0; i < m; ++i) {
+                        KSSMATH_CHECK_CLOSE(qra(i, j), a(i, j), 100 * eps * n);
+                    }
+                    for (size_t k = 0; k < n; ++k) {
+                        double qtq = 0;
+                        for (size_t i = 0; i < m; ++i) {
+                            qtq += q(i, j) * q(i, k);
+                        }
+                        KSSMATH_CHECK_CLOSE(qtq, (j == k ? 1.0 : 0.0), 100 * eps * m);
+                    }
+                }
+                auto c = randomVector<double>(m, 2);
+                const auto c0 = c;
+                qr.applyQTranspose(c);
+                qr.applyQ(c);
+                for (size_t i = 0; i < m; ++i) {
+                    KSSMATH_CHECK_CLOSE(c[i], c0[i], 100 * eps);
+                }
+            }
+        });
+
+        add("dense/pivotedQr/rank", [] {
+            // A 60 x 40 matrix of rank 25.
+            const auto a = multiply(randomMatrix<double>(60, 25, 1), randomMatrix<double>(25, 40, 2));
+            const PivotedQR<double> pqr(a);
+            KSSMATH_CHECK(pqr.rank() == 25);
+            const auto r = pqr.R();
+            for (size_t i = 1; i < 40; ++i) {
+                KSSMATH_CHECK(abs(r(i, i)) <= abs(r(i - 1, i - 1)) * (1 + 1e-12));
+            }
+        });
+
+        add("dense/lstsq/methods", [] {
+            const size_t m = 400, n = 12;
+            const auto a = randomMatrix<double>(m, n, 1);
+            const auto b = randomVector<double>(m, 2);
+            for (auto method : { LeastSquaresMethod::Automatic, LeastSquaresMethod::QR,
+                                 LeastSquaresMethod::PivotedQR, LeastSquaresMethod::TSQR })
+            {
+                LeastSquaresOptions opts;
+                opts.method = method;
+                opts.blocking.threads = 4;
+                const auto res = lstsq(a, b, opts);
+                KSSMATH_CHECK(res.rank == n);
+                const auto g = normalResidual(a, res.x, b);
+                KSSMATH_CHECK(maxAbs(g.begin(), g.end()) < 1e-12);
+                auto r = multiply(a, res.x);
+                double rr = 0;
+                for (size_t i = 0; i < m; ++i) {
+                    rr += (b[i] - r[i]) * (b[i] - r[i]);
+                }
+                KSSMATH_CHECK_CLOSE(res.residualNorm, sqrt(rr), 1e-12);
+            }
+        });
+
+        // Every number of rows from the smallest that TSQR splits, with more
+        // threads than can each be given a block of equal size.
+        add("dense/lstsq/tsqrBlocks", [] {
+            for (size_t n : { 1, 3 }) {
+                for (size_t m = n; m <= 80; ++m) {
+                    const auto a = randomMatrix<double>(m, n, m);
+                    const auto b = randomVector<double>(m, m + 1);
+                    for (unsigned threads : { 3u, 8u }) {
+                        LeastSquaresOptions opts;
+                        opts.method = LeastSquaresMethod::TSQR;
+                        opts.blocking.threads = threads;
+                        const auto res = lstsq(a, b, opts);
+                        const auto g = normalResidual(a, res.x, b);
+                        KSSMATH_CHECK(maxAbs(g.begin(), g.end()) < 1e-12);
+                        opts.method = LeastSquaresMethod::Automatic;
+                        const auto automatic = lstsq(a, b, opts);
+                        for (size_t j = 0; j < n; ++j) {
+                            KSSMATH_CHECK_CLOSE(automatic.x[j], res.x[j], 1e-10);
+                        }
+                    }
+                }
+            }
+        });
+
+        add("dense/lstsq/underdetermined", [] {
+            const size_t m = 20, n = 50;
+            const auto a = randomMatrix<double>(m, n, 1);
+            const auto b = randomVector<double>(m, 2);
+            const auto res = lstsq(a, b);
+            KSSMATH_CHECK(res.rank == m);
+            KSSMATH_CHECK(relativeResidual(a, res.x, b) < 100 * eps);
+
+            // The minimum norm solution is in the range of A', so it is
+            // orthogonal to the null space of A, which Q' of A' spans past m.
+            Matrix<double> at(n, m);
+            for (size_t j = 0; j < n; ++j) {
+                for (size_t i = 0; i < m; ++i) {
+                    at(j, i) = a(i, j);
+                }
+            }
+            const QR<double> qr(at);
+            auto c = res.x;
+            qr.applyQTranspose(c);
+            KSSMATH_CHECK(maxAbs(c.begin() + m, c.end()) < 1e-12);
+        });
+
+        add("dense/lstsq/rankDeficient", [] {
+            const auto a = multiply(randomMatrix<double>(50, 6, 1), randomMatrix<double>(6, 10, 2));
+            const auto b = randomVector<double>(50, 3);
+            const auto res = lstsq(a, b);
+            KSSMATH_CHECK(res.rank == 6);
+            const auto g = normalResidual(a, res.x, b);
+            KSSMATH_CHECK(maxAbs(g.begin(), g.end()) < 1e-10);
+            KSSMATH_CHECK_THROWS(lstsq(a, vector<double>(49)), invalid_argument);
+            LeastSquaresOptions opts;
+            opts.method = LeastSquaresMethod::TSQR;
+            KSSMATH_CHECK_THROWS(lstsq(Matrix<double>(3, 5), vector<double>(3), opts), invalid_argument);
+        });
+    }
+
+    void addEigenTests() {
+        add("dense/symmetricEigen/all", [] {
+            const size_t n = 150;
+            const auto a = randomSpdMatrix<double>(n, 1);
+            for (unsigned threads : { 1u, 4u }) {
+                SymmetricEigenOptions opts;
+                opts.blocking.blockSize = 16;
+                opts.blocking.threads = threads;
+                const SymmetricEigen<double> eig(a, opts);
+                const auto& lambda = eig.eigenvalues();
+                KSSMATH_CHECK(lambda.size() == n);
+                KSSMATH_CHECK(is_sorted(lambda.begin(), lambda.end()));
+                checkEigenpairs(a, lambda, eig.eigenvectors());
+
+                opts.computeVectors = false;
+                const SymmetricEigen<double> valuesOnly(a, opts);
+                KSSMATH_CHECK(valuesOnly.eigenvectors().size() == 0);
+                for (size_t i = 0; i < n; ++i) {
+                    KSSMATH_CHECK_CLOSE(valuesOnly.eigenvalues()[i], lambda[i], 1e-12 * lambda.back());
+                }
+            }
+        });
+
+        // Repeated and clustered eigenvalues, which divide and conquer deflates
+        // and inverse iteration must orthogonalize.
+        add("dense/symmetricEigen/clusters", [] {
+            const size_t n = 100;
+            vector<double> d(n);
+            for (size_t i = 0; i < n; ++i) {
+                d[i] = (i < 30 ? 1.0 : (i < 40 ? 2.0 + 1e-10 * double(i) : double(i) - 50.0));
+            }
+            const auto a = withEigenvalues(d, 1);
+            sort(d.begin(), d.end());
+            const SymmetricEigen<double> eig(a);
+            for (size_t i = 0; i < n; ++i) {
+                KSSMATH_CHECK_CLOSE(eig.eigenvalues()[i], d[i], 1e-12 * n);
+            }
+            checkEigenpairs(a, eig.eigenvalues(), eig.eigenvectors());
+
+            for (auto which : { Which::Smallest, Which::Largest }) {
+                SymmetricEigenOptions opts;
+                opts.count = 35;
+                opts.which = which;
+                const SymmetricEigen<double> some(a, opts);
+                const size_t first = (which == Which::Smallest ? 0 : n - 35);
+                for (size_t i = 0; i < 35; ++i) {
+                    KSSMATH_CHECK_CLOSE(some.eigenvalues()[i], d[first + i], 1e-12 * n);
+                }
+                checkEigenpairs(a, some.eigenvalues(), some.eigenvectors());
+            }
+        });
+
+        add("dense/symmetricEigen/arguments", [] {
+            KSSMATH_CHECK_THROWS(SymmetricEigen<double>(Matrix<double>(3, 4)), invalid_argument);
+            SymmetricEigenOptions opts;
+            opts.count = 4;
+            KSSMATH_CHECK_THROWS(SymmetricEigen<double>(Matrix<double>(3, 3), opts), invalid_argument);
+        });
+    }
+
+    // Checks that A = U*diag(s)*V' with orthonormal U and V.
+    void checkSvd(const Matrix<double>& a, const SVD<double>& svd) {
+        const auto& s = svd.singularValues();
+        const auto& u = svd.U();
+        const auto& v = svd.V();
+        const size_t k = s.size();
+        KSSMATH_CHECK(is_sorted(s.rbegin(), s.rend()));
+        KSSMATH_CHECK(u.cols() == k && v.cols() == k);
+        Matrix<double> us = u;
+        for (size_t j = 0; j < k; ++j) {
+            for (size_t i = 0; i < us.rows(); ++i) {
+                us(i, j) *= s[j];
+            }
+        }
+        Matrix<double> vt(k, v.rows());
+        for (size_t j = 0; j < v.rows(); ++j) {
+            for (size_t i = 0; i < k; ++i) {
+                vt(i, j) = v(j, i);
+            }
+        }
+        const auto usvt = multiply(us, vt);
+        const double tolerance = 100 * eps * max(a.rows(), a.cols()) * s.front();
+        for (size_t j = 0; j < a.cols(); ++j) {
+            for (size_t i = 0; i < a.rows(); ++i) {
+                KSSMATH_CHECK_CLOSE(usvt(i, j), a(i, j), tolerance);
+            }
+        }
+        for (const auto* q : { &u, &v }) {
+            for (size_t j = 0; j < k; ++j) {
+                for (size_t l = 0; l <= j; ++l) {
+                    double qq = 0;
+                    for (size_t i = 0; i < q->rows(); ++i) {
+                        qq += (*q)(i, j) * (*q)(i, l);
+                    }
+                    KSSMATH_CHECK_CLOSE(qq, (j == l ? 1.0 : 0.0), 100 * eps * q->rows());
+                }
+            }
+        }
+    }
+
+    void addSvdTests() {
+        add("dense/svd/decomposition", [] {
+            for (auto shape : { make_pair(80, 50), make_pair(40, 70) }) {
+                const auto a = randomMatrix<double>(size_t(shape.first), size_t(shape.second), 1);
+                SVDOptions opts;
+                opts.blocking.blockSize = 16;
+                opts.blocking.threads = 4;
+                const SVD<double> svd(a, opts);
+                checkSvd(a, svd);
+
+                // The squares of the singular values are the eigenvalues of A'A.
+                Matrix<double> at(a.cols(), a.rows());
+                for (size_t j = 0; j < a.cols(); ++j) {
+                    for (size_t i = 0; i < a.rows(); ++i) {
+                        at(j, i) = a(i, j);
+                    }
+                }
+                const auto ata = (a.rows() >= a.cols() ? multiply(at, a) : multiply(a, at));
+                const auto lambda = SymmetricEigen<double>(ata).eigenvalues();
+                const auto& s = svd.singularValues();
+                for (size_t i = 0; i < s.size(); ++i) {
+                    KSSMATH_CHECK_CLOSE(s[i] * s[i], lambda[lambda.size() - 1 - i], 1e-12 * lambda.back());
+                }
+
+                opts.computeVectors = false;
+                const SVD<double> valuesOnly(a, opts);
+                KSSMATH_CHECK(valuesOnly.U().size() == 0 && valuesOnly.V().size() == 0);
+                for (size_t i = 0; i < s.size(); ++i) {
+                    KSSMATH_CHECK_CLOSE(valuesOnly.singularValues()[i], s[i], 1e-12 * s.front());
+                }
+            }
+            Matrix<double> singular(3, 3);
+            singular(0, 0) = 1;
+            KSSMATH_CHECK(SVD<double>(singular).conditionNumber() == numeric_limits<double>::infinity());
+        });
+
+        add("dense/svd/randomized", [] {
+            // A matrix of rank 8, whose leading singular triplets the randomized
+            // SVD recovers to near full precision.
+            const size_t m = 300, n = 200, rank = 8;
+            const auto a = multiply(randomMatrix<double>(m, rank, 1), randomMatrix<double>(rank, n, 2));
+            const auto s = SVD<double>(a).singularValues();
+            RandomizedSVDOptions opts;
+            opts.blocking.threads = 4;
+            const auto approx = SVD<double>::randomized(a, rank, opts);
+            KSSMATH_CHECK(approx.singularValues().size() == rank);
+            for (size_t i = 0; i < rank; ++i) {
+                KSSMATH_CHECK_CLOSE(approx.singularValues()[i], s[i], 1e-10 * s[0]);
+            }
+            checkSvd(a, approx);
+
+            // The same seed gives the same result.
+            const auto again = SVD<double>::randomized(a, rank, opts);
+            KSSMATH_CHECK(again.singularValues() == approx.singularValues());
+            KSSMATH_CHECK_THROWS(SVD<double>::randomized(a, 0), invalid_argument);
+            KSSMATH_CHECK_THROWS(SVD<double>::randomized(a, n + 1), invalid_argument);
+        });
+    }
+
+}
+
+
+void kss::math::test::addDenseTests() {
+    addBlasTests();
+    addMixedPrecisionTests();
+    addFactorizationTests();
+    addLeastSquaresTests();
+    addEigenTests();
+    addSvdTests();
+}
@@ -0,0 +1,466 @@
+//
+//  io_tests.cpp
+//  kssmath_tests
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "kssmath/error.hpp"
+#include "kssmath/matrix_file.hpp"
+#include "kssmath/matrix_market.hpp"
+#include "kssmath/npy.hpp"
+#include "kssmath/out_of_core.hpp"
+#include "kssmath/qr.hpp"
+
+#include "test.hpp"
+
+using namespace std;
+using namespace kss::math;
+using namespace kss::math::test;
+
+
+namespace {
+
+    // Writes the given bytes as the whole contents of a file.
+    void writeBytes(const string& path, const string& bytes) {
+        ofstream out(path, ios::binary);
+        out.write(bytes.data(), streamsize(bytes.size()));
+    }
+
+    template <class T>
+    void checkDenseRoundTrip(size_t rows, size_t cols) {
+        TemporaryFile tmp(".kssm");
+        const auto a = randomMatrix<T>(rows, cols, rows * 1000 + cols);
+        MatrixFile::write(tmp.path(), a);
+
+        const MatrixFile f(tmp.path());
+        KSSMATH_CHECK(f.kind() == MatrixFileKind::Dense);
+        KSSMATH_CHECK(f.rows() == rows && f.cols() == cols);
+        const auto view = f.denseView<T>();
+        KSSMATH_CHECK(view.leadingDimension() >= rows);
+        for (size_t j = 0; j < cols; ++j) {
+            KSSMATH_CHECK(reinterpret_cast<uintptr_t>(view.column(j)) % matrixFileColumnAlignment == 0);
+        }
+        const auto b = view.toMatrix();
+        KSSMATH_CHECK(equal(a.data(), a.data() + a.size(), b.data()));
+    }
+
+    // Returns a version 1.0 .npy file with the given header dictionary and data.
+    string npyFile(const string& dict, const string& data) {
+        string header = dict;
+        while ((10 + header.size() + 1) % 64 != 0) {
+            header += ' ';
+        }
+        header += '\n';
+        string file("\x93NUMPY\x01\x00", 8);
+        file += char(header.size() & 0xff);
+        file += char(header.size() >> 8);
+        return file + header + data;
+    }
+
+    // Returns value as count little endian bytes.
+    string littleEndian(uint64_t value, size_t count) {
+        string bytes;
+        for (size_t i = 0; i < count; ++i) {
+            bytes += char((value >> (8 * i)) & 0xff);
+        }
+        return bytes;
+    }
+
+    // Returns a zip archive of one stored member "a.npy" whose central directory
+    // entry has its sizes and offset in a zip64 extra field of the given length.
+    string zip64Archive(size_t extraLength) {
+        const string name = "a.npy";
+        string local = littleEndian(0x04034b50, 4) + string(22, '\0') + littleEndian(name.size(), 2)
+                       + littleEndian(0, 2) + name;
+        string extra = littleEndian(1, 2) + littleEndian(extraLength, 2);
+        for (size_t i = 0; i < extraLength / 8; ++i) {
+            extra += littleEndian(0, 8);
+        }
+        string central = littleEndian(0x02014b50, 4) + string(16, '\0') + littleEndian(0xffffffff, 4)
+                         + littleEndian(0xffffffff, 4) + littleEndian(name.size(), 2)
+                         + littleEndian(extra.size(), 2) + string(10, '\0') + littleEndian(0xffffffff, 4)
+                         + name + extra;
+        string eocd = littleEndian(0x06054b50, 4) + string(4, '\0') + littleEndian(1, 2) + littleEndian(1, 2)
+                      + littleEndian(central.size(), 4) + littleEndian(local.size(), 4) + littleEndian(0, 2);
+        return local + central + eocd;
+    }
+
+    template <class T>
+    DenseMatrixView<T> view(Matrix<T>& a) {
+        return DenseMatrixView<T>(a.rows(), a.cols(), a.rows(), a.data());
+    }
+
+    template <class T>
+    DenseMatrixView<const T> view(const Matrix<T>& a) {
+        return DenseMatrixView<const T>(a.rows(), a.cols(), a.rows(), a.data());
+    }
+
+    // Tile sizes that do not divide the dimensions, and one that exceeds them.
+    OutOfCoreOptions tiles(size_t tileSize, unsigned threads) {
+        OutOfCoreOptions opts;
+        opts.tileSize = tileSize;
+        opts.blockSize = 8;
+        opts.threads = threads;
+        return opts;
+    }
+
+    void addMatrixFileTests() {
+        add("io/matrixFile/dense", [] {
+            // Odd row counts make the leading dimension larger than the rows.
+            checkDenseRoundTrip<double>(1, 1);
+            checkDenseRoundTrip<double>(37, 11);
+            checkDenseRoundTrip<float>(13, 50);
+            checkDenseRoundTrip<double>(0, 4);
+
+            TemporaryFile tmp(".kssm");
+            const auto a = randomMatrix<double>(20, 30, 101);
+            MatrixFile::write(tmp.path(), a);
+            const MatrixFile f(tmp.path());
+            const auto block = f.denseView<double>().block(3, 5, 10, 20);
+            for (size_t j = 0; j < 20; ++j) {
+                for (size_t i = 0; i < 10; ++i) {
+                    KSSMATH_CHECK(block(i, j) == a(i + 3, j + 5));
+                }
+            }
+            KSSMATH_CHECK_THROWS(f.denseView<double>().block(15, 0, 10, 1), out_of_range);
+        });
+
+        add("io/matrixFile/sparse", [] {
+            TemporaryFile tmp(".kssm");
+            const auto a = laplacian2d<double>(12);
+            MatrixFile::write(tmp.path(), a);
+
+            const MatrixFile f(tmp.path());
+            KSSMATH_CHECK(f.kind() == MatrixFileKind::Sparse);
+            KSSMATH_CHECK(f.valueType() == MatrixFileValueType::Float64);
+            const auto view = f.sparseView<double>();
+            KSSMATH_CHECK(view.nonZeros() == a.nonZeros());
+            const auto b = view.toSparseMatrix();
+            KSSMATH_CHECK(b.rowPointers() == a.rowPointers());
+            KSSMATH_CHECK(b.columnIndices() == a.columnIndices());
+            KSSMATH_CHECK(b.values() == a.values());
+
+            const auto x = randomVector<double>(a.cols(), 102);
+            vector<double> y1(a.rows()), y2(a.rows());
+            a.multiply(x.data(), y1.data(), 1);
+            view.multiply(x.data(), y2.data(), 4);
+            KSSMATH_CHECK(y1 == y2);
+        });
+
+        add("io/matrixFile/create", [] {
+            // A file filled through a writable view reads back after reopening.
+            TemporaryFile tmp(".kssm");
+            {
+                MatrixFile f = MatrixFile::createDense<float>(tmp.path(), 5, 7);
+                const auto view = f.mutableDenseView<float>();
+                for (size_t j = 0; j < 7; ++j) {
+                    for (size_t i = 0; i < 5; ++i) {
+                        view(i, j) = float(i * 10 + j);
+                    }
+                }
+                f.sync();
+            }
+            {
+                MatrixFile f(tmp.path(), MappedFile::Mode::ReadWrite);
+                KSSMATH_CHECK(f.denseView<float>()(4, 6) == 46.0f);
+                f.mutableDenseView<float>()(4, 6) = -1.0f;
+            }
+            const MatrixFile f(tmp.path());
+            KSSMATH_CHECK(f.denseView<float>()(4, 6) == -1.0f);
+            KSSMATH_CHECK(f.denseView<float>()(3, 2) == 32.0f);
+        });
+
+        add("io/matrixFile/errors", [] {
+            TemporaryFile tmp(".kssm");
+            MatrixFile::write(tmp.path(), randomMatrix<double>(4, 4, 103));
+            MatrixFile f(tmp.path());
+            KSSMATH_CHECK_THROWS(f.denseView<float>(), invalid_argument);
+            KSSMATH_CHECK_THROWS(f.sparseView<double>(), invalid_argument);
+            KSSMATH_CHECK_THROWS(f.mutableDenseView<double>(), logic_error);
+
+            TemporaryFile garbage(".kssm");
+            writeBytes(garbage.path(), string(8192, 'x'));
+            KSSMATH_CHECK_THROWS(MatrixFile(garbage.path()), runtime_error);
+            writeBytes(garbage.path(), "KSSMATX");
+            KSSMATH_CHECK_THROWS(MatrixFile(garbage.path()), runtime_error);
+
+            TemporaryFile missing(".kssm");
+            KSSMATH_CHECK_THROWS(MatrixFile(missing.path()), system_error);
+        });
+    }
+
+    void addOutOfCoreTests() {
+        add("io/outOfCore/gemm", [] {
+            const auto a = randomMatrix<double>(70, 50, 111);
+            const auto b = randomMatrix<double>(50, 90, 112);
+            const auto c0 = randomMatrix<double>(70, 90, 113);
+            auto expected = multiply(a, b);
+            for (size_t i = 0; i < expected.size(); ++i) {
+                expected.data()[i] = 1.5 * expected.data()[i] - 0.5 * c0.data()[i];
+            }
+            for (size_t tileSize : { 16u, 33u, 200u }) {
+                for (unsigned threads : { 1u, 4u }) {
+                    auto c = c0;
+                    outOfCoreGemm(1.5, view(a), view(b), -0.5, view(c), tiles(tileSize, threads));
+                    for (size_t i = 0; i < c.size(); ++i) {
+                        KSSMATH_CHECK_CLOSE(c.data()[i], expected.data()[i], 1e-13);
+                    }
+                }
+            }
+
+            // The same through mapped files, whose leading dimensions are padded.
+            TemporaryFile fa(".kssm"), fb(".kssm"), fc(".kssm");
+            MatrixFile::write(fa.path(), a);
+            MatrixFile::write(fb.path(), b);
+            MatrixFile::write(fc.path(), c0);
+            MatrixFile c(fc.path(), MappedFile::Mode::ReadWrite);
+            outOfCoreGemm(1.5, MatrixFile(fa.path()).denseView<double>(), MatrixFile(fb.path()).denseView<double>(),
+                          -0.5, c.mutableDenseView<double>(), tiles(16, 2));
+            const auto result = c.denseView<double>().toMatrix();
+            for (size_t i = 0; i < result.size(); ++i) {
+                KSSMATH_CHECK_CLOSE(result.data()[i], expected.data()[i], 1e-13);
+            }
+
+            auto wrong = c0;
+            KSSMATH_CHECK_THROWS(outOfCoreGemm(1.0, view(b), view(a), 0.0, view(wrong)), invalid_argument);
+        });
+
+        add("io/outOfCore/cholesky", [] {
+            const size_t n = 77;
+            const auto a = randomSpdMatrix<double>(n, 114);
+            for (size_t tileSize : { 16u, 40u, 100u }) {
+                auto l = a;
+                outOfCoreCholesky(view(l), tiles(tileSize, 2));
+                for (size_t j = 0; j < n; ++j) {
+                    for (size_t i = 0; i < j; ++i) {
+                        KSSMATH_CHECK(l(i, j) == a(i, j));
+                    }
+                    for (size_t i = j; i < n; ++i) {
+                        double s = 0;
+                        for (size_t k = 0; k <= j; ++k) {
+                            s += l(i, k) * l(j, k);
+                        }
+                        KSSMATH_CHECK_CLOSE(s, a(i, j), 1e-12 * double(n));
+                    }
+                }
+            }
+
+            auto indefinite = a;
+            indefinite(50, 50) = -1;
+            KSSMATH_CHECK_THROWS(outOfCoreCholesky(view(indefinite), tiles(16, 1)), NotPositiveDefiniteError);
+            auto rectangular = randomMatrix<double>(4, 5, 115);
+            KSSMATH_CHECK_THROWS(outOfCoreCholesky(view(rectangular)), invalid_argument);
+        });
+
+        add("io/outOfCore/qr", [] {
+            // The factors are in the same form as those of the in-memory QR, and
+            // agree with them to rounding error.
+            for (size_t cols : { 40u, 90u }) {
+                const auto a = randomMatrix<double>(90, cols, 116);
+                const QR<double> expected(a);
+                for (size_t tileSize : { 16u, 100u }) {
+                    auto f = a;
+                    const auto tau = outOfCoreQR(view(f), tiles(tileSize, 2));
+                    KSSMATH_CHECK(tau.size() == cols);
+                    for (size_t i = 0; i < f.size(); ++i) {
+                        KSSMATH_CHECK_CLOSE(f.data()[i], expected.factors().data()[i], 1e-12);
+                    }
+                }
+            }
+        });
+    }
+
+    void addMatrixMarketTests() {
+        add("io/matrixMarket/roundTrip", [] {
+            // The values are written with enough digits to read back exactly.
+            TemporaryFile tmp(".mtx");
+            Matrix<double> dense = randomMatrix<double>(120, 70, 121);
+            const auto mask = randomVector<double>(dense.size(), 120);
+            for (size_t i = 0; i < dense.size(); ++i) {
+                if (mask[i] > -0.9) {
+                    dense.data()[i] = 0;
+                }
+            }
+            const SparseMatrix<double> a(dense);
+            writeMatrixMarket(tmp.path(), a, 4);
+            for (unsigned threads : { 1u, 4u }) {
+                const auto b = readSparseMatrixMarket<double>(tmp.path(), threads);
+                KSSMATH_CHECK(b.rows() == a.rows() && b.cols() == a.cols());
+                KSSMATH_CHECK(b.rowPointers() == a.rowPointers());
+                KSSMATH_CHECK(b.columnIndices() == a.columnIndices());
+                KSSMATH_CHECK(b.values() == a.values());
+            }
+
+            const auto d = randomMatrix<double>(33, 17, 122);
+            writeMatrixMarket(tmp.path(), d);
+            const auto e = readDenseMatrixMarket<double>(tmp.path(), 4);
+            KSSMATH_CHECK(e.rows() == 33 && e.cols() == 17);
+            KSSMATH_CHECK(equal(d.data(), d.data() + d.size(), e.data()));
+            const auto f = readSparseMatrixMarket<double>(tmp.path());
+            KSSMATH_CHECK(f.nonZeros() == d.size());
+        });
+
+        add("io/matrixMarket/symmetry", [] {
+            TemporaryFile tmp(".mtx");
+            writeBytes(tmp.path(),
+                       "%%MatrixMarket matrix coordinate real symmetric\n"
+                       "% a comment\n"
+                       "\n"
+                       "3 3 4\n"
+                       "1 1 2.5\n"
+                       "2 1 -1\n"
+                       "3 2 1e-3\n"
+                       "3 3 4\n");
+            const auto a = readDenseMatrixMarket<double>(tmp.path());
+            KSSMATH_CHECK(a(0, 0) == 2.5 && a(1, 0) == -1 && a(0, 1) == -1);
+            KSSMATH_CHECK(a(2, 1) == 1e-3 && a(1, 2) == 1e-3 && a(2, 2) == 4 && a(1, 1) == 0);
+            KSSMATH_CHECK(readSparseMatrixMarket<double>(tmp.path()).nonZeros() == 6);
+
+            writeBytes(tmp.path(),
+                       "%%MatrixMarket matrix coordinate real skew-symmetric\n"
+                       "2 2 1\n"
+                       "2 1 3\n");
+            const auto s = readDenseMatrixMarket<double>(tmp.path());
+            KSSMATH_CHECK(s(1, 0) == 3 && s(0, 1) == -3);
+
+            writeBytes(tmp.path(),
+                       "%%MatrixMarket matrix coordinate pattern general\n"
+                       "2 3 2\n"
+                       "1 3\n"
+                       "2 1\n");
+            const auto p = readDenseMatrixMarket<float>(tmp.path());
+            KSSMATH_CHECK(p(0, 2) == 1.0f && p(1, 0) == 1.0f && p(0, 0) == 0.0f);
+        });
+
+        add("io/matrixMarket/errors", [] {
+            TemporaryFile tmp(".mtx");
+            writeBytes(tmp.path(), "%%MatrixMarket matrix coordinate complex general\n1 1 1\n1 1 1 0\n");
+            KSSMATH_CHECK_THROWS(readSparseMatrixMarket<double>(tmp.path()), runtime_error);
+            writeBytes(tmp.path(), "not a matrix market file\n");
+            KSSMATH_CHECK_THROWS(readSparseMatrixMarket<double>(tmp.path()), runtime_error);
+            writeBytes(tmp.path(), "%%MatrixMarket matrix coordinate real general\n2 2 1\n3 1 1\n");
+            KSSMATH_CHECK_THROWS(readSparseMatrixMarket<double>(tmp.path()), runtime_error);
+            writeBytes(tmp.path(), "%%MatrixMarket matrix coordinate real general\n2 2 2\n1 1 1\n");
+            KSSMATH_CHECK_THROWS(readSparseMatrixMarket<double>(tmp.path()), runtime_error);
+
+            TemporaryFile missing(".mtx");
+            KSSMATH_CHECK_THROWS(readSparseMatrixMarket<double>(missing.path()), system_error);
+        });
+    }
+
+    void addNpyTests() {
+        add("io/npy/roundTrip", [] {
+            TemporaryFile tmp(".npy");
+            const auto a = randomMatrix<double>(13, 7, 131);
+            writeNpy(tmp.path(), a);
+            const auto arr = readNpy(tmp.path());
+            KSSMATH_CHECK(arr.valueType() == NpyValueType::Float64);
+            KSSMATH_CHECK(arr.isFortranOrder() && arr.isZeroCopy());
+            KSSMATH_CHECK(arr.rows() == 13 && arr.cols() == 7);
+            const auto v = arr.denseView<double>();
+            for (size_t j = 0; j < 7; ++j) {
+                for (size_t i = 0; i < 13; ++i) {
+                    KSSMATH_CHECK(v(i, j) == a(i, j));
+                }
+            }
+            const auto f = arr.toMatrix<float>();
+            KSSMATH_CHECK(f(12, 6) == float(a(12, 6)));
+            KSSMATH_CHECK_THROWS(arr.denseView<float>(), invalid_argument);
+
+            const auto b = randomMatrix<float>(1, 9, 132);
+            writeNpy(tmp.path(), b);
+            const auto c = readNpy(tmp.path()).toMatrix<float>();
+            KSSMATH_CHECK(equal(b.data(), b.data() + b.size(), c.data()));
+        });
+
+        add("io/npy/cOrder", [] {
+            // As written by numpy.save of an int32 array of shape (2, 3).
+            TemporaryFile tmp(".npy");
+            string data;
+            for (int32_t x : { 1, 2, 3, 4, 5, 6 }) {
+                for (int b = 0; b < 4; ++b) {
+                    data += char((uint32_t(x) >> (8 * b)) & 0xff);
+                }
+            }
+            writeBytes(tmp.path(), npyFile("{'descr': '<i4', 'fortran_order': False, 'shape': (2, 3), }", data));
+            const auto arr = readNpy(tmp.path());
+            KSSMATH_CHECK(arr.valueType() == NpyValueType::Int32);
+            KSSMATH_CHECK(!arr.isFortranOrder());
+            const auto a = arr.toMatrix<double>();
+            KSSMATH_CHECK(a.rows() == 2 && a.cols() == 3);
+            KSSMATH_CHECK(a(0, 0) == 1 && a(0, 2) == 3 && a(1, 0) == 4 && a(1, 2) == 6);
+            KSSMATH_CHECK_THROWS(arr.denseView<double>(), invalid_argument);
+
+            writeBytes(tmp.path(), npyFile("{'descr': '<f8', 'fortran_order': False, 'shape': (2, 2, 2), }",
+                                           string(64, '\0')));
+            KSSMATH_CHECK_THROWS(readNpy(tmp.path()).rows(), invalid_argument);
+        });
+
+        add("io/npz/roundTrip", [] {
+            TemporaryFile tmp(".npz");
+            map<string, Matrix<double>> arrays;
+            arrays["a"] = randomMatrix<double>(5, 4, 133);
+            arrays["weights"] = randomMatrix<double>(100, 3, 134);
+            writeNpz(tmp.path(), arrays);
+            const auto read = readNpz(tmp.path());
+            KSSMATH_CHECK(read.size() == 2);
+            for (const auto& a : arrays) {
+                const auto& arr = read.at(a.first);
+                KSSMATH_CHECK(arr.isZeroCopy());
+                const auto m = arr.toMatrix<double>();
+                KSSMATH_CHECK(m.rows() == a.second.rows() && m.cols() == a.second.cols());
+                KSSMATH_CHECK(equal(m.data(), m.data() + m.size(), a.second.data()));
+            }
+        });
+
+        add("io/npy/errors", [] {
+            TemporaryFile tmp(".npy");
+            writeBytes(tmp.path(), string(100, 'x'));
+            KSSMATH_CHECK_THROWS(readNpy(tmp.path()), runtime_error);
+            KSSMATH_CHECK_THROWS(readNpz(tmp.path()), runtime_error);
+            writeBytes(tmp.path(), npyFile("{'descr': '<c16', 'fortran_order': True, 'shape': (1,), }",
+                                           string(16, '\0')));
+            KSSMATH_CHECK_THROWS(readNpy(tmp.path()), runtime_error);
+            writeBytes(tmp.path(), npyFile("{'descr': '<f8', 'fortran_order': True, 'shape': (4,), }",
+                                           string(16, '\0')));
+            KSSMATH_CHECK_THROWS(readNpy(tmp.path()), runtime_error);
+
+            TemporaryFile missing(".npy");
+            KSSMATH_CHECK_THROWS(readNpy(missing.path()), system_error);
+
+            // A zip64 extra field too short for the three values it must hold.
+            TemporaryFile zip(".npz");
+            writeBytes(zip.path(), zip64Archive(8));
+            try {
+                readNpz(zip.path());
+                KSSMATH_CHECK(false);
+            }
+            catch (const runtime_error& e) {
+                KSSMATH_CHECK(string(e.what()).find("zip64 extra field") != string::npos);
+            }
+            writeBytes(zip.path(), zip64Archive(24));
+            KSSMATH_CHECK_THROWS(readNpz(zip.path()), runtime_error);
+        });
+    }
+
+}
+
+
+void kss::math::test::addIoTests() {
+    addMatrixFileTests();
+    addOutOfCoreTests();
+    addMatrixMarketTests();
+    addNpyTests();
+}
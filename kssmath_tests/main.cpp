@@ -0,0 +1,77 @@
+//
+//  main.cpp
+//  kssmath_tests
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <string>
+
+#include "test.hpp"
+
+using namespace std;
+using namespace kss::math::test;
+
+
+namespace {
+
+    const char* usage =
+    "usage: kssmath_tests [options]\n"
+    "\n"
+    "Runs the kssmath tests, printing a line per test, and exits with a non-zero\n"
+    "status if any fail.\n"
+    "\n"
+    "options:\n"
+    "  --filter=REGEX       run only the tests whose names match REGEX\n"
+    "  --list               list the tests and exit\n";
+
+}
+
+
+int main(int argc, const char* argv[]) {
+    addDenseTests();
+    addIoTests();
+    addOptimizationTests();
+    addSparseTests();
+    addSystemTests();
+
+    try {
+        string filter;
+        bool list = false;
+
+        for (int i = 1; i < argc; ++i) {
+            const char* arg = argv[i];
+            if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0) {
+                cout << usage;
+                return 0;
+            }
+            else if (strcmp(arg, "--list") == 0) {
+                list = true;
+            }
+            else if (strncmp(arg, "--filter=", 9) == 0) {
+                filter = arg + 9;
+            }
+            else {
+                cerr << "kssmath_tests: unknown option " << arg << "\n\n" << usage;
+                return 2;
+            }
+        }
+
+        if (list) {
+            for (const auto& name : names()) {
+                cout << name << endl;
+            }
+            return 0;
+        }
+        return (run(filter, cout) == 0 ? 0 : 1);
+    }
+    catch (const exception& e) {
+        cerr << "kssmath_tests: " << e.what() << endl;
+        return 2;
+    }
+}
@@ -0,0 +1,652 @@
+//
+//  optimization_tests.cpp
+//  kssmath_tests
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "kssmath/derivative_free.hpp"
+#include "kssmath/dual.hpp"
+#include "kssmath/lbfgs.hpp"
+#include "kssmath/tape.hpp"
+#include "kssmath/workspace.hpp"
+
+#include "test.hpp"
+
+using namespace std;
+using namespace kss::math;
+using namespace kss::math::test;
+
+
+namespace {
+
+    // A function of 8 variables that uses every elementary function, written
+    // for any number type.
+    template <class V>
+    V elementary(const vector<V>& x) {
+        using std::abs; using std::acos; using std::asin; using std::atan; using std::atan2;
+        using std::cbrt; using std::cos; using std::cosh; using std::erf; using std::exp;
+        using std::expm1; using std::fmax; using std::fmin; using std::hypot; using std::log;
+        using std::log10; using std::log1p; using std::pow; using std::sin; using std::sinh;
+        using std::sqrt; using std::tan; using std::tanh;
+
+        V y = sin(x[0]) * exp(x[1]) + x[2] / (1.0 + x[3] * x[3]) + log1p(x[4] * x[4]);
+        y += sqrt(1.0 + x[5] * x[5]) + pow(x[6] * x[6] + 1.0, 1.5) + atan2(x[7], x[0] + 2.0);
+        y += tanh(x[1] * x[2]) + hypot(x[3], x[4]) + cbrt(2.0 + x[5]) + erf(x[6]) + 0.1 * cosh(x[7]);
+        y += fmax(x[0], x[1]) - fmin(x[2], x[3]) + log(2.0 + cos(x[2]));
+        y += asin(0.5 * tanh(x[3])) + acos(0.5 * tanh(x[4])) + atan(x[5]) + tan(0.3 * x[6]);
+        y += sinh(0.2 * x[7]) + expm1(0.1 * x[0]) + log10(3.0 + x[1] * x[1]) + abs(x[2] - 5.0);
+        y += pow(1.5, x[3]) + pow(x[4] * x[4] + 1.0, 0.2 * x[5]) - 2.0 / (3.0 + x[6]);
+        y -= x[7] - 1.0;
+        y *= 0.5;
+        y /= 1.5;
+        return y;
+    }
+
+    // The Rosenbrock function of n variables, whose Hessian is badly
+    // conditioned near the minimum at (1, ..., 1).
+    template <class V>
+    V rosenbrock(const vector<V>& x) {
+        V y = 0.0;
+        for (size_t i = 0; i + 1 < x.size(); ++i) {
+            const V a = x[i + 1] - x[i] * x[i], b = 1.0 - x[i];
+            y += 100.0 * a * a + b * b;
+        }
+        return y;
+    }
+
+    // Returns the gradient of f at x by central differences, which is
+    // accurate to about 1e-10 for smooth functions of order one.
+    vector<double> finiteDifferences(const function<double(const vector<double>&)>& f, vector<double> x) {
+        vector<double> g(x.size());
+        for (size_t i = 0; i < x.size(); ++i) {
+            const double xi = x[i], h = 1e-6 * max(1.0, abs(xi));
+            x[i] = xi + h;
+            const double up = f(x);
+            x[i] = xi - h;
+            const double down = f(x);
+            x[i] = xi;
+            g[i] = (up - down) / (2 * h);
+        }
+        return g;
+    }
+
+    void checkGradient(const vector<double>& g, const vector<double>& expected, double tolerance) {
+        KSSMATH_CHECK(g.size() == expected.size());
+        for (size_t i = 0; i < g.size(); ++i) {
+            KSSMATH_CHECK_CLOSE(g[i], expected[i], tolerance * max(1.0, abs(expected[i])));
+        }
+    }
+
+    // A sum of weighted Huber functions of x[i] - centre[i]: quadratic within
+    // 0.5 of the centre and linear beyond, so that steps in the linear parts
+    // give correction pairs without curvature, which lbfgs must reject.
+    double huber(const vector<double>& centre, const double* x, double* g) {
+        double y = 0.0;
+        for (size_t i = 0; i < centre.size(); ++i) {
+            const double r = x[i] - centre[i], w = 1.0 + 0.25 * double(i);
+            if (abs(r) <= 0.5) {
+                y += w * 0.5 * r * r;
+                g[i] = w * r;
+            }
+            else {
+                y += w * 0.5 * (abs(r) - 0.25);
+                g[i] = (r > 0.0 ? w * 0.5 : -w * 0.5);
+            }
+        }
+        return y;
+    }
+
+    void addDualTests() {
+        add("optimization/dual/elementary", [] {
+            // Each derivative against its formula, away from the edges of the
+            // domains.
+            using D = Dual<double>;
+            const double x = 0.3;
+            const D v(x, 0);
+            auto check = [](const D& y, double value, double derivative) {
+                KSSMATH_CHECK_CLOSE(y.value(), value, 1e-15);
+                KSSMATH_CHECK_CLOSE(y.derivative(0), derivative, 1e-14);
+            };
+            check(sqrt(v), sqrt(x), 0.5 / sqrt(x));
+            check(cbrt(v), cbrt(x), 1.0 / (3 * cbrt(x) * cbrt(x)));
+            check(exp(v), exp(x), exp(x));
+            check(expm1(v), expm1(x), exp(x));
+            check(log(v), log(x), 1 / x);
+            check(log1p(v), log1p(x), 1 / (1 + x));
+            check(log10(v), log10(x), 1 / (x * log(10.0)));
+            check(sin(v), sin(x), cos(x));
+            check(cos(v), cos(x), -sin(x));
+            check(tan(v), tan(x), 1 / (cos(x) * cos(x)));
+            check(asin(v), asin(x), 1 / sqrt(1 - x * x));
+            check(acos(v), acos(x), -1 / sqrt(1 - x * x));
+            check(atan(v), atan(x), 1 / (1 + x * x));
+            check(sinh(v), sinh(x), cosh(x));
+            check(cosh(v), cosh(x), sinh(x));
+            check(tanh(v), tanh(x), 1 - tanh(x) * tanh(x));
+            check(erf(v), erf(x), 2 / sqrt(acos(-1.0)) * exp(-x * x));
+            check(abs(-v), x, 1);
+            check(fabs(v), x, 1);
+            check(pow(v, 2.5), pow(x, 2.5), 2.5 * pow(x, 1.5));
+            check(pow(2.0, v), pow(2.0, x), pow(2.0, x) * log(2.0));
+            check(pow(v, v), pow(x, x), pow(x, x) * (log(x) + 1));
+            check(atan2(v, D(2.0)), atan2(x, 2.0), 2 / (4 + x * x));
+            check(hypot(v, D(0.4)), 0.5, x / 0.5);
+            check(1.0 / v, 1 / x, -1 / (x * x));
+            check(2.0 - v * v, 2 - x * x, -2 * x);
+
+            // The edge cases that the chain rule would make NaN.
+            KSSMATH_CHECK(pow(D(0.0, 0), 2.0).derivative(0) == 0);
+            KSSMATH_CHECK(pow(0.0, D(2.0, 0)).derivative(0) == 0);
+            KSSMATH_CHECK(pow(D(0.0, 0), D(2.0)).derivative(0) == 0);
+            KSSMATH_CHECK(hypot(D(0.0, 0), D(0.0)).derivative(0) == 0);
+            KSSMATH_CHECK(pow(D(3.0, 0), 0.0).derivative(0) == 0);
+        });
+
+        add("optimization/dual/gradient", [] {
+            // The forward mode gradient against finite differences, for any
+            // number of directions at a time.
+            const auto x = randomVector<double>(8, 101);
+            const auto expected = finiteDifferences(elementary<double>, x);
+            for (int variant = 0; variant < 4; ++variant) {
+                vector<double> g(x.size());
+                const auto f = [](const auto& v) { return elementary(v); };
+                double value = 0;
+                switch (variant) {
+                case 0: value = gradient<1>(f, x.data(), x.size(), g.data()); break;
+                case 1: value = gradient<3>(f, x.data(), x.size(), g.data()); break;
+                case 2: value = gradient<4>(f, x.data(), x.size(), g.data()); break;
+                default: value = gradient<16>(f, x.data(), x.size(), g.data()); break;
+                }
+                KSSMATH_CHECK_CLOSE(value, elementary(x), 1e-14);
+                checkGradient(g, expected, 1e-8);
+            }
+
+            const auto r = randomVector<double>(20, 102);
+            vector<double> g(r.size());
+            const double value = gradient<4>([](const auto& v) { return rosenbrock(v); }, r.data(), r.size(), g.data());
+            KSSMATH_CHECK_CLOSE(value, rosenbrock(r), 1e-12);
+            // The gradient of the Rosenbrock function, directly.
+            vector<double> exact(r.size(), 0.0);
+            for (size_t i = 0; i + 1 < r.size(); ++i) {
+                const double a = r[i + 1] - r[i] * r[i];
+                exact[i] += -400 * r[i] * a - 2 * (1 - r[i]);
+                exact[i + 1] += 200 * a;
+            }
+            checkGradient(g, exact, 1e-13);
+        });
+
+        add("optimization/dual/derivative", [] {
+            double d = 0;
+            const double y = derivative([](auto t) { using std::sin; return t * sin(t); }, 2.0, d);
+            KSSMATH_CHECK_CLOSE(y, 2 * sin(2.0), 1e-15);
+            KSSMATH_CHECK_CLOSE(d, sin(2.0) + 2 * cos(2.0), 1e-15);
+
+            // Comparisons use the value, so a branch differentiates the side
+            // taken.
+            const auto relu = [](auto t) { return (t > 0.0 ? t : 0.0 * t); };
+            derivative(relu, 0.5, d);
+            KSSMATH_CHECK(d == 1);
+            derivative(relu, -0.5, d);
+            KSSMATH_CHECK(d == 0);
+
+            KSSMATH_CHECK_THROWS((Dual<double, 2>(1.0, 2)), out_of_range);
+            Dual<float, 4> seeded(1.0f);
+            fill(seeded.derivatives(), seeded.derivatives() + 4, 0.5f);
+            KSSMATH_CHECK((seeded * seeded).derivative(3) == 1.0f);
+            KSSMATH_CHECK((Dual<double, 4>::size() == 4));
+        });
+    }
+
+    // A step of a damped nonlinear oscillator, state (x, v, k), where the
+    // stiffness k is carried in the state so that it can be differentiated.
+    template <class V>
+    void oscillatorStep(vector<V>& s, size_t step) {
+        using std::sin;
+        const double dt = 0.01 * (1.0 + 0.1 * double(step % 3));
+        const V a = -s[2] * sin(s[0]) - 0.1 * s[1];
+        s[1] = s[1] + dt * a;
+        s[0] = s[0] + dt * s[1];
+    }
+
+    // Returns x + v after the given number of steps from (x, v, k).
+    double oscillator(const vector<double>& initial, size_t steps) {
+        auto s = initial;
+        for (size_t k = 0; k < steps; ++k) {
+            oscillatorStep(s, k);
+        }
+        return s[0] + s[1];
+    }
+
+    void addTapeTests() {
+        add("optimization/tape/gradient", [] {
+            // Reverse mode agrees with forward mode to rounding, and both with
+            // finite differences.
+            const auto x = randomVector<double>(8, 111);
+            vector<double> g(x.size()), forward(x.size());
+            const double value = reverseGradient([](const auto& v) { return elementary(v); }, x.data(), x.size(), g.data());
+            gradient<4>([](const auto& v) { return elementary(v); }, x.data(), x.size(), forward.data());
+            KSSMATH_CHECK_CLOSE(value, elementary(x), 1e-14);
+            checkGradient(g, forward, 1e-14);
+            checkGradient(g, finiteDifferences(elementary<double>, x), 1e-8);
+
+            const auto r = randomVector<double>(50, 112);
+            vector<double> gr(r.size()), fr(r.size());
+            reverseGradient([](const auto& v) { return rosenbrock(v); }, r.data(), r.size(), gr.data());
+            gradient<8>([](const auto& v) { return rosenbrock(v); }, r.data(), r.size(), fr.data());
+            checkGradient(gr, fr, 1e-14);
+        });
+
+        add("optimization/tape/recording", [] {
+            Tape<double> tape;
+            const auto x = randomVector<double>(8, 113);
+            vector<TapeValue<double>> v;
+            for (double xi : x) {
+                v.push_back(tape.variable(xi));
+            }
+            KSSMATH_CHECK(tape.inputs() == 8 && tape.size() >= 8);
+            const auto y = elementary(v);
+            KSSMATH_CHECK(y.tape() == &tape && TapeValue<double>(1.0).tape() == nullptr);
+            KSSMATH_CHECK_CLOSE(y.value(), elementary(x), 1e-14);
+            tape.computeAdjoints(y);
+            vector<double> g(8);
+            tape.gradient(g.data());
+            checkGradient(g, finiteDifferences(elementary<double>, x), 1e-8);
+            KSSMATH_CHECK(tape.adjoint(v[3]) == g[3] && tape.adjoint(TapeValue<double>(2.0)) == 0);
+
+            // Replaying at new inputs gives what recording again would.
+            for (uint64_t seed = 114; seed < 120; ++seed) {
+                const auto z = randomVector<double>(8, seed);
+                KSSMATH_CHECK(tape.replay(z.data()));
+                KSSMATH_CHECK_CLOSE(tape.value(y), elementary(z), 1e-14);
+                tape.computeAdjoints(y);
+                tape.gradient(g.data());
+                vector<double> fresh(8);
+                reverseGradient([](const auto& w) { return elementary(w); }, z.data(), z.size(), fresh.data());
+                checkGradient(g, fresh, 1e-14);
+            }
+
+            // Clearing keeps nothing, and a value from another tape is refused.
+            tape.clear();
+            KSSMATH_CHECK(tape.size() == 0 && tape.inputs() == 0);
+            const auto a = tape.variable(2.0);
+            Tape<double> other;
+            const auto b = other.variable(3.0);
+            KSSMATH_CHECK_THROWS(tape.computeAdjoints(b * b), invalid_argument);
+            const auto c = a * a;
+            tape.computeAdjoints(c);
+            KSSMATH_CHECK(tape.adjoint(a) == 4);
+        });
+
+        add("optimization/tape/replayBranch", [] {
+            // A replay that would take the other side of a comparison fails.
+            Tape<double> tape;
+            const auto x = tape.variable(0.5);
+            const auto y = (x > 0.0 ? x * x : -x);
+            tape.computeAdjoints(y);
+            KSSMATH_CHECK(tape.adjoint(x) == 1.0);
+            double input = 2.0;
+            KSSMATH_CHECK(tape.replay(&input));
+            KSSMATH_CHECK(tape.value(y) == 4.0);
+            input = -1.0;
+            KSSMATH_CHECK(!tape.replay(&input));
+
+            // fmin and fmax are operations, so a replay can switch sides.
+            Tape<double> t2;
+            const auto p = t2.variable(1.0), q = t2.variable(2.0);
+            const auto m = fmin(p, q) * 3.0;
+            const double swapped[2] = { 5.0, 4.0 };
+            KSSMATH_CHECK(t2.replay(swapped));
+            KSSMATH_CHECK(t2.value(m) == 12.0);
+            t2.computeAdjoints(m);
+            KSSMATH_CHECK(t2.adjoint(p) == 0.0 && t2.adjoint(q) == 3.0);
+        });
+
+        add("optimization/tape/vectorJacobian", [] {
+            // The adjoints for a weighted sum of outputs are the weighted sum of
+            // the gradients.
+            Tape<double> tape;
+            const auto x = tape.variable(0.7), y = tape.variable(-0.3);
+            const TapeValue<double> outputs[3] = { x * y, sin(x) + y, TapeValue<double>(5.0) };
+            const double seeds[3] = { 2.0, -1.0, 7.0 };
+            tape.computeAdjoints(outputs, seeds, 3);
+            KSSMATH_CHECK_CLOSE(tape.adjoint(x), 2 * -0.3 - cos(0.7), 1e-15);
+            KSSMATH_CHECK_CLOSE(tape.adjoint(y), 2 * 0.7 - 1, 1e-15);
+        });
+
+        add("optimization/tape/checkpointedLoop", [] {
+            // The gradient through a checkpointed loop matches recording every
+            // step, for any interval, and survives a replay.
+            const size_t steps = 200;
+            const vector<double> initial = { 0.8, -0.2, 3.0 };
+            const auto expected = finiteDifferences([&](const vector<double>& s) { return oscillator(s, steps); },
+                                                    initial);
+
+            Tape<double> direct;
+            vector<TapeValue<double>> ds;
+            for (double v : initial) {
+                ds.push_back(direct.variable(v));
+            }
+            for (size_t k = 0; k < steps; ++k) {
+                oscillatorStep(ds, k);
+            }
+            const auto dy = ds[0] + ds[1];
+            direct.computeAdjoints(dy);
+            vector<double> dg(3);
+            direct.gradient(dg.data());
+            checkGradient(dg, expected, 1e-7);
+
+            for (size_t interval : { size_t(0), size_t(1), size_t(7), size_t(64), steps, steps + 5 }) {
+                Tape<double> tape;
+                vector<TapeValue<double>> s;
+                for (double v : initial) {
+                    s.push_back(tape.variable(v));
+                }
+                tape.checkpointedLoop(s, steps, [](auto& state, size_t k) { oscillatorStep(state, k); }, interval);
+                const auto y = s[0] + s[1];
+                KSSMATH_CHECK(tape.size() < direct.size());
+                KSSMATH_CHECK_CLOSE(y.value(), dy.value(), 1e-14);
+                tape.computeAdjoints(y);
+                vector<double> g(3);
+                tape.gradient(g.data());
+                checkGradient(g, dg, 1e-12);
+
+                const double moved[3] = { 0.5, 0.1, 2.0 };
+                KSSMATH_CHECK(tape.replay(moved));
+                KSSMATH_CHECK_CLOSE(tape.value(y), oscillator({ 0.5, 0.1, 2.0 }, steps), 1e-14);
+                tape.computeAdjoints(y);
+                tape.gradient(g.data());
+                checkGradient(g, finiteDifferences([&](const vector<double>& v) { return oscillator(v, steps); },
+                                                   { 0.5, 0.1, 2.0 }), 1e-7);
+            }
+
+            Tape<double> tape, other;
+            vector<TapeValue<double>> foreign = { other.variable(1.0) };
+            KSSMATH_CHECK_THROWS(tape.checkpointedLoop(foreign, 3, [](auto&, size_t) {}), invalid_argument);
+            vector<TapeValue<double>> s = { tape.variable(1.0) };
+            KSSMATH_CHECK_THROWS(tape.checkpointedLoop(s, 3, [](auto& state, size_t) { state.push_back(state[0]); }),
+                                 invalid_argument);
+        });
+    }
+
+
+    void addLbfgsTests() {
+        add("optimization/lbfgs/rosenbrock", [] {
+            const size_t n = 20;
+            vector<double> x(n);
+            for (size_t i = 0; i < n; ++i) {
+                x[i] = (i % 2 == 0 ? -1.2 : 1.0);
+            }
+            auto f = [](const double* v, double* g) {
+                return reverseGradient([](const auto& a) { return rosenbrock(a); }, v, 20, g);
+            };
+            for (size_t history : { 1, 6, 20 }) {
+                vector<double> v = x;
+                LbfgsOptions opts;
+                opts.history = history;
+                opts.gradientTolerance = 1e-8;
+                opts.functionTolerance = 0.0;
+                opts.maxIterations = 5000;
+                const auto res = lbfgs(f, v, opts);
+                KSSMATH_CHECK(res.converged);
+                KSSMATH_CHECK(res.gradientNorm <= 1e-8);
+                KSSMATH_CHECK(res.evaluations >= res.iterations);
+                for (size_t i = 0; i < n; ++i) {
+                    KSSMATH_CHECK_CLOSE(v[i], 1.0, 1e-6);
+                }
+            }
+        });
+
+        add("optimization/lbfgs/quadratic", [] {
+            // 1/2 x'Ax - b'x, minimized where Ax = b.
+            const size_t n = 40;
+            const auto a = randomSpdMatrix<double>(n, 31);
+            const auto b = randomVector<double>(n, 32);
+            auto f = [&](const double* x, double* g) {
+                const vector<double> ax = multiply(a, vector<double>(x, x + n));
+                double y = 0.0;
+                for (size_t i = 0; i < n; ++i) {
+                    g[i] = ax[i] - b[i];
+                    y += x[i] * (0.5 * ax[i] - b[i]);
+                }
+                return y;
+            };
+            LbfgsOptions opts;
+            opts.gradientTolerance = 1e-10;
+            opts.functionTolerance = 0.0;
+            vector<double> x(n, 0.0);
+            KSSMATH_CHECK(lbfgs(f, x, opts).converged);
+            KSSMATH_CHECK(relativeResidual(a, x, b) <= 1e-9);
+
+            // A diagonal one with a condition number of 1e6, which needs a
+            // history as long as the number of variables to converge quickly.
+            auto g = [](const double* x, double* grad) {
+                double y = 0.0;
+                for (size_t i = 0; i < 10; ++i) {
+                    const double d = pow(10.0, 6.0 * double(i) / 9.0);
+                    grad[i] = d * (x[i] - double(i));
+                    y += 0.5 * d * (x[i] - double(i)) * (x[i] - double(i));
+                }
+                return y;
+            };
+            vector<double> z(10, 1.0);
+            opts.history = 10;
+            opts.gradientTolerance = 1e-8;
+            const auto res = lbfgs(g, z, opts);
+            KSSMATH_CHECK(res.converged);
+            for (size_t i = 0; i < 10; ++i) {
+                KSSMATH_CHECK_CLOSE(z[i], double(i), 1e-6);
+            }
+        });
+
+        add("optimization/lbfgs/bounds", [] {
+            // The minimizer of the separable huber function in a box is each
+            // centre moved into the box. The linear parts reject correction
+            // pairs with the history full, and the steps end on the bounds.
+            const vector<double> centre = { 3.0, -2.0, 4.0, -1.0, 0.5, 2.5 };
+            const vector<double> lower(6, -10.0), upper = { 2.0, 10.0, 3.0, 10.0, 0.0, 10.0 };
+            auto f = [&](const double* x, double* g) { return huber(centre, x, g); };
+            vector<double> expected(6), g(6);
+            for (size_t i = 0; i < 6; ++i) {
+                expected[i] = max(lower[i], min(upper[i], centre[i]));
+            }
+            const double minimum = huber(centre, expected.data(), g.data());
+
+            const vector<vector<double>> starts = {
+                { -5.0, 5.0, 6.0, -7.0, 8.0, 1.0 },
+                { 20.0, -15.0, -18.0, 12.0, 9.0, -7.0 },
+                { 8.0, 8.0, 8.0, 8.0, 8.0, 8.0 }
+            };
+            for (const auto& start : starts) {
+                for (size_t history : { 1, 2, 3, 5 }) {
+                    LbfgsOptions opts;
+                    opts.history = history;
+                    vector<double> x = start;
+                    const auto res = lbfgsb(f, x, lower, upper, opts);
+                    KSSMATH_CHECK(res.converged);
+                    KSSMATH_CHECK_CLOSE(res.value, minimum, 1e-8);
+                    for (size_t i = 0; i < 6; ++i) {
+                        KSSMATH_CHECK(x[i] >= lower[i] && x[i] <= upper[i]);
+                        KSSMATH_CHECK_CLOSE(x[i], expected[i], 1e-4);
+                    }
+                }
+            }
+
+            // Unbounded sides, and a start outside the box.
+            const double inf = numeric_limits<double>::infinity();
+            vector<double> x(6, 50.0);
+            const auto res = lbfgsb(f, x, vector<double>(6, -inf), vector<double>(6, 1.0));
+            KSSMATH_CHECK(res.converged);
+            for (size_t i = 0; i < 6; ++i) {
+                KSSMATH_CHECK_CLOSE(x[i], min(1.0, centre[i]), 1e-4);
+            }
+        });
+
+        add("optimization/lbfgs/workspace", [] {
+            auto f = [](const double* v, double* g) {
+                return reverseGradient([](const auto& a) { return rosenbrock(a); }, v, 8, g);
+            };
+            const vector<double> start = { -1.2, 1.0, -1.2, 1.0, -1.2, 1.0, -1.2, 1.0 };
+            vector<double> x = start, y = start;
+            const auto heap = lbfgs(f, x);
+
+            Workspace ws;
+            LbfgsOptions opts;
+            opts.workspace = &ws;
+            for (int i = 0; i < 2; ++i) {
+                y = start;
+                const auto res = lbfgs(f, y, opts);
+                KSSMATH_CHECK(x == y);
+                KSSMATH_CHECK(res.iterations == heap.iterations);
+                KSSMATH_CHECK(res.evaluations == heap.evaluations);
+                KSSMATH_CHECK(ws.used() == 0);
+            }
+        });
+
+        add("optimization/lbfgs/errors", [] {
+            auto f = [](const double* v, double* g) { g[0] = 2.0 * v[0]; return v[0] * v[0]; };
+            vector<double> x = { 1.0 };
+            LbfgsOptions opts;
+            opts.history = 0;
+            KSSMATH_CHECK_THROWS(lbfgs(f, x, opts), invalid_argument);
+            KSSMATH_CHECK_THROWS(lbfgsb(f, x, { 0.0, 0.0 }, { 1.0, 1.0 }), invalid_argument);
+            KSSMATH_CHECK_THROWS(lbfgsb(f, x, { 1.0 }, { 0.0 }), invalid_argument);
+
+            auto nan = [](const double*, double* g) { g[0] = 0.0; return numeric_limits<double>::quiet_NaN(); };
+            KSSMATH_CHECK_THROWS(lbfgs(nan, x), domain_error);
+
+            // Already at the minimum.
+            x = { 0.0 };
+            const auto res = lbfgs(f, x);
+            KSSMATH_CHECK(res.converged);
+            KSSMATH_CHECK(res.iterations == 0);
+            KSSMATH_CHECK(res.evaluations == 1);
+        });
+    }
+
+
+    void addDerivativeFreeTests() {
+        add("optimization/parallelBatch/values", [] {
+            auto f = parallelBatch([](const double* v) { return rosenbrock(vector<double>(v, v + 3)); }, 3, 4);
+            const auto points = randomVector<double>(3 * 50, 41);
+            vector<double> values(50);
+            f(points.data(), size_t(50), values.data());
+            for (size_t k = 0; k < 50; ++k) {
+                const vector<double> v(points.begin() + 3 * k, points.begin() + 3 * k + 3);
+                KSSMATH_CHECK(values[k] == rosenbrock(v));
+            }
+        });
+
+        add("optimization/nelderMead/quadratic", [] {
+            // Every number of parallel vertices in a few dimensions, including
+            // n and more, which used to stall well short of the minimum, and up
+            // to n/2 in more.
+            for (size_t n : { 1, 2, 3, 8 }) {
+                auto f = parallelBatch([n](const double* v) {
+                    double y = 0.0;
+                    for (size_t i = 0; i < n; ++i) {
+                        y += double(i + 1) * (v[i] - 1.0) * (v[i] - 1.0);
+                    }
+                    return y;
+                }, n);
+                for (size_t p = 1; p <= (n > 3 ? n / 2 : n + 1); ++p) {
+                    for (bool speculative : { true, false }) {
+                        NelderMeadOptions opts;
+                        opts.parallelVertices = p;
+                        opts.speculative = speculative;
+                        vector<double> x(n, 0.0);
+                        const auto res = nelderMead(f, x, opts);
+                        KSSMATH_CHECK(res.converged);
+                        KSSMATH_CHECK(res.value <= 1e-10);
+                        KSSMATH_CHECK(res.evaluations <= opts.maxEvaluations);
+                        for (size_t i = 0; i < n; ++i) {
+                            KSSMATH_CHECK_CLOSE(x[i], 1.0, 1e-4);
+                        }
+                    }
+                }
+            }
+        });
+
+        add("optimization/nelderMead/rosenbrock", [] {
+            auto f = parallelBatch([](const double* v) { return rosenbrock(vector<double>(v, v + 2)); }, 2);
+            for (size_t p : { 1, 2 }) {
+                for (bool adaptive : { true, false }) {
+                    NelderMeadOptions opts;
+                    opts.parallelVertices = p;
+                    opts.adaptive = adaptive;
+                    vector<double> x = { -1.2, 1.0 };
+                    const auto res = nelderMead(f, x, opts);
+                    KSSMATH_CHECK(res.converged);
+                    KSSMATH_CHECK(res.value <= 1e-10);
+                    KSSMATH_CHECK_CLOSE(x[0], 1.0, 1e-4);
+                    KSSMATH_CHECK_CLOSE(x[1], 1.0, 1e-4);
+                }
+            }
+
+            vector<double> x;
+            KSSMATH_CHECK_THROWS(nelderMead(f, x), invalid_argument);
+            x = { 0.0, 0.0 };
+            NelderMeadOptions opts;
+            opts.parallelVertices = 0;
+            KSSMATH_CHECK_THROWS(nelderMead(f, x, opts), invalid_argument);
+        });
+
+        add("optimization/cmaes/minimize", [] {
+            auto sphere = parallelBatch([](const double* v) {
+                double y = 0.0;
+                for (size_t i = 0; i < 10; ++i) {
+                    y += (v[i] - 0.5) * (v[i] - 0.5);
+                }
+                return y;
+            }, 10);
+            vector<double> x(10, 2.0);
+            CmaesOptions opts;
+            opts.initialStep = 1.0;
+            const auto res = cmaes(sphere, x, opts);
+            KSSMATH_CHECK(res.converged);
+            KSSMATH_CHECK(res.value <= 1e-10);
+            for (size_t i = 0; i < 10; ++i) {
+                KSSMATH_CHECK_CLOSE(x[i], 0.5, 1e-4);
+            }
+
+            // The same seed gives the same search.
+            vector<double> y(10, 2.0);
+            const auto again = cmaes(sphere, y, opts);
+            KSSMATH_CHECK(x == y);
+            KSSMATH_CHECK(again.evaluations == res.evaluations);
+
+            auto f = parallelBatch([](const double* v) { return rosenbrock(vector<double>(v, v + 4)); }, 4);
+            vector<double> z(4, 0.0);
+            opts.initialStep = 0.5;
+            KSSMATH_CHECK(cmaes(f, z, opts).value <= 1e-10);
+            for (size_t i = 0; i < 4; ++i) {
+                KSSMATH_CHECK_CLOSE(z[i], 1.0, 1e-4);
+            }
+
+            vector<double> empty;
+            KSSMATH_CHECK_THROWS(cmaes(f, empty), invalid_argument);
+            opts.initialStep = 0.0;
+            KSSMATH_CHECK_THROWS(cmaes(f, z, opts), invalid_argument);
+        });
+    }
+
+}
+
+
+void kss::math::test::addOptimizationTests() {
+    addDualTests();
+    addTapeTests();
+    addLbfgsTests();
+    addDerivativeFreeTests();
+}
@@ -0,0 +1,752 @@
+//
+//  sparse_tests.cpp
+//  kssmath_tests
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "kssmath/amg.hpp"
+#include "kssmath/block_sparse_matrix.hpp"
+#include "kssmath/cholesky.hpp"
+#include "kssmath/conjugate_gradient.hpp"
+#include "kssmath/error.hpp"
+#include "kssmath/krylov_eigen.hpp"
+#include "kssmath/linear_operator.hpp"
+#include "kssmath/sliced_ell_matrix.hpp"
+#include "kssmath/sparse_direct.hpp"
+#include "kssmath/sparse_product.hpp"
+#include "kssmath/symmetric_eigen.hpp"
+#include "kssmath/tuned_sparse_matrix.hpp"
+
+#include "test.hpp"
+
+using namespace std;
+using namespace kss::math;
+using namespace kss::math::test;
+
+
+namespace {
+
+    const double eps = numeric_limits<double>::epsilon();
+
+    // Returns the largest absolute column sum, which bounds the 2-norm of a
+    // square matrix to within a factor of sqrt(n).
+    double norm1(const Matrix<double>& a) {
+        double nrm = 0;
+        for (size_t j = 0; j < a.cols(); ++j) {
+            double s = 0;
+            for (size_t i = 0; i < a.rows(); ++i) {
+                s += abs(a(i, j));
+            }
+            nrm = max(nrm, s);
+        }
+        return nrm;
+    }
+
+    // Returns ||b - Ax|| / ||b|| for a sparse matrix.
+    double sparseResidual(const SparseMatrix<double>& a, const vector<double>& x, const vector<double>& b) {
+        vector<double> ax(a.rows());
+        a.multiply(x.data(), ax.data());
+        double r = 0, bn = 0;
+        for (size_t i = 0; i < b.size(); ++i) {
+            r = hypot(r, b[i] - ax[i]);
+            bn = hypot(bn, b[i]);
+        }
+        return r / bn;
+    }
+
+    // Returns the normwise backward error ||b - Ax|| / (||A|| ||x|| + ||b||) in
+    // the infinity norm, which is of the order of the machine epsilon for a
+    // backward stable solver.
+    double backwardError(const SparseMatrix<double>& a, const vector<double>& x, const vector<double>& b) {
+        vector<double> ax(a.rows());
+        a.multiply(x.data(), ax.data());
+        double r = 0, anorm = 0;
+        for (size_t i = 0; i < a.rows(); ++i) {
+            r = max(r, abs(b[i] - ax[i]));
+            double sum = 0;
+            for (size_t k = a.rowPointers()[i]; k < a.rowPointers()[i + 1]; ++k) {
+                sum += abs(a.values()[k]);
+            }
+            anorm = max(anorm, sum);
+        }
+        return r / (anorm * maxAbs(x.begin(), x.end()) + maxAbs(b.begin(), b.end()));
+    }
+
+    // Returns a random n x n nonsymmetric matrix with the given bandwidth, which
+    // is not diagonally dominant, so that it needs pivoting.
+    SparseMatrix<double> randomBanded(size_t n, size_t bandwidth, uint64_t seed) {
+        const auto v = randomVector<double>(n * (2 * bandwidth + 1), seed);
+        vector<size_t> ptr(1, 0), idx;
+        vector<double> val;
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = (i > bandwidth ? i - bandwidth : 0); j <= min(n - 1, i + bandwidth); ++j) {
+                idx.push_back(j);
+                val.push_back(v[val.size()]);
+            }
+            ptr.push_back(idx.size());
+        }
+        return SparseMatrix<double>(n, n, move(ptr), move(idx), move(val));
+    }
+
+    // Returns a random rows x cols sparse matrix in which each entry is nonzero
+    // with the given probability.
+    SparseMatrix<double> randomSparse(size_t rows, size_t cols, double density, uint64_t seed) {
+        const auto mask = randomVector<double>(rows * cols, seed);
+        Matrix<double> a = randomMatrix<double>(rows, cols, seed + 1);
+        for (size_t i = 0; i < a.size(); ++i) {
+            if (mask[i] * 0.5 + 0.5 >= density) {
+                a.data()[i] = 0;
+            }
+        }
+        return SparseMatrix<double>(a);
+    }
+
+    // Checks that the column indices of each row of a are strictly increasing.
+    void checkSorted(const SparseMatrix<double>& a) {
+        for (size_t i = 0; i < a.rows(); ++i) {
+            for (size_t k = a.rowPointers()[i] + 1; k < a.rowPointers()[i + 1]; ++k) {
+                KSSMATH_CHECK(a.columnIndices()[k - 1] < a.columnIndices()[k]);
+            }
+            if (a.rowPointers()[i + 1] > a.rowPointers()[i]) {
+                KSSMATH_CHECK(a.columnIndices()[a.rowPointers()[i + 1] - 1] < a.cols());
+            }
+        }
+    }
+
+    // Returns a matrix whose row lengths vary from 0 to about cols/2, which
+    // makes the SELL-C-sigma padding and row sorting matter.
+    SparseMatrix<double> irregularRows(size_t rows, size_t cols, uint64_t seed) {
+        const auto v = randomVector<double>(rows * cols, seed);
+        vector<size_t> ptr(1, 0), idx;
+        vector<double> val;
+        for (size_t i = 0; i < rows; ++i) {
+            const size_t len = (i * 7919) % (cols / 2 + 1);
+            for (size_t k = 0; k < len; ++k) {
+                idx.push_back((k * 2 + i) % cols);
+                val.push_back(v[i * cols + k]);
+            }
+            sort(idx.end() - long(len), idx.end());
+            ptr.push_back(idx.size());
+        }
+        return SparseMatrix<double>(rows, cols, move(ptr), move(idx), move(val));
+    }
+
+    // Checks that multiply(x, y, threads) for the matrix b agrees with a*x.
+    template <class M>
+    void checkMultiply(const SparseMatrix<double>& a, const M& b) {
+        const auto x = randomVector<double>(a.cols(), 91);
+        vector<double> expected(a.rows());
+        a.multiply(x.data(), expected.data(), 1);
+        for (unsigned threads : { 1u, 4u }) {
+            vector<double> y(a.rows(), numeric_limits<double>::quiet_NaN());
+            b.multiply(x.data(), y.data(), threads);
+            for (size_t i = 0; i < y.size(); ++i) {
+                KSSMATH_CHECK_CLOSE(y[i], expected[i], 1e-13);
+            }
+        }
+    }
+
+    // An operator multiplying by diag(1, 2, ..., n), which is large enough for
+    // the vector operations of the Krylov methods to be split over threads.
+    LinearOperator<double> diagonalOperator(size_t n) {
+        return [n](const double* x, double* y) {
+            for (size_t i = 0; i < n; ++i) {
+                y[i] = double(i + 1) * x[i];
+            }
+        };
+    }
+
+    void addKrylovTests() {
+        add("sparse/krylov/threads", [] {
+            // The chunked reductions give the same bits on any number of threads.
+            const size_t n = 3 * kss::math::_private::krylovChunk + 17;
+            const auto x = randomVector<double>(n, 31);
+            const size_t k = 5;
+            Matrix<double> v(n, k);
+            for (size_t j = 0; j < k; ++j) {
+                const auto c = randomVector<double>(n, 32 + j);
+                copy(c.begin(), c.end(), v.column(j));
+                vector<double> h(k, 0.0);
+                kss::math::_private::orthogonalize(n, j, v.data(), n, v.column(j), h.data(), 1);
+                const double nrm = kss::math::_private::parallelNorm(n, v.column(j), 1);
+                for (size_t i = 0; i < n; ++i) {
+                    v(i, j) /= nrm;
+                }
+            }
+
+            const double nrm1 = kss::math::_private::parallelNorm(n, x.data(), 1);
+            vector<double> w1 = x, h1(k, 0.0);
+            kss::math::_private::orthogonalize(n, k, v.data(), n, w1.data(), h1.data(), 1);
+            for (unsigned threads : { 2u, 4u }) {
+                KSSMATH_CHECK(kss::math::_private::parallelNorm(n, x.data(), threads) == nrm1);
+                vector<double> w = x, h(k, 0.0);
+                kss::math::_private::orthogonalize(n, k, v.data(), n, w.data(), h.data(), threads);
+                KSSMATH_CHECK(w == w1);
+                KSSMATH_CHECK(h == h1);
+            }
+        });
+    }
+
+    void addConjugateGradientTests() {
+        add("sparse/cg/laplacian", [] {
+            const auto a = laplacian2d<double>(30);
+            const auto b = randomVector<double>(a.rows(), 51);
+            CGOptions opts;
+            opts.tolerance = 1e-10;
+            const auto res = conjugateGradient(sparseOperator(a), b, LinearOperator<double>(), opts);
+            KSSMATH_CHECK(res.converged);
+            KSSMATH_CHECK(res.residualNorm <= 1e-10);
+            KSSMATH_CHECK(sparseResidual(a, res.x, b) <= 1e-9);
+
+            opts.maxIterations = 5;
+            const auto partial = conjugateGradient(sparseOperator(a), b, LinearOperator<double>(), opts);
+            KSSMATH_CHECK(!partial.converged);
+            KSSMATH_CHECK(partial.iterations == 5);
+
+            const auto zero = conjugateGradient(sparseOperator(a), vector<double>(a.rows(), 0.0));
+            KSSMATH_CHECK(zero.converged);
+            KSSMATH_CHECK(zero.iterations == 0);
+        });
+
+        add("sparse/cg/threads", [] {
+            const size_t n = 5 * 16384 + 3;
+            const auto x = randomVector<double>(n, 52);
+            const auto y = randomVector<double>(n, 53);
+            const double dot1 = kss::math::_private::parallelDot(n, x.data(), y.data(), 1);
+            for (unsigned threads : { 2u, 4u }) {
+                KSSMATH_CHECK(kss::math::_private::parallelDot(n, x.data(), y.data(), threads) == dot1);
+            }
+
+            const auto a = laplacian2d<double>(300);
+            const auto b = randomVector<double>(a.rows(), 54);
+            CGOptions opts;
+            opts.maxIterations = 20;
+            opts.threads = 1;
+            const auto one = conjugateGradient(sparseOperator(a, 1), b, LinearOperator<double>(), opts);
+            for (unsigned threads : { 2u, 4u }) {
+                opts.threads = threads;
+                const auto res = conjugateGradient(sparseOperator(a, threads), b, LinearOperator<double>(), opts);
+                KSSMATH_CHECK(res.x == one.x);
+                KSSMATH_CHECK(res.residualNorm == one.residualNorm);
+            }
+        });
+
+        add("sparse/cg/notPositiveDefinite", [] {
+            const auto a = laplacian2d<double>(5);
+            const LinearOperator<double> negated = [&a](const double* x, double* y) {
+                a.multiply(x, y);
+                for (size_t i = 0; i < a.rows(); ++i) {
+                    y[i] = -y[i];
+                }
+            };
+            KSSMATH_CHECK_THROWS(conjugateGradient(negated, randomVector<double>(a.rows(), 55)),
+                                 NotPositiveDefiniteError);
+        });
+    }
+
+    void addAMGTests() {
+        add("sparse/amg/preconditioner", [] {
+            // AMG preconditioned CG converges in a number of iterations nearly
+            // independent of the grid size, and far fewer than plain CG.
+            const auto a = laplacian2d<double>(100);
+            const auto b = randomVector<double>(a.rows(), 61);
+            CGOptions copts;
+            copts.tolerance = 1e-10;
+            const auto plain = conjugateGradient(sparseOperator(a), b, LinearOperator<double>(), copts);
+            for (AMGSmoother smoother : { AMGSmoother::GaussSeidel, AMGSmoother::Chebyshev }) {
+                AMGOptions opts;
+                opts.smoother = smoother;
+                const SmoothedAggregationAMG<double> amg(a, opts);
+                KSSMATH_CHECK(amg.levels() >= 2);
+                KSSMATH_CHECK(amg.levelMatrix(amg.levels() - 1).rows() <= opts.coarseSize);
+                KSSMATH_CHECK(amg.operatorComplexity() > 1.0 && amg.operatorComplexity() < 2.0);
+
+                const auto res = conjugateGradient(sparseOperator(a), b, amg.preconditioner(), copts);
+                KSSMATH_CHECK(res.converged);
+                KSSMATH_CHECK(res.iterations <= 30);
+                KSSMATH_CHECK(res.iterations * 5 < plain.iterations);
+                KSSMATH_CHECK(sparseResidual(a, res.x, b) <= 1e-9);
+            }
+        });
+
+        add("sparse/amg/vcycle", [] {
+            // Repeated V-cycles on their own converge.
+            const auto a = laplacian2d<double>(60);
+            const auto b = randomVector<double>(a.rows(), 62);
+            const SmoothedAggregationAMG<double> amg(a);
+            vector<double> x(a.rows(), 0.0);
+            double previous = 1.0;
+            for (int i = 0; i < 10; ++i) {
+                amg.vcycle(b.data(), x.data());
+                const double r = sparseResidual(a, x, b);
+                KSSMATH_CHECK(r < previous);
+                previous = r;
+            }
+            KSSMATH_CHECK(previous <= 1e-4);
+        });
+
+        add("sparse/amg/threads", [] {
+            // The hierarchy and the preconditioner give the same bits on any
+            // number of threads.
+            const auto a = laplacian2d<double>(120);
+            const auto b = randomVector<double>(a.rows(), 63);
+            for (AMGSmoother smoother : { AMGSmoother::GaussSeidel, AMGSmoother::Chebyshev }) {
+                AMGOptions opts;
+                opts.smoother = smoother;
+                opts.threads = 1;
+                const SmoothedAggregationAMG<double> one(a, opts);
+                vector<double> x1(a.rows());
+                one.apply(b.data(), x1.data());
+                for (unsigned threads : { 2u, 4u }) {
+                    opts.threads = threads;
+                    const SmoothedAggregationAMG<double> amg(a, opts);
+                    KSSMATH_CHECK(amg.levels() == one.levels());
+                    for (size_t l = 0; l < amg.levels(); ++l) {
+                        KSSMATH_CHECK(amg.levelMatrix(l).values() == one.levelMatrix(l).values());
+                    }
+                    vector<double> x(a.rows());
+                    amg.apply(b.data(), x.data());
+                    KSSMATH_CHECK(x == x1);
+                }
+            }
+        });
+
+        add("sparse/amg/updateValues", [] {
+            // Scaling the matrix by 2 keeps the aggregates, so updating the
+            // values must give the same hierarchy as building it afresh.
+            const auto a = laplacian2d<double>(60);
+            auto a2 = a;
+            for (auto& v : a2.values()) {
+                v *= 2;
+            }
+            SmoothedAggregationAMG<double> amg(a);
+            amg.updateValues(a2);
+            const SmoothedAggregationAMG<double> fresh(a2);
+            KSSMATH_CHECK(amg.levels() == fresh.levels());
+            for (size_t l = 0; l < amg.levels(); ++l) {
+                KSSMATH_CHECK(amg.levelMatrix(l).values() == fresh.levelMatrix(l).values());
+            }
+            const auto b = randomVector<double>(a.rows(), 64);
+            vector<double> x(a.rows()), y(a.rows());
+            amg.apply(b.data(), x.data());
+            fresh.apply(b.data(), y.data());
+            KSSMATH_CHECK(x == y);
+
+            KSSMATH_CHECK_THROWS(amg.updateValues(laplacian2d<double>(59)), invalid_argument);
+        });
+
+        add("sparse/amg/arguments", [] {
+            KSSMATH_CHECK_THROWS(SmoothedAggregationAMG<double>(SparseMatrix<double>(4, 5)), invalid_argument);
+            auto a = laplacian2d<double>(10);
+            a.values()[0] = 0;
+            KSSMATH_CHECK_THROWS(SmoothedAggregationAMG<double>(a), NotPositiveDefiniteError);
+        });
+    }
+
+    void addSparseDirectTests() {
+        add("sparse/cholesky/residual", [] {
+            const auto a = laplacian2d<double>(30);
+            const auto b = randomVector<double>(a.rows(), 71);
+            const double logDet = Cholesky<double>(a.toDense()).logDeterminant();
+            for (SparseOrdering ordering : { SparseOrdering::Natural, SparseOrdering::MinimumDegree,
+                                             SparseOrdering::NestedDissection })
+            {
+                for (unsigned threads : { 1u, 4u }) {
+                    const SparseCholesky<double> chol(a, ordering, threads);
+                    KSSMATH_CHECK(backwardError(a, chol.solve(b), b) <= 10 * eps);
+                    KSSMATH_CHECK_CLOSE(chol.logDeterminant(), logDet, 1e-10 * abs(logDet));
+                }
+            }
+        });
+
+        add("sparse/cholesky/refactor", [] {
+            // A new matrix with the same pattern reuses the symbolic analysis,
+            // which may be shared with an LU factorization.
+            const auto a = laplacian2d<double>(20);
+            auto a2 = a;
+            for (size_t i = 0; i < a2.rows(); ++i) {
+                for (size_t k = a2.rowPointers()[i]; k < a2.rowPointers()[i + 1]; ++k) {
+                    if (a2.columnIndices()[k] == i) {
+                        a2.values()[k] += double(i % 7);
+                    }
+                }
+            }
+            const auto b = randomVector<double>(a.rows(), 72);
+            SparseCholesky<double> chol(a);
+            chol.refactor(a2);
+            KSSMATH_CHECK(chol.solve(b) == SparseCholesky<double>(chol.symbolic(), a2).solve(b));
+            KSSMATH_CHECK(backwardError(a2, chol.solve(b), b) <= 10 * eps);
+
+            const SparseLU<double> lu(chol.symbolic(), a2);
+            KSSMATH_CHECK(lu.symbolic() == chol.symbolic());
+            KSSMATH_CHECK(backwardError(a2, lu.solve(b), b) <= 10 * eps);
+
+            KSSMATH_CHECK_THROWS(chol.refactor(laplacian2d<double>(19)), invalid_argument);
+            KSSMATH_CHECK_THROWS(chol.solve(vector<double>(3)), invalid_argument);
+        });
+
+        add("sparse/cholesky/notPositiveDefinite", [] {
+            auto a = laplacian2d<double>(10);
+            for (auto& v : a.values()) {
+                v = -v;
+            }
+            KSSMATH_CHECK_THROWS(SparseCholesky<double>(a), NotPositiveDefiniteError);
+            KSSMATH_CHECK_THROWS(SparseCholesky<double>(SparseMatrix<double>(4, 5)), invalid_argument);
+        });
+
+        add("sparse/lu/residual", [] {
+            // Pivoting is restricted to the supernodes, so these need the residual
+            // check and refinement in solve to reach a backward error of eps.
+            for (size_t bandwidth : { 3u, 20u, 40u }) {
+                for (uint64_t seed : { 73u, 74u }) {
+                    const auto a = randomBanded(3600, bandwidth, seed);
+                    const auto b = randomVector<double>(a.rows(), 75);
+                    for (unsigned threads : { 1u, 4u }) {
+                        SparseLUOptions opts;
+                        opts.threads = threads;
+                        const SparseLU<double> lu(a, opts);
+                        KSSMATH_CHECK(lu.pivotGrowth() >= 1);
+                        const auto x = lu.solve(b);
+                        KSSMATH_CHECK(backwardError(a, x, b) <= 2 * eps);
+                    }
+                }
+            }
+        });
+
+        add("sparse/lu/refactor", [] {
+            const auto a = randomBanded(500, 4, 76);
+            const auto a2 = randomBanded(500, 4, 77);
+            const auto b = randomVector<double>(a.rows(), 78);
+            SparseLU<double> lu(a);
+            lu.refactor(a2);
+            KSSMATH_CHECK(backwardError(a2, lu.solve(b), b) <= 2 * eps);
+            KSSMATH_CHECK(lu.solve(b) == SparseLU<double>(lu.symbolic(), a2).solve(b));
+            KSSMATH_CHECK_THROWS(lu.refactor(randomBanded(500, 3, 76)), invalid_argument);
+            KSSMATH_CHECK_THROWS(lu.solve(vector<double>(3)), invalid_argument);
+        });
+
+        add("sparse/lu/needsOffDiagonalPivots", [] {
+            // A cyclic permutation has no nonzero diagonal entries, and no pivot
+            // within a supernode, which must be reported instead of returning NaN.
+            const size_t n = 200;
+            vector<size_t> ptr(1, 0), idx;
+            for (size_t i = 0; i < n; ++i) {
+                idx.push_back((i + 1) % n);
+                ptr.push_back(idx.size());
+            }
+            const SparseMatrix<double> p(n, n, move(ptr), move(idx), vector<double>(n, 1.0));
+            KSSMATH_CHECK_THROWS(SparseLU<double>(p).solve(randomVector<double>(n, 79)), SingularMatrixError);
+        });
+
+        add("sparse/lu/arguments", [] {
+            KSSMATH_CHECK_THROWS(SparseLU<double>(SparseMatrix<double>(4, 5)), invalid_argument);
+            auto a = laplacian2d<double>(5);
+            auto zero = a;
+            fill(zero.values().begin(), zero.values().end(), 0.0);
+            KSSMATH_CHECK_THROWS(SparseLU<double>(zero), SingularMatrixError);
+            a.values()[3] = numeric_limits<double>::quiet_NaN();
+            KSSMATH_CHECK_THROWS(SparseLU<double>(a), SingularMatrixError);
+        });
+    }
+
+    void addSparseProductTests() {
+        add("sparse/product/dense", [] {
+            // Dense rows of b exercise the dense accumulator and sparse ones the
+            // hash table, including its growth.
+            for (double density : { 0.01, 0.1, 0.6 }) {
+                const auto a = randomSparse(70, 90, density, 81);
+                const auto b = randomSparse(90, 300, density, 82);
+                const auto expected = multiply(a.toDense(), b.toDense());
+                for (SparseAccumulator acc : { SparseAccumulator::Automatic, SparseAccumulator::Hash,
+                                               SparseAccumulator::Dense })
+                {
+                    for (unsigned threads : { 1u, 4u }) {
+                        SparseProductOptions opts;
+                        opts.accumulator = acc;
+                        opts.threads = threads;
+                        const auto c = sparseProduct(a, b, opts);
+                        KSSMATH_CHECK(c.rows() == 70 && c.cols() == 300);
+                        checkSorted(c);
+                        const auto d = c.toDense();
+                        for (size_t i = 0; i < d.size(); ++i) {
+                            KSSMATH_CHECK_CLOSE(d.data()[i], expected.data()[i], 1e-13);
+                        }
+                    }
+                }
+            }
+        });
+
+        add("sparse/product/threads", [] {
+            const auto a = laplacian2d<double>(40);
+            SparseProductOptions opts;
+            opts.threads = 1;
+            const auto one = sparseProduct(a, a, opts);
+            for (unsigned threads : { 2u, 4u }) {
+                opts.threads = threads;
+                const auto c = sparseProduct(a, a, opts);
+                KSSMATH_CHECK(c.rowPointers() == one.rowPointers());
+                KSSMATH_CHECK(c.columnIndices() == one.columnIndices());
+                KSSMATH_CHECK(c.values() == one.values());
+            }
+        });
+
+        add("sparse/product/strided", [] {
+            // Columns a power of two apart, as in blocked patterns, which must
+            // not all fall into the same few slots of the hash table.
+            const size_t stride = 1024, n = 64;
+            vector<Triplet<double>> ta, tb;
+            for (size_t i = 0; i < 8; ++i) {
+                for (size_t k = 0; k < n; ++k) {
+                    ta.push_back({ i, k, double(i + k + 1) });
+                }
+            }
+            for (size_t k = 0; k < n; ++k) {
+                for (size_t j = 0; j < n; ++j) {
+                    if ((j + k) % 3 != 0) {
+                        tb.push_back({ k, j * stride + k % 2, 1.0 / double(j + k + 1) });
+                    }
+                }
+            }
+            const auto a = SparseMatrix<double>::fromTriplets(8, n, ta);
+            const auto b = SparseMatrix<double>::fromTriplets(n, n * stride, tb);
+            map<pair<size_t, size_t>, double> expected;
+            for (const auto& x : ta) {
+                for (const auto& y : tb) {
+                    if (x.col == y.row) {
+                        expected[make_pair(x.row, y.col)] += x.value * y.value;
+                    }
+                }
+            }
+            SparseProductOptions opts;
+            opts.accumulator = SparseAccumulator::Hash;
+            const auto c = sparseProduct(a, b, opts);
+            checkSorted(c);
+            KSSMATH_CHECK(c.nonZeros() == expected.size());
+            for (size_t i = 0; i < c.rows(); ++i) {
+                for (size_t k = c.rowPointers()[i]; k < c.rowPointers()[i + 1]; ++k) {
+                    const auto e = expected.find(make_pair(i, c.columnIndices()[k]));
+                    KSSMATH_CHECK(e != expected.end());
+                    KSSMATH_CHECK_CLOSE(c.values()[k], e->second, 1e-13);
+                }
+            }
+        });
+
+        add("sparse/product/arguments", [] {
+            KSSMATH_CHECK_THROWS(sparseProduct(SparseMatrix<double>(3, 4), SparseMatrix<double>(3, 4)),
+                                 invalid_argument);
+            const auto empty = sparseProduct(SparseMatrix<double>(3, 4), SparseMatrix<double>(4, 5));
+            KSSMATH_CHECK(empty.rows() == 3 && empty.cols() == 5 && empty.nonZeros() == 0);
+        });
+    }
+
+    void addSparseFormatTests() {
+        add("sparse/slicedEll/multiply", [] {
+            for (const auto& a : { irregularRows(1000, 80, 92), laplacian2d<double>(31), randomSparse(37, 53, 0.2, 93) }) {
+                for (size_t height : { 1u, 4u, 8u, 32u, 64u }) {
+                    for (size_t window : { 1u, 256u }) {
+                        SlicedEllOptions opts;
+                        opts.sliceHeight = height;
+                        opts.sortWindow = window;
+                        const SlicedEllMatrix<double> b(a, opts);
+                        KSSMATH_CHECK(b.nonZeros() == a.nonZeros());
+                        KSSMATH_CHECK(b.fillRatio() >= 1.0);
+                        checkMultiply(a, b);
+                    }
+                }
+            }
+
+            // Sorting within windows reduces the padding of irregular rows.
+            SlicedEllOptions opts;
+            opts.sliceHeight = 8;
+            opts.sortWindow = 1;
+            const auto a = irregularRows(1000, 80, 92);
+            const double unsorted = SlicedEllMatrix<double>(a, opts).fillRatio();
+            opts.sortWindow = 256;
+            KSSMATH_CHECK(SlicedEllMatrix<double>(a, opts).fillRatio() < unsorted);
+        });
+
+        add("sparse/slicedEll/arguments", [] {
+            SlicedEllOptions opts;
+            opts.sliceHeight = 0;
+            KSSMATH_CHECK_THROWS(SlicedEllMatrix<double>(laplacian2d<double>(3), opts), invalid_argument);
+            opts.sliceHeight = 65;
+            KSSMATH_CHECK_THROWS(SlicedEllMatrix<double>(laplacian2d<double>(3), opts), invalid_argument);
+        });
+
+        add("sparse/blockCsr/multiply", [] {
+            // The dimensions are not multiples of the block sizes, so the edge
+            // blocks are padded.
+            for (const auto& a : { irregularRows(301, 77, 94), laplacian2d<double>(17), randomSparse(37, 53, 0.2, 95) }) {
+                for (size_t br : { 1u, 2u, 3u, 4u }) {
+                    for (size_t bc : { 1u, 2u, 5u }) {
+                        const BlockSparseMatrix<double> b(a, br, bc);
+                        KSSMATH_CHECK(b.nonZeros() == a.nonZeros());
+                        KSSMATH_CHECK(b.storedEntries() == b.blocks() * br * bc);
+                        checkMultiply(a, b);
+                    }
+                }
+            }
+            KSSMATH_CHECK_THROWS(BlockSparseMatrix<double>(laplacian2d<double>(3), 0, 2), invalid_argument);
+            KSSMATH_CHECK_THROWS(BlockSparseMatrix<double>(laplacian2d<double>(3), 2, 0), invalid_argument);
+        });
+
+        add("sparse/tuned/formats", [] {
+            const auto a = irregularRows(500, 60, 96);
+            for (SparseFormat format : { SparseFormat::CSR, SparseFormat::SlicedEll, SparseFormat::BlockCSR }) {
+                const TunedSparseMatrix<double> b(a, format);
+                KSSMATH_CHECK(b.format() == format);
+                KSSMATH_CHECK(b.rows() == a.rows() && b.cols() == a.cols());
+                checkMultiply(a, b);
+            }
+            checkMultiply(a, TunedSparseMatrix<double>(a));
+
+            // Full 3 x 3 blocks strongly favor the block format.
+            const Matrix<double> dense = randomMatrix<double>(30, 30, 97);
+            KSSMATH_CHECK(TunedSparseMatrix<double>(SparseMatrix<double>(dense)).format() == SparseFormat::BlockCSR);
+        });
+    }
+
+    void addLanczosTests() {
+        add("sparse/lanczos/laplacian", [] {
+            const auto a = laplacian2d<double>(20);
+            const size_t n = a.rows();
+            const SymmetricEigen<double> dense(a.toDense());
+            for (Which which : { Which::Smallest, Which::Largest }) {
+                LanczosOptions opts;
+                opts.count = 4;
+                opts.which = which;
+                opts.basisSize = 40;
+                const LanczosEigen<double> eig(n, sparseOperator(a), opts);
+                KSSMATH_CHECK(eig.converged());
+                const size_t first = (which == Which::Smallest ? 0 : n - opts.count);
+                for (size_t i = 0; i < opts.count; ++i) {
+                    const double lambda = eig.eigenvalues()[i];
+                    KSSMATH_CHECK_CLOSE(lambda, dense.eigenvalues()[first + i], 1e-10);
+
+                    vector<double> x(eig.eigenvectors().column(i), eig.eigenvectors().column(i) + n), ax(n);
+                    a.multiply(x.data(), ax.data());
+                    for (size_t r = 0; r < n; ++r) {
+                        KSSMATH_CHECK_CLOSE(ax[r], lambda * x[r], 1e-10);
+                    }
+                }
+            }
+        });
+
+        add("sparse/lanczos/threads", [] {
+            const size_t n = 2 * kss::math::_private::krylovChunk + 5;
+            LanczosOptions opts;
+            opts.count = 3;
+            opts.maxRestarts = 3;
+            opts.threads = 1;
+            const LanczosEigen<double> one(n, diagonalOperator(n), opts);
+            for (unsigned threads : { 2u, 4u }) {
+                opts.threads = threads;
+                const LanczosEigen<double> eig(n, diagonalOperator(n), opts);
+                KSSMATH_CHECK(eig.eigenvalues() == one.eigenvalues());
+                KSSMATH_CHECK(equal(eig.eigenvectors().data(), eig.eigenvectors().data() + eig.eigenvectors().size(),
+                                    one.eigenvectors().data()));
+            }
+        });
+
+        add("sparse/lanczos/arguments", [] {
+            LanczosOptions opts;
+            opts.count = 0;
+            KSSMATH_CHECK_THROWS(LanczosEigen<double>(10, diagonalOperator(10), opts), invalid_argument);
+            opts.count = 11;
+            KSSMATH_CHECK_THROWS(LanczosEigen<double>(10, diagonalOperator(10), opts), invalid_argument);
+        });
+    }
+
+    void addArnoldiTests() {
+        add("sparse/arnoldi/residuals", [] {
+            // Random matrices, whose eigenvalues fill a disc and come in complex
+            // conjugate pairs. Every pair reported as converged must have a
+            // residual at the rounding level, not just a small estimate.
+            const size_t n = 400;
+            for (uint64_t seed : { 41u, 42u, 43u }) {
+                const auto a = randomMatrix<double>(n, n, seed);
+                const double anorm = norm1(a);
+                for (ArnoldiWhich which : { ArnoldiWhich::LargestMagnitude, ArnoldiWhich::LargestReal }) {
+                    ArnoldiOptions opts;
+                    opts.count = 4;
+                    opts.which = which;
+                    const ArnoldiEigen<double> eig(n, denseOperator(a), opts);
+                    KSSMATH_CHECK(eig.converged());
+
+                    const auto& lambda = eig.eigenvalues();
+                    const auto& x = eig.eigenvectors();
+                    for (size_t k = 0; k < opts.count; ++k) {
+                        if (k > 0) {
+                            if (which == ArnoldiWhich::LargestReal) {
+                                KSSMATH_CHECK(lambda[k].real() <= lambda[k - 1].real());
+                            }
+                            else {
+                                KSSMATH_CHECK(abs(lambda[k]) <= abs(lambda[k - 1]) * (1 + 1e-12));
+                            }
+                        }
+                        double res = 0, xnorm = 0;
+                        for (size_t i = 0; i < n; ++i) {
+                            complex<double> s = -lambda[k] * x(i, k);
+                            for (size_t j = 0; j < n; ++j) {
+                                s += a(i, j) * x(j, k);
+                            }
+                            res = hypot(res, abs(s));
+                            xnorm = hypot(xnorm, abs(x(i, k)));
+                        }
+                        KSSMATH_CHECK_CLOSE(xnorm, 1.0, 1e-12);
+                        KSSMATH_CHECK(res <= 100 * eps * anorm);
+                    }
+                }
+            }
+        });
+
+        add("sparse/arnoldi/threads", [] {
+            const size_t n = 2 * kss::math::_private::krylovChunk + 5;
+            ArnoldiOptions opts;
+            opts.count = 3;
+            opts.maxRestarts = 3;
+            opts.threads = 1;
+            const ArnoldiEigen<double> one(n, diagonalOperator(n), opts);
+            for (unsigned threads : { 2u, 4u }) {
+                opts.threads = threads;
+                const ArnoldiEigen<double> eig(n, diagonalOperator(n), opts);
+                KSSMATH_CHECK(eig.eigenvalues() == one.eigenvalues());
+                KSSMATH_CHECK(equal(eig.eigenvectors().data(), eig.eigenvectors().data() + eig.eigenvectors().size(),
+                                    one.eigenvectors().data()));
+            }
+        });
+
+        add("sparse/arnoldi/arguments", [] {
+            ArnoldiOptions opts;
+            opts.count = 0;
+            KSSMATH_CHECK_THROWS(ArnoldiEigen<double>(10, diagonalOperator(10), opts), invalid_argument);
+            opts.count = 11;
+            KSSMATH_CHECK_THROWS(ArnoldiEigen<double>(10, diagonalOperator(10), opts), invalid_argument);
+        });
+    }
+
+}
+
+
+void kss::math::test::addSparseTests() {
+    addConjugateGradientTests();
+    addAMGTests();
+    addSparseDirectTests();
+    addSparseProductTests();
+    addSparseFormatTests();
+    addKrylovTests();
+    addLanczosTests();
+    addArnoldiTests();
+}
@@ -0,0 +1,710 @@
+//
+//  system_tests.cpp
+//  kssmath_tests
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <list>
+#include <map>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#   include <pthread.h>
+#   include <sched.h>
+#endif
+
+#include "kssmath/aligned_buffer.hpp"
+#include "kssmath/amg.hpp"
+#include "kssmath/blas.hpp"
+#include "kssmath/conjugate_gradient.hpp"
+#include "kssmath/instrumentation.hpp"
+#include "kssmath/parallel.hpp"
+#include "kssmath/roofline.hpp"
+#include "kssmath/simd.hpp"
+#include "kssmath/task_graph.hpp"
+#include "kssmath/tuning.hpp"
+#include "kssmath/workspace.hpp"
+
+#include "test.hpp"
+
+using namespace std;
+using namespace kss::math;
+using namespace kss::math::test;
+
+
+namespace {
+
+    void addParallelTests() {
+        add("system/parallelFor/chunks", [] {
+            // The chunks are the same on any number of threads.
+            for (unsigned threads : { 1u, 2u, 4u }) {
+                mutex lock;
+                vector<pair<size_t, size_t>> chunks;
+                parallelFor(1000, 64, [&](size_t begin, size_t end) {
+                    lock_guard<mutex> l(lock);
+                    chunks.emplace_back(begin, end);
+                }, threads);
+                sort(chunks.begin(), chunks.end());
+                KSSMATH_CHECK(chunks.size() == 16);
+                for (size_t c = 0; c < chunks.size(); ++c) {
+                    KSSMATH_CHECK(chunks[c].first == c * 64);
+                    KSSMATH_CHECK(chunks[c].second == min<size_t>(c * 64 + 64, 1000));
+                }
+            }
+        });
+
+        add("system/parallelFor/exceptions", [] {
+            atomic<size_t> calls(0);
+            KSSMATH_CHECK_THROWS(parallelFor(100, 1, [&](size_t begin, size_t) {
+                ++calls;
+                if (begin == 10) {
+                    throw runtime_error("chunk failed");
+                }
+            }, 4), runtime_error);
+            KSSMATH_CHECK(calls >= 11);
+            parallelFor(0, 1, [](size_t, size_t) { throw runtime_error("not called"); }, 4);
+        });
+
+        add("system/parallelFor/pool", [] {
+            // The workers persist between calls, and a nested call runs on the
+            // thread that makes it.
+            set<thread::id> workers;
+            mutex lock;
+            for (int rep = 0; rep < 20; ++rep) {
+                parallelFor(64, 1, [&](size_t, size_t) {
+                    const auto id = this_thread::get_id();
+                    parallelFor(8, 1, [&](size_t, size_t) {
+                        KSSMATH_CHECK(this_thread::get_id() == id);
+                    }, 4);
+                    lock_guard<mutex> l(lock);
+                    workers.insert(id);
+                }, 4);
+            }
+            KSSMATH_CHECK(workers.size() <= 4);
+        });
+
+        add("system/parallelRanges/ranges", [] {
+            for (unsigned threads : { 1u, 3u, 4u }) {
+                mutex lock;
+                map<size_t, size_t> ranges;
+                parallelRanges(1000, 64, [&](size_t begin, size_t end) {
+                    lock_guard<mutex> l(lock);
+                    ranges[begin] = end;
+                }, threads);
+                KSSMATH_CHECK(ranges.size() == threads);
+                size_t next = 0;
+                for (const auto& r : ranges) {
+                    KSSMATH_CHECK(r.first == next && r.second > r.first);
+                    KSSMATH_CHECK(r.second == 1000 || r.second % 64 == 0);
+                    next = r.second;
+                }
+                KSSMATH_CHECK(next == 1000);
+            }
+
+            // Fewer units of granularity than threads.
+            size_t calls = 0;
+            parallelRanges(100, 64, [&](size_t begin, size_t end) {
+                KSSMATH_CHECK(end - begin == (begin == 0 ? 64 : 36));
+                ++calls;
+            }, 4);
+            KSSMATH_CHECK(calls == 2);
+            parallelRanges(0, 1, [](size_t, size_t) { throw runtime_error("not called"); }, 4);
+            KSSMATH_CHECK_THROWS(parallelRanges(100, 1, [](size_t begin, size_t) {
+                if (begin > 0) {
+                    throw runtime_error("range failed");
+                }
+            }, 4), runtime_error);
+        });
+
+        add("system/parallelRanges/placement", [] {
+            // Each range runs on the same thread every time. Pinned, that
+            // thread is on one CPU; otherwise it may use all the CPUs of the
+            // process, even if the calling thread is restricted to one.
+            const bool wasPinned = threadPinning();
+            auto owners = [](size_t cpus) {
+                mutex lock;
+                map<size_t, thread::id> owner;
+                parallelRanges(4096, 16, [&](size_t begin, size_t) {
+#if defined(__linux__)
+                    cpu_set_t set;
+                    CPU_ZERO(&set);
+                    KSSMATH_CHECK(pthread_getaffinity_np(pthread_self(), sizeof(set), &set) == 0);
+                    KSSMATH_CHECK(size_t(CPU_COUNT(&set)) == cpus);
+#else
+                    (void)cpus;
+#endif
+                    lock_guard<mutex> l(lock);
+                    owner[begin] = this_thread::get_id();
+                }, 4);
+                return owner;
+            };
+            setThreadPinning(true);
+            const auto first = owners(1);
+            KSSMATH_CHECK(first.size() == 4);
+            for (int rep = 0; rep < 10; ++rep) {
+                KSSMATH_CHECK(owners(1) == first);
+            }
+            setThreadPinning(false);
+            KSSMATH_CHECK(!threadPinning());
+            KSSMATH_CHECK(owners(defaultThreadCount()) == first);
+
+#if defined(__linux__)
+            cpu_set_t all, one;
+            KSSMATH_CHECK(pthread_getaffinity_np(pthread_self(), sizeof(all), &all) == 0);
+            KSSMATH_CHECK(size_t(CPU_COUNT(&all)) == defaultThreadCount());
+            CPU_ZERO(&one);
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET(cpu, &all)) {
+                    CPU_SET(cpu, &one);
+                    break;
+                }
+            }
+            KSSMATH_CHECK(pthread_setaffinity_np(pthread_self(), sizeof(one), &one) == 0);
+            const auto restricted = owners(defaultThreadCount());
+            KSSMATH_CHECK(pthread_setaffinity_np(pthread_self(), sizeof(all), &all) == 0);
+            KSSMATH_CHECK(restricted == first);
+#endif
+            setThreadPinning(wasPinned);
+
+            // AlignedBuffer is initialized through the same ranges.
+            AlignedBufferOptions opts;
+            opts.threads = 4;
+            AlignedBuffer<double> a(100000, 2.5, opts);
+            KSSMATH_CHECK(a[0] == 2.5 && a[99999] == 2.5);
+            vector<size_t> covered(a.size(), 0);
+            a.parallelRanges([&](size_t begin, size_t end) {
+                KSSMATH_CHECK(begin % 512 == 0);
+                for (size_t i = begin; i < end; ++i) {
+                    ++covered[i];
+                }
+            }, opts.threads);
+            KSSMATH_CHECK(all_of(covered.begin(), covered.end(), [](size_t c) { return c == 1; }));
+        });
+    }
+
+    // Checks every operation of Batch<T, N> and Mask<T, N> against the same
+    // operation on the lanes one at a time.
+    template <class T, size_t N>
+    void checkBatch() {
+        using B = simd::Batch<T, N>;
+        const auto u = randomVector<T>(N + 3, N), v = randomVector<T>(N, N + 1);
+        const B a = B::load(u.data() + 1), b = B::load(v.data());
+        KSSMATH_CHECK(B::size() == N && B().lanes()[N - 1] == T(0));
+
+        const B sum = a + b, difference = a - b, product = a * b, quotient = a / b, negated = -a;
+        B scaled = a;
+        scaled *= T(2);
+        scaled += T(1);
+        const B fused = simd::fma(a, b, B(T(0.5)));
+        const B low = simd::min(a, b), high = simd::max(a, b), magnitude = simd::abs(a);
+        const B root = simd::sqrt(magnitude);
+        const auto less = (a < b), same = (a == a), notEqual = (a != b);
+        const B selected = simd::select(less, a, B(T(7)));
+        for (size_t i = 0; i < N; ++i) {
+            const T x = u[i + 1], y = v[i];
+            KSSMATH_CHECK(a[i] == x);
+            KSSMATH_CHECK(sum[i] == x + y && difference[i] == x - y);
+            KSSMATH_CHECK(product[i] == x * y && quotient[i] == x / y && negated[i] == -x);
+            KSSMATH_CHECK(scaled[i] == x * T(2) + T(1));
+            KSSMATH_CHECK_CLOSE(fused[i], x * y + T(0.5), 2 * numeric_limits<T>::epsilon());
+            KSSMATH_CHECK(low[i] == min(x, y) && high[i] == max(x, y));
+            KSSMATH_CHECK(magnitude[i] == std::abs(x) && root[i] == std::sqrt(std::abs(x)));
+            KSSMATH_CHECK(less[i] == (x < y) && same[i] && notEqual[i] == (x != y));
+            KSSMATH_CHECK((a >= b)[i] == (x >= y) && (a > b)[i] == (x > y) && (a <= b)[i] == (x <= y));
+            KSSMATH_CHECK(selected[i] == (x < y ? x : T(7)));
+            KSSMATH_CHECK((~less)[i] == !(x < y) && (less & same)[i] == less[i]);
+            KSSMATH_CHECK((less | ~less)[i] && !(less ^ less)[i]);
+        }
+        KSSMATH_CHECK(same.all() && same.any() && !(~same).any());
+        KSSMATH_CHECK((simd::Mask<T, N>(true).all() && !simd::Mask<T, N>().any()));
+
+        // The sum is added pairwise, the upper half to the lower half.
+        vector<T> lanes(u.begin() + 1, u.begin() + 1 + N);
+        for (size_t w = N / 2; w > 0; w /= 2) {
+            for (size_t i = 0; i < w; ++i) {
+                lanes[i] += lanes[i + w];
+            }
+        }
+        KSSMATH_CHECK(simd::reduceAdd(a) == lanes[0]);
+        KSSMATH_CHECK(simd::reduceMin(a) == *min_element(u.begin() + 1, u.begin() + 1 + N));
+        KSSMATH_CHECK(simd::reduceMax(a) == *max_element(u.begin() + 1, u.begin() + 1 + N));
+
+        // Partial loads and stores leave the other lanes and elements alone.
+        const size_t count = (N + 1) / 2;
+        const B partial = B::loadPartial(u.data(), count);
+        vector<T> out(N + 1, T(9));
+        partial.storePartial(out.data(), count);
+        for (size_t i = 0; i < N; ++i) {
+            KSSMATH_CHECK(partial[i] == (i < count ? u[i] : T(0)));
+            KSSMATH_CHECK(out[i] == (i < count ? u[i] : T(9)));
+        }
+        a.store(out.data() + 1);
+        KSSMATH_CHECK(equal(out.begin(), out.end(), u.begin()));
+
+        vector<int> index(N);
+        for (size_t i = 0; i < N; ++i) {
+            index[i] = int((i * 5 + 2) % (N + 3));
+        }
+        const B gathered = B::gather(u.data(), index.data());
+        alignas(128) T aligned[N];
+        gathered.storeAligned(aligned);
+        for (size_t i = 0; i < N; ++i) {
+            KSSMATH_CHECK(aligned[i] == u[size_t(index[i])]);
+        }
+        KSSMATH_CHECK(B::loadAligned(aligned)[N - 1] == gathered[N - 1]);
+    }
+
+    template <class T>
+    void checkBatches() {
+        checkBatch<T, 1>();
+        checkBatch<T, 2>();
+        checkBatch<T, 4>();
+        checkBatch<T, 8>();
+        checkBatch<T, 16>();
+        checkBatch<T, simd::nativeLanes<T>()>();
+    }
+
+    void addSimdTests() {
+        add("system/simd/batch", [] {
+            checkBatches<float>();
+            checkBatches<double>();
+            KSSMATH_CHECK(simd::nativeLanes<float>() == 2 * simd::nativeLanes<double>());
+            KSSMATH_CHECK(simd::NativeBatch<double>::size() * sizeof(double) >= 16);
+        });
+
+        add("system/simd/specialValues", [] {
+            // NaN compares false, so min and max return their first argument,
+            // and abs clears the sign of -0 and infinity.
+            using B = simd::Batch<double, 4>;
+            const double nan = numeric_limits<double>::quiet_NaN(), inf = numeric_limits<double>::infinity();
+            const double values[4] = { nan, -0.0, -inf, 1.0 };
+            const B a = B::load(values), b(2.0);
+            KSSMATH_CHECK(std::isnan(simd::min(a, b)[0]) && std::isnan(simd::max(a, b)[0]));
+            KSSMATH_CHECK(simd::min(b, a)[0] == 2.0 && simd::max(b, a)[0] == 2.0);
+            KSSMATH_CHECK(!(a == a)[0] && (a != a)[0]);
+            const B m = simd::abs(a);
+            KSSMATH_CHECK(std::isnan(m[0]) && m[1] == 0.0 && !std::signbit(m[1]) && m[2] == inf && m[3] == 1.0);
+        });
+    }
+
+    // Returns the statistics recorded for the named kernel, with no calls if
+    // there are none.
+    KernelStatistics statisticsOf(const string& name) {
+        for (const auto& k : kernelStatistics()) {
+            if (k.name == name) {
+                return k;
+            }
+        }
+        return KernelStatistics();
+    }
+
+    // Turns instrumentation off, and clears what it recorded, at the end of a
+    // test.
+    class InstrumentationGuard {
+    public:
+        InstrumentationGuard() noexcept { resetKernelStatistics(); }
+        ~InstrumentationGuard() noexcept { disableInstrumentation(); resetKernelStatistics(); }
+        InstrumentationGuard(const InstrumentationGuard&) = delete;
+        InstrumentationGuard& operator=(const InstrumentationGuard&) = delete;
+    };
+
+    void instrumentedKernel(double flops) {
+        KSSMATH_INSTRUMENT("test::instrumentedKernel", flops, 8 * flops);
+    }
+
+    void addInstrumentationTests() {
+        add("system/instrumentation/counts", [] {
+            InstrumentationGuard guard;
+            const size_t m = 20, n = 30, k = 40;
+            const auto a = randomVector<double>(m * k, 81), b = randomVector<double>(k * n, 82);
+            vector<double> c(m * n);
+            auto gemm = [&] {
+                blas::gemm(blas::Op::NoTrans, blas::Op::NoTrans, m, n, k, 1.0, a.data(), m,
+                           b.data(), k, 0.0, c.data(), m);
+            };
+
+            gemm();
+            KSSMATH_CHECK(!isInstrumentationEnabled());
+            KSSMATH_CHECK(statisticsOf("blas::dgemm").calls == 0);
+
+            enableInstrumentation();
+            KSSMATH_CHECK(isInstrumentationEnabled());
+            for (int i = 0; i < 3; ++i) {
+                gemm();
+            }
+            instrumentedKernel(1e6);
+            disableInstrumentation();
+            gemm();
+
+            const auto s = statisticsOf("blas::dgemm");
+            KSSMATH_CHECK(s.calls == 3);
+            KSSMATH_CHECK(s.flops == 3 * 2.0 * m * n * k);
+            KSSMATH_CHECK(s.bytes == 3 * (double(m) * k + double(k) * n + 2.0 * m * n) * sizeof(double));
+            KSSMATH_CHECK(s.seconds > 0);
+            const auto t = statisticsOf("test::instrumentedKernel");
+            KSSMATH_CHECK(t.calls == 1 && t.flops == 1e6 && t.bytes == 8e6);
+
+            const auto all = kernelStatistics();
+            for (size_t i = 1; i < all.size(); ++i) {
+                KSSMATH_CHECK(all[i - 1].seconds >= all[i].seconds);
+            }
+            ostringstream report;
+            writeKernelReport(report);
+            KSSMATH_CHECK(report.str().find("blas::dgemm") != string::npos);
+            KSSMATH_CHECK(report.str().find("test::instrumentedKernel") != string::npos);
+
+            resetKernelStatistics();
+            KSSMATH_CHECK(statisticsOf("blas::dgemm").calls == 0);
+        });
+
+        add("system/instrumentation/threads", [] {
+            // Calls from several threads at once are all counted.
+            InstrumentationGuard guard;
+            enableInstrumentation();
+            parallelFor(1000, 1, [](size_t begin, size_t) { instrumentedKernel(double(begin)); }, 4);
+            disableInstrumentation();
+            const auto t = statisticsOf("test::instrumentedKernel");
+            KSSMATH_CHECK(t.calls == 1000);
+            KSSMATH_CHECK(t.flops == 999.0 * 1000.0 / 2);
+        });
+
+        add("system/instrumentation/hardware", [] {
+            // Hardware counters are often unavailable (in containers, or with a
+            // restrictive perf_event_paranoid), in which case enabling throws
+            // and leaves instrumentation off.
+            InstrumentationGuard guard;
+            InstrumentationOptions opts;
+            opts.hardwareCounters = true;
+            try {
+                enableInstrumentation(opts);
+            }
+            catch (const system_error&) {
+                KSSMATH_CHECK(!isInstrumentationEnabled());
+                return;
+            }
+            instrumentedKernel(1);
+            disableInstrumentation();
+            const auto t = statisticsOf("test::instrumentedKernel");
+            KSSMATH_CHECK(t.calls == 1 && t.hardware.instructions > 0);
+        });
+    }
+
+    void addRooflineTests() {
+        add("system/roofline/point", [] {
+            // A machine of 100 GFLOP/s and 20 GB/s has its ridge at 5 flop/byte.
+            MachinePeak peak;
+            peak.gflops = 100;
+            peak.gbytesPerSecond = 20;
+            KSSMATH_CHECK(peak.ridgeIntensity() == 5);
+
+            // 1 flop/byte, 8 GFLOP/s achieved of an attainable 20.
+            const auto memory = rooflinePoint(peak, 8e9, 8e9, 1.0);
+            KSSMATH_CHECK(memory.bound == RooflineBound::Memory);
+            KSSMATH_CHECK(memory.intensity == 1 && memory.attainableGflops == 20);
+            KSSMATH_CHECK_CLOSE(memory.fraction, 0.4, 1e-12);
+            KSSMATH_CHECK_CLOSE(memory.achievedGbytesPerSecond, 8.0, 1e-12);
+
+            // 10 flop/byte, 50 GFLOP/s achieved of an attainable 100.
+            const auto compute = rooflinePoint(peak, 25e9, 2.5e9, 0.5);
+            KSSMATH_CHECK(compute.bound == RooflineBound::Compute);
+            KSSMATH_CHECK(compute.attainableGflops == 100);
+            KSSMATH_CHECK_CLOSE(compute.fraction, 0.5, 1e-12);
+
+            // Kernels that report only one of their work and traffic.
+            const auto flopsOnly = rooflinePoint(peak, 10e9, 0, 1.0);
+            KSSMATH_CHECK(flopsOnly.bound == RooflineBound::Compute && flopsOnly.intensity == 0);
+            KSSMATH_CHECK_CLOSE(flopsOnly.fraction, 0.1, 1e-12);
+            const auto bytesOnly = rooflinePoint(peak, 0, 10e9, 1.0);
+            KSSMATH_CHECK(bytesOnly.bound == RooflineBound::Memory);
+            KSSMATH_CHECK_CLOSE(bytesOnly.fraction, 0.5, 1e-12);
+            KSSMATH_CHECK(rooflinePoint(peak, 0, 0, 1.0).bound == RooflineBound::Unknown);
+            KSSMATH_CHECK(rooflinePoint(peak, 1e9, 1e9, 0.0).fraction == 0);
+
+            KSSMATH_CHECK(string(rooflineBoundName(RooflineBound::Memory)) == "memory");
+            KSSMATH_CHECK(string(rooflineBoundName(RooflineBound::Compute)) == "compute");
+            KSSMATH_CHECK(string(rooflineBoundName(RooflineBound::Unknown)) == "unknown");
+
+            KernelStatistics s;
+            s.name = "test::streaming";
+            s.calls = 1;
+            s.flops = 8e9;
+            s.bytes = 8e9;
+            s.seconds = 1;
+            ostringstream report;
+            writeRooflineReport(report, peak, { s });
+            KSSMATH_CHECK(report.str().find("ridge at 5.00") != string::npos);
+            KSSMATH_CHECK(report.str().find("test::streaming") != string::npos);
+            KSSMATH_CHECK(report.str().find("40.0%") != string::npos);
+            KSSMATH_CHECK(report.str().find("memory") != string::npos);
+        });
+
+        add("system/roofline/measure", [] {
+            // A short measurement, which only has to give plausible numbers.
+            RooflineOptions opts;
+            opts.threads = 2;
+            opts.streamBytes = size_t(1) << 20;
+            opts.repetitions = 1;
+            opts.minTime = 0.001;
+            const auto peak = measureMachinePeak(opts);
+            KSSMATH_CHECK(peak.threads == 2);
+            KSSMATH_CHECK(peak.instructionSet == activeInstructionSet());
+            KSSMATH_CHECK(peak.gflops > 0.01 && peak.gflops < 1e6);
+            KSSMATH_CHECK(peak.gbytesPerSecond > 0.01 && peak.gbytesPerSecond < 1e5);
+            KSSMATH_CHECK(peak.ridgeIntensity() > 0);
+        });
+    }
+
+    // Restores the tuning parameters that were in use when it was created.
+    class TuningGuard {
+    public:
+        TuningGuard() : _params(tuningParameters()) {}
+        ~TuningGuard() noexcept { setTuningParameters(_params); }
+        TuningGuard(const TuningGuard&) = delete;
+        TuningGuard& operator=(const TuningGuard&) = delete;
+
+    private:
+        TuningParameters _params;
+    };
+
+    void writeText(const string& path, const string& text) {
+        ofstream out(path);
+        out << text;
+    }
+
+    string readText(const string& path) {
+        ifstream in(path);
+        return string(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+    }
+
+    bool sameParameters(const TuningParameters& a, const TuningParameters& b) {
+        return a.tuned == b.tuned && a.instructionSet == b.instructionSet && a.blockSize == b.blockSize
+            && a.threads == b.threads && a.sliceHeight == b.sliceHeight && a.spmvChunkRows == b.spmvChunkRows;
+    }
+
+    void addTuningTests() {
+        add("system/tuning/file", [] {
+            TemporaryFile tmp(".conf");
+            const string section = "[" + machineName() + "]\n";
+            writeText(tmp.path(), "# comment\n[another machine]\nblock_size = 64\n");
+            const auto defaults = readTuningFile(tmp.path());
+            KSSMATH_CHECK(sameParameters(defaults, defaultTuningParameters()) && !defaults.tuned);
+
+            // The section for this machine is added, and later replaced, while
+            // the other machine's is kept.
+            TuningParameters params;
+            params.tuned = true;
+            params.instructionSet = InstructionSet::Generic;
+            params.blockSize = 48;
+            params.threads = 3;
+            params.sliceHeight = 16;
+            params.spmvChunkRows = 512;
+            writeTuningFile(tmp.path(), params);
+            KSSMATH_CHECK(sameParameters(readTuningFile(tmp.path()), params));
+            params.blockSize = 128;
+            writeTuningFile(tmp.path(), params);
+            KSSMATH_CHECK(sameParameters(readTuningFile(tmp.path()), params));
+            const string text = readText(tmp.path());
+            KSSMATH_CHECK(text.find("[another machine]\nblock_size = 64\n") != string::npos);
+            KSSMATH_CHECK(text.find(section) == text.rfind(section));
+
+            // Unknown keys are ignored; bad values and lines are not.
+            writeText(tmp.path(), section + "block_size = 32\nfuture_key = 7\n");
+            const auto read = readTuningFile(tmp.path());
+            KSSMATH_CHECK(read.tuned && read.blockSize == 32);
+            KSSMATH_CHECK(read.sliceHeight == defaultTuningParameters().sliceHeight);
+            for (const char* bad : { "block_size = -1\n", "block_size = 0\n", "threads = two\n",
+                                     "slice_height = 65\n", "instruction_set = sse9\n", "block_size\n" })
+            {
+                writeText(tmp.path(), section + bad);
+                KSSMATH_CHECK_THROWS(readTuningFile(tmp.path()), runtime_error);
+            }
+            TemporaryFile missing(".conf");
+            KSSMATH_CHECK_THROWS(readTuningFile(missing.path()), system_error);
+        });
+
+        add("system/tuning/parameters", [] {
+            TuningGuard guard;
+            TuningParameters params = defaultTuningParameters();
+            KSSMATH_CHECK(isSupported(params.instructionSet) && !params.tuned);
+            params.blockSize = 64;
+            params.instructionSet = InstructionSet::Generic;
+            setTuningParameters(params);
+            KSSMATH_CHECK(tuningParameters().blockSize == 64);
+            KSSMATH_CHECK(activeInstructionSet() == InstructionSet::Generic);
+
+            for (auto change : { &TuningParameters::blockSize, &TuningParameters::sliceHeight,
+                                 &TuningParameters::spmvChunkRows })
+            {
+                TuningParameters bad = params;
+                bad.*change = 0;
+                KSSMATH_CHECK_THROWS(setTuningParameters(bad), invalid_argument);
+            }
+            TuningParameters tall = params;
+            tall.sliceHeight = 65;
+            KSSMATH_CHECK_THROWS(setTuningParameters(tall), invalid_argument);
+            KSSMATH_CHECK(tuningParameters().blockSize == 64);
+        });
+
+        add("system/tuning/autotune", [] {
+            // A very short run on small problems, which only has to choose
+            // valid parameters and make them current.
+            TuningGuard guard;
+            AutotuneOptions opts;
+            opts.denseSize = 128;
+            opts.sparseGrid = 32;
+            opts.maxThreads = 2;
+            opts.minTime = 0.0005;
+            opts.repetitions = 1;
+            ostringstream log;
+            opts.log = &log;
+            const auto params = autotune(opts);
+            KSSMATH_CHECK(params.tuned && isSupported(params.instructionSet));
+            KSSMATH_CHECK(params.blockSize > 0 && params.spmvChunkRows > 0);
+            KSSMATH_CHECK(params.sliceHeight > 0 && params.sliceHeight <= 64 && params.threads <= 2);
+            KSSMATH_CHECK(sameParameters(tuningParameters(), params));
+            KSSMATH_CHECK(!log.str().empty());
+        });
+    }
+
+    bool isAligned(const void* p, size_t alignment) {
+        return reinterpret_cast<uintptr_t>(p) % alignment == 0;
+    }
+
+    void addWorkspaceTests() {
+        add("system/workspace/arena", [] {
+            Workspace w(1000);
+            KSSMATH_CHECK(w.capacity() >= 1000 && w.used() == 0);
+            char* a = static_cast<char*>(w.allocate(3));
+            double* b = w.allocate<double>(100);
+            KSSMATH_CHECK(isAligned(a, 64) && isAligned(b, 64));
+            KSSMATH_CHECK(reinterpret_cast<char*>(b) >= a + 3);
+
+            // Outgrowing the first region adds another, and releasing to a
+            // marker gives back only what was allocated after it.
+            const auto marker = w.mark();
+            const size_t used = w.used();
+            float* big = w.allocate<float>(1 << 20);
+            KSSMATH_CHECK(isAligned(big, 64));
+            fill(big, big + (1 << 20), 1.0f);
+            KSSMATH_CHECK(w.used() >= used + (4 << 20));
+            w.release(marker);
+            KSSMATH_CHECK(w.used() == used);
+            {
+                Workspace::Scope scope(w);
+                w.allocate(5000);
+                KSSMATH_CHECK(w.used() > used);
+            }
+            KSSMATH_CHECK(w.used() == used);
+
+            // Once everything is released the workspace is reused without
+            // growing.
+            w.reset();
+            KSSMATH_CHECK(w.used() == 0);
+            const size_t capacity = w.capacity();
+            for (int i = 0; i < 3; ++i) {
+                w.allocate(3);
+                w.allocate<float>(1 << 20);
+                w.reset();
+                KSSMATH_CHECK(w.capacity() == capacity);
+            }
+
+            Workspace moved(move(w));
+            KSSMATH_CHECK(moved.capacity() == capacity);
+            KSSMATH_CHECK(w.capacity() == 0);
+        });
+
+        add("system/workspace/allocator", [] {
+            Workspace w;
+            {
+                Workspace::Scope scope(w);
+                vector<double, WorkspaceAllocator<double>> v{WorkspaceAllocator<double>(w)};
+                for (int i = 0; i < 1000; ++i) {
+                    v.push_back(i);
+                }
+                KSSMATH_CHECK(v[999] == 999 && isAligned(v.data(), 64));
+                KSSMATH_CHECK(w.used() >= 1000 * sizeof(double));
+            }
+            KSSMATH_CHECK(w.used() == 0);
+        });
+
+        add("system/workspace/solvers", [] {
+            // The solvers that take a workspace give the same bits with it as
+            // without, and leave it as they found it.
+            const auto a = laplacian2d<double>(40);
+            const auto b = randomVector<double>(a.rows(), 71);
+            Workspace w;
+            AMGOptions aopts;
+            const SmoothedAggregationAMG<double> plain(a, aopts);
+            aopts.workspace = &w;
+            const SmoothedAggregationAMG<double> pooled(a, aopts);
+            CGOptions copts;
+            copts.tolerance = 1e-10;
+            const auto expected = conjugateGradient(sparseOperator(a), b, plain.preconditioner(), copts);
+            copts.workspace = &w;
+            for (int i = 0; i < 2; ++i) {
+                const auto res = conjugateGradient(sparseOperator(a), b, pooled.preconditioner(), copts);
+                KSSMATH_CHECK(res.converged && res.iterations == expected.iterations);
+                KSSMATH_CHECK(res.x == expected.x);
+                KSSMATH_CHECK(w.used() == 0);
+            }
+        });
+
+        add("system/blockPool", [] {
+            KSSMATH_CHECK_THROWS(BlockPool(0), invalid_argument);
+            KSSMATH_CHECK_THROWS(BlockPool(8, 0), invalid_argument);
+
+            BlockPool pool(24, 4);
+            KSSMATH_CHECK(pool.blockSize() >= 24);
+            vector<void*> blocks;
+            for (int i = 0; i < 10; ++i) {
+                blocks.push_back(pool.allocate());
+                KSSMATH_CHECK(isAligned(blocks.back(), 16));
+            }
+            sort(blocks.begin(), blocks.end());
+            KSSMATH_CHECK(unique(blocks.begin(), blocks.end()) == blocks.end());
+
+            // Freed blocks are reused.
+            void* last = blocks.back();
+            pool.deallocate(last);
+            KSSMATH_CHECK(pool.allocate() == last);
+
+            BlockPool nodes(64);
+            {
+                list<int, PoolAllocator<int>> l{PoolAllocator<int>(nodes)};
+                for (int i = 0; i < 5000; ++i) {
+                    l.push_back(i);
+                }
+                l.remove_if([](int i) { return i % 2 == 0; });
+                KSSMATH_CHECK(l.size() == 2500 && l.front() == 1 && l.back() == 4999);
+            }
+        });
+    }
+
+}
+
+
+void kss::math::test::addSystemTests() {
+    addParallelTests();
+    addSimdTests();
+    addInstrumentationTests();
+    addRooflineTests();
+    addTuningTests();
+    addWorkspaceTests();
+}
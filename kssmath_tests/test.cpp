@@ -0,0 +1,117 @@
+//
+//  test.cpp
+//  kssmath_tests
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <iomanip>
+#include <ostream>
+#include <regex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include <unistd.h>
+
+#include "test.hpp"
+
+using namespace std;
+using namespace kss::math::test;
+
+
+namespace {
+
+    using Clock = chrono::steady_clock;
+
+    vector<pair<string, function<void()>>>& registry() {
+        static vector<pair<string, function<void()>>> tests;
+        return tests;
+    }
+
+}
+
+
+void kss::math::test::_private::fail(const char* file, int line, const string& message) {
+    // Report the file name without its directories.
+    string name(file);
+    const auto slash = name.find_last_of("/\\");
+    if (slash != string::npos) {
+        name.erase(0, slash + 1);
+    }
+    throw Failure(name + ":" + to_string(line) + ": " + message);
+}
+
+kss::math::test::TemporaryFile::TemporaryFile(const string& suffix) {
+    static atomic<unsigned> counter(0);
+    const char* dir = getenv("TMPDIR");
+    _path = string(dir && *dir ? dir : "/tmp");
+    if (_path.back() != '/') {
+        _path += '/';
+    }
+    _path += "kssmath_tests_" + to_string(getpid()) + "_" + to_string(counter++) + suffix;
+}
+
+kss::math::test::TemporaryFile::~TemporaryFile() noexcept {
+    std::remove(_path.c_str());
+}
+
+void kss::math::test::add(const string& name, function<void()> test) {
+    auto& tests = registry();
+    for (const auto& t : tests) {
+        if (t.first == name) {
+            throw invalid_argument("test " + name + " is already registered");
+        }
+    }
+    tests.emplace_back(name, move(test));
+}
+
+vector<string> kss::math::test::names() {
+    vector<string> v;
+    for (const auto& t : registry()) {
+        v.push_back(t.first);
+    }
+    return v;
+}
+
+size_t kss::math::test::run(const string& filter, ostream& out) {
+    const regex re(filter);
+    size_t passed = 0, failed = 0;
+    for (const auto& t : registry()) {
+        if (!regex_search(t.first, re)) {
+            continue;
+        }
+        const auto start = Clock::now();
+        string error;
+        try {
+            t.second();
+        }
+        catch (const Failure& e) {
+            error = e.what();
+        }
+        catch (const exception& e) {
+            error = string("unexpected exception: ") + e.what();
+        }
+        catch (...) {
+            error = "unexpected exception";
+        }
+        const double ms = chrono::duration<double, milli>(Clock::now() - start).count();
+        if (error.empty()) {
+            ++passed;
+            out << "ok      " << t.first << " (" << fixed << setprecision(1) << ms << " ms)" << endl;
+        }
+        else {
+            ++failed;
+            out << "FAILED  " << t.first << ": " << error << endl;
+        }
+    }
+    out << passed << " passed, " << failed << " failed" << endl;
+    return failed;
+}
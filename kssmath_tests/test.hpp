@@ -0,0 +1,263 @@
+//
+//  test.hpp
+//  kssmath_tests
+//
+//  Created by Steven W. Klassen on 2026-10-16.
+//  Copyright © 2026 Klassen Software Solutions. All rights reserved.
+//  Licensing follows the MIT License.
+//
+
+#ifndef kssmath_tests_test_hpp
+#define kssmath_tests_test_hpp
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "kssmath/matrix.hpp"
+#include "kssmath/sparse_matrix.hpp"
+
+namespace kss { namespace math { namespace test {
+
+    /*!
+     Thrown by the checks below when they fail, which ends the test.
+     */
+    class Failure : public std::runtime_error {
+    public:
+        using std::runtime_error::runtime_error;
+    };
+
+    /*!
+     Add a test. Names are paths such as "dense/cholesky/residual", so that
+     groups can be selected with a regular expression. A test passes if it
+     returns and fails if it throws.
+     @throws std::invalid_argument if the name is already registered.
+     */
+    void add(const std::string& name, std::function<void()> test);
+
+    /*!
+     Returns the names of the registered tests, in the order added.
+     */
+    std::vector<std::string> names();
+
+    /*!
+     Run the tests whose names contain a match of filter (a regular expression
+     in ECMAScript syntax), printing a line to out as each completes, and
+     return the number that failed.
+     @throws std::regex_error if the filter is not a valid regular expression.
+     */
+    std::size_t run(const std::string& filter, std::ostream& out);
+
+    namespace _private {
+        [[noreturn]] void fail(const char* file, int line, const std::string& message);
+
+        template <class A, class B, class Tol>
+        void checkClose(const A& a, const B& b, const Tol& tolerance,
+                        const char* expr, const char* file, int line)
+        {
+            if (!(std::abs(a - b) <= tolerance)) {
+                std::ostringstream s;
+                s.precision(17);
+                s << expr << ": " << a << " and " << b << " differ by more than " << tolerance;
+                fail(file, line, s.str());
+            }
+        }
+    }
+
+    /*!
+     Fail the test, with the location and text of the condition, unless cond is
+     true.
+     */
+#   define KSSMATH_CHECK(cond) \
+        do { \
+            if (!(cond)) { \
+                ::kss::math::test::_private::fail(__FILE__, __LINE__, #cond); \
+            } \
+        } while (false)
+
+    /*!
+     Fail the test unless |a - b| <= tolerance (which is false for a NaN).
+     */
+#   define KSSMATH_CHECK_CLOSE(a, b, tolerance) \
+        ::kss::math::test::_private::checkClose((a), (b), (tolerance), #a " vs " #b, __FILE__, __LINE__)
+
+    /*!
+     Fail the test unless expr throws an exception of type (or derived from)
+     Exception.
+     */
+#   define KSSMATH_CHECK_THROWS(expr, Exception) \
+        do { \
+            bool kssmathThrew = false; \
+            try { \
+                (void)(expr); \
+            } \
+            catch (const Exception&) { \
+                kssmathThrew = true; \
+            } \
+            if (!kssmathThrew) { \
+                ::kss::math::test::_private::fail(__FILE__, __LINE__, #expr " did not throw " #Exception); \
+            } \
+        } while (false)
+
+    /*!
+     A unique path in the temporary directory (TMPDIR, or /tmp) for a test that
+     writes a file. The file, if it was created, is removed by the destructor.
+     */
+    class TemporaryFile {
+    public:
+        explicit TemporaryFile(const std::string& suffix = std::string());
+        ~TemporaryFile() noexcept;
+        TemporaryFile(const TemporaryFile&) = delete;
+        TemporaryFile& operator=(const TemporaryFile&) = delete;
+
+        const std::string& path() const noexcept { return _path; }
+
+    private:
+        std::string _path;
+    };
+
+    /*!
+     Random inputs, uniform in [-1, 1), generated from the raw output of
+     std::mt19937_64 so that they are the same on every platform.
+     */
+    template <class T>
+    std::vector<T> randomVector(std::size_t n, std::uint64_t seed) {
+        std::mt19937_64 g(seed);
+        std::vector<T> v(n);
+        for (auto& x : v) {
+            x = T(double(g() >> 11) / 4503599627370496.0 - 1.0);
+        }
+        return v;
+    }
+
+    template <class T>
+    Matrix<T> randomMatrix(std::size_t rows, std::size_t cols, std::uint64_t seed) {
+        Matrix<T> a(rows, cols);
+        const auto v = randomVector<T>(rows * cols, seed);
+        std::copy(v.begin(), v.end(), a.data());
+        return a;
+    }
+
+    /*!
+     Returns a random symmetric matrix with n added to its diagonal, which makes
+     it positive definite.
+     */
+    template <class T>
+    Matrix<T> randomSpdMatrix(std::size_t n, std::uint64_t seed) {
+        Matrix<T> a = randomMatrix<T>(n, n, seed);
+        for (std::size_t j = 0; j < n; ++j) {
+            for (std::size_t i = j; i < n; ++i) {
+                a(j, i) = a(i, j) = (i == j ? std::abs(a(i, j)) + T(n) : a(i, j));
+            }
+        }
+        return a;
+    }
+
+    /*!
+     Returns the 5 point finite difference Laplacian on a k x k grid.
+     */
+    template <class T>
+    SparseMatrix<T> laplacian2d(std::size_t k) {
+        const std::size_t n = k * k;
+        std::vector<std::size_t> ptr(1, 0), idx;
+        std::vector<T> val;
+        for (std::size_t r = 0; r < n; ++r) {
+            const std::size_t i = r % k, j = r / k;
+            auto entry = [&](std::size_t c, T v) { idx.push_back(c); val.push_back(v); };
+            if (j > 0) { entry(r - k, T(-1)); }
+            if (i > 0) { entry(r - 1, T(-1)); }
+            entry(r, T(4));
+            if (i + 1 < k) { entry(r + 1, T(-1)); }
+            if (j + 1 < k) { entry(r + k, T(-1)); }
+            ptr.push_back(idx.size());
+        }
+        return SparseMatrix<T>(n, n, std::move(ptr), std::move(idx), std::move(val));
+    }
+
+    /*!
+     Returns y = A*x for a dense matrix, computed directly so that it does not
+     depend on the kernels under test.
+     */
+    template <class T>
+    std::vector<T> multiply(const Matrix<T>& a, const std::vector<T>& x) {
+        std::vector<T> y(a.rows(), T(0));
+        for (std::size_t j = 0; j < a.cols(); ++j) {
+            for (std::size_t i = 0; i < a.rows(); ++i) {
+                y[i] += a(i, j) * x[j];
+            }
+        }
+        return y;
+    }
+
+    /*!
+     Returns C = A*B for dense matrices, computed directly.
+     */
+    template <class T>
+    Matrix<T> multiply(const Matrix<T>& a, const Matrix<T>& b) {
+        Matrix<T> c(a.rows(), b.cols());
+        for (std::size_t j = 0; j < b.cols(); ++j) {
+            for (std::size_t p = 0; p < a.cols(); ++p) {
+                for (std::size_t i = 0; i < a.rows(); ++i) {
+                    c(i, j) += a(i, p) * b(p, j);
+                }
+            }
+        }
+        return c;
+    }
+
+    /*!
+     Returns the largest absolute value of the elements of a range.
+     */
+    template <class It>
+    auto maxAbs(It first, It last) -> typename std::decay<decltype(*first)>::type {
+        typename std::decay<decltype(*first)>::type m(0);
+        for (; first != last; ++first) {
+            m = std::max(m, std::abs(*first));
+        }
+        return m;
+    }
+
+    /*!
+     Returns the normwise relative residual ||b - Ax|| / (||A|| ||x|| + ||b||),
+     in the infinity norm, which is of the order of the machine epsilon for a
+     backward stable solver.
+     */
+    template <class T>
+    T relativeResidual(const Matrix<T>& a, const std::vector<T>& x, const std::vector<T>& b) {
+        std::vector<T> r = multiply(a, x);
+        for (std::size_t i = 0; i < r.size(); ++i) {
+            r[i] = b[i] - r[i];
+        }
+        T anorm(0);
+        for (std::size_t i = 0; i < a.rows(); ++i) {
+            T s(0);
+            for (std::size_t j = 0; j < a.cols(); ++j) {
+                s += std::abs(a(i, j));
+            }
+            anorm = std::max(anorm, s);
+        }
+        const T denom = anorm * maxAbs(x.begin(), x.end()) + maxAbs(b.begin(), b.end());
+        return maxAbs(r.begin(), r.end()) / (denom == T(0) ? T(1) : denom);
+    }
+
+    /*!
+     The tests of each part of the library, which are added by main.
+     */
+    void addDenseTests();
+    void addIoTests();
+    void addOptimizationTests();
+    void addSparseTests();
+    void addSystemTests();
+
+}}}
+
+#endif